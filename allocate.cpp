@@ -22,6 +22,331 @@
 #if defined(CRYPTOPP_POSIX_MEMALIGN_AVAILABLE)
 # include <stdlib.h>
 #endif
+// for the locked arena
+#if defined(CRYPTOPP_WIN32_AVAILABLE)
+# include <windows.h>
+#elif defined(CRYPTOPP_UNIX_AVAILABLE)
+# include <sys/mman.h>
+# include <unistd.h>
+# if !defined(CRYPTOPP_CXX11_SYNCHRONIZATION)
+#  include <pthread.h>
+# endif
+#endif
+
+// The pool keeps a header in front of each block. The header holds the
+// size class so the block can be recycled regardless of the element count
+// the caller passes during deallocation. 16 bytes keeps the payload on
+// the same 16-byte boundary as AlignedAllocate.
+ANONYMOUS_NAMESPACE_BEGIN
+
+using CryptoPP::byte;
+using CryptoPP::word64;
+
+const size_t POOL_HEADER = 16;
+const size_t POOL_MIN_BLOCK = 16;
+const unsigned int POOL_CLASSES = 11;  // 16 to 16384 bytes
+const unsigned int POOL_DEPTH = 32;    // blocks per class
+
+inline unsigned int PoolSizeClass(size_t size)
+{
+	unsigned int c = 0;
+	while (c < POOL_CLASSES && (POOL_MIN_BLOCK << c) < size)
+		c++;
+	return c;
+}
+
+#if defined(CRYPTOPP_CXX11_ATOMICS)
+std::atomic<bool> s_poolEnabled(true);
+inline bool PoolEnabled() {return s_poolEnabled.load(std::memory_order_relaxed);}
+#else
+volatile bool s_poolEnabled = true;
+inline bool PoolEnabled() {return s_poolEnabled;}
+#endif
+
+#if defined(CRYPTOPP_CXX11_THREAD_LOCAL)
+
+struct PoolBlock
+{
+	PoolBlock *next;
+};
+
+// The state has no constructor or destructor. It is zero initialized
+// and stays usable while other thread_local objects are destroyed. The
+// reaper returns the cached blocks at thread exit and sets dead so
+// later deallocations go straight to the system.
+struct PoolState
+{
+	PoolBlock *head[POOL_CLASSES];
+	unsigned int count[POOL_CLASSES];
+	CryptoPP::AllocatorPoolStatistics stats;
+	bool armed, dead;
+};
+
+thread_local PoolState s_poolState;
+
+void ReleasePoolState(PoolState &state)
+{
+	for (unsigned int c=0; c<POOL_CLASSES; ++c)
+	{
+		while (state.head[c])
+		{
+			PoolBlock *block = state.head[c];
+			state.head[c] = block->next;
+			CryptoPP::AlignedDeallocate(reinterpret_cast<byte*>(block) - POOL_HEADER);
+		}
+		state.count[c] = 0;
+	}
+	state.stats.cached = 0;
+}
+
+struct PoolReaper
+{
+	~PoolReaper()
+	{
+		ReleasePoolState(s_poolState);
+		s_poolState.dead = true;
+	}
+};
+
+void ArmPoolReaper()
+{
+	static thread_local PoolReaper reaper;
+	CRYPTOPP_UNUSED(reaper);
+	s_poolState.armed = true;
+}
+
+#endif  // CRYPTOPP_CXX11_THREAD_LOCAL
+
+ANONYMOUS_NAMESPACE_END
+
+// The locked arena is a list of regions. Each region is one mapping with
+// a guard page on either side. The region header and the free list live
+// inside the locked pages, so the arena never calls back into the heap.
+// Blocks carry a 16-byte header with their size, and free blocks are kept
+// in address order so neighbours can be merged.
+ANONYMOUS_NAMESPACE_BEGIN
+
+const size_t ARENA_HEADER = 16;
+const size_t ARENA_MIN_BLOCK = 32;
+
+struct ArenaBlock
+{
+	size_t size;  // includes the header
+	ArenaBlock *next;
+};
+
+struct ArenaRegion
+{
+	ArenaRegion *next;
+	CryptoPP::byte *begin, *end;
+	ArenaBlock *free;
+	size_t mapped;
+	bool locked;
+};
+
+// No constructor or destructor. The regions are never released so
+// static SecBlocks can be destroyed in any order at exit.
+struct ArenaState
+{
+	ArenaRegion *regions;
+	size_t regionSize;
+	size_t inUse;
+};
+
+ArenaState s_arena = {NULLPTR, 256*1024, 0};
+
+// The arena lock. Without a lock the arena is not shared, and each
+// LockedAllocate call maps a region of its own that LockedDeallocate
+// releases again.
+#if defined(CRYPTOPP_CXX11_SYNCHRONIZATION)
+// Never destroyed, like the regions it protects
+std::mutex& ArenaMutex()
+{
+	static std::mutex* mutex = new std::mutex;
+	return *mutex;
+}
+#elif defined(CRYPTOPP_WIN32_AVAILABLE)
+// A spin lock. A CRITICAL_SECTION needs an initialization that is
+// itself thread safe, and the critical sections are short.
+volatile LONG s_arenaLock = 0;
+#elif defined(CRYPTOPP_UNIX_AVAILABLE)
+pthread_mutex_t s_arenaMutex = PTHREAD_MUTEX_INITIALIZER;
+#else
+# define CRYPTOPP_ARENA_UNSHARED 1
+#endif
+
+// Holds the arena lock for the lifetime of the object
+class ArenaGuard
+{
+public:
+#if defined(CRYPTOPP_CXX11_SYNCHRONIZATION)
+	ArenaGuard() : m_guard(ArenaMutex()) {}
+
+private:
+	std::lock_guard<std::mutex> m_guard;
+#elif defined(CRYPTOPP_WIN32_AVAILABLE)
+	ArenaGuard() {
+		while (InterlockedCompareExchange(&s_arenaLock, 1, 0) != 0)
+			Sleep(0);
+	}
+	~ArenaGuard() {InterlockedExchange(&s_arenaLock, 0);}
+#elif defined(CRYPTOPP_UNIX_AVAILABLE)
+	ArenaGuard() {pthread_mutex_lock(&s_arenaMutex);}
+	~ArenaGuard() {pthread_mutex_unlock(&s_arenaMutex);}
+#else
+	ArenaGuard() {}
+#endif
+};
+
+inline size_t ArenaPageSize()
+{
+#if defined(CRYPTOPP_WIN32_AVAILABLE)
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return info.dwPageSize;
+#elif defined(CRYPTOPP_UNIX_AVAILABLE)
+	const long size = sysconf(_SC_PAGESIZE);
+	return size > 0 ? static_cast<size_t>(size) : 4096;
+#else
+	return 4096;
+#endif
+}
+
+inline size_t ArenaRoundUp(size_t n, size_t m)
+{
+	return (n + m - 1) / m * m;
+}
+
+// Maps size usable bytes between two guard pages. The usable pages are
+// locked and excluded from core dumps where the platform allows it.
+ArenaRegion* NewArenaRegion(size_t size)
+{
+	const size_t page = ArenaPageSize();
+	size = ArenaRoundUp(size + ArenaRoundUp(sizeof(ArenaRegion), ARENA_HEADER), page);
+	if (size > SIZE_MAX - 2*page)
+		throw std::bad_alloc();
+	const size_t mapped = size + 2*page;
+
+	CryptoPP::byte *base, *usable;
+	bool locked = false;
+
+#if defined(CRYPTOPP_WIN32_AVAILABLE)
+	base = static_cast<CryptoPP::byte*>(VirtualAlloc(NULLPTR, mapped, MEM_RESERVE, PAGE_NOACCESS));
+	if (base == NULLPTR)
+		throw std::bad_alloc();
+	usable = base + page;
+	if (VirtualAlloc(usable, size, MEM_COMMIT, PAGE_READWRITE) == NULLPTR)
+	{
+		VirtualFree(base, 0, MEM_RELEASE);
+		throw std::bad_alloc();
+	}
+	locked = (VirtualLock(usable, size) != 0);
+#elif defined(CRYPTOPP_UNIX_AVAILABLE)
+	void *p = mmap(NULLPTR, mapped, PROT_NONE, MAP_PRIVATE|MAP_ANON, -1, 0);
+	if (p == MAP_FAILED)
+		throw std::bad_alloc();
+	base = static_cast<CryptoPP::byte*>(p);
+	usable = base + page;
+	if (mprotect(usable, size, PROT_READ|PROT_WRITE) != 0)
+	{
+		munmap(base, mapped);
+		throw std::bad_alloc();
+	}
+	locked = (mlock(usable, size) == 0);
+# if defined(MADV_DONTDUMP)
+	(void)madvise(usable, size, MADV_DONTDUMP);
+# endif
+#else
+	// No page protection available. The arena still sub-allocates.
+	base = static_cast<CryptoPP::byte*>(CryptoPP::AlignedAllocate(mapped));
+	usable = base + page;
+#endif
+
+	ArenaRegion *region = reinterpret_cast<ArenaRegion*>(usable);
+	region->next = NULLPTR;
+	region->begin = usable + ArenaRoundUp(sizeof(ArenaRegion), ARENA_HEADER);
+	region->end = usable + size;
+	region->mapped = size;
+	region->locked = locked;
+
+	ArenaBlock *block = reinterpret_cast<ArenaBlock*>(region->begin);
+	block->size = region->end - region->begin;
+	block->next = NULLPTR;
+	region->free = block;
+
+	return region;
+}
+
+#if defined(CRYPTOPP_ARENA_UNSHARED)
+// Frees a region mapped by NewArenaRegion. Only the unshared arena
+// releases regions.
+void DeleteArenaRegion(ArenaRegion *region)
+{
+	CryptoPP::byte *usable = reinterpret_cast<CryptoPP::byte*>(region);
+	CryptoPP::AlignedDeallocate(usable - ArenaPageSize());
+}
+#endif
+
+// First fit. The remainder of a block is split off if it can hold
+// another block.
+void* ArenaRegionAllocate(ArenaRegion *region, size_t size)
+{
+	ArenaBlock **link = &region->free;
+	for (ArenaBlock *block = *link; block; link = &block->next, block = *link)
+	{
+		if (block->size < size)
+			continue;
+
+		if (block->size - size >= ARENA_MIN_BLOCK)
+		{
+			ArenaBlock *rest = reinterpret_cast<ArenaBlock*>(reinterpret_cast<CryptoPP::byte*>(block) + size);
+			rest->size = block->size - size;
+			rest->next = block->next;
+			*link = rest;
+			block->size = size;
+		}
+		else
+		{
+			*link = block->next;
+		}
+
+		block->next = NULLPTR;
+		return reinterpret_cast<CryptoPP::byte*>(block) + ARENA_HEADER;
+	}
+	return NULLPTR;
+}
+
+void ArenaRegionDeallocate(ArenaRegion *region, ArenaBlock *block)
+{
+	ArenaBlock *prev = NULLPTR, *next = region->free;
+	while (next && next < block)
+	{
+		prev = next;
+		next = next->next;
+	}
+
+	CryptoPP::byte *p = reinterpret_cast<CryptoPP::byte*>(block);
+	block->next = next;
+	if (next && p + block->size == reinterpret_cast<CryptoPP::byte*>(next))
+	{
+		block->size += next->size;
+		block->next = next->next;
+		next->size = 0; next->next = NULLPTR;
+	}
+
+	if (prev && reinterpret_cast<CryptoPP::byte*>(prev) + prev->size == p)
+	{
+		prev->size += block->size;
+		prev->next = block->next;
+		block->size = 0; block->next = NULLPTR;
+	}
+	else if (prev)
+		prev->next = block;
+	else
+		region->free = block;
+}
+
+ANONYMOUS_NAMESPACE_END
 
 NAMESPACE_BEGIN(CryptoPP)
 
@@ -102,6 +427,180 @@ void UnalignedDeallocate(void *p)
 	free(p);
 }
 
+void * PoolAllocate(size_t size)
+{
+	if (size > SIZE_MAX - POOL_HEADER)
+		throw InvalidArgument("PoolAllocate: requested size would cause integer overflow");
+
+	const unsigned int c = PoolSizeClass(size);
+
+#if defined(CRYPTOPP_CXX11_THREAD_LOCAL)
+	PoolState &state = s_poolState;
+	if (c < POOL_CLASSES && state.head[c] && PoolEnabled())
+	{
+		PoolBlock *block = state.head[c];
+		state.head[c] = block->next;
+		block->next = NULLPTR;
+		state.count[c]--;
+
+		state.stats.hits++;
+		state.stats.bytes += POOL_MIN_BLOCK << c;
+		state.stats.cached -= POOL_MIN_BLOCK << c;
+		return block;
+	}
+	state.stats.misses++;
+#endif
+
+	// Round up so the block can serve any request in its class
+	if (c < POOL_CLASSES)
+		size = POOL_MIN_BLOCK << c;
+
+	byte *p = static_cast<byte*>(AlignedAllocate(size + POOL_HEADER));
+	*reinterpret_cast<size_t*>(p) = c;
+	return p + POOL_HEADER;
+}
+
+void PoolDeallocate(void *ptr)
+{
+	if (ptr == NULLPTR)
+		return;
+
+	byte *p = static_cast<byte*>(ptr) - POOL_HEADER;
+	const size_t c = *reinterpret_cast<size_t*>(p);
+	CRYPTOPP_ASSERT(c <= POOL_CLASSES);
+
+#if defined(CRYPTOPP_CXX11_THREAD_LOCAL)
+	PoolState &state = s_poolState;
+	if (c < POOL_CLASSES && state.count[c] < POOL_DEPTH && !state.dead && PoolEnabled())
+	{
+		if (!state.armed)
+			ArmPoolReaper();
+
+		PoolBlock *block = static_cast<PoolBlock*>(ptr);
+		block->next = state.head[c];
+		state.head[c] = block;
+		state.count[c]++;
+
+		state.stats.cached += POOL_MIN_BLOCK << c;
+		return;
+	}
+#else
+	CRYPTOPP_UNUSED(c);
+#endif
+
+	AlignedDeallocate(p);
+}
+
+void SetAllocatorPool(bool enable)
+{
+	s_poolEnabled = enable;
+}
+
+AllocatorPoolStatistics GetAllocatorPoolStatistics()
+{
+#if defined(CRYPTOPP_CXX11_THREAD_LOCAL)
+	return s_poolState.stats;
+#else
+	AllocatorPoolStatistics stats = {0, 0, 0, 0};
+	return stats;
+#endif
+}
+
+void ReleaseAllocatorPool()
+{
+#if defined(CRYPTOPP_CXX11_THREAD_LOCAL)
+	ReleasePoolState(s_poolState);
+#endif
+}
+
+void * LockedAllocate(size_t size)
+{
+	if (size > SIZE_MAX - ARENA_HEADER - ARENA_MIN_BLOCK)
+		throw InvalidArgument("LockedAllocate: requested size would cause integer overflow");
+
+	// Header plus payload, rounded to keep payloads 16-byte aligned
+	const size_t total = STDMAX(ArenaRoundUp(size + ARENA_HEADER, ARENA_HEADER), ARENA_MIN_BLOCK);
+
+#if defined(CRYPTOPP_ARENA_UNSHARED)
+	ArenaRegion *region = NewArenaRegion(total);
+	void *p = ArenaRegionAllocate(region, total);
+	CRYPTOPP_ASSERT(p != NULLPTR);
+	return p;
+#else
+	ArenaGuard guard;
+
+	void *p = NULLPTR;
+	for (ArenaRegion *region = s_arena.regions; region && !p; region = region->next)
+		p = ArenaRegionAllocate(region, total);
+
+	if (p == NULLPTR)
+	{
+		ArenaRegion *region = NewArenaRegion(STDMAX(s_arena.regionSize, total));
+		region->next = s_arena.regions;
+		s_arena.regions = region;
+
+		p = ArenaRegionAllocate(region, total);
+		CRYPTOPP_ASSERT(p != NULLPTR);
+	}
+
+	s_arena.inUse += reinterpret_cast<ArenaBlock*>(static_cast<byte*>(p) - ARENA_HEADER)->size;
+	return p;
+#endif
+}
+
+void LockedDeallocate(void *ptr)
+{
+	if (ptr == NULLPTR)
+		return;
+
+	byte *p = static_cast<byte*>(ptr);
+	ArenaBlock *block = reinterpret_cast<ArenaBlock*>(p - ARENA_HEADER);
+
+#if defined(CRYPTOPP_ARENA_UNSHARED)
+	// The block is the first one in its own region
+	SecureWipeBuffer(p, block->size - ARENA_HEADER);
+	DeleteArenaRegion(reinterpret_cast<ArenaRegion*>(reinterpret_cast<byte*>(block) -
+		ArenaRoundUp(sizeof(ArenaRegion), ARENA_HEADER)));
+#else
+	ArenaGuard guard;
+
+	for (ArenaRegion *region = s_arena.regions; region; region = region->next)
+	{
+		if (p > region->begin && p < region->end)
+		{
+			s_arena.inUse -= block->size;
+			SecureWipeBuffer(p, block->size - ARENA_HEADER);
+			ArenaRegionDeallocate(region, block);
+			return;
+		}
+	}
+
+	// Not an arena pointer
+	CRYPTOPP_ASSERT(0);
+#endif
+}
+
+void SetLockedArenaSize(size_t size)
+{
+	ArenaGuard guard;
+
+	s_arena.regionSize = size;
+}
+
+LockedArenaStatistics GetLockedArenaStatistics()
+{
+	ArenaGuard guard;
+
+	LockedArenaStatistics stats = {0, 0, true};
+	for (ArenaRegion *region = s_arena.regions; region; region = region->next)
+	{
+		stats.reserved += region->end - region->begin;
+		stats.locked = stats.locked && region->locked;
+	}
+	stats.inUse = s_arena.inUse;
+	return stats;
+}
+
 NAMESPACE_END
 
 #endif  // CRYPTOPP_IMPORTS
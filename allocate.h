@@ -69,6 +69,123 @@ CRYPTOPP_DLL void * CRYPTOPP_API UnalignedAllocate(size_t size);
 ///  <A HREF="http://github.com/weidai11/cryptopp/issues/779">Issue 779</A>
 CRYPTOPP_DLL void CRYPTOPP_API UnalignedDeallocate(void *ptr);
 
+/// \brief Allocator pool counters
+/// \details The counters are kept per thread and describe the free lists of
+///  the calling thread.
+/// \since Crypto++ 8.4
+/// \sa GetAllocatorPoolStatistics, PoolAllocate
+struct AllocatorPoolStatistics
+{
+	/// \brief Requests satisfied from a free list
+	word64 hits;
+	/// \brief Requests passed to the system allocator
+	word64 misses;
+	/// \brief Bytes handed out from the free lists
+	word64 bytes;
+	/// \brief Bytes currently held in the free lists
+	word64 cached;
+};
+
+/// \brief Allocates a buffer from the allocator pool
+/// \param size the size of the buffer
+/// \details PoolAllocate rounds requests up to a power of two size class
+///  between 16 and 16384 bytes, and tries the free list of the calling
+///  thread for that class first. Larger requests and misses go to
+///  AlignedAllocate. The buffer is aligned on a 16-byte boundary.
+/// \details AllocatorWithCleanup uses PoolAllocate and PoolDeallocate when
+///  CRYPTOPP_ALLOCATOR_POOL is defined in config.h.
+/// \since Crypto++ 8.4
+/// \sa PoolDeallocate, SetAllocatorPool, GetAllocatorPoolStatistics
+CRYPTOPP_DLL void* CRYPTOPP_API PoolAllocate(size_t size);
+
+/// \brief Frees a buffer allocated with PoolAllocate
+/// \param ptr the buffer to free
+/// \details PoolDeallocate puts the buffer on the free list of the calling
+///  thread if the list for its size class has room. Otherwise the buffer
+///  is returned to the system. The buffer is not wiped, so the caller must
+///  wipe it first. AllocatorWithCleanup does so.
+/// \details A buffer may be freed on a different thread than the one that
+///  allocated it. The free lists are returned to the system when the
+///  thread exits.
+/// \since Crypto++ 8.4
+/// \sa PoolAllocate, ReleaseAllocatorPool
+CRYPTOPP_DLL void CRYPTOPP_API PoolDeallocate(void *ptr);
+
+/// \brief Enables or disables the allocator pool
+/// \param enable flag indicating the free lists should be used
+/// \details The pool is enabled by default. When it is disabled,
+///  PoolAllocate and PoolDeallocate go directly to the system allocator.
+///  Blocks that are already cached stay in place until the thread exits or
+///  ReleaseAllocatorPool is called. The setting applies to all threads.
+/// \since Crypto++ 8.4
+CRYPTOPP_DLL void CRYPTOPP_API SetAllocatorPool(bool enable);
+
+/// \brief Retrieves the allocator pool counters
+/// \returns the counters of the calling thread
+/// \details The counters are zero if the compiler does not provide
+///  <tt>thread_local</tt>. In that case the pool does not cache blocks.
+/// \since Crypto++ 8.4
+CRYPTOPP_DLL AllocatorPoolStatistics CRYPTOPP_API GetAllocatorPoolStatistics();
+
+/// \brief Returns cached blocks to the system
+/// \details ReleaseAllocatorPool empties the free lists of the calling
+///  thread. The other counters are not reset.
+/// \since Crypto++ 8.4
+CRYPTOPP_DLL void CRYPTOPP_API ReleaseAllocatorPool();
+
+/// \brief Locked arena counters
+/// \since Crypto++ 8.4
+/// \sa GetLockedArenaStatistics, LockedAllocate
+struct LockedArenaStatistics
+{
+	/// \brief Bytes mapped for the arena, excluding guard pages
+	word64 reserved;
+	/// \brief Bytes handed out, including block headers
+	word64 inUse;
+	/// \brief Flag indicating every region is locked in memory
+	bool locked;
+};
+
+/// \brief Allocates a buffer from the locked arena
+/// \param size the size of the buffer
+/// \details The locked arena is a process-wide set of regions intended for
+///  long-lived secrets like private keys and key schedules. Each region is
+///  mapped once, locked in memory with <tt>mlock</tt> or <tt>VirtualLock</tt>,
+///  excluded from core dumps with <tt>MADV_DONTDUMP</tt> where available, and
+///  placed between two inaccessible guard pages. Buffers are carved from the
+///  regions so there is no system call per allocation. The buffer is aligned
+///  on a 16-byte boundary.
+/// \details If the arena is full then another region is mapped. If the
+///  operating system refuses to lock a region, for example because
+///  <tt>RLIMIT_MEMLOCK</tt> is too small, the region is still used.
+///  GetLockedArenaStatistics() reports whether all regions are locked.
+/// \details Regions are never returned to the operating system.
+/// \details The arena is shared by all threads and guarded by a lock. Where
+///  no lock is available, each buffer gets a region of its own that is
+///  released by LockedDeallocate().
+/// \since Crypto++ 8.4
+/// \sa LockedDeallocate, LockedAllocatorWithCleanup, SetLockedArenaSize
+CRYPTOPP_DLL void* CRYPTOPP_API LockedAllocate(size_t size);
+
+/// \brief Frees a buffer allocated with LockedAllocate
+/// \param ptr the buffer to free
+/// \details The whole buffer is wiped before it is returned to the arena.
+/// \since Crypto++ 8.4
+/// \sa LockedAllocate
+CRYPTOPP_DLL void CRYPTOPP_API LockedDeallocate(void *ptr);
+
+/// \brief Sets the size of locked arena regions
+/// \param size the usable size of each new region, in bytes
+/// \details The size applies to regions mapped after the call. The default
+///  is 256 KB. A request larger than the size gets a region of its own.
+/// \since Crypto++ 8.4
+CRYPTOPP_DLL void CRYPTOPP_API SetLockedArenaSize(size_t size);
+
+/// \brief Retrieves the locked arena counters
+/// \returns the counters for the process
+/// \since Crypto++ 8.4
+CRYPTOPP_DLL LockedArenaStatistics CRYPTOPP_API GetLockedArenaStatistics();
+
 NAMESPACE_END
 
 #endif  // CRYPTOPP_ALLOCATE_H
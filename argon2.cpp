@@ -0,0 +1,545 @@
+// argon2.cpp - written and placed in public domain by the Crypto++ project.
+//              Based on RFC 9106 and the reference implementation by
+//              Alex Biryukov, Daniel Dinu and Dmitry Khovratovich.
+
+#include "pch.h"
+
+#include "argon2.h"
+#include "algparam.h"
+#include "argnames.h"
+#include "allocate.h"
+#include "blake2.h"
+#include "stdcpp.h"
+#include "misc.h"
+#include "cpu.h"
+
+#include <sstream>
+#include <limits>
+
+#ifdef _OPENMP
+# include <omp.h>
+#endif
+
+#if defined(__linux__)
+# include <stdlib.h>
+# include <sys/mman.h>
+#endif
+
+NAMESPACE_BEGIN(CryptoPP)
+
+#if (CRYPTOPP_AVX2_AVAILABLE)
+extern void Argon2_FillBlock_AVX2(word64 *next, const word64 *prev, const word64 *ref, bool withXor);
+#endif
+#if (CRYPTOPP_SSSE3_AVAILABLE)
+extern void Argon2_FillBlock_SSSE3(word64 *next, const word64 *prev, const word64 *ref, bool withXor);
+#endif
+
+NAMESPACE_END
+
+ANONYMOUS_NAMESPACE_BEGIN
+
+using CryptoPP::byte;
+using CryptoPP::word32;
+using CryptoPP::word64;
+using CryptoPP::BLAKE2b;
+using CryptoPP::GetWord;
+using CryptoPP::PutWord;
+using CryptoPP::rotrConstant;
+using CryptoPP::LITTLE_ENDIAN_ORDER;
+
+const unsigned int ARGON2_VERSION = 0x13;
+const unsigned int ARGON2_BLOCKSIZE = 1024;
+const unsigned int ARGON2_QWORDS = ARGON2_BLOCKSIZE / 8;
+const unsigned int ARGON2_SYNC_POINTS = 4;
+const unsigned int ARGON2_PREHASH_SEED = 72;
+
+typedef void (*FillBlockFn)(word64 *next, const word64 *prev, const word64 *ref, bool withXor);
+
+inline word64 BlaMka(word64 x, word64 y)
+{
+    const word64 m = static_cast<word64>(static_cast<word32>(x)) * static_cast<word32>(y);
+    return x + y + 2 * m;
+}
+
+inline void GB(word64& a, word64& b, word64& c, word64& d)
+{
+    a = BlaMka(a, b); d = rotrConstant<32>(d ^ a);
+    c = BlaMka(c, d); b = rotrConstant<24>(b ^ c);
+    a = BlaMka(a, b); d = rotrConstant<16>(d ^ a);
+    c = BlaMka(c, d); b = rotrConstant<63>(b ^ c);
+}
+
+// The BLAKE2b round function P with BlaMka in place of addition
+inline void P(word64& v0, word64& v1, word64& v2, word64& v3,
+              word64& v4, word64& v5, word64& v6, word64& v7,
+              word64& v8, word64& v9, word64& v10, word64& v11,
+              word64& v12, word64& v13, word64& v14, word64& v15)
+{
+    GB(v0, v4, v8, v12); GB(v1, v5, v9, v13);
+    GB(v2, v6, v10, v14); GB(v3, v7, v11, v15);
+    GB(v0, v5, v10, v15); GB(v1, v6, v11, v12);
+    GB(v2, v7, v8, v13); GB(v3, v4, v9, v14);
+}
+
+// next = G(prev, ref), or next ^= G(prev, ref) when withXor is set.
+// ref and next may be the same block.
+void Argon2_FillBlock_CXX(word64 *next, const word64 *prev, const word64 *ref, bool withXor)
+{
+    word64 R[ARGON2_QWORDS], T[ARGON2_QWORDS];
+
+    for (unsigned int i = 0; i < ARGON2_QWORDS; ++i)
+        R[i] = prev[i] ^ ref[i];
+    for (unsigned int i = 0; i < ARGON2_QWORDS; ++i)
+        T[i] = withXor ? R[i] ^ next[i] : R[i];
+
+    // Rows are 16 consecutive words
+    for (unsigned int i = 0; i < 8; ++i)
+    {
+        word64* v = R + 16 * i;
+        P(v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7],
+          v[8], v[9], v[10], v[11], v[12], v[13], v[14], v[15]);
+    }
+
+    // Columns are pairs of words, one pair from each row
+    for (unsigned int i = 0; i < 8; ++i)
+    {
+        word64* v = R + 2 * i;
+        P(v[0], v[1], v[16], v[17], v[32], v[33], v[48], v[49],
+          v[64], v[65], v[80], v[81], v[96], v[97], v[112], v[113]);
+    }
+
+    for (unsigned int i = 0; i < ARGON2_QWORDS; ++i)
+        next[i] = T[i] ^ R[i];
+}
+
+inline FillBlockFn GetFillBlock()
+{
+#if (CRYPTOPP_AVX2_AVAILABLE)
+    if (CryptoPP::HasAVX2())
+        return &CryptoPP::Argon2_FillBlock_AVX2;
+#endif
+#if (CRYPTOPP_SSSE3_AVAILABLE)
+    if (CryptoPP::HasSSSE3())
+        return &CryptoPP::Argon2_FillBlock_SSSE3;
+#endif
+    return &Argon2_FillBlock_CXX;
+}
+
+inline void LE32ENC(byte* out, word32 in)
+{
+    PutWord(false, LITTLE_ENDIAN_ORDER, out, in);
+}
+
+inline void UpdateLength(BLAKE2b& hash, size_t length)
+{
+    byte buf[4];
+    LE32ENC(buf, static_cast<word32>(length));
+    hash.Update(buf, 4);
+}
+
+// H' from RFC 9106, Section 3.3
+void Blake2bLong(byte* out, size_t outLen, const byte* in, size_t inLen)
+{
+    const unsigned int HALF = BLAKE2b::DIGESTSIZE / 2;
+
+    if (outLen <= BLAKE2b::DIGESTSIZE)
+    {
+        BLAKE2b hash(false, static_cast<unsigned int>(outLen));
+        UpdateLength(hash, outLen);
+        hash.Update(in, inLen);
+        hash.Final(out);
+        return;
+    }
+
+    byte V[BLAKE2b::DIGESTSIZE];
+    BLAKE2b hash;
+    UpdateLength(hash, outLen);
+    hash.Update(in, inLen);
+    hash.Final(V);
+
+    std::memcpy(out, V, HALF);
+    out += HALF; outLen -= HALF;
+
+    while (outLen > BLAKE2b::DIGESTSIZE)
+    {
+        hash.CalculateDigest(V, V, sizeof(V));
+        std::memcpy(out, V, HALF);
+        out += HALF; outLen -= HALF;
+    }
+
+    BLAKE2b last(false, static_cast<unsigned int>(outLen));
+    last.CalculateDigest(out, V, sizeof(V));
+    CryptoPP::SecureWipeArray(V, sizeof(V));
+}
+
+// The memory matrix. Large matrices are aligned on a 2 MiB boundary
+// and the kernel is advised to use huge pages, which avoids most TLB
+// misses in the random reads of the fill loop.
+class BlockMemory
+{
+public:
+    explicit BlockMemory(size_t blocks)
+        : m_ptr(NULLPTR), m_size(blocks * ARGON2_BLOCKSIZE), m_huge(false)
+    {
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+        const size_t HUGE_PAGE = 2 * 1024 * 1024;
+        if (m_size >= HUGE_PAGE)
+        {
+            void* p = NULLPTR;
+            while (posix_memalign(&p, HUGE_PAGE, m_size) != 0)
+                CryptoPP::CallNewHandler();
+
+            (void)madvise(p, m_size, MADV_HUGEPAGE);
+            m_ptr = static_cast<word64*>(p);
+            m_huge = true;
+            return;
+        }
+#endif
+        m_ptr = static_cast<word64*>(CryptoPP::AlignedAllocate(m_size));
+    }
+
+    ~BlockMemory()
+    {
+        CryptoPP::SecureWipeBuffer(m_ptr, m_size / 8);
+        if (m_huge)
+            free(m_ptr);
+        else
+            CryptoPP::AlignedDeallocate(m_ptr);
+    }
+
+    word64* Block(size_t index) {
+        return m_ptr + index * ARGON2_QWORDS;
+    }
+
+private:
+    BlockMemory(const BlockMemory&);
+    void operator=(const BlockMemory&);
+
+    word64* m_ptr;
+    size_t m_size;
+    bool m_huge;
+};
+
+struct Instance
+{
+    Instance(size_t blocks) : memory(blocks) {}
+
+    BlockMemory memory;
+    FillBlockFn fill;
+    word32 passes, lanes;
+    word32 laneLength, segmentLength;
+    word32 memoryBlocks, type;
+};
+
+// Maps a pseudo-random value onto the reference area, RFC 9106, Section 3.4.2
+inline word32 IndexAlpha(const Instance& inst, word32 pass, word32 slice,
+                         word32 index, word32 pseudoRand, bool sameLane)
+{
+    word32 areaSize;
+    if (pass == 0)
+    {
+        if (slice == 0)
+            areaSize = index - 1;
+        else if (sameLane)
+            areaSize = slice * inst.segmentLength + index - 1;
+        else
+            areaSize = slice * inst.segmentLength - (index == 0 ? 1 : 0);
+    }
+    else
+    {
+        if (sameLane)
+            areaSize = inst.laneLength - inst.segmentLength + index - 1;
+        else
+            areaSize = inst.laneLength - inst.segmentLength - (index == 0 ? 1 : 0);
+    }
+
+    word64 relative = pseudoRand;
+    relative = (relative * relative) >> 32;
+    relative = areaSize - 1 - ((areaSize * relative) >> 32);
+
+    word32 start = 0;
+    if (pass != 0)
+        start = (slice == ARGON2_SYNC_POINTS - 1) ? 0 : (slice + 1) * inst.segmentLength;
+
+    return static_cast<word32>((start + relative) % inst.laneLength);
+}
+
+inline void NextAddresses(const Instance& inst, word64* address, word64* input, const word64* zero)
+{
+    input[6]++;
+    inst.fill(address, zero, input, false);
+    inst.fill(address, zero, address, false);
+}
+
+void FillSegment(Instance& inst, word32 pass, word32 lane, word32 slice)
+{
+    const bool independent = (inst.type == CryptoPP::Argon2::ARGON2I) ||
+        (inst.type == CryptoPP::Argon2::ARGON2ID && pass == 0 && slice < ARGON2_SYNC_POINTS / 2);
+
+    CRYPTOPP_ALIGN_DATA(32) word64 address[ARGON2_QWORDS];
+    CRYPTOPP_ALIGN_DATA(32) word64 input[ARGON2_QWORDS];
+    CRYPTOPP_ALIGN_DATA(32) word64 zero[ARGON2_QWORDS];
+
+    if (independent)
+    {
+        std::memset(zero, 0, sizeof(zero));
+        std::memset(input, 0, sizeof(input));
+        input[0] = pass; input[1] = lane; input[2] = slice;
+        input[3] = inst.memoryBlocks; input[4] = inst.passes;
+        input[5] = inst.type;
+    }
+
+    word32 startIndex = 0;
+    if (pass == 0 && slice == 0)
+    {
+        // The first two blocks of each lane come from H0
+        startIndex = 2;
+        if (independent)
+            NextAddresses(inst, address, input, zero);
+    }
+
+    size_t currOffset = static_cast<size_t>(lane) * inst.laneLength +
+        slice * inst.segmentLength + startIndex;
+    size_t prevOffset = (currOffset % inst.laneLength == 0) ?
+        currOffset + inst.laneLength - 1 : currOffset - 1;
+
+    for (word32 i = startIndex; i < inst.segmentLength; ++i, ++currOffset, ++prevOffset)
+    {
+        if (currOffset % inst.laneLength == 1)
+            prevOffset = currOffset - 1;
+
+        word64 pseudoRand;
+        if (independent)
+        {
+            if (i % ARGON2_QWORDS == 0)
+                NextAddresses(inst, address, input, zero);
+            pseudoRand = address[i % ARGON2_QWORDS];
+        }
+        else
+        {
+            pseudoRand = inst.memory.Block(prevOffset)[0];
+        }
+
+        word32 refLane = static_cast<word32>((pseudoRand >> 32) % inst.lanes);
+        if (pass == 0 && slice == 0)
+            refLane = lane;
+
+        const word32 refIndex = IndexAlpha(inst, pass, slice, i,
+            static_cast<word32>(pseudoRand), refLane == lane);
+
+        const word64* ref = inst.memory.Block(static_cast<size_t>(inst.laneLength) * refLane + refIndex);
+        inst.fill(inst.memory.Block(currOffset), inst.memory.Block(prevOffset), ref, pass != 0);
+    }
+}
+
+ANONYMOUS_NAMESPACE_END
+
+NAMESPACE_BEGIN(CryptoPP)
+
+std::string Argon2::AlgorithmName() const
+{
+    switch (m_variant)
+    {
+    case ARGON2D:
+        return "Argon2d";
+    case ARGON2I:
+        return "Argon2i";
+    default:
+        return "Argon2id";
+    }
+}
+
+std::string Argon2::AlgorithmProvider() const
+{
+#if (CRYPTOPP_AVX2_AVAILABLE)
+    if (HasAVX2())
+        return "AVX2";
+#endif
+#if (CRYPTOPP_SSSE3_AVAILABLE)
+    if (HasSSSE3())
+        return "SSSE3";
+#endif
+    return "C++";
+}
+
+size_t Argon2::GetValidDerivedLength(size_t keylength) const
+{
+    if (keylength > MaxDerivedKeyLength())
+        return MaxDerivedKeyLength();
+    return keylength;
+}
+
+void Argon2::ValidateParameters(size_t derivedLen, size_t saltLen, word32 timeCost,
+    word32 memoryCost, word32 parallelization) const
+{
+    CRYPTOPP_ASSERT(derivedLen >= 4);
+    CRYPTOPP_ASSERT(saltLen >= 8);
+    CRYPTOPP_ASSERT(timeCost != 0);
+    CRYPTOPP_ASSERT(parallelization != 0);
+
+    if (derivedLen < 4)
+        throw InvalidArgument("Argon2: derived key length must be at least 4");
+
+    if (saltLen < 8)
+        throw InvalidArgument("Argon2: salt length must be at least 8");
+
+    if (timeCost == 0)
+        throw InvalidArgument("Argon2: time cost cannot be 0");
+
+    if (parallelization == 0 || parallelization > 0xffffff)
+    {
+        std::ostringstream oss;
+        oss << "parallelization " << parallelization << " is not between 1 and " << 0xffffff;
+        throw InvalidArgument("Argon2: " + oss.str());
+    }
+
+    // https://github.com/weidai11/cryptopp/issues/787
+    if (parallelization > static_cast<word32>(std::numeric_limits<int>::max()))
+        throw InvalidArgument("Argon2: parallelization is too large");
+
+    if (static_cast<word64>(memoryCost) < 8 * static_cast<word64>(parallelization))
+    {
+        std::ostringstream oss;
+        oss << "memory cost " << memoryCost << " is smaller than " << 8 * static_cast<word64>(parallelization);
+        throw InvalidArgument("Argon2: " + oss.str());
+    }
+
+    // Optimizer should remove this on 64-bit platforms
+    const word64 bytes = static_cast<word64>(memoryCost) * ARGON2_BLOCKSIZE;
+    if (bytes > static_cast<word64>(SIZE_MAX))
+        throw std::bad_alloc();
+}
+
+size_t Argon2::DeriveKey(byte *derived, size_t derivedLen,
+    const byte *secret, size_t secretLen, const NameValuePairs& params) const
+{
+    CRYPTOPP_ASSERT(secret /*&& secretLen*/);
+    CRYPTOPP_ASSERT(derived && derivedLen);
+    CRYPTOPP_ASSERT(derivedLen <= MaxDerivedKeyLength());
+
+    word32 timeCost=0, memoryCost=0, parallelization=0;
+    if (params.GetValue("TimeCost", timeCost) == false)
+        timeCost = defaultTimeCost;
+
+    if (params.GetValue("MemoryCost", memoryCost) == false)
+        memoryCost = defaultMemoryCost;
+
+    if (params.GetValue("Parallelization", parallelization) == false)
+        parallelization = defaultParallelization;
+
+    ConstByteArrayParameter salt, key, ad;
+    (void)params.GetValue(Name::Salt(), salt);
+    (void)params.GetValue(Name::Key(), key);
+    (void)params.GetValue("AssociatedData", ad);
+
+    return DeriveKey(derived, derivedLen, secret, secretLen, salt.begin(), salt.size(),
+        timeCost, memoryCost, parallelization, key.begin(), key.size(), ad.begin(), ad.size());
+}
+
+size_t Argon2::DeriveKey(byte *derived, size_t derivedLen, const byte *secret, size_t secretLen,
+    const byte *salt, size_t saltLen, word32 timeCost, word32 memoryCost, word32 parallelization,
+    const byte *key, size_t keyLen, const byte *ad, size_t adLen) const
+{
+    CRYPTOPP_ASSERT(secret /*&& secretLen*/);
+    CRYPTOPP_ASSERT(derived && derivedLen);
+    CRYPTOPP_ASSERT(derivedLen <= MaxDerivedKeyLength());
+
+    ThrowIfInvalidDerivedKeyLength(derivedLen);
+    ValidateParameters(derivedLen, saltLen, timeCost, memoryCost, parallelization);
+
+    if (secretLen > 0xffffffff || saltLen > 0xffffffff || keyLen > 0xffffffff || adLen > 0xffffffff)
+        throw InvalidArgument("Argon2: input length is larger than 0xffffffff");
+
+    // m' = 4 * p * floor(m / 4p), RFC 9106, Section 3.2
+    const word32 memoryBlocks = (memoryCost / (ARGON2_SYNC_POINTS * parallelization)) *
+        (ARGON2_SYNC_POINTS * parallelization);
+
+    Instance inst(memoryBlocks);
+    inst.fill = GetFillBlock();
+    inst.passes = timeCost;
+    inst.lanes = parallelization;
+    inst.laneLength = memoryBlocks / parallelization;
+    inst.segmentLength = inst.laneLength / ARGON2_SYNC_POINTS;
+    inst.memoryBlocks = memoryBlocks;
+    inst.type = static_cast<word32>(m_variant);
+
+    // H0, followed by room for the block index and lane
+    FixedSizeSecBlock<byte, ARGON2_PREHASH_SEED> seed;
+    {
+        BLAKE2b hash;
+        UpdateLength(hash, parallelization);
+        UpdateLength(hash, derivedLen);
+        UpdateLength(hash, memoryCost);
+        UpdateLength(hash, timeCost);
+        UpdateLength(hash, ARGON2_VERSION);
+        UpdateLength(hash, inst.type);
+        UpdateLength(hash, secretLen);
+        hash.Update(secret, secretLen);
+        UpdateLength(hash, saltLen);
+        hash.Update(salt, saltLen);
+        UpdateLength(hash, keyLen);
+        hash.Update(key, keyLen);
+        UpdateLength(hash, adLen);
+        hash.Update(ad, adLen);
+        hash.Final(seed);
+    }
+
+    // B[i][0] = H'(H0 || 0 || i) and B[i][1] = H'(H0 || 1 || i)
+    FixedSizeSecBlock<byte, ARGON2_BLOCKSIZE> block;
+    for (word32 lane = 0; lane < inst.lanes; ++lane)
+    {
+        for (word32 j = 0; j < 2; ++j)
+        {
+            LE32ENC(seed + BLAKE2b::DIGESTSIZE, j);
+            LE32ENC(seed + BLAKE2b::DIGESTSIZE + 4, lane);
+            Blake2bLong(block, ARGON2_BLOCKSIZE, seed, ARGON2_PREHASH_SEED);
+
+            word64* dest = inst.memory.Block(static_cast<size_t>(lane) * inst.laneLength + j);
+            for (unsigned int k = 0; k < ARGON2_QWORDS; ++k)
+                dest[k] = GetWord<word64>(false, LITTLE_ENDIAN_ORDER, block + 8 * k);
+        }
+    }
+
+    // Visual Studio and OpenMP 2.0 fixup. We must use int, not word32.
+    const int maxParallel = static_cast<int>(parallelization);
+
+    #ifdef _OPENMP
+    int threads = STDMIN(omp_get_max_threads(), maxParallel);
+    #endif
+
+    // The lanes of a slice are independent. The implicit barrier at the
+    // end of the omp for synchronizes the slices.
+    #pragma omp parallel num_threads(threads)
+    {
+        for (word32 pass = 0; pass < inst.passes; ++pass)
+        {
+            for (word32 slice = 0; slice < ARGON2_SYNC_POINTS; ++slice)
+            {
+                #pragma omp for
+                for (int lane = 0; lane < maxParallel; ++lane)
+                {
+                    FillSegment(inst, pass, static_cast<word32>(lane), slice);
+                }
+            }
+        }
+    }
+
+    // C = B[0][q-1] XOR B[1][q-1] XOR ... XOR B[p-1][q-1]
+    FixedSizeSecBlock<word64, ARGON2_QWORDS> acc;
+    std::memcpy(acc, inst.memory.Block(inst.laneLength - 1), ARGON2_BLOCKSIZE);
+    for (word32 lane = 1; lane < inst.lanes; ++lane)
+    {
+        const word64* last = inst.memory.Block(static_cast<size_t>(lane) * inst.laneLength + inst.laneLength - 1);
+        for (unsigned int k = 0; k < ARGON2_QWORDS; ++k)
+            acc[k] ^= last[k];
+    }
+
+    for (unsigned int k = 0; k < ARGON2_QWORDS; ++k)
+        PutWord(false, LITTLE_ENDIAN_ORDER, block + 8 * k, acc[k]);
+
+    Blake2bLong(derived, derivedLen, block, ARGON2_BLOCKSIZE);
+
+    return timeCost;
+}
+
+NAMESPACE_END
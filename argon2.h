@@ -0,0 +1,130 @@
+// argon2.h - written and placed in public domain by the Crypto++ project.
+//            Based on RFC 9106 and the reference implementation by
+//            Alex Biryukov, Daniel Dinu and Dmitry Khovratovich.
+
+/// \file argon2.h
+/// \brief Classes for Argon2 from RFC 9106
+/// \sa <A HREF="https://www.rfc-editor.org/rfc/rfc9106.html">RFC 9106, Argon2
+///   Memory-Hard Function for Password Hashing and Proof-of-Work Applications</A>
+/// \since Crypto++ 8.4
+
+#ifndef CRYPTOPP_ARGON2_H
+#define CRYPTOPP_ARGON2_H
+
+#include "cryptlib.h"
+#include "secblock.h"
+
+NAMESPACE_BEGIN(CryptoPP)
+
+/// \brief Argon2 key derivation function
+/// \details Argon2 is the memory-hard password hashing function from RFC 9106. The
+///   default variant is Argon2id, which RFC 9106 recommends for general use. Argon2d
+///   and Argon2i are available through the constructor.
+/// \details The Crypto++ implementation uses OpenMP to fill the lanes in parallel
+///   when available, like Scrypt. The compression function uses SSSE3 or AVX2 when
+///   the processor supports them.
+/// \details The memory matrix is allocated with a 2 MiB alignment on Linux and the
+///   kernel is advised to back it with huge pages. The memory is zeroized before
+///   it is released.
+/// \sa <A HREF="https://www.rfc-editor.org/rfc/rfc9106.html">RFC 9106, Argon2
+///   Memory-Hard Function for Password Hashing and Proof-of-Work Applications</A>
+/// \since Crypto++ 8.4
+class Argon2 : public KeyDerivationFunction
+{
+public:
+    /// \brief Argon2 variants
+    enum Variant {
+        /// \brief Argon2d, data-dependent memory access
+        ARGON2D=0,
+        /// \brief Argon2i, data-independent memory access
+        ARGON2I=1,
+        /// \brief Argon2id, Argon2i for the first half pass, then Argon2d
+        ARGON2ID=2
+    };
+
+    virtual ~Argon2() {}
+
+    /// \brief Construct an Argon2 object
+    /// \param variant the Argon2 variant
+    Argon2(Variant variant=ARGON2ID) : m_variant(variant) {}
+
+    static std::string StaticAlgorithmName () {
+        return "Argon2";
+    }
+
+    // KeyDerivationFunction interface
+    std::string AlgorithmName() const;
+
+    // Algorithm interface
+    std::string AlgorithmProvider() const;
+
+    // KeyDerivationFunction interface
+    size_t MaxDerivedKeyLength() const {
+        return static_cast<size_t>(0xffffffff);
+    }
+
+    // KeyDerivationFunction interface
+    size_t GetValidDerivedLength(size_t keylength) const;
+
+    // KeyDerivationFunction interface
+    size_t DeriveKey(byte *derived, size_t derivedLen, const byte *secret, size_t secretLen,
+        const NameValuePairs& params) const;
+
+    /// \brief Derive a key from a password
+    /// \param derived the derived output buffer
+    /// \param derivedLen the size of the derived buffer, in bytes
+    /// \param secret the password input buffer
+    /// \param secretLen the size of the password buffer, in bytes
+    /// \param salt the salt input buffer
+    /// \param saltLen the size of the salt buffer, in bytes
+    /// \param timeCost the number of passes over the memory
+    /// \param memoryCost the size of the memory, in KiB
+    /// \param parallelization the number of lanes
+    /// \param key the optional secret key
+    /// \param keyLen the size of the secret key, in bytes
+    /// \param ad the optional associated data
+    /// \param adLen the size of the associated data, in bytes
+    /// \returns the number of passes performed
+    /// \throws InvalidDerivedKeyLength if <tt>derivedLen</tt> is invalid for the scheme
+    /// \throws InvalidArgument if a parameter is out of range
+    /// \details DeriveKey() provides a standard interface to derive a key from
+    ///   a seed and other parameters. Each class that derives from KeyDerivationFunction
+    ///   provides an overload that accepts most parameters used by the derivation function.
+    /// \details The derived key must be at least 4 bytes. The salt must be at least 8
+    ///   bytes. <tt>timeCost</tt> ("t" in RFC 9106) must be at least 1.
+    ///   <tt>memoryCost</tt> ("m" in RFC 9106) must be at least
+    ///   <tt>8*parallelization</tt>, and it is rounded down to a multiple of
+    ///   <tt>4*parallelization</tt>. <tt>parallelization</tt> ("p" in RFC 9106)
+    ///   must be between 1 and <tt>2^24-1</tt>.
+    /// \details The lanes are processed by up to <tt>parallelization</tt> threads
+    ///   when the library is built with OpenMP. The result does not depend on the
+    ///   number of threads.
+    size_t DeriveKey(byte *derived, size_t derivedLen, const byte *secret, size_t secretLen,
+        const byte *salt, size_t saltLen, word32 timeCost=3, word32 memoryCost=4096,
+        word32 parallelization=1, const byte *key=NULLPTR, size_t keyLen=0,
+        const byte *ad=NULLPTR, size_t adLen=0) const;
+
+    /// \brief Retrieve the Argon2 variant
+    /// \returns the variant used by this object
+    Variant GetVariant() const {
+        return m_variant;
+    }
+
+protected:
+    enum {defaultTimeCost=3, defaultMemoryCost=4096, defaultParallelization=1};
+
+    // KeyDerivationFunction interface
+    const Algorithm & GetAlgorithm() const {
+        return *this;
+    }
+
+    inline void ValidateParameters(size_t derivedLen, size_t saltLen, word32 timeCost,
+        word32 memoryCost, word32 parallelization) const;
+
+private:
+    Variant m_variant;
+};
+
+NAMESPACE_END
+
+#endif // CRYPTOPP_ARGON2_H
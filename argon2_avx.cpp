@@ -0,0 +1,185 @@
+// argon2_avx.cpp - written and placed in the public domain by the Crypto++ project.
+//
+//    This source file uses intrinsics to gain access to AVX2
+//    instructions. A separate source file is needed because
+//    additional CXXFLAGS are required to enable the appropriate
+//    instructions sets in some build configurations.
+//
+//    Each __m256i holds four words. The row pass processes two rows
+//    at a time and permutes within a register to reach the diagonals.
+//    The column pass processes two columns at a time and uses blends
+//    across register pairs, like the reference implementation.
+
+#include "pch.h"
+#include "config.h"
+#include "misc.h"
+
+#if (CRYPTOPP_AVX2_AVAILABLE)
+# include <xmmintrin.h>
+# include <emmintrin.h>
+# include <immintrin.h>
+#endif
+
+// Squash MS LNK4221 and libtool warnings
+extern const char ARGON2_AVX_FNAME[] = __FILE__;
+
+NAMESPACE_BEGIN(CryptoPP)
+
+#if (CRYPTOPP_AVX2_AVAILABLE)
+
+ANONYMOUS_NAMESPACE_BEGIN
+
+inline __m256i BlaMka(const __m256i x, const __m256i y)
+{
+    const __m256i z = _mm256_mul_epu32(x, y);
+    return _mm256_add_epi64(_mm256_add_epi64(x, y), _mm256_add_epi64(z, z));
+}
+
+inline __m256i RotateRight32(const __m256i x)
+{
+    return _mm256_shuffle_epi32(x, _MM_SHUFFLE(2,3,0,1));
+}
+
+inline __m256i RotateRight24(const __m256i x)
+{
+    const __m256i mask = _mm256_setr_epi8(3,4,5,6,7,0,1,2, 11,12,13,14,15,8,9,10,
+                                          3,4,5,6,7,0,1,2, 11,12,13,14,15,8,9,10);
+    return _mm256_shuffle_epi8(x, mask);
+}
+
+inline __m256i RotateRight16(const __m256i x)
+{
+    const __m256i mask = _mm256_setr_epi8(2,3,4,5,6,7,0,1, 10,11,12,13,14,15,8,9,
+                                          2,3,4,5,6,7,0,1, 10,11,12,13,14,15,8,9);
+    return _mm256_shuffle_epi8(x, mask);
+}
+
+inline __m256i RotateRight63(const __m256i x)
+{
+    return _mm256_xor_si256(_mm256_srli_epi64(x, 63), _mm256_add_epi64(x, x));
+}
+
+inline void G1(__m256i& A, __m256i& B, __m256i& C, __m256i& D)
+{
+    A = BlaMka(A, B); D = RotateRight32(_mm256_xor_si256(D, A));
+    C = BlaMka(C, D); B = RotateRight24(_mm256_xor_si256(B, C));
+}
+
+inline void G2(__m256i& A, __m256i& B, __m256i& C, __m256i& D)
+{
+    A = BlaMka(A, B); D = RotateRight16(_mm256_xor_si256(D, A));
+    C = BlaMka(C, D); B = RotateRight63(_mm256_xor_si256(B, C));
+}
+
+inline void G(__m256i& A0, __m256i& A1, __m256i& B0, __m256i& B1,
+              __m256i& C0, __m256i& C1, __m256i& D0, __m256i& D1)
+{
+    G1(A0, B0, C0, D0); G1(A1, B1, C1, D1);
+    G2(A0, B0, C0, D0); G2(A1, B1, C1, D1);
+}
+
+// Two rows, one per register set. A row fits in A, B, C and D.
+inline void RowRound(__m256i& A0, __m256i& A1, __m256i& B0, __m256i& B1,
+                     __m256i& C0, __m256i& C1, __m256i& D0, __m256i& D1)
+{
+    G(A0, A1, B0, B1, C0, C1, D0, D1);
+
+    B0 = _mm256_permute4x64_epi64(B0, _MM_SHUFFLE(0,3,2,1));
+    C0 = _mm256_permute4x64_epi64(C0, _MM_SHUFFLE(1,0,3,2));
+    D0 = _mm256_permute4x64_epi64(D0, _MM_SHUFFLE(2,1,0,3));
+    B1 = _mm256_permute4x64_epi64(B1, _MM_SHUFFLE(0,3,2,1));
+    C1 = _mm256_permute4x64_epi64(C1, _MM_SHUFFLE(1,0,3,2));
+    D1 = _mm256_permute4x64_epi64(D1, _MM_SHUFFLE(2,1,0,3));
+
+    G(A0, A1, B0, B1, C0, C1, D0, D1);
+
+    B0 = _mm256_permute4x64_epi64(B0, _MM_SHUFFLE(2,1,0,3));
+    C0 = _mm256_permute4x64_epi64(C0, _MM_SHUFFLE(1,0,3,2));
+    D0 = _mm256_permute4x64_epi64(D0, _MM_SHUFFLE(0,3,2,1));
+    B1 = _mm256_permute4x64_epi64(B1, _MM_SHUFFLE(2,1,0,3));
+    C1 = _mm256_permute4x64_epi64(C1, _MM_SHUFFLE(1,0,3,2));
+    D1 = _mm256_permute4x64_epi64(D1, _MM_SHUFFLE(0,3,2,1));
+}
+
+// Two columns interleaved in 128-bit halves. A column spans A0 and A1, etc.
+inline void ColumnRound(__m256i& A0, __m256i& A1, __m256i& B0, __m256i& B1,
+                        __m256i& C0, __m256i& C1, __m256i& D0, __m256i& D1)
+{
+    G(A0, A1, B0, B1, C0, C1, D0, D1);
+
+    __m256i t0 = _mm256_blend_epi32(B0, B1, 0xCC);
+    __m256i t1 = _mm256_blend_epi32(B0, B1, 0x33);
+    B1 = _mm256_permute4x64_epi64(t0, _MM_SHUFFLE(2,3,0,1));
+    B0 = _mm256_permute4x64_epi64(t1, _MM_SHUFFLE(2,3,0,1));
+
+    t0 = C0; C0 = C1; C1 = t0;
+
+    t0 = _mm256_blend_epi32(D0, D1, 0xCC);
+    t1 = _mm256_blend_epi32(D0, D1, 0x33);
+    D0 = _mm256_permute4x64_epi64(t0, _MM_SHUFFLE(2,3,0,1));
+    D1 = _mm256_permute4x64_epi64(t1, _MM_SHUFFLE(2,3,0,1));
+
+    G(A0, A1, B0, B1, C0, C1, D0, D1);
+
+    t0 = _mm256_blend_epi32(B0, B1, 0xCC);
+    t1 = _mm256_blend_epi32(B0, B1, 0x33);
+    B0 = _mm256_permute4x64_epi64(t0, _MM_SHUFFLE(2,3,0,1));
+    B1 = _mm256_permute4x64_epi64(t1, _MM_SHUFFLE(2,3,0,1));
+
+    t0 = C0; C0 = C1; C1 = t0;
+
+    t0 = _mm256_blend_epi32(D0, D1, 0x33);
+    t1 = _mm256_blend_epi32(D0, D1, 0xCC);
+    D0 = _mm256_permute4x64_epi64(t0, _MM_SHUFFLE(2,3,0,1));
+    D1 = _mm256_permute4x64_epi64(t1, _MM_SHUFFLE(2,3,0,1));
+}
+
+ANONYMOUS_NAMESPACE_END
+
+void Argon2_FillBlock_AVX2(word64 *next, const word64 *prev, const word64 *ref, bool withXor)
+{
+    __m256i state[32], T[32];
+
+    for (unsigned int i = 0; i < 32; ++i)
+    {
+        state[i] = _mm256_xor_si256(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(prev + 4*i)),
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ref + 4*i)));
+    }
+
+    if (withXor)
+    {
+        for (unsigned int i = 0; i < 32; ++i)
+            T[i] = _mm256_xor_si256(state[i], _mm256_loadu_si256(reinterpret_cast<const __m256i*>(next + 4*i)));
+    }
+    else
+    {
+        for (unsigned int i = 0; i < 32; ++i)
+            T[i] = state[i];
+    }
+
+    for (unsigned int i = 0; i < 4; ++i)
+    {
+        RowRound(state[8*i+0], state[8*i+4], state[8*i+1], state[8*i+5],
+                 state[8*i+2], state[8*i+6], state[8*i+3], state[8*i+7]);
+    }
+
+    for (unsigned int i = 0; i < 4; ++i)
+    {
+        ColumnRound(state[ 0+i], state[ 4+i], state[ 8+i], state[12+i],
+                    state[16+i], state[20+i], state[24+i], state[28+i]);
+    }
+
+    for (unsigned int i = 0; i < 32; ++i)
+    {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(next + 4*i),
+            _mm256_xor_si256(state[i], T[i]));
+    }
+
+    // Some compilers emit SSE code after AVX without vzeroupper
+    _mm256_zeroupper();
+}
+
+#endif  // CRYPTOPP_AVX2_AVAILABLE
+
+NAMESPACE_END
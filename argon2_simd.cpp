@@ -0,0 +1,160 @@
+// argon2_simd.cpp - written and placed in the public domain by the Crypto++ project.
+//
+//    This source file uses intrinsics to gain access to SSSE3
+//    instructions. A separate source file is needed because
+//    additional CXXFLAGS are required to enable the appropriate
+//    instructions sets in some build configurations.
+//
+//    The BlaMka permutation is the BLAKE2b round from blake2b_simd.cpp
+//    with the additions replaced by x + y + 2 * lo(x) * lo(y). Each
+//    __m128i holds two words of a row, like the reference implementation.
+
+#include "pch.h"
+#include "config.h"
+#include "misc.h"
+
+#if (CRYPTOPP_SSSE3_AVAILABLE)
+# include <emmintrin.h>
+# include <tmmintrin.h>
+#endif
+
+// Squash MS LNK4221 and libtool warnings
+extern const char ARGON2_SIMD_FNAME[] = __FILE__;
+
+NAMESPACE_BEGIN(CryptoPP)
+
+#if (CRYPTOPP_SSSE3_AVAILABLE)
+
+ANONYMOUS_NAMESPACE_BEGIN
+
+inline __m128i BlaMka(const __m128i x, const __m128i y)
+{
+    const __m128i z = _mm_mul_epu32(x, y);
+    return _mm_add_epi64(_mm_add_epi64(x, y), _mm_add_epi64(z, z));
+}
+
+inline __m128i RotateRight32(const __m128i x)
+{
+    return _mm_shuffle_epi32(x, _MM_SHUFFLE(2,3,0,1));
+}
+
+inline __m128i RotateRight24(const __m128i x)
+{
+    const __m128i mask = _mm_setr_epi8(3,4,5,6,7,0,1,2, 11,12,13,14,15,8,9,10);
+    return _mm_shuffle_epi8(x, mask);
+}
+
+inline __m128i RotateRight16(const __m128i x)
+{
+    const __m128i mask = _mm_setr_epi8(2,3,4,5,6,7,0,1, 10,11,12,13,14,15,8,9);
+    return _mm_shuffle_epi8(x, mask);
+}
+
+inline __m128i RotateRight63(const __m128i x)
+{
+    return _mm_xor_si128(_mm_srli_epi64(x, 63), _mm_add_epi64(x, x));
+}
+
+inline void G1(__m128i& A0, __m128i& B0, __m128i& C0, __m128i& D0,
+               __m128i& A1, __m128i& B1, __m128i& C1, __m128i& D1)
+{
+    A0 = BlaMka(A0, B0); A1 = BlaMka(A1, B1);
+    D0 = RotateRight32(_mm_xor_si128(D0, A0)); D1 = RotateRight32(_mm_xor_si128(D1, A1));
+    C0 = BlaMka(C0, D0); C1 = BlaMka(C1, D1);
+    B0 = RotateRight24(_mm_xor_si128(B0, C0)); B1 = RotateRight24(_mm_xor_si128(B1, C1));
+}
+
+inline void G2(__m128i& A0, __m128i& B0, __m128i& C0, __m128i& D0,
+               __m128i& A1, __m128i& B1, __m128i& C1, __m128i& D1)
+{
+    A0 = BlaMka(A0, B0); A1 = BlaMka(A1, B1);
+    D0 = RotateRight16(_mm_xor_si128(D0, A0)); D1 = RotateRight16(_mm_xor_si128(D1, A1));
+    C0 = BlaMka(C0, D0); C1 = BlaMka(C1, D1);
+    B0 = RotateRight63(_mm_xor_si128(B0, C0)); B1 = RotateRight63(_mm_xor_si128(B1, C1));
+}
+
+inline void Diagonalize(__m128i& B0, __m128i& C0, __m128i& D0,
+                        __m128i& B1, __m128i& C1, __m128i& D1)
+{
+    __m128i t0 = _mm_alignr_epi8(B1, B0, 8);
+    __m128i t1 = _mm_alignr_epi8(B0, B1, 8);
+    B0 = t0; B1 = t1;
+
+    t0 = C0; C0 = C1; C1 = t0;
+
+    t0 = _mm_alignr_epi8(D1, D0, 8);
+    t1 = _mm_alignr_epi8(D0, D1, 8);
+    D0 = t1; D1 = t0;
+}
+
+inline void Undiagonalize(__m128i& B0, __m128i& C0, __m128i& D0,
+                          __m128i& B1, __m128i& C1, __m128i& D1)
+{
+    __m128i t0 = _mm_alignr_epi8(B0, B1, 8);
+    __m128i t1 = _mm_alignr_epi8(B1, B0, 8);
+    B0 = t0; B1 = t1;
+
+    t0 = C0; C0 = C1; C1 = t0;
+
+    t0 = _mm_alignr_epi8(D0, D1, 8);
+    t1 = _mm_alignr_epi8(D1, D0, 8);
+    D0 = t1; D1 = t0;
+}
+
+inline void Round(__m128i& A0, __m128i& A1, __m128i& B0, __m128i& B1,
+                  __m128i& C0, __m128i& C1, __m128i& D0, __m128i& D1)
+{
+    G1(A0, B0, C0, D0, A1, B1, C1, D1);
+    G2(A0, B0, C0, D0, A1, B1, C1, D1);
+    Diagonalize(B0, C0, D0, B1, C1, D1);
+    G1(A0, B0, C0, D0, A1, B1, C1, D1);
+    G2(A0, B0, C0, D0, A1, B1, C1, D1);
+    Undiagonalize(B0, C0, D0, B1, C1, D1);
+}
+
+ANONYMOUS_NAMESPACE_END
+
+void Argon2_FillBlock_SSSE3(word64 *next, const word64 *prev, const word64 *ref, bool withXor)
+{
+    __m128i state[64], T[64];
+
+    for (unsigned int i = 0; i < 64; ++i)
+    {
+        state[i] = _mm_xor_si128(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(prev + 2*i)),
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(ref + 2*i)));
+    }
+
+    if (withXor)
+    {
+        for (unsigned int i = 0; i < 64; ++i)
+            T[i] = _mm_xor_si128(state[i], _mm_loadu_si128(reinterpret_cast<const __m128i*>(next + 2*i)));
+    }
+    else
+    {
+        for (unsigned int i = 0; i < 64; ++i)
+            T[i] = state[i];
+    }
+
+    for (unsigned int i = 0; i < 8; ++i)
+    {
+        Round(state[8*i+0], state[8*i+1], state[8*i+2], state[8*i+3],
+              state[8*i+4], state[8*i+5], state[8*i+6], state[8*i+7]);
+    }
+
+    for (unsigned int i = 0; i < 8; ++i)
+    {
+        Round(state[8*0+i], state[8*1+i], state[8*2+i], state[8*3+i],
+              state[8*4+i], state[8*5+i], state[8*6+i], state[8*7+i]);
+    }
+
+    for (unsigned int i = 0; i < 64; ++i)
+    {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(next + 2*i),
+            _mm_xor_si128(state[i], T[i]));
+    }
+}
+
+#endif  // CRYPTOPP_SSSE3_AVAILABLE
+
+NAMESPACE_END
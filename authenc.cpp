@@ -5,6 +5,7 @@
 #ifndef CRYPTOPP_IMPORTS
 
 #include "authenc.h"
+#include "instrument.h"
 
 NAMESPACE_BEGIN(CryptoPP)
 
@@ -79,6 +80,7 @@ void AuthenticatedSymmetricCipherBase::Resynchronize(const byte *iv, int length)
 
 void AuthenticatedSymmetricCipherBase::Update(const byte *input, size_t length)
 {
+	InstrumentedCall instrumented(static_cast<const StreamTransformation &>(*this), InstrumentedCall::UPDATE, length);
 	// Part of original authenc.cpp code. Don't remove it.
 	if (length == 0) {return;}
 
@@ -108,6 +110,7 @@ void AuthenticatedSymmetricCipherBase::Update(const byte *input, size_t length)
 
 void AuthenticatedSymmetricCipherBase::ProcessData(byte *outString, const byte *inString, size_t length)
 {
+	InstrumentedCall instrumented(static_cast<const StreamTransformation &>(*this), InstrumentedCall::PROCESS, length);
 	if (m_state >= State_IVSet && length > MaxMessageLength()-m_totalMessageLength)
 		throw InvalidArgument(AlgorithmName() + ": message length exceeds maximum");
 	m_totalMessageLength += length;
@@ -15,10 +15,193 @@
 
 #include "basecode.h"
 #include "fltrimpl.h"
+#include "cpu.h"
 #include <ctype.h>
 
 NAMESPACE_BEGIN(CryptoPP)
 
+#if (CRYPTOPP_AVX2_AVAILABLE)
+extern size_t Base64Encode_AVX2(byte *output, const byte *input, size_t length, bool url);
+extern size_t Base64Decode_AVX2(byte *output, const byte *input, size_t length, bool url);
+extern size_t HexEncode_AVX2(byte *output, const byte *input, size_t length, const byte *alphabet);
+extern size_t HexDecode_AVX2(byte *output, const byte *input, size_t length);
+#endif
+
+#if (CRYPTOPP_SSSE3_AVAILABLE)
+extern size_t Base64Encode_SSSE3(byte *output, const byte *input, size_t length, bool url);
+extern size_t Base64Decode_SSSE3(byte *output, const byte *input, size_t length, bool url);
+extern size_t HexEncode_SSSE3(byte *output, const byte *input, size_t length, const byte *alphabet);
+extern size_t HexDecode_SSSE3(byte *output, const byte *input, size_t length);
+#endif
+
+#if (CRYPTOPP_ARM_NEON_AVAILABLE)
+extern size_t Base64Encode_NEON(byte *output, const byte *input, size_t length, bool url);
+extern size_t Base64Decode_NEON(byte *output, const byte *input, size_t length, bool url);
+extern size_t HexEncode_NEON(byte *output, const byte *input, size_t length, const byte *alphabet);
+extern size_t HexDecode_NEON(byte *output, const byte *input, size_t length);
+#endif
+
+ANONYMOUS_NAMESPACE_BEGIN
+
+// Alphabets and lookup arrays that are encoded and decoded a group
+// at a time. The *_SIMD kinds also have SSSE3, AVX2 and NEON kernels.
+enum {BLOCKS_NONE, BLOCKS_BASE64, BLOCKS_BASE64_SIMD, BLOCKS_BASE64_URL_SIMD, BLOCKS_HEX, BLOCKS_HEX_SIMD};
+
+// Input bytes per call, so the output fits in BLOCK_BUFFER_SIZE. The
+// kernels write up to 4 bytes past their output, which SIMD_SLACK covers.
+const size_t BLOCK_BUFFER_SIZE = 4096, SIMD_SLACK = 32;
+const size_t BASE64_ENCODE_LIMIT = 3072, HEX_ENCODE_LIMIT = 2048;
+const size_t BASE64_DECODE_LIMIT = 5440, HEX_DECODE_LIMIT = 8192;
+
+const byte s_base64Std[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+const byte s_base64Url[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+const byte s_hexUpper[] = "0123456789ABCDEF";
+
+// True if lookup is the lookup array of alphabet
+bool SameLookup(const int *lookup, const byte *alphabet, unsigned int base, bool caseInsensitive)
+{
+	int expected[256];
+	BaseN_Decoder::InitializeDecodingLookupArray(expected, alphabet, base, caseInsensitive);
+	return std::memcmp(lookup, expected, sizeof(expected)) == 0;
+}
+
+// Encodes whole groups, and returns the number of characters written.
+// Base 64 groups are 3 bytes and base 16 groups are 1 byte.
+size_t EncodeBlocks(int kind, const byte *alphabet, byte *output, const byte *input, size_t length)
+{
+	size_t processed = 0;
+	if (kind == BLOCKS_BASE64_SIMD || kind == BLOCKS_BASE64_URL_SIMD)
+	{
+		const bool url = (kind == BLOCKS_BASE64_URL_SIMD);
+		length = STDMIN(length, BASE64_ENCODE_LIMIT);
+#if (CRYPTOPP_AVX2_AVAILABLE)
+		if (HasAVX2())
+			processed = Base64Encode_AVX2(output, input, length, url);
+#endif
+#if (CRYPTOPP_SSSE3_AVAILABLE)
+		if (HasSSSE3())
+			processed += Base64Encode_SSSE3(output+processed/3*4, input+processed, length-processed, url);
+#endif
+#if (CRYPTOPP_ARM_NEON_AVAILABLE)
+		if (HasNEON())
+			processed += Base64Encode_NEON(output+processed/3*4, input+processed, length-processed, url);
+#endif
+	}
+	else if (kind == BLOCKS_HEX_SIMD)
+	{
+		length = STDMIN(length, HEX_ENCODE_LIMIT);
+#if (CRYPTOPP_AVX2_AVAILABLE)
+		if (HasAVX2())
+			processed = HexEncode_AVX2(output, input, length, alphabet);
+#endif
+#if (CRYPTOPP_SSSE3_AVAILABLE)
+		if (HasSSSE3())
+			processed += HexEncode_SSSE3(output+processed*2, input+processed, length-processed, alphabet);
+#endif
+#if (CRYPTOPP_ARM_NEON_AVAILABLE)
+		if (HasNEON())
+			processed += HexEncode_NEON(output+processed*2, input+processed, length-processed, alphabet);
+#endif
+	}
+	else if (kind == BLOCKS_BASE64)
+		length = STDMIN(length, BASE64_ENCODE_LIMIT);
+	else
+		length = STDMIN(length, HEX_ENCODE_LIMIT);
+
+	if (kind == BLOCKS_HEX || kind == BLOCKS_HEX_SIMD)
+	{
+		for (; processed < length; processed++)
+		{
+			output[2*processed+0] = alphabet[input[processed] >> 4];
+			output[2*processed+1] = alphabet[input[processed] & 15];
+		}
+		return 2*processed;
+	}
+
+	byte *out = output+processed/3*4;
+	for (; length-processed >= 3; processed += 3, out += 4)
+	{
+		const word32 w = (word32(input[processed]) << 16) | (word32(input[processed+1]) << 8) | input[processed+2];
+		out[0] = alphabet[(w >> 18) & 63];
+		out[1] = alphabet[(w >> 12) & 63];
+		out[2] = alphabet[(w >>  6) & 63];
+		out[3] = alphabet[w & 63];
+	}
+	return out-output;
+}
+
+// Decodes whole groups that are in the alphabet, and returns the number of
+// bytes written. Base 64 groups are 4 characters and base 16 groups are 2.
+size_t DecodeBlocks(int kind, const int *lookup, byte *output, const byte *input, size_t length)
+{
+	size_t processed = 0;
+	if (kind == BLOCKS_BASE64_SIMD || kind == BLOCKS_BASE64_URL_SIMD)
+	{
+		const bool url = (kind == BLOCKS_BASE64_URL_SIMD);
+		length = STDMIN(length, BASE64_DECODE_LIMIT);
+#if (CRYPTOPP_AVX2_AVAILABLE)
+		if (HasAVX2())
+			processed = Base64Decode_AVX2(output, input, length, url);
+#endif
+#if (CRYPTOPP_SSSE3_AVAILABLE)
+		if (HasSSSE3())
+			processed += Base64Decode_SSSE3(output+processed/4*3, input+processed, length-processed, url);
+#endif
+#if (CRYPTOPP_ARM_NEON_AVAILABLE)
+		if (HasNEON())
+			processed += Base64Decode_NEON(output+processed/4*3, input+processed, length-processed, url);
+#endif
+	}
+	else if (kind == BLOCKS_HEX_SIMD)
+	{
+		length = STDMIN(length, HEX_DECODE_LIMIT);
+#if (CRYPTOPP_AVX2_AVAILABLE)
+		if (HasAVX2())
+			processed = HexDecode_AVX2(output, input, length);
+#endif
+#if (CRYPTOPP_SSSE3_AVAILABLE)
+		if (HasSSSE3())
+			processed += HexDecode_SSSE3(output+processed/2, input+processed, length-processed);
+#endif
+#if (CRYPTOPP_ARM_NEON_AVAILABLE)
+		if (HasNEON())
+			processed += HexDecode_NEON(output+processed/2, input+processed, length-processed);
+#endif
+	}
+	else if (kind == BLOCKS_BASE64)
+		length = STDMIN(length, BASE64_DECODE_LIMIT);
+	else
+		length = STDMIN(length, HEX_DECODE_LIMIT);
+
+	// The values are unsigned so characters outside the alphabet, which are -1, fail the range check
+	if (kind == BLOCKS_HEX || kind == BLOCKS_HEX_SIMD)
+	{
+		byte *out = output+processed/2;
+		for (; length-processed >= 2; processed += 2)
+		{
+			const word32 a = lookup[input[processed]], b = lookup[input[processed+1]];
+			if ((a | b) >= 16)
+				break;
+			*out++ = byte((a << 4) | b);
+		}
+		return out-output;
+	}
+
+	byte *out = output+processed/4*3;
+	for (; length-processed >= 4; processed += 4, out += 3)
+	{
+		const word32 a = lookup[input[processed]], b = lookup[input[processed+1]];
+		const word32 c = lookup[input[processed+2]], d = lookup[input[processed+3]];
+		if ((a | b | c | d) >= 64)
+			break;
+		const word32 w = (a << 18) | (b << 12) | (c << 6) | d;
+		out[0] = byte(w >> 16); out[1] = byte(w >> 8); out[2] = byte(w);
+	}
+	return out-output;
+}
+
+ANONYMOUS_NAMESPACE_END
+
 void BaseN_Encoder::IsolatedInitialize(const NameValuePairs &parameters)
 {
 	parameters.GetRequiredParameter("BaseN_Encoder", Name::EncodingLookupArray(), m_alphabet);
@@ -43,6 +226,23 @@ void BaseN_Encoder::IsolatedInitialize(const NameValuePairs &parameters)
 	m_outputBlockSize = i/m_bitsPerChar;
 
 	m_outBuf.New(m_outputBlockSize);
+
+	if (m_bitsPerChar == 6)
+	{
+		if (std::memcmp(m_alphabet, s_base64Std, 64) == 0)
+			m_blockKind = BLOCKS_BASE64_SIMD;
+		else if (std::memcmp(m_alphabet, s_base64Url, 64) == 0)
+			m_blockKind = BLOCKS_BASE64_URL_SIMD;
+		else
+			m_blockKind = BLOCKS_BASE64;
+	}
+	else if (m_bitsPerChar == 4)
+		m_blockKind = BLOCKS_HEX_SIMD;
+	else
+		m_blockKind = BLOCKS_NONE;
+
+	if (m_blockKind != BLOCKS_NONE)
+		m_blockBuf.New(BLOCK_BUFFER_SIZE+SIMD_SLACK);
 }
 
 size_t BaseN_Encoder::Put2(const byte *begin, size_t length, int messageEnd, bool blocking)
@@ -50,6 +250,17 @@ size_t BaseN_Encoder::Put2(const byte *begin, size_t length, int messageEnd, boo
 	FILTER_BEGIN;
 	while (m_inputPosition < length)
 	{
+		if (m_blockKind != BLOCKS_NONE && m_bytePos == 0 && m_bitPos == 0)
+		{
+			m_blockLength = EncodeBlocks(m_blockKind, m_alphabet, m_blockBuf, begin+m_inputPosition, length-m_inputPosition);
+			if (m_blockLength)
+			{
+				m_inputPosition += m_blockLength*m_bitsPerChar/8;
+				FILTER_OUTPUT(3, m_blockBuf, m_blockLength, 0);
+				continue;
+			}
+		}
+
 		if (m_bytePos == 0)
 			memset(m_outBuf, 0, m_outputBlockSize);
 
@@ -128,6 +339,28 @@ void BaseN_Decoder::IsolatedInitialize(const NameValuePairs &parameters)
 	m_outputBlockSize = i/8;
 
 	m_outBuf.New(m_outputBlockSize);
+
+	if (m_bitsPerChar == 6)
+	{
+		if (SameLookup(m_lookup, s_base64Std, 64, false))
+			m_blockKind = BLOCKS_BASE64_SIMD;
+		else if (SameLookup(m_lookup, s_base64Url, 64, false))
+			m_blockKind = BLOCKS_BASE64_URL_SIMD;
+		else
+			m_blockKind = BLOCKS_BASE64;
+	}
+	else if (m_bitsPerChar == 4)
+	{
+		if (SameLookup(m_lookup, s_hexUpper, 16, true))
+			m_blockKind = BLOCKS_HEX_SIMD;
+		else
+			m_blockKind = BLOCKS_HEX;
+	}
+	else
+		m_blockKind = BLOCKS_NONE;
+
+	if (m_blockKind != BLOCKS_NONE)
+		m_blockBuf.New(BLOCK_BUFFER_SIZE+SIMD_SLACK);
 }
 
 size_t BaseN_Decoder::Put2(const byte *begin, size_t length, int messageEnd, bool blocking)
@@ -135,6 +368,17 @@ size_t BaseN_Decoder::Put2(const byte *begin, size_t length, int messageEnd, boo
 	FILTER_BEGIN;
 	while (m_inputPosition < length)
 	{
+		if (m_blockKind != BLOCKS_NONE && m_bytePos == 0 && m_bitPos == 0)
+		{
+			m_blockLength = DecodeBlocks(m_blockKind, m_lookup, m_blockBuf, begin+m_inputPosition, length-m_inputPosition);
+			if (m_blockLength)
+			{
+				m_inputPosition += m_blockLength*8/m_bitsPerChar;
+				FILTER_OUTPUT(3, m_blockBuf, m_blockLength, 0);
+				continue;
+			}
+		}
+
 		unsigned int value;
 		value = m_lookup[begin[m_inputPosition++]];
 		if (value >= 256)
@@ -14,6 +14,9 @@
 NAMESPACE_BEGIN(CryptoPP)
 
 /// \brief Encoder for bases that are a power of 2
+/// \details Base 16 and base 64 alphabets are encoded a group at a time. The
+///  standard and URL safe base 64 alphabets, and all base 16 alphabets, use
+///  SSSE3, AVX2 or NEON when available. Other bases are encoded a bit at a time.
 class CRYPTOPP_DLL BaseN_Encoder : public Unflushable<Filter>
 {
 public:
@@ -22,6 +25,7 @@ public:
 	BaseN_Encoder(BufferedTransformation *attachment=NULLPTR)
 		: m_alphabet(NULLPTR), m_padding(0), m_bitsPerChar(0)
 		, m_outputBlockSize(0), m_bytePos(0), m_bitPos(0)
+		, m_blockKind(0), m_blockLength(0)
 			{Detach(attachment);}
 
 	/// \brief Construct a BaseN_Encoder
@@ -34,6 +38,7 @@ public:
 	BaseN_Encoder(const byte *alphabet, int log2base, BufferedTransformation *attachment=NULLPTR, int padding=-1)
 		: m_alphabet(NULLPTR), m_padding(0), m_bitsPerChar(0)
 		, m_outputBlockSize(0), m_bytePos(0), m_bitPos(0)
+		, m_blockKind(0), m_blockLength(0)
 	{
 		Detach(attachment);
 		BaseN_Encoder::IsolatedInitialize(
@@ -52,9 +57,17 @@ private:
 	int m_padding, m_bitsPerChar, m_outputBlockSize;
 	int m_bytePos, m_bitPos;
 	SecByteBlock m_outBuf;
+	int m_blockKind;
+	size_t m_blockLength;
+	SecByteBlock m_blockBuf;
 };
 
 /// \brief Decoder for bases that are a power of 2
+/// \details Base 16 and base 64 lookup arrays are decoded a group at a time.
+///  The lookup arrays of Base64Decoder, Base64URLDecoder and HexDecoder use
+///  SSSE3, AVX2 or NEON when available. A group with a character that is not
+///  in the alphabet is decoded a character at a time, and the character is
+///  skipped.
 class CRYPTOPP_DLL BaseN_Decoder : public Unflushable<Filter>
 {
 public:
@@ -65,6 +78,7 @@ public:
 	BaseN_Decoder(BufferedTransformation *attachment=NULLPTR)
 		: m_lookup(NULLPTR), m_bitsPerChar(0)
 		, m_outputBlockSize(0), m_bytePos(0), m_bitPos(0)
+		, m_blockKind(0), m_blockLength(0)
 			{Detach(attachment);}
 
 	/// \brief Construct a BaseN_Decoder
@@ -78,6 +92,7 @@ public:
 	BaseN_Decoder(const int *lookup, int log2base, BufferedTransformation *attachment=NULLPTR)
 		: m_lookup(NULLPTR), m_bitsPerChar(0)
 		, m_outputBlockSize(0), m_bytePos(0), m_bitPos(0)
+		, m_blockKind(0), m_blockLength(0)
 	{
 		Detach(attachment);
 		BaseN_Decoder::IsolatedInitialize(
@@ -106,6 +121,9 @@ private:
 	int m_bitsPerChar, m_outputBlockSize;
 	int m_bytePos, m_bitPos;
 	SecByteBlock m_outBuf;
+	int m_blockKind;
+	size_t m_blockLength;
+	SecByteBlock m_blockBuf;
 };
 
 /// \brief Filter that breaks input stream into groups of fixed size
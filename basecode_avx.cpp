@@ -0,0 +1,199 @@
+// basecode_avx.cpp - written and placed in the public domain by the Crypto++ project.
+//
+//    This source file uses intrinsics to gain access to AVX2
+//    instructions. A separate source file is needed because
+//    additional CXXFLAGS are required to enable the appropriate
+//    instructions sets in some build configurations.
+//
+//    The kernels are the SSSE3 kernels in basecode_simd.cpp with
+//    two 128-bit lanes. Base64 loads 12 bytes into each lane, and
+//    hex reorders lanes after unpacking and packing.
+
+#include "pch.h"
+#include "config.h"
+#include "misc.h"
+
+#if defined(CRYPTOPP_AVX2_AVAILABLE)
+# include <xmmintrin.h>
+# include <emmintrin.h>
+# include <immintrin.h>
+#endif
+
+// Squash MS LNK4221 and libtool warnings
+extern const char BASECODE_AVX_FNAME[] = __FILE__;
+
+// Clang intrinsic casts, http://bugs.llvm.org/show_bug.cgi?id=20670
+#define M128_CAST(x) ((__m128i *)(void *)(x))
+#define CONST_M128_CAST(x) ((const __m128i *)(const void *)(x))
+#define M256_CAST(x) ((__m256i *)(void *)(x))
+#define CONST_M256_CAST(x) ((const __m256i *)(const void *)(x))
+
+NAMESPACE_BEGIN(CryptoPP)
+
+#if (CRYPTOPP_AVX2_AVAILABLE)
+
+ANONYMOUS_NAMESPACE_BEGIN
+
+// 0xff in each byte of c that is between lo and hi inclusive
+inline __m256i InRange(const __m256i c, char lo, char hi)
+{
+	return _mm256_and_si256(_mm256_cmpgt_epi8(c, _mm256_set1_epi8(lo-1)),
+	                        _mm256_cmpgt_epi8(_mm256_set1_epi8(hi+1), c));
+}
+
+inline __m256i HexValues(const __m256i c, __m256i &valid)
+{
+	const __m256i digit = InRange(c, '0', '9');
+	const __m256i upper = InRange(c, 'A', 'F');
+	const __m256i lower = InRange(c, 'a', 'f');
+	valid = _mm256_and_si256(valid, _mm256_or_si256(digit, _mm256_or_si256(upper, lower)));
+
+	__m256i v = _mm256_and_si256(digit, _mm256_sub_epi8(c, _mm256_set1_epi8('0')));
+	v = _mm256_or_si256(v, _mm256_and_si256(upper, _mm256_sub_epi8(c, _mm256_set1_epi8('A'-10))));
+	return _mm256_or_si256(v, _mm256_and_si256(lower, _mm256_sub_epi8(c, _mm256_set1_epi8('a'-10))));
+}
+
+ANONYMOUS_NAMESPACE_END
+
+size_t Base64Encode_AVX2(byte *output, const byte *input, size_t length, bool url)
+{
+	const __m256i offsets = url ?
+		_mm256_setr_epi8('a'-26, '0'-52, '0'-52, '0'-52, '0'-52, '0'-52, '0'-52,
+		                 '0'-52, '0'-52, '0'-52, '0'-52, '-'-62, '_'-63, 'A', 0, 0,
+		                 'a'-26, '0'-52, '0'-52, '0'-52, '0'-52, '0'-52, '0'-52,
+		                 '0'-52, '0'-52, '0'-52, '0'-52, '-'-62, '_'-63, 'A', 0, 0) :
+		_mm256_setr_epi8('a'-26, '0'-52, '0'-52, '0'-52, '0'-52, '0'-52, '0'-52,
+		                 '0'-52, '0'-52, '0'-52, '0'-52, '+'-62, '/'-63, 'A', 0, 0,
+		                 'a'-26, '0'-52, '0'-52, '0'-52, '0'-52, '0'-52, '0'-52,
+		                 '0'-52, '0'-52, '0'-52, '0'-52, '+'-62, '/'-63, 'A', 0, 0);
+	const __m256i shuffle = _mm256_setr_epi8(1,0,2,1, 4,3,5,4, 7,6,8,7, 10,9,11,10,
+	                                         1,0,2,1, 4,3,5,4, 7,6,8,7, 10,9,11,10);
+	size_t processed = 0;
+
+	// Reads bytes 0-15 and 12-27 and encodes the first 24
+	while (length - processed >= 28)
+	{
+		__m256i x = _mm256_inserti128_si256(_mm256_castsi128_si256(
+			_mm_loadu_si128(CONST_M128_CAST(input+processed))),
+			_mm_loadu_si128(CONST_M128_CAST(input+processed+12)), 1);
+		x = _mm256_shuffle_epi8(x, shuffle);
+
+		const __m256i t0 = _mm256_mulhi_epu16(_mm256_and_si256(x, _mm256_set1_epi32(0x0fc0fc00)), _mm256_set1_epi32(0x04000040));
+		const __m256i t1 = _mm256_mullo_epi16(_mm256_and_si256(x, _mm256_set1_epi32(0x003f03f0)), _mm256_set1_epi32(0x01000010));
+		const __m256i v = _mm256_or_si256(t0, t1);
+
+		// 0..25 -> 13, 26..51 -> 0, 52..61 -> 1..10, 62 -> 11, 63 -> 12
+		__m256i r = _mm256_subs_epu8(v, _mm256_set1_epi8(51));
+		r = _mm256_or_si256(r, _mm256_and_si256(_mm256_cmpgt_epi8(_mm256_set1_epi8(26), v), _mm256_set1_epi8(13)));
+		_mm256_storeu_si256(M256_CAST(output), _mm256_add_epi8(v, _mm256_shuffle_epi8(offsets, r)));
+
+		output += 32;
+		processed += 24;
+	}
+
+	// Avoid AVX to SSE transition penalties
+	_mm256_zeroupper();
+	return processed;
+}
+
+size_t Base64Decode_AVX2(byte *output, const byte *input, size_t length, bool url)
+{
+	const __m256i c62 = _mm256_set1_epi8(url ? '-' : '+');
+	const __m256i c63 = _mm256_set1_epi8(url ? '_' : '/');
+	const __m256i shuffle = _mm256_setr_epi8(2,1,0, 6,5,4, 10,9,8, 14,13,12, -1,-1,-1,-1,
+	                                         2,1,0, 6,5,4, 10,9,8, 14,13,12, -1,-1,-1,-1);
+	size_t processed = 0;
+
+	// Decodes 32 characters and writes 28 bytes, of which 24 are output
+	while (length - processed >= 32)
+	{
+		const __m256i c = _mm256_loadu_si256(CONST_M256_CAST(input+processed));
+		const __m256i upper = InRange(c, 'A', 'Z');
+		const __m256i lower = InRange(c, 'a', 'z');
+		const __m256i digit = InRange(c, '0', '9');
+		const __m256i is62 = _mm256_cmpeq_epi8(c, c62);
+		const __m256i is63 = _mm256_cmpeq_epi8(c, c63);
+
+		const __m256i valid = _mm256_or_si256(_mm256_or_si256(upper, lower), _mm256_or_si256(digit, _mm256_or_si256(is62, is63)));
+		if (_mm256_movemask_epi8(valid) != -1)
+			break;
+
+		__m256i v = _mm256_and_si256(upper, _mm256_sub_epi8(c, _mm256_set1_epi8('A')));
+		v = _mm256_or_si256(v, _mm256_and_si256(lower, _mm256_sub_epi8(c, _mm256_set1_epi8('a'-26))));
+		v = _mm256_or_si256(v, _mm256_and_si256(digit, _mm256_add_epi8(c, _mm256_set1_epi8(52-'0'))));
+		v = _mm256_or_si256(v, _mm256_and_si256(is62, _mm256_set1_epi8(62)));
+		v = _mm256_or_si256(v, _mm256_and_si256(is63, _mm256_set1_epi8(63)));
+
+		v = _mm256_maddubs_epi16(v, _mm256_set1_epi32(0x01400140));
+		v = _mm256_madd_epi16(v, _mm256_set1_epi32(0x00011000));
+		v = _mm256_shuffle_epi8(v, shuffle);
+
+		// 12 bytes in each lane. The second store overwrites the unused bytes of the first.
+		_mm_storeu_si128(M128_CAST(output+ 0), _mm256_castsi256_si128(v));
+		_mm_storeu_si128(M128_CAST(output+12), _mm256_extracti128_si256(v, 1));
+
+		output += 24;
+		processed += 32;
+	}
+
+	// Avoid AVX to SSE transition penalties
+	_mm256_zeroupper();
+	return processed;
+}
+
+size_t HexEncode_AVX2(byte *output, const byte *input, size_t length, const byte *alphabet)
+{
+	const __m256i table = _mm256_broadcastsi128_si256(_mm_loadu_si128(CONST_M128_CAST(alphabet)));
+	const __m256i mask = _mm256_set1_epi8(0x0f);
+	size_t processed = 0;
+
+	while (length - processed >= 32)
+	{
+		const __m256i x = _mm256_loadu_si256(CONST_M256_CAST(input+processed));
+		const __m256i hi = _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(x, 4), mask));
+		const __m256i lo = _mm256_shuffle_epi8(table, _mm256_and_si256(x, mask));
+
+		// Unpacking works within lanes, so the lanes are reordered
+		const __m256i a = _mm256_unpacklo_epi8(hi, lo);
+		const __m256i b = _mm256_unpackhi_epi8(hi, lo);
+		_mm256_storeu_si256(M256_CAST(output+ 0), _mm256_permute2x128_si256(a, b, 0x20));
+		_mm256_storeu_si256(M256_CAST(output+32), _mm256_permute2x128_si256(a, b, 0x31));
+
+		output += 64;
+		processed += 32;
+	}
+
+	// Avoid AVX to SSE transition penalties
+	_mm256_zeroupper();
+	return processed;
+}
+
+size_t HexDecode_AVX2(byte *output, const byte *input, size_t length)
+{
+	size_t processed = 0;
+
+	while (length - processed >= 64)
+	{
+		__m256i valid = _mm256_set1_epi8(-1);
+		const __m256i a = HexValues(_mm256_loadu_si256(CONST_M256_CAST(input+processed+ 0)), valid);
+		const __m256i b = HexValues(_mm256_loadu_si256(CONST_M256_CAST(input+processed+32)), valid);
+		if (_mm256_movemask_epi8(valid) != -1)
+			break;
+
+		// 16*first + second for each pair of nibbles. Packing works within lanes.
+		const __m256i weights = _mm256_set1_epi16(0x0110);
+		const __m256i x = _mm256_packus_epi16(_mm256_maddubs_epi16(a, weights), _mm256_maddubs_epi16(b, weights));
+		_mm256_storeu_si256(M256_CAST(output), _mm256_permute4x64_epi64(x, _MM_SHUFFLE(3,1,2,0)));
+
+		output += 32;
+		processed += 64;
+	}
+
+	// Avoid AVX to SSE transition penalties
+	_mm256_zeroupper();
+	return processed;
+}
+
+#endif  // CRYPTOPP_AVX2_AVAILABLE
+
+NAMESPACE_END
@@ -0,0 +1,350 @@
+// basecode_simd.cpp - written and placed in the public domain by the Crypto++ project.
+//
+//    This source file uses intrinsics to gain access to SSSE3 and
+//    ARMv7a/ARMv8a NEON instructions. A separate source file is
+//    needed because additional CXXFLAGS are required to enable the
+//    appropriate instructions sets in some build configurations.
+//
+//    The base64 encoder and the SSSE3 decoder pack and unpack 6-bit
+//    values with multiplies, as described by Wojciech Mula and Daniel
+//    Lemire in "Faster Base64 Encoding and Decoding using AVX2
+//    Instructions". Characters are validated with range compares, and
+//    a block that has a character outside the alphabet is left for the
+//    caller, which skips the character like BaseN_Decoder always has.
+
+#include "pch.h"
+#include "config.h"
+#include "misc.h"
+
+#if (CRYPTOPP_SSSE3_AVAILABLE)
+# include <emmintrin.h>
+# include <tmmintrin.h>
+#endif
+
+#if (CRYPTOPP_ARM_NEON_HEADER)
+# include <arm_neon.h>
+#endif
+
+#if (CRYPTOPP_ARM_ACLE_HEADER)
+# include <stdint.h>
+# include <arm_acle.h>
+#endif
+
+// Clang intrinsic casts, http://bugs.llvm.org/show_bug.cgi?id=20670
+#define M128_CAST(x) ((__m128i *)(void *)(x))
+#define CONST_M128_CAST(x) ((const __m128i *)(const void *)(x))
+
+// Squash MS LNK4221 and libtool warnings
+extern const char BASECODE_SIMD_FNAME[] = __FILE__;
+
+NAMESPACE_BEGIN(CryptoPP)
+
+#if (CRYPTOPP_SSSE3_AVAILABLE)
+
+ANONYMOUS_NAMESPACE_BEGIN
+
+// 0xff in each byte of c that is between lo and hi inclusive
+inline __m128i InRange(const __m128i c, char lo, char hi)
+{
+	return _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8(lo-1)),
+	                     _mm_cmplt_epi8(c, _mm_set1_epi8(hi+1)));
+}
+
+// Offsets from 6-bit values to characters, indexed by range
+inline __m128i Base64Offsets(bool url)
+{
+	return url ?
+		_mm_setr_epi8('a'-26, '0'-52, '0'-52, '0'-52, '0'-52, '0'-52, '0'-52,
+		              '0'-52, '0'-52, '0'-52, '0'-52, '-'-62, '_'-63, 'A', 0, 0) :
+		_mm_setr_epi8('a'-26, '0'-52, '0'-52, '0'-52, '0'-52, '0'-52, '0'-52,
+		              '0'-52, '0'-52, '0'-52, '0'-52, '+'-62, '/'-63, 'A', 0, 0);
+}
+
+ANONYMOUS_NAMESPACE_END
+
+size_t Base64Encode_SSSE3(byte *output, const byte *input, size_t length, bool url)
+{
+	const __m128i offsets = Base64Offsets(url);
+	size_t processed = 0;
+
+	// Reads 16 bytes and encodes the first 12
+	while (length - processed >= 16)
+	{
+		__m128i x = _mm_loadu_si128(CONST_M128_CAST(input+processed));
+		x = _mm_shuffle_epi8(x, _mm_setr_epi8(1,0,2,1, 4,3,5,4, 7,6,8,7, 10,9,11,10));
+
+		const __m128i t0 = _mm_mulhi_epu16(_mm_and_si128(x, _mm_set1_epi32(0x0fc0fc00)), _mm_set1_epi32(0x04000040));
+		const __m128i t1 = _mm_mullo_epi16(_mm_and_si128(x, _mm_set1_epi32(0x003f03f0)), _mm_set1_epi32(0x01000010));
+		const __m128i v = _mm_or_si128(t0, t1);
+
+		// 0..25 -> 13, 26..51 -> 0, 52..61 -> 1..10, 62 -> 11, 63 -> 12
+		__m128i r = _mm_subs_epu8(v, _mm_set1_epi8(51));
+		r = _mm_or_si128(r, _mm_and_si128(_mm_cmpgt_epi8(_mm_set1_epi8(26), v), _mm_set1_epi8(13)));
+		_mm_storeu_si128(M128_CAST(output), _mm_add_epi8(v, _mm_shuffle_epi8(offsets, r)));
+
+		output += 16;
+		processed += 12;
+	}
+	return processed;
+}
+
+size_t Base64Decode_SSSE3(byte *output, const byte *input, size_t length, bool url)
+{
+	const __m128i c62 = _mm_set1_epi8(url ? '-' : '+');
+	const __m128i c63 = _mm_set1_epi8(url ? '_' : '/');
+	size_t processed = 0;
+
+	// Decodes 16 characters and writes 16 bytes, of which 12 are output
+	while (length - processed >= 16)
+	{
+		const __m128i c = _mm_loadu_si128(CONST_M128_CAST(input+processed));
+		const __m128i upper = InRange(c, 'A', 'Z');
+		const __m128i lower = InRange(c, 'a', 'z');
+		const __m128i digit = InRange(c, '0', '9');
+		const __m128i is62 = _mm_cmpeq_epi8(c, c62);
+		const __m128i is63 = _mm_cmpeq_epi8(c, c63);
+
+		const __m128i valid = _mm_or_si128(_mm_or_si128(upper, lower), _mm_or_si128(digit, _mm_or_si128(is62, is63)));
+		if (_mm_movemask_epi8(valid) != 0xffff)
+			break;
+
+		__m128i v = _mm_and_si128(upper, _mm_sub_epi8(c, _mm_set1_epi8('A')));
+		v = _mm_or_si128(v, _mm_and_si128(lower, _mm_sub_epi8(c, _mm_set1_epi8('a'-26))));
+		v = _mm_or_si128(v, _mm_and_si128(digit, _mm_add_epi8(c, _mm_set1_epi8(52-'0'))));
+		v = _mm_or_si128(v, _mm_and_si128(is62, _mm_set1_epi8(62)));
+		v = _mm_or_si128(v, _mm_and_si128(is63, _mm_set1_epi8(63)));
+
+		// Four 6-bit values to 24 bits in each 32-bit word, then big-endian bytes
+		v = _mm_maddubs_epi16(v, _mm_set1_epi32(0x01400140));
+		v = _mm_madd_epi16(v, _mm_set1_epi32(0x00011000));
+		v = _mm_shuffle_epi8(v, _mm_setr_epi8(2,1,0, 6,5,4, 10,9,8, 14,13,12, -1,-1,-1,-1));
+		_mm_storeu_si128(M128_CAST(output), v);
+
+		output += 12;
+		processed += 16;
+	}
+	return processed;
+}
+
+size_t HexEncode_SSSE3(byte *output, const byte *input, size_t length, const byte *alphabet)
+{
+	const __m128i table = _mm_loadu_si128(CONST_M128_CAST(alphabet));
+	const __m128i mask = _mm_set1_epi8(0x0f);
+	size_t processed = 0;
+
+	while (length - processed >= 16)
+	{
+		const __m128i x = _mm_loadu_si128(CONST_M128_CAST(input+processed));
+		const __m128i hi = _mm_shuffle_epi8(table, _mm_and_si128(_mm_srli_epi16(x, 4), mask));
+		const __m128i lo = _mm_shuffle_epi8(table, _mm_and_si128(x, mask));
+		_mm_storeu_si128(M128_CAST(output+ 0), _mm_unpacklo_epi8(hi, lo));
+		_mm_storeu_si128(M128_CAST(output+16), _mm_unpackhi_epi8(hi, lo));
+
+		output += 32;
+		processed += 16;
+	}
+	return processed;
+}
+
+ANONYMOUS_NAMESPACE_BEGIN
+
+// Returns the nibbles in c, and clears valid if a character is not a hex digit
+inline __m128i HexValues(const __m128i c, __m128i &valid)
+{
+	const __m128i digit = InRange(c, '0', '9');
+	const __m128i upper = InRange(c, 'A', 'F');
+	const __m128i lower = InRange(c, 'a', 'f');
+	valid = _mm_and_si128(valid, _mm_or_si128(digit, _mm_or_si128(upper, lower)));
+
+	__m128i v = _mm_and_si128(digit, _mm_sub_epi8(c, _mm_set1_epi8('0')));
+	v = _mm_or_si128(v, _mm_and_si128(upper, _mm_sub_epi8(c, _mm_set1_epi8('A'-10))));
+	return _mm_or_si128(v, _mm_and_si128(lower, _mm_sub_epi8(c, _mm_set1_epi8('a'-10))));
+}
+
+ANONYMOUS_NAMESPACE_END
+
+size_t HexDecode_SSSE3(byte *output, const byte *input, size_t length)
+{
+	size_t processed = 0;
+
+	while (length - processed >= 32)
+	{
+		__m128i valid = _mm_set1_epi8(-1);
+		const __m128i a = HexValues(_mm_loadu_si128(CONST_M128_CAST(input+processed+ 0)), valid);
+		const __m128i b = HexValues(_mm_loadu_si128(CONST_M128_CAST(input+processed+16)), valid);
+		if (_mm_movemask_epi8(valid) != 0xffff)
+			break;
+
+		// 16*first + second for each pair of nibbles
+		const __m128i weights = _mm_set1_epi16(0x0110);
+		_mm_storeu_si128(M128_CAST(output), _mm_packus_epi16(
+			_mm_maddubs_epi16(a, weights), _mm_maddubs_epi16(b, weights)));
+
+		output += 16;
+		processed += 32;
+	}
+	return processed;
+}
+
+#endif  // CRYPTOPP_SSSE3_AVAILABLE
+
+#if (CRYPTOPP_ARM_NEON_AVAILABLE)
+
+ANONYMOUS_NAMESPACE_BEGIN
+
+// Table lookup of 16 entries. vqtbl1q_u8 is only available on Aarch64.
+inline uint8x16_t Lookup16(const uint8x16_t table, const uint8x16_t index)
+{
+#if defined(__aarch64__)
+	return vqtbl1q_u8(table, index);
+#else
+	uint8x8x2_t t;
+	t.val[0] = vget_low_u8(table);
+	t.val[1] = vget_high_u8(table);
+	return vcombine_u8(vtbl2_u8(t, vget_low_u8(index)), vtbl2_u8(t, vget_high_u8(index)));
+#endif
+}
+
+inline bool AllSet(const uint8x16_t mask)
+{
+	const uint8x8_t t = vand_u8(vget_low_u8(mask), vget_high_u8(mask));
+	return vget_lane_u64(vreinterpret_u64_u8(t), 0) == W64LIT(0xffffffffffffffff);
+}
+
+inline uint8x16_t InRange(const uint8x16_t c, byte lo, byte hi)
+{
+	return vandq_u8(vcgeq_u8(c, vdupq_n_u8(lo)), vcleq_u8(c, vdupq_n_u8(hi)));
+}
+
+inline uint8x16_t Base64Chars(const uint8x16_t v, const uint8x16_t offsets)
+{
+	// 0..25 -> 13, 26..51 -> 0, 52..61 -> 1..10, 62 -> 11, 63 -> 12
+	uint8x16_t r = vqsubq_u8(v, vdupq_n_u8(51));
+	r = vorrq_u8(r, vandq_u8(vcltq_u8(v, vdupq_n_u8(26)), vdupq_n_u8(13)));
+	return vaddq_u8(v, Lookup16(offsets, r));
+}
+
+inline uint8x16_t Base64Values(const uint8x16_t c, bool url, uint8x16_t &valid)
+{
+	const uint8x16_t upper = InRange(c, 'A', 'Z');
+	const uint8x16_t lower = InRange(c, 'a', 'z');
+	const uint8x16_t digit = InRange(c, '0', '9');
+	const uint8x16_t is62 = vceqq_u8(c, vdupq_n_u8(url ? '-' : '+'));
+	const uint8x16_t is63 = vceqq_u8(c, vdupq_n_u8(url ? '_' : '/'));
+	valid = vandq_u8(valid, vorrq_u8(vorrq_u8(upper, lower), vorrq_u8(digit, vorrq_u8(is62, is63))));
+
+	uint8x16_t v = vandq_u8(upper, vsubq_u8(c, vdupq_n_u8('A')));
+	v = vorrq_u8(v, vandq_u8(lower, vsubq_u8(c, vdupq_n_u8('a'-26))));
+	v = vorrq_u8(v, vandq_u8(digit, vaddq_u8(c, vdupq_n_u8(52-'0'))));
+	v = vorrq_u8(v, vandq_u8(is62, vdupq_n_u8(62)));
+	return vorrq_u8(v, vandq_u8(is63, vdupq_n_u8(63)));
+}
+
+inline uint8x16_t HexValues(const uint8x16_t c, uint8x16_t &valid)
+{
+	const uint8x16_t digit = InRange(c, '0', '9');
+	const uint8x16_t upper = InRange(c, 'A', 'F');
+	const uint8x16_t lower = InRange(c, 'a', 'f');
+	valid = vandq_u8(valid, vorrq_u8(digit, vorrq_u8(upper, lower)));
+
+	uint8x16_t v = vandq_u8(digit, vsubq_u8(c, vdupq_n_u8('0')));
+	v = vorrq_u8(v, vandq_u8(upper, vsubq_u8(c, vdupq_n_u8('A'-10))));
+	return vorrq_u8(v, vandq_u8(lower, vsubq_u8(c, vdupq_n_u8('a'-10))));
+}
+
+ANONYMOUS_NAMESPACE_END
+
+size_t Base64Encode_NEON(byte *output, const byte *input, size_t length, bool url)
+{
+	const byte d = byte('0'-52);
+	const byte offsets[16] = {'a'-26, d,d,d,d,d,d,d,d,d,d,
+		byte((url ? '-' : '+')-62), byte((url ? '_' : '/')-63), 'A', 0, 0};
+	const uint8x16_t table = vld1q_u8(offsets);
+	size_t processed = 0;
+
+	while (length - processed >= 48)
+	{
+		const uint8x16x3_t x = vld3q_u8(input+processed);
+		uint8x16x4_t c;
+		c.val[0] = Base64Chars(vshrq_n_u8(x.val[0], 2), table);
+		c.val[1] = Base64Chars(vorrq_u8(vshlq_n_u8(vandq_u8(x.val[0], vdupq_n_u8(0x03)), 4), vshrq_n_u8(x.val[1], 4)), table);
+		c.val[2] = Base64Chars(vorrq_u8(vshlq_n_u8(vandq_u8(x.val[1], vdupq_n_u8(0x0f)), 2), vshrq_n_u8(x.val[2], 6)), table);
+		c.val[3] = Base64Chars(vandq_u8(x.val[2], vdupq_n_u8(0x3f)), table);
+		vst4q_u8(output, c);
+
+		output += 64;
+		processed += 48;
+	}
+	return processed;
+}
+
+size_t Base64Decode_NEON(byte *output, const byte *input, size_t length, bool url)
+{
+	size_t processed = 0;
+
+	while (length - processed >= 64)
+	{
+		const uint8x16x4_t c = vld4q_u8(input+processed);
+		uint8x16_t valid = vdupq_n_u8(0xff);
+		const uint8x16_t v0 = Base64Values(c.val[0], url, valid);
+		const uint8x16_t v1 = Base64Values(c.val[1], url, valid);
+		const uint8x16_t v2 = Base64Values(c.val[2], url, valid);
+		const uint8x16_t v3 = Base64Values(c.val[3], url, valid);
+		if (!AllSet(valid))
+			break;
+
+		uint8x16x3_t x;
+		x.val[0] = vorrq_u8(vshlq_n_u8(v0, 2), vshrq_n_u8(v1, 4));
+		x.val[1] = vorrq_u8(vshlq_n_u8(v1, 4), vshrq_n_u8(v2, 2));
+		x.val[2] = vorrq_u8(vshlq_n_u8(v2, 6), v3);
+		vst3q_u8(output, x);
+
+		output += 48;
+		processed += 64;
+	}
+	return processed;
+}
+
+size_t HexEncode_NEON(byte *output, const byte *input, size_t length, const byte *alphabet)
+{
+	const uint8x16_t table = vld1q_u8(alphabet);
+	size_t processed = 0;
+
+	while (length - processed >= 16)
+	{
+		const uint8x16_t x = vld1q_u8(input+processed);
+		uint8x16x2_t c;
+		c.val[0] = Lookup16(table, vshrq_n_u8(x, 4));
+		c.val[1] = Lookup16(table, vandq_u8(x, vdupq_n_u8(0x0f)));
+		vst2q_u8(output, c);
+
+		output += 32;
+		processed += 16;
+	}
+	return processed;
+}
+
+size_t HexDecode_NEON(byte *output, const byte *input, size_t length)
+{
+	size_t processed = 0;
+
+	while (length - processed >= 32)
+	{
+		const uint8x16x2_t c = vld2q_u8(input+processed);
+		uint8x16_t valid = vdupq_n_u8(0xff);
+		const uint8x16_t hi = HexValues(c.val[0], valid);
+		const uint8x16_t lo = HexValues(c.val[1], valid);
+		if (!AllSet(valid))
+			break;
+
+		vst1q_u8(output, vorrq_u8(vshlq_n_u8(hi, 4), lo));
+
+		output += 16;
+		processed += 32;
+	}
+	return processed;
+}
+
+#endif  // CRYPTOPP_ARM_NEON_AVAILABLE
+
+NAMESPACE_END
@@ -60,12 +60,63 @@ enum TestClass {
 	TestFirst=(0), TestLast=(1<<15)
 };
 
+// Output format of the message size sweep
+enum BenchmarkFormat {FormatHTML, FormatJSON, FormatCSV};
+
+// Hardware events per operation. A negative value means the
+//  event is not available on the platform.
+struct CounterResult
+{
+	double cycles, instructions, cacheMisses, branchMisses;
+};
+
+// Hardware event counters around a timed loop. On Linux the events
+//  come from perf_event_open. When perf events are not available or not
+//  permitted, cycles are time stamp counter ticks on x86, and the other
+//  events are not available. Counters only count the calling thread.
+class BenchCounters
+{
+public:
+	enum Source {NoCounters, PerfEvents, TimeStampCounter};
+
+	BenchCounters();
+	~BenchCounters();
+
+	// The source a new BenchCounters object uses on this machine
+	static Source DefaultSource();
+	static const char *SourceName(Source source);
+	// Time stamp counter ticks per second, calibrated once against the wall clock
+	static double TimeStampFrequency();
+
+	Source GetSource() const {return m_source;}
+	void Start();
+	void Stop();
+	// Events between Start() and Stop(), divided by operations
+	CounterResult Result(double operations) const;
+
+private:
+	enum {Cycles, Instructions, CacheMisses, BranchMisses, EventCount};
+
+	Source m_source;
+	int m_fd[EventCount];
+	double m_counts[EventCount];
+	word64 m_tsc;
+};
+
+// Latency distribution of one operation, in microseconds
+struct LatencyResult
+{
+	word64 samples;
+	double mean, p50, p90, p99, p999, max;
+};
+
 extern const double CLOCK_TICKS_PER_SECOND;
 extern double g_allocatedTime;
 extern double g_hertz;
 extern double g_logTotal;
 extern unsigned int g_logCount;
 extern const byte defaultKey[];
+extern BenchmarkFormat g_format;
 
 // Test book keeping
 extern time_t g_testBegin;
@@ -83,17 +134,28 @@ void Benchmark2(double t, double hertz);
 void Benchmark3(double t, double hertz);
 // Public key systems over elliptic curves
 void Benchmark4(double t, double hertz);
+// Message size sweep over the given sizes, optionally limited to some algorithms
+void BenchmarkSizes(const std::vector<size_t> &sizes, const std::vector<std::string> &algorithms, double t, double hertz, bool allProviders);
+// Multi-core scaling over the given thread counts, with per-thread and shared objects
+void BenchmarkScaling(const std::vector<size_t> &sizes, const std::vector<unsigned int> &threads,
+	const std::vector<std::string> &algorithms, bool pin, double t);
+// Latency percentiles of public key operations, cold and warm
+void BenchmarkLatency(const std::vector<std::string> &algorithms, double t);
 
 // These are defined in bench1.cpp
 extern void OutputResultKeying(double iterations, double timeTaken);
 extern void OutputResultBytes(const char *name, const char *provider, double length, double timeTaken);
 extern void OutputResultOperations(const char *name, const char *provider, const char *operation, bool pc, unsigned long iterations, double timeTaken);
+extern void OutputResultSize(const char *name, const char *provider, size_t size, double nsPerOp, double nsPerRekeyedOp, const CounterResult &counters);
+extern void OutputResultLatency(const char *name, const char *provider, const char *operation, const char *mode, const LatencyResult &result);
+extern void OutputResultScaling(const char *name, const char *provider, size_t size, unsigned int threads, bool shared, double opsPerSecond, double efficiency);
 
 // These are defined in bench1.cpp
 extern void BenchMark(const char *name, BufferedTransformation &bt, double timeTotal);
 extern void BenchMark(const char *name, StreamTransformation &cipher, double timeTotal);
 extern void BenchMark(const char *name, HashTransformation &ht, double timeTotal);
 extern void BenchMark(const char *name, RandomNumberGenerator &rng, double timeTotal);
+extern void BenchMark(const char *name, KeyDerivationFunction &kdf, const NameValuePairs &params, double memory, double timeTotal);
 
 // These are defined in bench2.cpp
 extern void BenchMarkKeying(SimpleKeyingInterface &c, size_t keyLength, const NameValuePairs &params);
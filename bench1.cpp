@@ -14,15 +14,32 @@
 
 #include "osrng.h"
 #include "drbg.h"
+#include "argon2.h"
 #include "darn.h"
 #include "mersenne.h"
 #include "rdrand.h"
 #include "padlkrng.h"
+#include "hrtimer.h"
 
 #include <iostream>
 #include <iomanip>
 #include <sstream>
 
+#if defined(CRYPTOPP_CXX11_SYNCHRONIZATION)
+# include <thread>
+#endif
+
+#if defined(__linux__)
+# include <linux/perf_event.h>
+# include <sys/ioctl.h>
+# include <sys/syscall.h>
+# include <unistd.h>
+#endif
+
+#if (CRYPTOPP_BOOL_X86 || CRYPTOPP_BOOL_X32 || CRYPTOPP_BOOL_X64) && defined(CRYPTOPP_MSC_VERSION)
+# include <intrin.h>
+#endif
+
 #if CRYPTOPP_MSC_VERSION
 # pragma warning(disable: 4355)
 #endif
@@ -50,6 +67,188 @@ extern const byte defaultKey[] = "0123456789" // 168 + NULL
 double g_allocatedTime = 0.0, g_hertz = 0.0, g_logTotal = 0.0;
 unsigned int g_logCount = 0;
 time_t g_testBegin, g_testEnd;
+BenchmarkFormat g_format = FormatHTML;
+
+// JSON records written so far, for the separators
+static unsigned int g_recordCount = 0;
+
+#if defined(__linux__)
+int OpenPerfEvent(word64 config)
+{
+	perf_event_attr attr;
+	std::memset(&attr, 0, sizeof(attr));
+	attr.size = sizeof(attr);
+	attr.type = PERF_TYPE_HARDWARE;
+	attr.config = config;
+	attr.disabled = 1;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+	attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+	return static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+}
+#endif
+
+inline bool HasTimeStampCounter()
+{
+#if (CRYPTOPP_BOOL_X86 || CRYPTOPP_BOOL_X32 || CRYPTOPP_BOOL_X64)
+	return true;
+#else
+	return false;
+#endif
+}
+
+inline word64 ReadTimeStampCounter()
+{
+#if (CRYPTOPP_BOOL_X86 || CRYPTOPP_BOOL_X32 || CRYPTOPP_BOOL_X64) && defined(CRYPTOPP_MSC_VERSION)
+	return __rdtsc();
+#elif (CRYPTOPP_BOOL_X86 || CRYPTOPP_BOOL_X32 || CRYPTOPP_BOOL_X64)
+	word32 lo, hi;
+	__asm__ __volatile__ ("rdtsc" : "=a" (lo), "=d" (hi));
+	return (word64(hi) << 32) | lo;
+#else
+	return 0;
+#endif
+}
+
+BenchCounters::BenchCounters() : m_source(DefaultSource()), m_tsc(0)
+{
+	for (unsigned int i=0; i<EventCount; ++i)
+	{
+		m_fd[i] = -1;
+		m_counts[i] = -1.0;
+	}
+
+#if defined(__linux__)
+	if (m_source == PerfEvents)
+	{
+		const word64 configs[EventCount] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+			PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+		for (unsigned int i=0; i<EventCount; ++i)
+			m_fd[i] = OpenPerfEvent(configs[i]);
+
+		// Out of descriptors, or the cycles event went away
+		if (m_fd[Cycles] < 0)
+			m_source = HasTimeStampCounter() ? TimeStampCounter : NoCounters;
+	}
+#endif
+}
+
+BenchCounters::~BenchCounters()
+{
+#if defined(__linux__)
+	for (unsigned int i=0; i<EventCount; ++i)
+	{
+		if (m_fd[i] >= 0)
+			close(m_fd[i]);
+	}
+#endif
+}
+
+BenchCounters::Source BenchCounters::DefaultSource()
+{
+	static Source source = NoCounters;
+	static bool detected = false;
+	if (detected)
+		return source;
+
+#if defined(__linux__)
+	const int fd = OpenPerfEvent(PERF_COUNT_HW_CPU_CYCLES);
+	if (fd >= 0)
+	{
+		close(fd);
+		source = PerfEvents;
+	}
+#endif
+	if (source == NoCounters && HasTimeStampCounter())
+		source = TimeStampCounter;
+
+	detected = true;
+	return source;
+}
+
+const char *BenchCounters::SourceName(Source source)
+{
+	switch (source)
+	{
+	case PerfEvents:
+		return "perf";
+	case TimeStampCounter:
+		return "tsc";
+	default:
+		return "none";
+	}
+}
+
+double BenchCounters::TimeStampFrequency()
+{
+	static double frequency = -1.0;
+	if (frequency >= 0.0)
+		return frequency;
+
+	frequency = 0.0;
+	if (HasTimeStampCounter())
+	{
+		Timer timer;
+		timer.StartTimer();
+		const word64 start = ReadTimeStampCounter();
+		double elapsed;
+		while ((elapsed = timer.ElapsedTimeAsDouble()) < 0.05) {}
+		frequency = double(ReadTimeStampCounter() - start) / elapsed;
+	}
+	return frequency;
+}
+
+void BenchCounters::Start()
+{
+#if defined(__linux__)
+	if (m_source == PerfEvents)
+	{
+		for (unsigned int i=0; i<EventCount; ++i)
+		{
+			if (m_fd[i] < 0) continue;
+			ioctl(m_fd[i], PERF_EVENT_IOC_RESET, 0);
+			ioctl(m_fd[i], PERF_EVENT_IOC_ENABLE, 0);
+		}
+	}
+#endif
+	if (m_source == TimeStampCounter)
+		m_tsc = ReadTimeStampCounter();
+}
+
+void BenchCounters::Stop()
+{
+	if (m_source == TimeStampCounter)
+		m_counts[Cycles] = double(ReadTimeStampCounter() - m_tsc);
+
+#if defined(__linux__)
+	if (m_source == PerfEvents)
+	{
+		for (unsigned int i=0; i<EventCount; ++i)
+		{
+			if (m_fd[i] < 0) continue;
+			ioctl(m_fd[i], PERF_EVENT_IOC_DISABLE, 0);
+
+			// The kernel multiplexes events when there are more events
+			//  than counters, so scale by the time the event was counted.
+			word64 values[3] = {0, 0, 0};
+			if (read(m_fd[i], values, sizeof(values)) == static_cast<ssize_t>(sizeof(values)) && values[2])
+				m_counts[i] = double(values[0]) * double(values[1]) / double(values[2]);
+			else
+				m_counts[i] = -1.0;
+		}
+	}
+#endif
+}
+
+CounterResult BenchCounters::Result(double operations) const
+{
+	CounterResult result;
+	result.cycles = m_counts[Cycles] < 0.0 ? -1.0 : m_counts[Cycles] / operations;
+	result.instructions = m_counts[Instructions] < 0.0 ? -1.0 : m_counts[Instructions] / operations;
+	result.cacheMisses = m_counts[CacheMisses] < 0.0 ? -1.0 : m_counts[CacheMisses] / operations;
+	result.branchMisses = m_counts[BranchMisses] < 0.0 ? -1.0 : m_counts[BranchMisses] / operations;
+	return result;
+}
 
 inline std::string HertzToString(double hertz)
 {
@@ -111,6 +310,175 @@ void OutputResultKeying(double iterations, double timeTaken)
 	std::cout << oss.str();
 }
 
+inline std::string JsonString(const std::string &str)
+{
+	const char hex[] = "0123456789abcdef";
+	std::string result("\"");
+	for (size_t i=0; i<str.size(); ++i)
+	{
+		const byte ch = static_cast<byte>(str[i]);
+		if (ch < 0x20)
+		{
+			result += "\\u00";
+			result += hex[ch >> 4];
+			result += hex[ch & 15];
+			continue;
+		}
+		if (ch == '"' || ch == '\\')
+			result += '\\';
+		result += str[i];
+	}
+	return result + "\"";
+}
+
+// RFC 4180 field. Quotes are doubled.
+inline std::string CsvString(const std::string &str)
+{
+	std::string result("\"");
+	for (size_t i=0; i<str.size(); ++i)
+	{
+		if (str[i] == '"')
+			result += '"';
+		result += str[i];
+	}
+	return result + "\"";
+}
+
+// A negative nsPerRekeyedOp means the algorithm is not keyed. The
+//  fields and their order are fixed so scripts can diff the output
+//  of two builds. Cycles come from the counters, or from the frequency
+//  when it is given and there are no counters.
+void OutputResultSize(const char *name, const char *provider, size_t size, double nsPerOp, double nsPerRekeyedOp, const CounterResult &counters)
+{
+	std::ostringstream oss;
+	oss << std::setiosflags(std::ios::fixed);
+
+	// Coverity finding
+	if (nsPerOp < 0.000001f) nsPerOp = 0.000001f;
+	const double mbs = double(size) / nsPerOp * 1e9 / (1024*1024);
+	double cpb = -1.0;
+	if (counters.cycles >= 0.0 && size)
+		cpb = counters.cycles / double(size);
+	else if (g_hertz > 1.0f && size)
+		cpb = nsPerOp * g_hertz / 1e9 / double(size);
+	const double ipc = (counters.cycles > 0.0 && counters.instructions >= 0.0) ? counters.instructions / counters.cycles : -1.0;
+
+	if (g_format == FormatCSV)
+	{
+		oss << CsvString(name) << ',' << CsvString(provider) << ',' << size;
+		oss << ',' << std::setprecision(1) << nsPerOp << ',';
+		if (nsPerRekeyedOp >= 0.0)
+			oss << std::setprecision(1) << nsPerRekeyedOp;
+		oss << ',' << std::setprecision(2) << mbs << ',';
+		if (cpb >= 0.0)
+			oss << std::setprecision(3) << cpb;
+		oss << ',';
+		if (ipc >= 0.0)
+			oss << std::setprecision(2) << ipc;
+		oss << ',';
+		if (counters.cacheMisses >= 0.0)
+			oss << std::setprecision(2) << counters.cacheMisses;
+		oss << ',';
+		if (counters.branchMisses >= 0.0)
+			oss << std::setprecision(2) << counters.branchMisses;
+		oss << "\n";
+	}
+	else
+	{
+		oss << (g_recordCount ? ",\n" : "\n") << "    {\"algorithm\": " << JsonString(name);
+		oss << ", \"provider\": " << JsonString(provider) << ", \"size\": " << size;
+		oss << ", \"ns_per_op\": " << std::setprecision(1) << nsPerOp;
+		oss << ", \"ns_per_op_rekey\": ";
+		if (nsPerRekeyedOp >= 0.0)
+			oss << std::setprecision(1) << nsPerRekeyedOp;
+		else
+			oss << "null";
+		oss << ", \"mib_per_s\": " << std::setprecision(2) << mbs;
+		oss << ", \"cycles_per_byte\": ";
+		if (cpb >= 0.0)
+			oss << std::setprecision(3) << cpb;
+		else
+			oss << "null";
+		oss << ", \"ipc\": ";
+		if (ipc >= 0.0)
+			oss << std::setprecision(2) << ipc;
+		else
+			oss << "null";
+		oss << ", \"cache_misses_per_op\": ";
+		if (counters.cacheMisses >= 0.0)
+			oss << std::setprecision(2) << counters.cacheMisses;
+		else
+			oss << "null";
+		oss << ", \"branch_misses_per_op\": ";
+		if (counters.branchMisses >= 0.0)
+			oss << std::setprecision(2) << counters.branchMisses;
+		else
+			oss << "null";
+		oss << "}";
+	}
+	g_recordCount++;
+
+	std::cout << oss.str() << std::flush;
+}
+
+// Latencies are in microseconds. The timer resolution is reported
+//  in the header, so a reader can tell when p50 is near one tick.
+void OutputResultLatency(const char *name, const char *provider, const char *operation, const char *mode, const LatencyResult &result)
+{
+	std::ostringstream oss;
+	oss << std::setiosflags(std::ios::fixed) << std::setprecision(2);
+
+	if (g_format == FormatCSV)
+	{
+		oss << CsvString(name) << ',' << CsvString(provider) << ',' << CsvString(operation) << ',' << mode;
+		oss << ',' << result.samples << ',' << result.mean << ',' << result.p50 << ',' << result.p90;
+		oss << ',' << result.p99 << ',' << result.p999 << ',' << result.max << "\n";
+	}
+	else
+	{
+		oss << (g_recordCount ? ",\n" : "\n") << "    {\"algorithm\": " << JsonString(name);
+		oss << ", \"provider\": " << JsonString(provider) << ", \"operation\": " << JsonString(operation);
+		oss << ", \"mode\": " << JsonString(mode) << ", \"samples\": " << result.samples;
+		oss << ", \"mean_us\": " << result.mean << ", \"p50_us\": " << result.p50;
+		oss << ", \"p90_us\": " << result.p90 << ", \"p99_us\": " << result.p99;
+		oss << ", \"p999_us\": " << result.p999 << ", \"max_us\": " << result.max << "}";
+	}
+	g_recordCount++;
+
+	std::cout << oss.str() << std::flush;
+}
+
+// Efficiency is the aggregate throughput divided by the thread count
+//  times the single thread throughput of the same mode. A shared object
+//  is serialized by a lock, so its efficiency shows the lock overhead.
+void OutputResultScaling(const char *name, const char *provider, size_t size, unsigned int threads, bool shared, double opsPerSecond, double efficiency)
+{
+	std::ostringstream oss;
+	oss << std::setiosflags(std::ios::fixed);
+
+	const double mbs = opsPerSecond * double(size) / (1024*1024);
+	const char *mode = shared ? "shared" : "per-thread";
+
+	if (g_format == FormatCSV)
+	{
+		oss << CsvString(name) << ',' << CsvString(provider) << ',' << size << ',' << threads;
+		oss << ',' << mode << ',' << std::setprecision(1) << opsPerSecond;
+		oss << ',' << std::setprecision(2) << mbs << ',' << std::setprecision(3) << efficiency << "\n";
+	}
+	else
+	{
+		oss << (g_recordCount ? ",\n" : "\n") << "    {\"algorithm\": " << JsonString(name);
+		oss << ", \"provider\": " << JsonString(provider) << ", \"size\": " << size;
+		oss << ", \"threads\": " << threads << ", \"mode\": " << JsonString(mode);
+		oss << ", \"ops_per_s\": " << std::setprecision(1) << opsPerSecond;
+		oss << ", \"mib_per_s\": " << std::setprecision(2) << mbs;
+		oss << ", \"efficiency\": " << std::setprecision(3) << efficiency << "}";
+	}
+	g_recordCount++;
+
+	std::cout << oss.str() << std::flush;
+}
+
 void OutputResultOperations(const char *name, const char *provider, const char *operation, bool pc, unsigned long iterations, double timeTaken)
 {
 	CRYPTOPP_UNUSED(provider);
@@ -293,6 +661,30 @@ void BenchMark(const char *name, NIST_DRBG &rng, double timeTotal)
 	OutputResultBytes(name, provider.c_str(), double(blocks) * BUF_SIZE, timeTaken);
 }
 
+// The memory parameter is the number of bytes a derivation writes,
+//  so the result is comparable to the hashes. Argon2 fills memoryCost
+//  KiB on each of timeCost passes.
+void BenchMark(const char *name, KeyDerivationFunction &kdf, const NameValuePairs &params, double memory, double timeTotal)
+{
+	SecByteBlock password(16), derived(32);
+	Test::GlobalRNG().GenerateBlock(password, password.size());
+
+	unsigned long derivations = 0;
+	double timeTaken;
+
+	clock_t start = ::clock();
+	do
+	{
+		kdf.DeriveKey(derived, derived.size(), password, password.size(), params);
+		derivations++;
+		timeTaken = double(::clock() - start) / CLOCK_TICKS_PER_SECOND;
+	}
+	while (timeTaken < timeTotal);
+
+	std::string provider = kdf.AlgorithmProvider();
+	OutputResultBytes(name, provider.c_str(), double(derivations) * memory, timeTaken);
+}
+
 template <class T>
 void BenchMarkByNameKeyLess(const char *factoryName, const char *displayName = NULLPTR, const NameValuePairs &params = g_nullNameValuePairs)
 {
@@ -332,6 +724,10 @@ void AddHtmlHeader()
 	else
 		oss << "\n<P>CPU frequency of the test platform was not provided.</P>" << std::endl;
 
+	const std::string masked = MaskedCPUFeatures();
+	if (!masked.empty())
+		oss << "\n<P>CPU features disabled with CRYPTOPP_CPU_MASK: " << masked << ".</P>" << std::endl;
+
 	std::cout << oss.str();
 }
 
@@ -342,9 +738,219 @@ void AddHtmlFooter()
 	std::cout << oss.str();
 }
 
+// A non-empty threads list selects the scaling header. The latency
+//  suite has no message sizes, so its header omits them.
+void AddSizeHeader(const std::vector<size_t> &sizes, const std::vector<unsigned int> &threads, bool pin, bool latency)
+{
+	std::ostringstream oss;
+	if (g_format == FormatCSV && latency)
+	{
+		oss << "algorithm,provider,operation,mode,samples,mean_us,p50_us,p90_us,p99_us,p999_us,max_us\n";
+	}
+	else if (g_format == FormatCSV && threads.empty())
+	{
+		oss << "algorithm,provider,size,ns_per_op,ns_per_op_rekey,mib_per_s,cycles_per_byte,ipc,cache_misses_per_op,branch_misses_per_op\n";
+	}
+	else if (g_format == FormatCSV)
+	{
+		oss << "algorithm,provider,size,threads,mode,ops_per_s,mib_per_s,efficiency\n";
+	}
+	else
+	{
+		oss << "{\n  \"library\": \"Crypto++ " << CRYPTOPP_VERSION / 100 << '.' << (CRYPTOPP_VERSION % 100) / 10;
+		oss << '.' << CRYPTOPP_VERSION % 10 << "\",\n  \"started\": " << JsonString(TimeToString(g_testBegin));
+		oss << ",\n  \"seconds_per_test\": " << g_allocatedTime << ",\n  \"cpu_hz\": ";
+		if (g_hertz > 1.0f)
+			oss << std::setiosflags(std::ios::fixed) << std::setprecision(0) << g_hertz;
+		else
+			oss << "null";
+		oss << ",\n  \"cpu_mask\": " << JsonString(MaskedCPUFeatures());
+		if (latency)
+		{
+			oss << ",\n  \"timer_hz\": " << Timer().TicksPerSecond();
+			oss << ",\n  \"results\": [";
+			std::cout << oss.str();
+			return;
+		}
+
+		if (threads.empty())
+		{
+			const BenchCounters::Source source = BenchCounters::DefaultSource();
+			oss << ",\n  \"counters\": " << JsonString(BenchCounters::SourceName(source));
+			if (source == BenchCounters::TimeStampCounter)
+				oss << ",\n  \"tsc_hz\": " << std::setiosflags(std::ios::fixed) << std::setprecision(0) << BenchCounters::TimeStampFrequency();
+		}
+
+		oss << ",\n  \"sizes\": [";
+		for (size_t i=0; i<sizes.size(); ++i)
+			oss << (i ? ", " : "") << sizes[i];
+		if (!threads.empty())
+		{
+			oss << "],\n  \"threads\": [";
+			for (size_t i=0; i<threads.size(); ++i)
+				oss << (i ? ", " : "") << threads[i];
+			oss << "],\n  \"pinned\": " << (pin ? "true" : "false");
+			oss << ",\n  \"results\": [";
+		}
+		else
+		{
+			oss << "],\n  \"results\": [";
+		}
+	}
+	std::cout << oss.str();
+}
+
+void AddSizeFooter()
+{
+	if (g_format == FormatJSON)
+		std::cout << "\n  ]\n}" << std::endl;
+}
+
+// Parses a list like "16,64,1K,64K". K and M are powers of 1024.
+std::vector<size_t> ParseSizes(const std::string &list)
+{
+	std::vector<size_t> sizes;
+	std::istringstream iss(list);
+	std::string item;
+	while (std::getline(iss, item, ','))
+	{
+		size_t multiplier = 1;
+		if (!item.empty() && (item[item.size()-1] == 'K' || item[item.size()-1] == 'k'))
+			multiplier = 1024;
+		else if (!item.empty() && (item[item.size()-1] == 'M' || item[item.size()-1] == 'm'))
+			multiplier = 1024*1024;
+		if (multiplier != 1)
+			item.erase(item.size()-1);
+
+		const int size = Test::StringToValue<int, true>(item);
+		if (size <= 0)
+			throw InvalidArgument("Benchmark: message size must be positive");
+		sizes.push_back(size_t(size) * multiplier);
+	}
+	return sizes;
+}
+
+// Parses a list like "1,2,4,max". max is the number of logical processors.
+std::vector<unsigned int> ParseThreads(const std::string &list)
+{
+	std::vector<unsigned int> threads;
+	std::istringstream iss(list);
+	std::string item;
+	while (std::getline(iss, item, ','))
+	{
+		if (item == "max")
+		{
+			unsigned int count = 0;
+#if defined(CRYPTOPP_CXX11_SYNCHRONIZATION)
+			count = std::thread::hardware_concurrency();
+#endif
+			threads.push_back(count ? count : 1);
+			continue;
+		}
+
+		const int count = Test::StringToValue<int, true>(item);
+		if (count <= 0)
+			throw InvalidArgument("Benchmark: thread count must be positive");
+		threads.push_back(static_cast<unsigned int>(count));
+	}
+	return threads;
+}
+
+std::vector<std::string> ParseNames(const std::string &list)
+{
+	std::vector<std::string> names;
+	std::istringstream iss(list);
+	std::string item;
+	while (std::getline(iss, item, ','))
+	{
+		if (!item.empty())
+			names.push_back(item);
+	}
+	return names;
+}
+
+// cryptest.exe b --sizes 16,64,1K [--format json|csv] [--time seconds]
+//   [--freq gigahertz] [--algorithms name,name,...]
+// cryptest.exe b --threads 1,2,4,max [--pin] [--sizes 16K] ...
+// cryptest.exe b --latency [--format json|csv] [--time seconds] ...
+// cryptest.exe b --all-providers [--cpu-mask aesni,shani] [--sizes 16K] ...
+void BenchmarkSizesWithCommand(int argc, const char* const argv[])
+{
+	std::vector<size_t> sizes;
+	std::vector<unsigned int> threads;
+	std::vector<std::string> algorithms;
+	float runningTime = 0.25f, cpuFreq = 0.0f;
+	bool pin = false, latency = false, allProviders = false;
+	g_format = FormatJSON;
+
+	for (int i=2; i<argc; i+=2)
+	{
+		const std::string option(argv[i]);
+		if (option == "--pin" || option == "--latency" || option == "--all-providers")
+		{
+			(option == "--pin" ? pin : option == "--latency" ? latency : allProviders) = true;
+			i--;
+			continue;
+		}
+		if (i+1 >= argc)
+			throw InvalidArgument("Benchmark: option " + option + " requires a value");
+
+		const std::string value(argv[i+1]);
+		if (option == "--threads")
+			threads = ParseThreads(value);
+		else if (option == "--sizes")
+			sizes = ParseSizes(value);
+		else if (option == "--cpu-mask")
+			MaskCPUFeatures(value);
+		else if (option == "--algorithms")
+			algorithms = ParseNames(value);
+		else if (option == "--time")
+			runningTime = Test::StringToValue<float, true>(value);
+		else if (option == "--freq")
+			cpuFreq = Test::StringToValue<float, true>(value)*float(1e9);
+		else if (option == "--format" && value == "json")
+			g_format = FormatJSON;
+		else if (option == "--format" && value == "csv")
+			g_format = FormatCSV;
+		else
+			throw InvalidArgument("Benchmark: unknown option " + option + " " + value);
+	}
+
+	if (pin && threads.empty())
+		throw InvalidArgument("Benchmark: option --pin requires --threads");
+	if (latency && (!threads.empty() || !sizes.empty()))
+		throw InvalidArgument("Benchmark: option --latency cannot be used with --threads or --sizes");
+	if (allProviders && (latency || !threads.empty()))
+		throw InvalidArgument("Benchmark: option --all-providers only applies to the size sweep");
+	if (sizes.empty())
+		sizes = ParseSizes(threads.empty() ? "16,64,256,1K,8K,64K" : "16K");
+
+	g_allocatedTime = runningTime;
+	g_hertz = cpuFreq;
+	g_recordCount = 0;
+	g_testBegin = ::time(NULLPTR);
+
+	AddSizeHeader(sizes, threads, pin, latency);
+	if (latency)
+		BenchmarkLatency(algorithms, runningTime);
+	else if (threads.empty())
+		BenchmarkSizes(sizes, algorithms, runningTime, cpuFreq, allProviders);
+	else
+		BenchmarkScaling(sizes, threads, algorithms, pin, runningTime);
+	AddSizeFooter();
+
+	g_format = FormatHTML;
+}
+
 void BenchmarkWithCommand(int argc, const char* const argv[])
 {
 	std::string command(argv[1]);
+	if (command == "b" && argc >= 3 && std::string(argv[2]).compare(0, 2, "--") == 0)
+	{
+		BenchmarkSizesWithCommand(argc, argv);
+		return;
+	}
+
 	float runningTime(argc >= 3 ? Test::StringToValue<float, true>(argv[2]) : 1.0f);
 	float cpuFreq(argc >= 4 ? Test::StringToValue<float, true>(argv[3])*float(1e9) : 0.0f);
 	std::string algoName(argc >= 5 ? argv[4] : "");
@@ -462,6 +1068,8 @@ void Benchmark1(double t, double hertz)
 		BenchMarkByNameKeyLess<NIST_DRBG>("Hash_DRBG(SHA256)");
 		BenchMarkByNameKeyLess<NIST_DRBG>("HMAC_DRBG(SHA1)");
 		BenchMarkByNameKeyLess<NIST_DRBG>("HMAC_DRBG(SHA256)");
+		BenchMarkByNameKeyLess<NIST_DRBG>("CTR_DRBG(AES-128)");
+		BenchMarkByNameKeyLess<NIST_DRBG>("CTR_DRBG(AES-256)");
 	}
 
 	std::cout << "\n<TBODY style=\"background: yellow;\">";
@@ -492,6 +1100,21 @@ void Benchmark1(double t, double hertz)
 		BenchMarkByNameKeyLess<HashTransformation>("BLAKE2b");
 	}
 
+	std::cout << "\n<TBODY style=\"background: white;\">";
+	{
+		const byte salt[16] = {0};
+		const word32 memoryCost = 16*1024, timeCost = 1;
+		const double memory = 1024.0 * memoryCost * timeCost;
+
+		Argon2 argon2;
+		BenchMark("Argon2id (m=16 MiB, t=1, p=1)", argon2, MakeParameters("MemoryCost", memoryCost)
+			("TimeCost", timeCost)("Parallelization", (word32)1)(Name::Salt(), ConstByteArrayParameter(salt, sizeof(salt))),
+			memory, g_allocatedTime);
+		BenchMark("Argon2id (m=16 MiB, t=1, p=4)", argon2, MakeParameters("MemoryCost", memoryCost)
+			("TimeCost", timeCost)("Parallelization", (word32)4)(Name::Salt(), ConstByteArrayParameter(salt, sizeof(salt))),
+			memory, g_allocatedTime);
+	}
+
 	std::cout << "\n</TABLE>" << std::endl;
 }
 
@@ -17,6 +17,27 @@
 #include "ttmac.h"
 #include "cmac.h"
 #include "dmac.h"
+#include "gcm.h"
+#include "aes.h"
+#include "chachapoly.h"
+#include "oneshot.h"
+#include "filters.h"
+#include "osrng.h"
+#include "randpool.h"
+
+#if defined(CRYPTOPP_CXX11_SYNCHRONIZATION)
+# include <atomic>
+# include <chrono>
+# include <mutex>
+# include <thread>
+#endif
+
+#if defined(CRYPTOPP_CXX11_SYNCHRONIZATION) && defined(__linux__)
+# include <pthread.h>
+# include <sched.h>
+#elif defined(CRYPTOPP_CXX11_SYNCHRONIZATION) && defined(CRYPTOPP_WIN32_AVAILABLE)
+# include <windows.h>
+#endif
 
 #if CRYPTOPP_MSC_VERSION
 # pragma warning(disable: 4355)
@@ -55,6 +76,48 @@ void BenchMark(const char *name, AuthenticatedSymmetricCipher &cipher, double ti
 	BenchMark(name, static_cast<StreamTransformation &>(cipher), timeTotal);
 }
 
+// Small messages are dominated by the cost of the filter pipeline
+void BenchMarkOneShot(const char *name, AuthenticatedSymmetricCipher &cipher, size_t length, double timeTotal)
+{
+	const std::string provider(static_cast<StreamTransformation &>(cipher).AlgorithmProvider());
+	const std::string label = std::string(name) + " (" + IntToString(length) + "-byte messages, ";
+	SecByteBlock iv(12), message(length), buffer(length+cipher.TagSize());
+	std::memset(iv, 0x00, iv.size());
+	std::memset(message, 0x00, message.size());
+
+	unsigned long i=0;
+	double timeTaken;
+
+	clock_t start = ::clock();
+	do
+	{
+		for (unsigned int j=0; j<256; j++)
+		{
+			std::string ciphertext;
+			cipher.Resynchronize(iv, (int)iv.size());
+			StringSource(message, length, true, new AuthenticatedEncryptionFilter(cipher, new StringSink(ciphertext)));
+		}
+		i += 256;
+		timeTaken = double(::clock() - start) / CLOCK_TICKS_PER_SECOND;
+	}
+	while (timeTaken < timeTotal);
+
+	OutputResultBytes((label + "filter)").c_str(), provider.c_str(), double(length)*i, timeTaken);
+
+	i = 0;
+	start = ::clock();
+	do
+	{
+		for (unsigned int j=0; j<256; j++)
+			EncryptAndAuthenticate(cipher, buffer, buffer.size(), iv, iv.size(), NULLPTR, 0, message, length);
+		i += 256;
+		timeTaken = double(::clock() - start) / CLOCK_TICKS_PER_SECOND;
+	}
+	while (timeTaken < timeTotal);
+
+	OutputResultBytes((label + "one-shot)").c_str(), provider.c_str(), double(length)*i, timeTaken);
+}
+
 template <class T_FactoryOutput, class T_Interface>
 void BenchMarkByName2(const char *factoryName, size_t keyLength=0, const char *displayName=NULLPTR, const NameValuePairs &params = g_nullNameValuePairs)
 {
@@ -80,6 +143,447 @@ void BenchMarkByName(const char *factoryName, size_t keyLength=0, const char *di
 	BenchMarkByName2<T_FactoryOutput,T_FactoryOutput>(factoryName, keyLength, displayName, params);
 }
 
+// One message of the size sweep. Run() pays for the resynchronization
+//  and finalization of a real message. With rekey it also sets the key.
+//  The operation owns its object, so each thread can have its own.
+class SizeOperation
+{
+public:
+	virtual ~SizeOperation() {}
+	virtual std::string Provider() const = 0;
+	virtual bool IsKeyed() const = 0;
+	virtual void Run(byte *buf, size_t size, bool rekey) = 0;
+};
+
+class HashSizeOperation : public SizeOperation
+{
+public:
+	// keying is the same object as hash, or NULL for an unkeyed hash
+	HashSizeOperation(HashTransformation *hash, SimpleKeyingInterface *keying, size_t keyLength)
+		: m_hash(hash), m_keying(keying), m_digest(hash->DigestSize()), m_keyLength(keyLength)
+	{
+		if (m_keying)
+			m_keying->SetKey(defaultKey, m_keyLength);
+	}
+
+	std::string Provider() const {return m_hash->AlgorithmProvider();}
+	bool IsKeyed() const {return m_keying != NULLPTR;}
+	void Run(byte *buf, size_t size, bool rekey)
+	{
+		if (rekey && m_keying)
+			m_keying->SetKey(defaultKey, m_keyLength);
+		m_hash->CalculateDigest(m_digest, buf, size);
+	}
+
+private:
+	member_ptr<HashTransformation> m_hash;
+	SimpleKeyingInterface *m_keying;
+	SecByteBlock m_digest;
+	size_t m_keyLength;
+};
+
+class CipherSizeOperation : public SizeOperation
+{
+public:
+	CipherSizeOperation(SymmetricCipher *cipher, size_t keyLength)
+		: m_cipher(cipher), m_keyLength(keyLength)
+	{
+		m_cipher->SetKeyWithIV(defaultKey, m_keyLength, defaultKey, m_cipher->IVSize());
+	}
+
+	std::string Provider() const {return m_cipher->AlgorithmProvider();}
+	bool IsKeyed() const {return true;}
+	void Run(byte *buf, size_t size, bool rekey)
+	{
+		if (rekey)
+			m_cipher->SetKeyWithIV(defaultKey, m_keyLength, defaultKey, m_cipher->IVSize());
+		else
+			m_cipher->Resynchronize(defaultKey, (int)m_cipher->IVSize());
+		m_cipher->ProcessData(buf, buf, size);
+	}
+
+private:
+	member_ptr<SymmetricCipher> m_cipher;
+	size_t m_keyLength;
+};
+
+class AuthenticatedSizeOperation : public SizeOperation
+{
+public:
+	AuthenticatedSizeOperation(AuthenticatedSymmetricCipher *cipher, size_t keyLength)
+		: m_cipher(cipher), m_tag(cipher->TagSize()), m_keyLength(keyLength)
+	{
+		m_cipher->SetKeyWithIV(defaultKey, m_keyLength, defaultKey, m_cipher->DefaultIVLength());
+	}
+
+	std::string Provider() const {return static_cast<const StreamTransformation &>(*m_cipher).AlgorithmProvider();}
+	bool IsKeyed() const {return true;}
+	void Run(byte *buf, size_t size, bool rekey)
+	{
+		if (rekey)
+			m_cipher->SetKeyWithIV(defaultKey, m_keyLength, defaultKey, m_cipher->DefaultIVLength());
+		m_cipher->EncryptAndAuthenticate(buf, m_tag, m_tag.size(), defaultKey,
+			(int)m_cipher->DefaultIVLength(), NULLPTR, 0, buf, size);
+	}
+
+private:
+	member_ptr<AuthenticatedSymmetricCipher> m_cipher;
+	SecByteBlock m_tag;
+	size_t m_keyLength;
+};
+
+class RandomSizeOperation : public SizeOperation
+{
+public:
+	RandomSizeOperation(RandomNumberGenerator *rng) : m_rng(rng) {}
+
+	std::string Provider() const {return m_rng->AlgorithmProvider();}
+	bool IsKeyed() const {return false;}
+	void Run(byte *buf, size_t size, bool rekey)
+	{
+		CRYPTOPP_UNUSED(rekey);
+		m_rng->GenerateBlock(buf, size);
+	}
+
+private:
+	member_ptr<RandomNumberGenerator> m_rng;
+};
+
+enum SizeAlgorithmType {SizeHash, SizeMAC, SizeCipher, SizeAEAD, SizeRNG};
+
+struct SizeAlgorithm
+{
+	SizeAlgorithmType type;
+	const char *factoryName;
+	size_t keyLength;
+	const char *displayName;
+};
+
+const SizeAlgorithm s_sizeAlgorithms[] = {
+	{SizeHash, "SHA-1", 0, NULLPTR},
+	{SizeHash, "SHA-256", 0, NULLPTR},
+	{SizeHash, "SHA-512", 0, NULLPTR},
+	{SizeHash, "SHA3-256", 0, NULLPTR},
+	{SizeHash, "BLAKE2s", 0, NULLPTR},
+	{SizeHash, "BLAKE2b", 0, NULLPTR},
+
+	{SizeMAC, "HMAC(SHA-256)", 0, NULLPTR},
+	{SizeMAC, "CMAC(AES)", 0, NULLPTR},
+	{SizeMAC, "Poly1305TLS", 0, NULLPTR},
+	{SizeMAC, "SipHash-2-4", 0, NULLPTR},
+
+	{SizeCipher, "AES/CTR", 16, "AES/CTR (128-bit key)"},
+	{SizeCipher, "AES/CTR", 32, "AES/CTR (256-bit key)"},
+	{SizeCipher, "ChaCha", 0, "ChaCha20"},
+
+	{SizeAEAD, "AES/GCM", 16, "AES/GCM (128-bit key)"},
+	{SizeAEAD, "AES/GCM", 32, "AES/GCM (256-bit key)"},
+	{SizeAEAD, "AES/CCM", 16, "AES/CCM (128-bit key)"},
+	{SizeAEAD, "ChaCha20/Poly1305", 0, NULLPTR},
+
+#ifdef OS_RNG_AVAILABLE
+	{SizeRNG, "AutoSeededRandomPool", 0, NULLPTR},
+#endif
+	{SizeRNG, "RandomPool", 0, NULLPTR}
+};
+
+inline std::string DisplayName(const SizeAlgorithm &alg)
+{
+	return alg.displayName ? alg.displayName : alg.factoryName;
+}
+
+inline bool IsSelected(const SizeAlgorithm &alg, const std::vector<std::string> &algorithms)
+{
+	return algorithms.empty() || std::find(algorithms.begin(), algorithms.end(), DisplayName(alg)) != algorithms.end();
+}
+
+SizeOperation* NewSizeOperation(const SizeAlgorithm &alg)
+{
+	switch (alg.type)
+	{
+	case SizeHash:
+		return new HashSizeOperation(ObjectFactoryRegistry<HashTransformation>::Registry().CreateObject(alg.factoryName), NULLPTR, 0);
+	case SizeMAC:
+	{
+		member_ptr<MessageAuthenticationCode> mac(ObjectFactoryRegistry<MessageAuthenticationCode>::Registry().CreateObject(alg.factoryName));
+		const size_t keyLength = alg.keyLength ? alg.keyLength : mac->DefaultKeyLength();
+		MessageAuthenticationCode *keyed = mac.release();
+		return new HashSizeOperation(keyed, keyed, keyLength);
+	}
+	case SizeCipher:
+	{
+		member_ptr<SymmetricCipher> cipher(ObjectFactoryRegistry<SymmetricCipher>::Registry().CreateObject(alg.factoryName));
+		const size_t keyLength = alg.keyLength ? alg.keyLength : cipher->DefaultKeyLength();
+		return new CipherSizeOperation(cipher.release(), keyLength);
+	}
+	case SizeAEAD:
+	{
+		member_ptr<AuthenticatedSymmetricCipher> cipher(ObjectFactoryRegistry<AuthenticatedSymmetricCipher>::Registry().CreateObject(alg.factoryName));
+		const size_t keyLength = alg.keyLength ? alg.keyLength : cipher->DefaultKeyLength();
+		return new AuthenticatedSizeOperation(cipher.release(), keyLength);
+	}
+	default:
+		// Generators are not in the object factory
+#ifdef OS_RNG_AVAILABLE
+		if (std::string(alg.factoryName) == "AutoSeededRandomPool")
+			return new RandomSizeOperation(new AutoSeededRandomPool);
+#endif
+		return new RandomSizeOperation(new RandomPool);
+	}
+}
+
+// Returns nanoseconds per operation. If counters is not NULL then
+//  it receives the hardware events of the same loop.
+double TimeSizeOperation(SizeOperation &op, byte *buf, size_t size, bool rekey, double timeTotal, CounterResult *counters = NULLPTR)
+{
+	unsigned long i=0, operations=1;
+	double timeTaken;
+	BenchCounters events;
+
+	events.Start();
+	clock_t start = ::clock();
+	do
+	{
+		operations *= 2;
+		for (; i<operations; i++)
+			op.Run(buf, size, rekey);
+		timeTaken = double(::clock() - start) / CLOCK_TICKS_PER_SECOND;
+	}
+	while (timeTaken < 2.0/3*timeTotal);
+	events.Stop();
+
+	if (counters)
+		*counters = events.Result(double(operations));
+	return timeTaken * 1e9 / double(operations);
+}
+
+// The CPU features to mask so the library moves off a provider
+const char *ProviderFeatures(const std::string &provider)
+{
+	const char *features[][2] = {
+		{"AESNI", "aesni"}, {"SHANI", "shani"}, {"CLMUL", "clmul"}, {"AVX2", "avx2"}, {"AVX", "avx"},
+		{"SSE4.2", "sse4.2"}, {"SSE4.1", "sse4.1"}, {"SSSE3", "ssse3"}, {"SSE2", "sse2"}, {"Padlock", "padlock"},
+		{"ARMv8", "aes,pmull,crc32,sha1,sha2,sha512,sha3,sm3,sm4"}, {"NEON", "neon"}, {"ARMv7", "armv7"},
+		{"Power9", "power9"}, {"Power8", "power8"}, {"Power7", "power7"}, {"Altivec", "altivec"}
+	};
+
+	for (size_t i=0; i<COUNTOF(features); ++i)
+	{
+		if (provider == features[i][0])
+			return features[i][1];
+	}
+	return NULLPTR;
+}
+
+void BenchMarkSize(const SizeAlgorithm &alg, byte *buf, size_t size, double t)
+{
+	member_ptr<SizeOperation> op(NewSizeOperation(alg));
+	const std::string name = DisplayName(alg), provider = op->Provider();
+
+	CounterResult counters;
+	const double nsPerOp = TimeSizeOperation(*op, buf, size, false, t, &counters);
+	const double nsPerRekeyedOp = op->IsKeyed() ? TimeSizeOperation(*op, buf, size, true, t) : -1.0;
+	OutputResultSize(name.c_str(), provider.c_str(), size, nsPerOp, nsPerRekeyedOp, counters);
+}
+
+// Benchmarks the provider the library selects, then masks the CPU
+//  features behind it and repeats until the provider does not change.
+//  The records of one size are adjacent so the providers line up.
+void BenchMarkSizeProviders(const SizeAlgorithm &alg, byte *buf, size_t size, double t)
+{
+	const std::string original = MaskedCPUFeatures();
+	std::string mask = original;
+	std::vector<std::string> seen;
+
+	try
+	{
+		while (true)
+		{
+			MaskCPUFeatures(mask);
+			const std::string provider = member_ptr<SizeOperation>(NewSizeOperation(alg))->Provider();
+			if (std::find(seen.begin(), seen.end(), provider) != seen.end())
+				break;
+
+			BenchMarkSize(alg, buf, size, t);
+			seen.push_back(provider);
+
+			const char *features = ProviderFeatures(provider);
+			if (!features)
+				break;
+			mask += (mask.empty() ? "" : ",") + std::string(features);
+		}
+	}
+	catch (const InvalidArgument &)
+	{
+		// A feature name of another platform
+	}
+
+	MaskCPUFeatures(original);
+}
+
+void BenchmarkSizes(const std::vector<size_t> &sizes, const std::vector<std::string> &algorithms, double t, double hertz, bool allProviders)
+{
+	g_allocatedTime = t;
+	g_hertz = hertz;
+
+	if (sizes.empty())
+		throw InvalidArgument("Benchmark: no message sizes");
+
+	AlignedSecByteBlock buf(*std::max_element(sizes.begin(), sizes.end()));
+	Test::GlobalRNG().GenerateBlock(buf, buf.size());
+
+	for (size_t i=0; i<COUNTOF(s_sizeAlgorithms); ++i)
+	{
+		const SizeAlgorithm &alg = s_sizeAlgorithms[i];
+		if (!IsSelected(alg, algorithms))
+			continue;
+
+		for (size_t j=0; j<sizes.size(); ++j)
+		{
+			if (allProviders)
+				BenchMarkSizeProviders(alg, buf, sizes[j], t);
+			else
+				BenchMarkSize(alg, buf, sizes[j], t);
+		}
+	}
+}
+
+#if defined(CRYPTOPP_CXX11_SYNCHRONIZATION)
+
+// Pins the calling thread to one logical processor. Pinning is
+//  best effort; platforms without an affinity call run unpinned.
+void PinThread(unsigned int cpu)
+{
+#if defined(__linux__)
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(cpu % CPU_SETSIZE, &set);
+	(void)pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#elif defined(CRYPTOPP_WIN32_AVAILABLE) && !defined(CRYPTOPP_WIN32_NO_THREAD_AFFINITY)
+	(void)SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << (cpu % (sizeof(DWORD_PTR)*8)));
+#else
+	CRYPTOPP_UNUSED(cpu);
+#endif
+}
+
+// Shared state of one scaling run. Threads spin on start so they
+//  begin together, then run until the main thread sets stop.
+struct ScalingRun
+{
+	ScalingRun() : start(false), stop(false) {}
+
+	std::atomic<bool> start, stop;
+	std::mutex mutex;
+};
+
+void RunScalingThread(ScalingRun &run, SizeOperation &op, bool shared, size_t size,
+	bool pin, unsigned int cpu, unsigned long long &operations)
+{
+	if (pin)
+		PinThread(cpu);
+
+	AlignedSecByteBlock buf(size);
+	std::memset(buf, 0x00, buf.size());
+
+	unsigned long long count = 0;
+	while (!run.start.load(std::memory_order_acquire))
+		std::this_thread::yield();
+
+	while (!run.stop.load(std::memory_order_relaxed))
+	{
+		if (shared)
+		{
+			std::lock_guard<std::mutex> guard(run.mutex);
+			op.Run(buf, size, false);
+		}
+		else
+		{
+			op.Run(buf, size, false);
+		}
+		count++;
+	}
+
+	operations = count;
+}
+
+// Returns operations per second over all threads
+double TimeScaling(const SizeAlgorithm &alg, size_t size, unsigned int threads, bool shared, bool pin, double timeTotal)
+{
+	std::vector<member_ptr<SizeOperation> > ops(shared ? 1 : threads);
+	for (size_t i=0; i<ops.size(); ++i)
+		ops[i].reset(NewSizeOperation(alg));
+
+	ScalingRun run;
+	std::vector<unsigned long long> operations(threads);
+	std::vector<std::thread> workers;
+	for (unsigned int i=0; i<threads; ++i)
+	{
+		workers.push_back(std::thread(RunScalingThread, std::ref(run), std::ref(*ops[shared ? 0 : i]),
+			shared, size, pin, i, std::ref(operations[i])));
+	}
+
+	const std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+	run.start.store(true, std::memory_order_release);
+	std::this_thread::sleep_for(std::chrono::duration<double>(timeTotal));
+	run.stop.store(true, std::memory_order_relaxed);
+
+	for (size_t i=0; i<workers.size(); ++i)
+		workers[i].join();
+	const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+	unsigned long long total = 0;
+	for (size_t i=0; i<operations.size(); ++i)
+		total += operations[i];
+
+	return double(total) / elapsed;
+}
+
+void BenchmarkScaling(const std::vector<size_t> &sizes, const std::vector<unsigned int> &threads,
+	const std::vector<std::string> &algorithms, bool pin, double t)
+{
+	g_allocatedTime = t;
+
+	if (sizes.empty() || threads.empty())
+		throw InvalidArgument("Benchmark: no message sizes or thread counts");
+
+	for (size_t i=0; i<COUNTOF(s_sizeAlgorithms); ++i)
+	{
+		const SizeAlgorithm &alg = s_sizeAlgorithms[i];
+		if (!IsSelected(alg, algorithms))
+			continue;
+
+		const std::string name = DisplayName(alg);
+		const std::string provider = member_ptr<SizeOperation>(NewSizeOperation(alg))->Provider();
+		for (size_t j=0; j<sizes.size(); ++j)
+		{
+			for (unsigned int shared=0; shared<2; ++shared)
+			{
+				double single = 0.0;
+				for (size_t k=0; k<threads.size(); ++k)
+				{
+					const double opsPerSecond = TimeScaling(alg, sizes[j], threads[k], shared != 0, pin, t);
+					if (k == 0)
+						single = opsPerSecond / threads[k];
+					OutputResultScaling(name.c_str(), provider.c_str(), sizes[j], threads[k],
+						shared != 0, opsPerSecond, single > 0.0 ? opsPerSecond / (single * threads[k]) : 0.0);
+				}
+			}
+		}
+	}
+}
+
+#else
+
+void BenchmarkScaling(const std::vector<size_t> &sizes, const std::vector<unsigned int> &threads,
+	const std::vector<std::string> &algorithms, bool pin, double t)
+{
+	CRYPTOPP_UNUSED(sizes); CRYPTOPP_UNUSED(threads);
+	CRYPTOPP_UNUSED(algorithms); CRYPTOPP_UNUSED(pin); CRYPTOPP_UNUSED(t);
+	throw NotImplemented("Benchmark: the scaling suite requires C++11 threads");
+}
+
+#endif  // CRYPTOPP_CXX11_SYNCHRONIZATION
+
 void Benchmark2(double t, double hertz)
 {
 	g_allocatedTime = t;
@@ -260,6 +764,19 @@ void Benchmark2(double t, double hertz)
 		BenchMarkByName2<AuthenticatedSymmetricCipher, AuthenticatedSymmetricCipher>("XChaCha20/Poly1305");
 	}
 
+	std::cout << "\n<TBODY style=\"background: yellow;\">";
+	{
+		GCM<AES>::Encryption gcm;
+		gcm.SetKeyWithIV(defaultKey, 16, defaultKey, 12);
+		BenchMarkOneShot("AES/GCM", gcm, 64, t);
+		BenchMarkOneShot("AES/GCM", gcm, 1024, t);
+
+		ChaCha20Poly1305::Encryption chacha;
+		chacha.SetKeyWithIV(defaultKey, 32, defaultKey, 12);
+		BenchMarkOneShot("ChaCha20/Poly1305", chacha, 64, t);
+		BenchMarkOneShot("ChaCha20/Poly1305", chacha, 1024, t);
+	}
+
 	std::cout << "\n</TABLE>" << std::endl;
 }
 
@@ -300,6 +300,250 @@ void BenchMarkKeyAgreement(const char *filename, const char *name, double timeTo
 	BenchMarkAgreement(name, d, timeTotal);
 }
 
+// Log-linear histogram in the style of HdrHistogram. Values below 128
+//  ticks have their own bucket. Above that each power of two has 64
+//  buckets, so a reported value is within 1/64 of the recorded value.
+class LatencyHistogram
+{
+public:
+	LatencyHistogram() : m_counts((58 << SubBits) + Sub), m_count(0), m_sum(0), m_max(0) {}
+
+	void Record(word64 value)
+	{
+		m_counts[Index(value)]++;
+		m_count++; m_sum += double(value);
+		m_max = STDMAX(m_max, value);
+	}
+
+	word64 Count() const {return m_count;}
+	word64 Max() const {return m_max;}
+	double Mean() const {return m_count ? m_sum / double(m_count) : 0.0;}
+
+	// Returns the midpoint of the bucket holding the p-th percentile
+	word64 Percentile(double p) const
+	{
+		const word64 target = STDMAX(word64(1), word64(std::ceil(p / 100.0 * double(m_count))));
+		word64 seen = 0;
+		for (size_t i=0; i<m_counts.size(); ++i)
+		{
+			seen += m_counts[i];
+			if (seen >= target)
+				return STDMIN(Value(i), m_max);
+		}
+		return m_max;
+	}
+
+private:
+	enum {SubBits = 6, Sub = 1 << SubBits};
+
+	static size_t Index(word64 value)
+	{
+		const unsigned int bits = BitPrecision(value);
+		const unsigned int shift = bits > SubBits+1 ? bits - (SubBits+1) : 0;
+		return (size_t(shift) << SubBits) + size_t(value >> shift);
+	}
+
+	static word64 Value(size_t index)
+	{
+		if (index < 2*Sub)
+			return index;
+		const unsigned int shift = static_cast<unsigned int>(index >> SubBits) - 1;
+		const word64 mantissa = index - (size_t(shift) << SubBits);
+		return (mantissa << shift) + (word64(1) << (shift - 1));
+	}
+
+	std::vector<word64> m_counts;
+	word64 m_count;
+	double m_sum;
+	word64 m_max;
+};
+
+template <class SIGNER>
+class SigningLatency
+{
+public:
+	SigningLatency(const SIGNER &key) : m_key(key), m_message(16), m_signature(key.SignatureLength())
+	{
+		Test::GlobalRNG().GenerateBlock(m_message, m_message.size());
+	}
+
+	static const char *Operation() {return "Signature";}
+	std::string Provider() const {return m_key.AlgorithmProvider();}
+	CryptoMaterial& AccessMaterial() {return m_key.AccessMaterial();}
+	void Run() {(void)m_key.SignMessage(Test::GlobalRNG(), m_message, m_message.size(), m_signature);}
+
+private:
+	SIGNER m_key;
+	SecByteBlock m_message, m_signature;
+};
+
+template <class VERIFIER>
+class VerificationLatency
+{
+public:
+	VerificationLatency(const PK_Signer &priv, const VERIFIER &key) : m_key(key), m_message(16), m_signature(key.SignatureLength())
+	{
+		Test::GlobalRNG().GenerateBlock(m_message, m_message.size());
+		priv.SignMessage(Test::GlobalRNG(), m_message, m_message.size(), m_signature);
+	}
+
+	static const char *Operation() {return "Verification";}
+	std::string Provider() const {return m_key.AlgorithmProvider();}
+	CryptoMaterial& AccessMaterial() {return m_key.AccessMaterial();}
+	void Run() {(void)m_key.VerifyMessage(m_message, m_message.size(), m_signature, m_signature.size());}
+
+private:
+	VERIFIER m_key;
+	SecByteBlock m_message, m_signature;
+};
+
+template <class D>
+class AgreementLatency
+{
+public:
+	AgreementLatency(const D &d) : m_domain(d),
+		m_priv1(d.PrivateKeyLength()), m_priv2(d.PrivateKeyLength()),
+		m_pub1(d.PublicKeyLength()), m_pub2(d.PublicKeyLength()), m_val(d.AgreedValueLength())
+	{
+		m_domain.GenerateKeyPair(Test::GlobalRNG(), m_priv1, m_pub1);
+		m_domain.GenerateKeyPair(Test::GlobalRNG(), m_priv2, m_pub2);
+	}
+
+	static const char *Operation() {return "Key Agreement";}
+	std::string Provider() const {return m_domain.AlgorithmProvider();}
+	CryptoMaterial& AccessMaterial() {return m_domain.AccessMaterial();}
+	void Run() {(void)m_domain.Agree(m_val, m_priv1, m_pub2);}
+
+private:
+	D m_domain;
+	SecByteBlock m_priv1, m_priv2, m_pub1, m_pub2, m_val;
+};
+
+template <class OP>
+void OutputLatency(const char *name, const OP &op, const char *mode, const LatencyHistogram &histogram, double ticksPerSecond)
+{
+	const double us = 1e6 / ticksPerSecond;
+	LatencyResult result;
+	result.samples = histogram.Count();
+	result.mean = histogram.Mean() * us;
+	result.p50 = double(histogram.Percentile(50.0)) * us;
+	result.p90 = double(histogram.Percentile(90.0)) * us;
+	result.p99 = double(histogram.Percentile(99.0)) * us;
+	result.p999 = double(histogram.Percentile(99.9)) * us;
+	result.max = double(histogram.Max()) * us;
+
+	const std::string provider = op.Provider();
+	OutputResultLatency(name, provider.c_str(), OP::Operation(), mode, result);
+}
+
+// Cold samples use a fresh copy of the prototype, which has not been
+//  used or precomputed, and time the precomputation and the first
+//  operation. Warm samples reuse one precomputed object after a short
+//  warm up. Both use the wall clock, so they include page faults and
+//  allocator stalls that ThreadUserTimer would hide.
+template <class OP>
+void BenchMarkLatency(const char *name, const OP &prototype, double timeTotal)
+{
+	Timer timer;
+	const double ticksPerSecond = double(timer.TicksPerSecond());
+
+	{
+		LatencyHistogram histogram;
+		timer.StartTimer();
+		do
+		{
+			OP op(prototype);
+			const TimerWord start = timer.GetCurrentTimerValue();
+			if (op.AccessMaterial().SupportsPrecomputation())
+				op.AccessMaterial().Precompute(16);
+			op.Run();
+			histogram.Record(timer.GetCurrentTimerValue() - start);
+		}
+		while (timer.ElapsedTimeAsDouble() < timeTotal);
+
+		OutputLatency(name, prototype, "cold", histogram, ticksPerSecond);
+	}
+
+	{
+		OP op(prototype);
+		if (op.AccessMaterial().SupportsPrecomputation())
+			op.AccessMaterial().Precompute(16);
+
+		timer.StartTimer();
+		do
+			op.Run();
+		while (timer.ElapsedTimeAsDouble() < timeTotal / 10);
+
+		LatencyHistogram histogram;
+		timer.StartTimer();
+		do
+		{
+			const TimerWord start = timer.GetCurrentTimerValue();
+			op.Run();
+			histogram.Record(timer.GetCurrentTimerValue() - start);
+		}
+		while (timer.ElapsedTimeAsDouble() < timeTotal);
+
+		OutputLatency(name, op, "warm", histogram, ticksPerSecond);
+	}
+}
+
+template <class SIGNER, class VERIFIER>
+void BenchMarkSignatureLatency(const char *name, const SIGNER &priv, const VERIFIER &pub,
+	const std::vector<std::string> &algorithms, double timeTotal)
+{
+	if (!algorithms.empty() && std::find(algorithms.begin(), algorithms.end(), name) == algorithms.end())
+		return;
+
+	BenchMarkLatency(name, SigningLatency<SIGNER>(priv), timeTotal);
+	BenchMarkLatency(name, VerificationLatency<VERIFIER>(priv, pub), timeTotal);
+}
+
+template <class D>
+void BenchMarkAgreementLatency(const char *name, const D &d,
+	const std::vector<std::string> &algorithms, double timeTotal)
+{
+	if (!algorithms.empty() && std::find(algorithms.begin(), algorithms.end(), name) == algorithms.end())
+		return;
+
+	BenchMarkLatency(name, AgreementLatency<D>(d), timeTotal);
+}
+
+void BenchmarkLatency(const std::vector<std::string> &algorithms, double t)
+{
+	g_allocatedTime = t;
+
+	{
+		FileSource f(DataDir("TestData/rsa2048.dat").c_str(), true, new HexDecoder);
+		RSASS<PKCS1v15, SHA256>::Signer priv(f);
+		RSASS<PKCS1v15, SHA256>::Verifier pub(priv);
+		BenchMarkSignatureLatency("RSA 2048", priv, pub, algorithms, t);
+	}
+	{
+		ECDSA<ECP, SHA256>::Signer priv(Test::GlobalRNG(), ASN1::secp256r1());
+		ECDSA<ECP, SHA256>::Verifier pub(priv);
+		BenchMarkSignatureLatency("ECDSA P-256", priv, pub, algorithms, t);
+	}
+	{
+		ed25519::Signer priv(Test::GlobalRNG());
+		ed25519::Verifier pub(priv);
+		BenchMarkSignatureLatency("ed25519", priv, pub, algorithms, t);
+	}
+	{
+		FileSource f(DataDir("TestData/dh2048.dat").c_str(), true, new HexDecoder);
+		DH d(f);
+		BenchMarkAgreementLatency("DH 2048", d, algorithms, t);
+	}
+	{
+		ECDH<ECP>::Domain d(ASN1::secp256r1());
+		BenchMarkAgreementLatency("ECDH P-256", d, algorithms, t);
+	}
+	{
+		x25519 d(Test::GlobalRNG());
+		BenchMarkAgreementLatency("x25519", d, algorithms, t);
+	}
+}
+
 void Benchmark3(double t, double hertz)
 {
 	g_allocatedTime = t;
@@ -20,6 +20,7 @@
 #include "algparam.h"
 #include "blake2.h"
 #include "cpu.h"
+#include "instrument.h"
 
 // Uncomment for benchmarking C++ against SSE2 or NEON.
 // Do so in both blake2.cpp and blake2-simd.cpp.
@@ -545,6 +546,7 @@ void BLAKE2b::Restart(const BLAKE2b_ParameterBlock& block, const word64 counter[
 
 void BLAKE2s::Update(const byte *input, size_t length)
 {
+    InstrumentedCall instrumented(*this, InstrumentedCall::UPDATE, length);
     CRYPTOPP_ASSERT(input != NULLPTR || length == 0);
 
     if (length > BLOCKSIZE - m_state.m_len)
@@ -582,6 +584,7 @@ void BLAKE2s::Update(const byte *input, size_t length)
 
 void BLAKE2b::Update(const byte *input, size_t length)
 {
+    InstrumentedCall instrumented(*this, InstrumentedCall::UPDATE, length);
     CRYPTOPP_ASSERT(input != NULLPTR || length == 0);
 
     if (length > BLOCKSIZE - m_state.m_len)
@@ -3,6 +3,7 @@
 #ifndef CRYPTOPP_IMPORTS
 
 #include "cbcmac.h"
+#include "modes.h"
 
 NAMESPACE_BEGIN(CryptoPP)
 
@@ -51,6 +52,56 @@ void CBC_MAC_Base::TruncatedFinal(byte *mac, size_t size)
 	memset(m_reg, 0, AccessCipher().BlockSize());
 }
 
+void CBC_MAC_Base::CalculateDigests(byte *const macs[], size_t macSize, const byte *const messages[],
+	const size_t lengths[], size_t count)
+{
+	ThrowIfInvalidTruncatedSize(macSize);
+	if (!count) return;
+
+	const BlockCipher &cipher = AccessCipher();
+	const unsigned int blockSize = cipher.BlockSize();
+
+	SecByteBlock regs;
+	regs.CleanNew(count*blockSize);
+
+	std::vector<byte *> chains(count);
+	for (size_t i=0; i<count; ++i)
+		chains[i] = regs+i*blockSize;
+
+	ProcessStreams(cipher, &chains[0], messages, lengths, count);
+
+	for (size_t i=0; i<count; ++i)
+		std::memcpy(macs[i], chains[i], macSize);
+}
+
+void CBC_MAC_Base::ProcessStreams(const BlockCipher &cipher, byte *const chains[],
+	const byte *const inputs[], const size_t lengths[], size_t count)
+{
+	const unsigned int blockSize = cipher.BlockSize();
+
+	SecByteBlock tails;
+	tails.CleanNew(count*blockSize);
+
+	std::vector<const byte *> lastBlocks(count);
+	std::vector<size_t> blocks(count);
+	for (size_t i=0; i<count; ++i)
+		blocks[i] = lengths[i]/blockSize;
+
+	// full blocks
+	CBC_ProcessStreams(cipher, chains, NULLPTR, inputs, &blocks[0], count);
+
+	// zero padded final blocks
+	for (size_t i=0; i<count; ++i)
+	{
+		const size_t tail = lengths[i]%blockSize;
+		if (tail)
+			std::memcpy(tails+i*blockSize, inputs[i]+lengths[i]-tail, tail);
+		lastBlocks[i] = tails+i*blockSize;
+		blocks[i] = (tail ? 1 : 0);
+	}
+	CBC_ProcessStreams(cipher, chains, NULLPTR, &lastBlocks[0], &blocks[0], count);
+}
+
 void CBC_MAC_Base::ProcessBuf()
 {
 	AccessCipher().ProcessBlock(m_reg);
@@ -24,6 +24,35 @@ public:
 	void TruncatedFinal(byte *mac, size_t size);
 	unsigned int DigestSize() const {return const_cast<CBC_MAC_Base*>(this)->AccessCipher().BlockSize();}
 
+	/// \brief Calculate the MACs of independent messages in lockstep
+	/// \param macs array of count buffers that receive the MACs
+	/// \param macSize the size of each MAC, in bytes
+	/// \param messages array of count messages
+	/// \param lengths array of count message lengths, in bytes
+	/// \param count the number of messages
+	/// \details CalculateDigests() produces the same MACs as calling
+	///  <tt>CalculateTruncatedDigest(macs[i], macSize, messages[i], lengths[i])</tt>
+	///  for each message under the current key. The CBC chains of the messages
+	///  are advanced together with CBC_ProcessStreams() so the cipher's
+	///  multi-block kernel is kept busy. A partially processed message in
+	///  the object is neither used nor disturbed.
+	/// \since Crypto++ 8.4
+	void CalculateDigests(byte *const macs[], size_t macSize, const byte *const messages[],
+		const size_t lengths[], size_t count);
+
+	/// \brief Advance CBC-MAC chains over independent inputs in lockstep
+	/// \param cipher the block cipher in the forward direction
+	/// \param chains array of count chaining values
+	/// \param inputs array of count inputs
+	/// \param lengths array of count input lengths, in bytes
+	/// \param count the number of chains
+	/// \details ProcessStreams() runs CBC_ProcessStreams() over the full
+	///  blocks of each input, and then over its last partial block padded
+	///  with zeros. CalculateDigests() and CCM use it.
+	/// \since Crypto++ 8.4
+	static void ProcessStreams(const BlockCipher &cipher, byte *const chains[],
+		const byte *const inputs[], const size_t lengths[], size_t count);
+
 protected:
 	virtual BlockCipher & AccessCipher() =0;
 
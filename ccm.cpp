@@ -5,6 +5,7 @@
 #ifndef CRYPTOPP_IMPORTS
 
 #include "ccm.h"
+#include "cbcmac.h"
 
 NAMESPACE_BEGIN(CryptoPP)
 
@@ -134,6 +135,173 @@ void CCM_Base::AuthenticateLastFooterBlock(byte *mac, size_t macSize)
 	m_ctr.ProcessData(mac, CBC_Buffer(), macSize);
 }
 
+size_t CCM_Base::ThrowIfInvalidStreams(const char *function, size_t macSize, int ivLength, const size_t messageLengths[], size_t count)
+{
+	if (m_state < State_KeySet)
+		throw BadState(AlgorithmName(), function, "key is set");
+
+	ThrowIfInvalidTruncatedSize(macSize);
+	const size_t ivLen = ThrowIfInvalidIVLength(ivLength);
+
+	const int L = STDMIN(REQUIRED_BLOCKSIZE-1-(int)ivLen, 8);
+	for (size_t i=0; L<8 && i<count; ++i)
+	{
+		if (messageLengths[i] >= (W64LIT(1)<<(8*L)))
+			throw InvalidArgument(AlgorithmName() + ": message length exceeds maximum");
+	}
+
+	return ivLen;
+}
+
+void CCM_Base::CipherStreams(byte *const outStrings[], const byte *const inStrings[], const size_t lengths[],
+	const byte *const ivs[], size_t ivLength, size_t count)
+{
+	const int L = STDMIN(REQUIRED_BLOCKSIZE-1-(int)ivLength, 8);
+	CTR_Mode_ExternalCipher::Encryption ctr;
+	byte counter[REQUIRED_BLOCKSIZE];
+
+	for (size_t i=0; i<count; ++i)
+	{
+		if (!lengths[i])
+			continue;
+
+		// A1, the first counter block used for the payload
+		counter[0] = byte(L-1);	// flag
+		std::memcpy(counter+1, ivs[i], ivLength);
+		std::memset(counter+1+ivLength, 0, REQUIRED_BLOCKSIZE-1-ivLength);
+		counter[REQUIRED_BLOCKSIZE-1] = 1;
+
+		ctr.SetCipherWithIV(AccessBlockCipher(), counter);
+		ctr.ProcessData(outStrings[i], inStrings[i], lengths[i]);
+	}
+}
+
+void CCM_Base::AuthenticateStreams(byte *tags, const byte *const ivs[], size_t ivLength, const byte *const headers[],
+	const size_t headerLengths[], const byte *const messages[], const size_t messageLengths[], size_t count)
+{
+	const BlockCipher &cipher = GetBlockCipher();
+	const int L = STDMIN(REQUIRED_BLOCKSIZE-1-(int)ivLength, 8);
+
+	SecByteBlock regs, scratch(count*REQUIRED_BLOCKSIZE);
+	regs.CleanNew(count*REQUIRED_BLOCKSIZE);
+
+	std::vector<byte *> chains(count);
+	std::vector<const byte *> inputs(count);
+	std::vector<size_t> blocks(count), lengths(count);
+
+	// B0
+	for (size_t i=0; i<count; ++i)
+	{
+		byte *block = scratch+i*REQUIRED_BLOCKSIZE;
+		block[0] = byte(64*(headerLengths[i]>0) + 8*((m_digestSize-2)/2) + (L-1));	// flag
+		PutWord<word64>(false, BIG_ENDIAN_ORDER, block+REQUIRED_BLOCKSIZE-8, messageLengths[i]);
+		std::memcpy(block+1, ivs[i], REQUIRED_BLOCKSIZE-1-L);
+
+		chains[i] = regs+i*REQUIRED_BLOCKSIZE;
+		inputs[i] = block;
+		blocks[i] = 1;
+	}
+	CBC_ProcessStreams(cipher, &chains[0], NULLPTR, &inputs[0], &blocks[0], count);
+
+	// first block of the AAD, which carries the encoded AAD length
+	for (size_t i=0; i<count; ++i)
+	{
+		const lword headerLength = headerLengths[i];
+		byte *block = scratch+i*REQUIRED_BLOCKSIZE;
+		std::memset(block, 0, REQUIRED_BLOCKSIZE);
+
+		size_t prefix = 0;
+		if (headerLength == 0)
+			prefix = 0;
+		else if (headerLength < ((1<<16) - (1<<8)))
+		{
+			PutWord<word16>(false, BIG_ENDIAN_ORDER, block, (word16)headerLength);
+			prefix = 2;
+		}
+		else if (headerLength < (W64LIT(1)<<32))
+		{
+			block[0] = 0xff;
+			block[1] = 0xfe;
+			PutWord<word32>(false, BIG_ENDIAN_ORDER, block+2, (word32)headerLength);
+			prefix = 6;
+		}
+		else
+		{
+			block[0] = 0xff;
+			block[1] = 0xff;
+			PutWord<word64>(false, BIG_ENDIAN_ORDER, block+2, headerLength);
+			prefix = 10;
+		}
+
+		const size_t head = prefix ? STDMIN(headerLengths[i], REQUIRED_BLOCKSIZE-prefix) : 0;
+		if (head)
+			std::memcpy(block+prefix, headers[i], head);
+
+		inputs[i] = block;
+		blocks[i] = (prefix ? 1 : 0);
+		lengths[i] = head;
+	}
+	CBC_ProcessStreams(cipher, &chains[0], NULLPTR, &inputs[0], &blocks[0], count);
+
+	// rest of the AAD, and then the payload
+	for (size_t i=0; i<count; ++i)
+	{
+		inputs[i] = headers[i]+lengths[i];
+		lengths[i] = headerLengths[i]-lengths[i];
+	}
+	CBC_MAC_Base::ProcessStreams(cipher, &chains[0], &inputs[0], &lengths[0], count);
+	CBC_MAC_Base::ProcessStreams(cipher, &chains[0], messages, messageLengths, count);
+
+	// A0, whose encryption masks the CBC-MAC
+	for (size_t i=0; i<count; ++i)
+	{
+		byte *block = scratch+i*REQUIRED_BLOCKSIZE;
+		block[0] = byte(L-1);	// flag
+		std::memcpy(block+1, ivs[i], ivLength);
+		std::memset(block+1+ivLength, 0, REQUIRED_BLOCKSIZE-1-ivLength);
+	}
+	cipher.AdvancedProcessBlocks(scratch, regs, tags, count*REQUIRED_BLOCKSIZE, BlockTransformation::BT_AllowParallel);
+}
+
+void CCM_Base::EncryptAndAuthenticateStreams(byte *const ciphertexts[], byte *const macs[], size_t macSize,
+	const byte *const ivs[], int ivLength, const byte *const headers[], const size_t headerLengths[],
+	const byte *const messages[], const size_t messageLengths[], size_t count)
+{
+	const size_t ivLen = ThrowIfInvalidStreams("EncryptAndAuthenticateStreams", macSize, ivLength, messageLengths, count);
+	if (!count) return;
+
+	// authentication is on the plaintext, so it comes first for in-place operation
+	SecByteBlock tags(count*REQUIRED_BLOCKSIZE);
+	AuthenticateStreams(tags, ivs, ivLen, headers, headerLengths, messages, messageLengths, count);
+	CipherStreams(ciphertexts, messages, messageLengths, ivs, ivLen, count);
+
+	for (size_t i=0; i<count; ++i)
+		std::memcpy(macs[i], tags+i*REQUIRED_BLOCKSIZE, macSize);
+}
+
+bool CCM_Base::DecryptAndVerifyStreams(byte *const messages[], bool results[], const byte *const macs[], size_t macSize,
+	const byte *const ivs[], int ivLength, const byte *const headers[], const size_t headerLengths[],
+	const byte *const ciphertexts[], const size_t ciphertextLengths[], size_t count)
+{
+	const size_t ivLen = ThrowIfInvalidStreams("DecryptAndVerifyStreams", macSize, ivLength, ciphertextLengths, count);
+	if (!count) return true;
+
+	SecByteBlock tags(count*REQUIRED_BLOCKSIZE);
+	CipherStreams(messages, ciphertexts, ciphertextLengths, ivs, ivLen, count);
+	AuthenticateStreams(tags, ivs, ivLen, headers, headerLengths, messages, ciphertextLengths, count);
+
+	bool verified = true;
+	for (size_t i=0; i<count; ++i)
+	{
+		const bool result = VerifyBufsEqual(tags+i*REQUIRED_BLOCKSIZE, macs[i], macSize);
+		if (results)
+			results[i] = result;
+		verified = result && verified;
+	}
+
+	return verified;
+}
+
 NAMESPACE_END
 
 #endif
@@ -56,6 +56,49 @@ public:
 		{return true;}
 	void UncheckedSpecifyDataLengths(lword headerLength, lword messageLength, lword footerLength);
 
+	/// \brief Encrypt and authenticate independent messages in lockstep
+	/// \param ciphertexts array of count buffers that receive the ciphertexts
+	/// \param macs array of count buffers that receive the MACs
+	/// \param macSize the size of each MAC, in bytes
+	/// \param ivs array of count nonces
+	/// \param ivLength the size of each nonce, in bytes
+	/// \param headers array of count AAD buffers
+	/// \param headerLengths array of count AAD lengths, in bytes
+	/// \param messages array of count messages
+	/// \param messageLengths array of count message lengths, in bytes
+	/// \param count the number of messages
+	/// \details EncryptAndAuthenticateStreams() produces the same output as
+	///  calling EncryptAndAuthenticate() for each message under the current
+	///  key. The CBC-MAC chains of the messages are advanced together with
+	///  CBC_ProcessStreams() so the cipher's multi-block kernel is kept busy.
+	///  The object's current message, if any, is neither used nor disturbed.
+	/// \since Crypto++ 8.4
+	void EncryptAndAuthenticateStreams(byte *const ciphertexts[], byte *const macs[], size_t macSize,
+		const byte *const ivs[], int ivLength, const byte *const headers[], const size_t headerLengths[],
+		const byte *const messages[], const size_t messageLengths[], size_t count);
+
+	/// \brief Decrypt and verify independent messages in lockstep
+	/// \param messages array of count buffers that receive the plaintexts
+	/// \param results array of count verification results, or NULL
+	/// \param macs array of count MACs
+	/// \param macSize the size of each MAC, in bytes
+	/// \param ivs array of count nonces
+	/// \param ivLength the size of each nonce, in bytes
+	/// \param headers array of count AAD buffers
+	/// \param headerLengths array of count AAD lengths, in bytes
+	/// \param ciphertexts array of count ciphertexts
+	/// \param ciphertextLengths array of count ciphertext lengths, in bytes
+	/// \param count the number of messages
+	/// \returns true if every message was verified, false otherwise
+	/// \details DecryptAndVerifyStreams() produces the same output as calling
+	///  DecryptAndVerify() for each message under the current key. The result
+	///  for each message is stored in <tt>results[i]</tt> if results is not NULL.
+	///  Like DecryptAndVerify(), the plaintext is written even if verification fails.
+	/// \since Crypto++ 8.4
+	bool DecryptAndVerifyStreams(byte *const messages[], bool results[], const byte *const macs[], size_t macSize,
+		const byte *const ivs[], int ivLength, const byte *const headers[], const size_t headerLengths[],
+		const byte *const ciphertexts[], const size_t ciphertextLengths[], size_t count);
+
 protected:
 	// AuthenticatedSymmetricCipherBase
 	bool AuthenticationIsOnPlaintext() const
@@ -70,6 +113,12 @@ protected:
 	void AuthenticateLastFooterBlock(byte *mac, size_t macSize);
 	SymmetricCipher & AccessSymmetricCipher() {return m_ctr;}
 
+	size_t ThrowIfInvalidStreams(const char *function, size_t macSize, int ivLength, const size_t messageLengths[], size_t count);
+	void CipherStreams(byte *const outStrings[], const byte *const inStrings[], const size_t lengths[],
+		const byte *const ivs[], size_t ivLength, size_t count);
+	void AuthenticateStreams(byte *tags, const byte *const ivs[], size_t ivLength, const byte *const headers[],
+		const size_t headerLengths[], const byte *const messages[], const size_t messageLengths[], size_t count);
+
 	virtual BlockCipher & AccessBlockCipher() =0;
 	virtual int DefaultDigestSize() const =0;
 
@@ -96,6 +145,37 @@ public:
 	bool IsForwardTransformation() const
 		{return T_IsEncryption;}
 
+	/// \brief Construct a CCM_Final
+	CCM_Final() {}
+
+	/// \brief Copy a CCM_Final
+	/// \param other the object to copy
+	/// \details The copy holds its own copy of the keyed cipher. The key
+	///   schedule is not recomputed.
+	/// \since Crypto++ 8.4
+	CCM_Final(const CCM_Final &other)
+		: CCM_Base(other), m_cipher(other.m_cipher) {this->m_ctr.RebindCipher(m_cipher);}
+
+	/// \brief Assign a CCM_Final
+	/// \param other the object to copy
+	/// \since Crypto++ 8.4
+	CCM_Final& operator=(const CCM_Final &other)
+	{
+		CCM_Base::operator=(other);
+		m_cipher = other.m_cipher;
+		this->m_ctr.RebindCipher(m_cipher);
+		return *this;
+	}
+
+	/// \brief Create a copy of this object
+	/// \return a copy of this object
+	/// \details Clone() copies the keyed state, including the expanded key,
+	///   rather than recomputing it. A keyed object that is no longer
+	///   modified can be cloned by several threads at the same time. The
+	///   caller is responsible for freeing the object.
+	/// \since Crypto++ 8.4
+	Clonable * Clone() const {return static_cast<MessageAuthenticationCode *>(new CCM_Final(*this));}
+
 private:
 	BlockCipher & AccessBlockCipher() {return m_cipher;}
 	int DefaultDigestSize() const {return T_DefaultDigestSize;}
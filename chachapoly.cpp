@@ -110,6 +110,116 @@ bool ChaCha20Poly1305_Base::DecryptAndVerify(byte *message, const byte *mac, siz
 	return TruncatedVerify(mac, macLength);
 }
 
+void ChaCha20Poly1305_Base::ThrowIfInvalidStreams(const char *function, size_t macSize, int ivLength, const size_t messageLengths[], size_t count)
+{
+	if (m_state < State_KeySet)
+		throw BadState(AlgorithmName(), function, "key is set");
+
+	ThrowIfInvalidTruncatedSize(macSize);
+	ThrowIfInvalidIVLength(ivLength);
+
+	for (size_t i=0; i<count; ++i)
+	{
+		if (messageLengths[i] > MaxMessageLength())
+			throw InvalidArgument(AlgorithmName() + ": message length exceeds maximum");
+	}
+}
+
+// Resync() rekeys both ChaCha20 and Poly1305 through SetKey for every
+// message. Here the key is loaded once and each message only loads its
+// nonce. Block 0 of the keystream keys Poly1305 and the payload starts at
+// block 1, so a short message is staged behind block 0 and all of its
+// keystream comes from one call to the multi-block kernel.
+void ChaCha20Poly1305_Base::CipherAndAuthenticateStreams(byte *tags, byte *const outStrings[], const byte *const inStrings[],
+	const size_t lengths[], const byte *const ivs[], const byte *const headers[], const size_t headerLengths[], size_t count, bool encrypt)
+{
+	ChaChaTLS::Encryption cipher;
+	Poly1305TLS mac;
+	cipher.SetKey(m_userKey, m_userKey.SizeInBytes(), MakeParameters(Name::IV(),
+		ConstByteArrayParameter(ivs[0], 12))("InitialBlock", (word64)0));
+
+	FixedSizeAlignedSecBlock<byte, 2048> stage;
+	const size_t maxStaged = stage.size()-64;
+	const byte zero[16] = {0};
+	CRYPTOPP_ALIGN_DATA(8) byte length[2*sizeof(word64)];
+
+	for (size_t i=0; i<count; ++i)
+	{
+		const byte *in = inStrings[i];
+		byte *out = outStrings[i];
+		const size_t len = lengths[i];
+		const bool staged = (len <= maxStaged);
+
+		cipher.Resynchronize(ivs[i], 12);
+		std::memset(stage, 0, 64);
+		if (staged)
+		{
+			if (len)
+				std::memcpy(stage+64, in, len);
+			cipher.ProcessData(stage, stage, 64+len);
+		}
+		else
+			cipher.ProcessData(stage, stage, 64);
+
+		// Only the first 256-bits are used to key the MAC
+		mac.SetKey(stage, 32);
+		mac.Update(headers[i], headerLengths[i]);
+		mac.Update(zero, (16U - (headerLengths[i] % 16)) % 16);
+
+		// authentication is on the ciphertext, so it comes first for in-place decryption
+		if (!encrypt)
+			mac.Update(in, len);
+		if (staged && len)
+			std::memcpy(out, stage+64, len);
+		else if (!staged)
+			cipher.ProcessData(out, in, len);
+		if (encrypt)
+			mac.Update(out, len);
+		mac.Update(zero, (16U - (len % 16)) % 16);
+
+		PutWord(true, LITTLE_ENDIAN_ORDER, length+0, (word64)headerLengths[i]);
+		PutWord(true, LITTLE_ENDIAN_ORDER, length+8, (word64)len);
+		mac.Update(length, sizeof(length));
+		mac.Final(tags+i*16);
+	}
+}
+
+void ChaCha20Poly1305_Base::EncryptAndAuthenticateStreams(byte *const ciphertexts[], byte *const macs[], size_t macSize,
+	const byte *const ivs[], int ivLength, const byte *const headers[], const size_t headerLengths[],
+	const byte *const messages[], const size_t messageLengths[], size_t count)
+{
+	ThrowIfInvalidStreams("EncryptAndAuthenticateStreams", macSize, ivLength, messageLengths, count);
+	if (!count) return;
+
+	SecByteBlock tags(count*16);
+	CipherAndAuthenticateStreams(tags, ciphertexts, messages, messageLengths, ivs, headers, headerLengths, count, true);
+
+	for (size_t i=0; i<count; ++i)
+		std::memcpy(macs[i], tags+i*16, macSize);
+}
+
+bool ChaCha20Poly1305_Base::DecryptAndVerifyStreams(byte *const messages[], bool results[], const byte *const macs[], size_t macSize,
+	const byte *const ivs[], int ivLength, const byte *const headers[], const size_t headerLengths[],
+	const byte *const ciphertexts[], const size_t ciphertextLengths[], size_t count)
+{
+	ThrowIfInvalidStreams("DecryptAndVerifyStreams", macSize, ivLength, ciphertextLengths, count);
+	if (!count) return true;
+
+	SecByteBlock tags(count*16);
+	CipherAndAuthenticateStreams(tags, messages, ciphertexts, ciphertextLengths, ivs, headers, headerLengths, count, false);
+
+	bool verified = true;
+	for (size_t i=0; i<count; ++i)
+	{
+		const bool result = VerifyBufsEqual(tags+i*16, macs[i], macSize);
+		if (results)
+			results[i] = result;
+		verified = result && verified;
+	}
+
+	return verified;
+}
+
 ////////////////////////////// IETF XChaCha20 draft //////////////////////////////
 
 // RekeyCipherAndMac is heavier-weight than we like. The Authenc framework was
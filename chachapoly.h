@@ -99,6 +99,51 @@ public:
 	///  is truncated if <tt>macLength < TagSize()</tt>.
 	virtual bool DecryptAndVerify(byte *message, const byte *mac, size_t macSize, const byte *iv, int ivLength, const byte *aad, size_t aadLength, const byte *ciphertext, size_t ciphertextLength);
 
+	/// \brief Encrypt and authenticate independent messages in a batch
+	/// \param ciphertexts array of count buffers that receive the ciphertexts
+	/// \param macs array of count buffers that receive the MACs
+	/// \param macSize the size of each MAC, in bytes
+	/// \param ivs array of count nonces
+	/// \param ivLength the size of each nonce, in bytes
+	/// \param headers array of count AAD buffers
+	/// \param headerLengths array of count AAD lengths, in bytes
+	/// \param messages array of count messages
+	/// \param messageLengths array of count message lengths, in bytes
+	/// \param count the number of messages
+	/// \details EncryptAndAuthenticateStreams() produces the same output as
+	///  calling EncryptAndAuthenticate() for each message under the current
+	///  key. The key is expanded once for the batch, and each message only
+	///  loads its nonce. The Poly1305 key of a short message is generated
+	///  in the same keystream call as its payload.
+	/// \details The object's current message, if any, is neither used nor
+	///  disturbed. A message may be encrypted in place.
+	/// \since Crypto++ 8.4
+	void EncryptAndAuthenticateStreams(byte *const ciphertexts[], byte *const macs[], size_t macSize,
+		const byte *const ivs[], int ivLength, const byte *const headers[], const size_t headerLengths[],
+		const byte *const messages[], const size_t messageLengths[], size_t count);
+
+	/// \brief Decrypt and verify independent messages in a batch
+	/// \param messages array of count buffers that receive the plaintexts
+	/// \param results array of count verification results, or NULL
+	/// \param macs array of count MACs
+	/// \param macSize the size of each MAC, in bytes
+	/// \param ivs array of count nonces
+	/// \param ivLength the size of each nonce, in bytes
+	/// \param headers array of count AAD buffers
+	/// \param headerLengths array of count AAD lengths, in bytes
+	/// \param ciphertexts array of count ciphertexts
+	/// \param ciphertextLengths array of count ciphertext lengths, in bytes
+	/// \param count the number of messages
+	/// \returns true if every message was verified, false otherwise
+	/// \details DecryptAndVerifyStreams() produces the same output as calling
+	///  DecryptAndVerify() for each message under the current key. The result
+	///  for each message is stored in <tt>results[i]</tt> if results is not NULL.
+	///  Like DecryptAndVerify(), the plaintext is written even if verification fails.
+	/// \since Crypto++ 8.4
+	bool DecryptAndVerifyStreams(byte *const messages[], bool results[], const byte *const macs[], size_t macSize,
+		const byte *const ivs[], int ivLength, const byte *const headers[], const size_t headerLengths[],
+		const byte *const ciphertexts[], const size_t ciphertextLengths[], size_t count);
+
 protected:
 	// AuthenticatedSymmetricCipherBase
 	bool AuthenticationIsOnPlaintext() const {return false;}
@@ -113,6 +158,10 @@ protected:
 	// See comments in chachapoly.cpp
 	void RekeyCipherAndMac(const byte *userKey, size_t userKeyLength, const NameValuePairs &params);
 
+	void ThrowIfInvalidStreams(const char *function, size_t macSize, int ivLength, const size_t messageLengths[], size_t count);
+	void CipherAndAuthenticateStreams(byte *tags, byte *const outStrings[], const byte *const inStrings[], const size_t lengths[],
+		const byte *const ivs[], const byte *const headers[], const size_t headerLengths[], size_t count, bool encrypt);
+
 	virtual const MessageAuthenticationCode & GetMAC() const = 0;
 	virtual MessageAuthenticationCode & AccessMAC() = 0;
 
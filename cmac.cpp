@@ -5,7 +5,9 @@
 #ifndef CRYPTOPP_IMPORTS
 
 #include "cmac.h"
+#include "modes.h"
 #include "misc.h"
+#include "instrument.h"
 
 ANONYMOUS_NAMESPACE_BEGIN
 
@@ -93,6 +95,7 @@ void CMAC_Base::UncheckedSetKey(const byte *key, unsigned int length, const Name
 
 void CMAC_Base::Update(const byte *input, size_t length)
 {
+	InstrumentedCall instrumented(*this, InstrumentedCall::UPDATE, length);
 	CRYPTOPP_ASSERT((input && length) || !(input || length));
 	if (!length)
 		return;
@@ -136,6 +139,57 @@ void CMAC_Base::Update(const byte *input, size_t length)
 	CRYPTOPP_ASSERT(m_counter > 0);
 }
 
+void CMAC_Base::CalculateDigests(byte *const macs[], size_t macSize, const byte *const messages[],
+	const size_t lengths[], size_t count)
+{
+	ThrowIfInvalidTruncatedSize(macSize);
+	if (!count) return;
+
+	const BlockCipher &cipher = AccessCipher();
+	const unsigned int blockSize = cipher.BlockSize();
+
+	SecByteBlock regs, tails;
+	regs.CleanNew(count*blockSize);
+	tails.CleanNew(count*blockSize);
+
+	std::vector<byte *> chains(count);
+	std::vector<const byte *> lastBlocks(count);
+	std::vector<size_t> blocks(count);
+	for (size_t i=0; i<count; ++i)
+	{
+		// all blocks except the final one
+		chains[i] = regs+i*blockSize;
+		blocks[i] = lengths[i] ? (lengths[i]-1)/blockSize : 0;
+	}
+
+	CBC_ProcessStreams(cipher, &chains[0], NULLPTR, messages, &blocks[0], count);
+
+	// final blocks are padded and masked with K1 or K2
+	for (size_t i=0; i<count; ++i)
+	{
+		byte *last = tails+i*blockSize;
+		const size_t used = blocks[i]*blockSize;
+		const size_t len = lengths[i]-used;
+		if (len)
+			std::memcpy(last, messages[i]+used, len);
+
+		if (len < blockSize)
+		{
+			last[len] = 0x80;
+			xorbuf(last, m_reg+2*blockSize, blockSize);
+		}
+		else
+			xorbuf(last, m_reg+blockSize, blockSize);
+
+		lastBlocks[i] = last;
+		blocks[i] = 1;
+	}
+	CBC_ProcessStreams(cipher, &chains[0], NULLPTR, &lastBlocks[0], &blocks[0], count);
+
+	for (size_t i=0; i<count; ++i)
+		std::memcpy(macs[i], chains[i], macSize);
+}
+
 void CMAC_Base::TruncatedFinal(byte *mac, size_t size)
 {
 	ThrowIfInvalidTruncatedSize(size);
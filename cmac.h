@@ -36,6 +36,22 @@ public:
 	unsigned int OptimalDataAlignment() const {return GetCipher().OptimalDataAlignment();}
 	std::string AlgorithmProvider() const {return GetCipher().AlgorithmProvider();}
 
+	/// \brief Calculate the MACs of independent messages in lockstep
+	/// \param macs array of count buffers that receive the MACs
+	/// \param macSize the size of each MAC, in bytes
+	/// \param messages array of count messages
+	/// \param lengths array of count message lengths, in bytes
+	/// \param count the number of messages
+	/// \details CalculateDigests() produces the same MACs as calling
+	///  <tt>CalculateTruncatedDigest(macs[i], macSize, messages[i], lengths[i])</tt>
+	///  for each message under the current key. The CBC chains of the messages
+	///  are advanced together with CBC_ProcessStreams() so the cipher's
+	///  multi-block kernel is kept busy. A partially processed message in
+	///  the object is neither used nor disturbed.
+	/// \since Crypto++ 8.4
+	void CalculateDigests(byte *const macs[], size_t macSize, const byte *const messages[],
+		const size_t lengths[], size_t count);
+
 protected:
 	friend class EAX_Base;
 
@@ -66,6 +82,15 @@ public:
 
 	static std::string StaticAlgorithmName() {return std::string("CMAC(") + T::StaticAlgorithmName() + ")";}
 
+	/// \brief Create a copy of this object
+	/// \return a copy of this object
+	/// \details Clone() copies the keyed state, including the expanded key
+	///   and the subkeys K1 and K2, rather than recomputing it. A keyed
+	///   object that is no longer modified can be cloned by several threads
+	///   at the same time. The caller is responsible for freeing the object.
+	/// \since Crypto++ 8.4
+	Clonable * Clone() const {return new CMAC(*this);}
+
 private:
 	BlockCipher & AccessCipher() {return m_cipher;}
 	typename T::Encryption m_cipher;
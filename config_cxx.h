@@ -55,6 +55,10 @@
 // this file. At the moment it should only affect std::uncaught_exceptions.
 // #define CRYPTOPP_NO_CXX17 1
 
+// Define CRYPTOPP_NO_CXX20 to avoid C++20 related features shown at the end of
+// this file. At the moment it should only affect std::span overloads.
+// #define CRYPTOPP_NO_CXX20 1
+
 // C++11 macro version, https://stackoverflow.com/q/7223991/608639
 #if !defined(CRYPTOPP_NO_CXX11)
 #  if ((_MSC_VER >= 1600) || (__cplusplus >= 201103L)) && !defined(_STLPORT_VERSION)
@@ -88,6 +92,13 @@
 #  endif
 #endif
 
+// C++20 macro version. MSVC only sets __cplusplus with /Zc:__cplusplus.
+#if defined(CRYPTOPP_CXX17) && !defined(CRYPTOPP_NO_CXX20)
+#  if ((_MSVC_LANG >= 202002L) || (__cplusplus >= 202002L)) && !defined(_STLPORT_VERSION)
+#    define CRYPTOPP_CXX20 1
+#  endif
+#endif
+
 // ***************** C++11 and above ********************
 
 #if defined(CRYPTOPP_CXX11)
@@ -132,6 +143,13 @@
 # define CRYPTOPP_CXX11_DELETED_FUNCTIONS 1
 #endif // deleted functions
 
+// thread_local: MS at VS2015 (19.00); GCC at 4.8; Clang at 3.3; Xcode 8.0; Intel 15.0; SunCC 5.13.
+#if (CRYPTOPP_MSC_VERSION >= 1900) || (CRYPTOPP_LLVM_CLANG_VERSION >= 30300) || \
+	(CRYPTOPP_APPLE_CLANG_VERSION >= 80000) || (__INTEL_COMPILER >= 1500) || \
+	(CRYPTOPP_GCC_VERSION >= 40800) || (__SUNPRO_CC >= 0x5130)
+#  define CRYPTOPP_CXX11_THREAD_LOCAL 1
+#endif // thread_local
+
 // alignof/alignas: MS at VS2015 (19.00); GCC at 4.8; Clang at 3.0; Intel 15.0; SunCC 5.13.
 #if (CRYPTOPP_MSC_VERSION >= 1900) || __has_feature(cxx_alignas) || \
 	(__INTEL_COMPILER >= 1500) || (CRYPTOPP_GCC_VERSION >= 40800) || (__SUNPRO_CC >= 0x5130)
@@ -185,6 +203,13 @@
 # define CRYPTOPP_CXX11_NULLPTR 1
 #endif // nullptr_t compilers
 
+// rvalue references: MS at VS2010 (16.00); GCC at 4.3; Clang at 2.9; Intel 11.1; SunCC 5.13.
+#if (CRYPTOPP_MSC_VERSION >= 1600) || __has_feature(cxx_rvalue_references) || \
+	(__INTEL_COMPILER >= 1110) || (CRYPTOPP_GCC_VERSION >= 40300) || \
+	(__SUNPRO_CC >= 0x5130)
+# define CRYPTOPP_CXX11_RVALUES 1
+#endif // rvalue references
+
 #endif // CRYPTOPP_CXX11
 
 // ***************** C++14 and above ********************
@@ -219,6 +244,22 @@
 
 #endif  // CRYPTOPP_CXX17
 
+// ***************** C++20 and above ********************
+
+// C++20 is available
+#if defined(CRYPTOPP_CXX20)
+
+// C++20 span: MS at VS2019 16.2; GCC at 10.0; Clang at 7.0 with libc++.
+#if defined(__has_include)
+# if __has_include(<span>)
+#  define CRYPTOPP_CXX20_SPAN 1
+# endif
+#elif (CRYPTOPP_MSC_VERSION >= 1922)
+# define CRYPTOPP_CXX20_SPAN 1
+#endif // span
+
+#endif  // CRYPTOPP_CXX20
+
 // ***************** C++ fixups ********************
 
 #if defined(CRYPTOPP_CXX11_NOEXCEPT)
@@ -56,6 +56,14 @@
 // # define CRYPTOPP_WANT_SECURE_LIB
 // #endif
 
+// Define this if you want AllocatorWithCleanup to recycle blocks through
+// per-thread, size-class free lists rather than calling malloc and free
+// for each SecBlock. The library and the program must agree on the
+// setting. Also see PoolAllocate() and GetAllocatorPoolStatistics().
+// #if !defined(CRYPTOPP_ALLOCATOR_POOL)
+// # define CRYPTOPP_ALLOCATOR_POOL
+// #endif
+
 // Define this if ARMv8 shifts are slow. ARM Cortex-A53 and Cortex-A57 shift
 // operation perform poorly, so NEON and ASIMD code that relies on shifts
 // or rotates often performs worse than C/C++ code. Also see
@@ -135,6 +135,9 @@ extern "C"
 }
 #endif  // Not CRYPTOPP_MS_STYLE_INLINE_ASSEMBLY
 
+// Applies CRYPTOPP_CPU_MASK at the end of detection. Defined below.
+static void ApplyEnvironmentMask();
+
 // *************************** IA-32 CPUs ***************************
 
 #if (CRYPTOPP_BOOL_X86 || CRYPTOPP_BOOL_X32 || CRYPTOPP_BOOL_X64)
@@ -473,6 +476,7 @@ void DetectX86Features()
 	if (g_cacheLineSize == 0)
 		g_cacheLineSize = CRYPTOPP_L1_CACHE_LINE_SIZE;
 
+	ApplyEnvironmentMask();
 	*const_cast<volatile bool*>(&g_x86DetectionDone) = true;
 }
 
@@ -861,6 +865,7 @@ void DetectArmFeatures()
 	if (g_cacheLineSize == 0)
 		g_cacheLineSize = CRYPTOPP_L1_CACHE_LINE_SIZE;
 
+	ApplyEnvironmentMask();
 	*const_cast<volatile bool*>(&g_ArmDetectionDone) = true;
 }
 
@@ -1063,10 +1068,173 @@ void DetectPowerpcFeatures()
 	if (g_cacheLineSize == 0)
 		g_cacheLineSize = CRYPTOPP_L1_CACHE_LINE_SIZE;
 
+	ApplyEnvironmentMask();
 	*const_cast<volatile bool*>(&g_PowerpcDetectionDone) = true;
 }
 
 #endif
+
+// *************************** CPU feature masks ***************************
+
+#if (CRYPTOPP_BOOL_X86 || CRYPTOPP_BOOL_X32 || CRYPTOPP_BOOL_X64 || CRYPTOPP_BOOL_ARM32 || CRYPTOPP_BOOL_ARMV8 || CRYPTOPP_BOOL_PPC32 || CRYPTOPP_BOOL_PPC64)
+# define CRYPTOPP_CPU_MASK_AVAILABLE 1
+#endif
+
+#if defined(CRYPTOPP_CPU_MASK_AVAILABLE)
+
+struct CpuFeature
+{
+	const char *name;
+	bool *flag;
+};
+
+// The padlock entries share one name
+static const CpuFeature s_cpuFeatures[] = {
+#if (CRYPTOPP_BOOL_X86 || CRYPTOPP_BOOL_X32 || CRYPTOPP_BOOL_X64)
+	{"sse2", &g_hasSSE2}, {"ssse3", &g_hasSSSE3}, {"sse4.1", &g_hasSSE41}, {"sse4.2", &g_hasSSE42},
+	{"avx", &g_hasAVX}, {"avx2", &g_hasAVX2}, {"aesni", &g_hasAESNI}, {"clmul", &g_hasCLMUL},
+	{"shani", &g_hasSHA}, {"adx", &g_hasADX}, {"rdrand", &g_hasRDRAND}, {"rdseed", &g_hasRDSEED},
+	{"padlock", &g_hasPadlockRNG}, {"padlock", &g_hasPadlockACE}, {"padlock", &g_hasPadlockACE2},
+	{"padlock", &g_hasPadlockPHE}, {"padlock", &g_hasPadlockPMM}
+#elif (CRYPTOPP_BOOL_ARM32 || CRYPTOPP_BOOL_ARMV8)
+	{"armv7", &g_hasARMv7}, {"neon", &g_hasNEON}, {"crc32", &g_hasCRC32}, {"pmull", &g_hasPMULL},
+	{"aes", &g_hasAES}, {"sha1", &g_hasSHA1}, {"sha2", &g_hasSHA2}, {"sha512", &g_hasSHA512},
+	{"sha3", &g_hasSHA3}, {"sm3", &g_hasSM3}, {"sm4", &g_hasSM4}
+#else
+	{"altivec", &g_hasAltivec}, {"power7", &g_hasPower7}, {"power8", &g_hasPower8},
+	{"power9", &g_hasPower9}, {"aes", &g_hasAES}, {"pmull", &g_hasPMULL},
+	{"sha256", &g_hasSHA256}, {"sha512", &g_hasSHA512}, {"darn", &g_hasDARN}
+#endif
+};
+
+// Plain arrays because detection runs during static initialization
+static bool s_cpuDetected[COUNTOF(s_cpuFeatures)];
+static bool s_cpuMasked[COUNTOF(s_cpuFeatures)];
+static bool s_cpuDetectedSaved = false;
+
+// Features that are built on a masked feature are masked too
+static void ApplyFeatureDependencies()
+{
+#if (CRYPTOPP_BOOL_X86 || CRYPTOPP_BOOL_X32 || CRYPTOPP_BOOL_X64)
+	if (!g_hasSSE2)
+		g_hasSSSE3 = g_hasSSE41 = g_hasSSE42 = g_hasAESNI = g_hasCLMUL = g_hasSHA = g_hasAVX = false;
+	if (!g_hasAVX)
+		g_hasAVX2 = false;
+#elif (CRYPTOPP_BOOL_PPC32 || CRYPTOPP_BOOL_PPC64)
+	if (!g_hasAltivec)
+		g_hasPower7 = false;
+	if (!g_hasPower7)
+		g_hasPower8 = false;
+	if (!g_hasPower8)
+		g_hasPower9 = g_hasAES = g_hasPMULL = g_hasSHA256 = g_hasSHA512 = false;
+	if (!g_hasPower9)
+		g_hasDARN = false;
+#endif
+}
+
+static void ApplyCpuMask(const std::string &features, bool strict)
+{
+	if (!s_cpuDetectedSaved)
+	{
+		for (size_t i=0; i<COUNTOF(s_cpuFeatures); ++i)
+			s_cpuDetected[i] = *s_cpuFeatures[i].flag;
+		s_cpuDetectedSaved = true;
+	}
+
+	bool masked[COUNTOF(s_cpuFeatures)] = {false};
+	std::string::size_type first = 0;
+	while (first < features.size())
+	{
+		std::string::size_type last = features.find(',', first);
+		if (last == std::string::npos)
+			last = features.size();
+
+		std::string name;
+		for (std::string::size_type i=first; i<last; ++i)
+		{
+			if (features[i] != ' ' && features[i] != '\t')
+				name += static_cast<char>(std::tolower(static_cast<unsigned char>(features[i])));
+		}
+		first = last+1;
+		if (name.empty())
+			continue;
+
+		bool found = false;
+		for (size_t i=0; i<COUNTOF(s_cpuFeatures); ++i)
+		{
+			if (name == s_cpuFeatures[i].name)
+				masked[i] = found = true;
+		}
+		if (!found && strict)
+			throw InvalidArgument("MaskCPUFeatures: " + name + " is not a CPU feature of this platform");
+	}
+
+	for (size_t i=0; i<COUNTOF(s_cpuFeatures); ++i)
+	{
+		s_cpuMasked[i] = masked[i];
+		*s_cpuFeatures[i].flag = s_cpuDetected[i] && !masked[i];
+	}
+	ApplyFeatureDependencies();
+}
+
+static void ApplyEnvironmentMask()
+{
+#if defined(CRYPTOPP_MSC_VERSION) && (CRYPTOPP_MSC_VERSION >= 1400)
+	char *env = NULLPTR; size_t length = 0;
+	if (_dupenv_s(&env, &length, "CRYPTOPP_CPU_MASK") == 0 && env != NULLPTR)
+	{
+		ApplyCpuMask(env, false);
+		std::free(env);
+	}
+#else
+	const char *env = std::getenv("CRYPTOPP_CPU_MASK");
+	if (env != NULLPTR)
+		ApplyCpuMask(env, false);
+#endif
+}
+
+static void EnsureCpuDetection()
+{
+#if (CRYPTOPP_BOOL_X86 || CRYPTOPP_BOOL_X32 || CRYPTOPP_BOOL_X64)
+	if (!g_x86DetectionDone)
+		DetectX86Features();
+#elif (CRYPTOPP_BOOL_ARM32 || CRYPTOPP_BOOL_ARMV8)
+	if (!g_ArmDetectionDone)
+		DetectArmFeatures();
+#else
+	if (!g_PowerpcDetectionDone)
+		DetectPowerpcFeatures();
+#endif
+}
+
+#endif  // CRYPTOPP_CPU_MASK_AVAILABLE
+
+void MaskCPUFeatures(const std::string &features)
+{
+#if defined(CRYPTOPP_CPU_MASK_AVAILABLE)
+	EnsureCpuDetection();
+	ApplyCpuMask(features, true);
+#else
+	if (features.find_first_not_of(", \t") != std::string::npos)
+		throw InvalidArgument("MaskCPUFeatures: this platform has no CPU features to mask");
+#endif
+}
+
+std::string MaskedCPUFeatures()
+{
+	std::string result;
+#if defined(CRYPTOPP_CPU_MASK_AVAILABLE)
+	EnsureCpuDetection();
+	for (size_t i=0; i<COUNTOF(s_cpuFeatures); ++i)
+	{
+		const bool duplicate = i > 0 && std::strcmp(s_cpuFeatures[i].name, s_cpuFeatures[i-1].name) == 0;
+		if (s_cpuMasked[i] && !duplicate)
+			result += (result.empty() ? "" : ",") + std::string(s_cpuFeatures[i].name);
+	}
+#endif
+	return result;
+}
+
 NAMESPACE_END
 
 // *************************** C++ Static Initialization ***************************
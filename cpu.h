@@ -32,6 +32,10 @@
 
 #include "config.h"
 
+#ifndef CRYPTOPP_GENERATE_X64_MASM
+# include <string>
+#endif
+
 // Issue 340
 #if CRYPTOPP_GCC_DIAGNOSTIC_AVAILABLE
 # pragma GCC diagnostic push
@@ -852,6 +856,45 @@ inline int GetCacheLineSize()
 
 #endif  // CRYPTOPP_BOOL_PPC32 || CRYPTOPP_BOOL_PPC64
 
+// ***************************** Feature masks ***************************** //
+
+/// \name CPU FEATURE MASKS
+//@{
+
+/// \brief Disables CPU features at runtime
+/// \param features a comma separated list of feature names
+/// \throws InvalidArgument if a name is not a feature of the platform
+/// \details MaskCPUFeatures() clears the features in the list, so HasAESNI(), HasSHA()
+///   and friends return false for them, and the library uses its next best code path.
+///   Features can only be disabled. A feature the processor lacks stays unavailable.
+///   Each call replaces the previous mask, and an empty list restores the detected features.
+/// \details The names are <tt>sse2</tt>, <tt>ssse3</tt>, <tt>sse4.1</tt>, <tt>sse4.2</tt>,
+///   <tt>avx</tt>, <tt>avx2</tt>, <tt>aesni</tt>, <tt>clmul</tt>, <tt>shani</tt>,
+///   <tt>adx</tt>, <tt>rdrand</tt>, <tt>rdseed</tt> and <tt>padlock</tt> on IA-32;
+///   <tt>armv7</tt>, <tt>neon</tt>, <tt>crc32</tt>, <tt>pmull</tt>, <tt>aes</tt>, <tt>sha1</tt>,
+///   <tt>sha2</tt>, <tt>sha512</tt>, <tt>sha3</tt>, <tt>sm3</tt> and <tt>sm4</tt> on ARM; and
+///   <tt>altivec</tt>, <tt>power7</tt>, <tt>power8</tt>, <tt>power9</tt>, <tt>aes</tt>,
+///   <tt>pmull</tt>, <tt>sha256</tt>, <tt>sha512</tt> and <tt>darn</tt> on PowerPC. Names
+///   are not case sensitive. Disabling <tt>sse2</tt>, <tt>avx</tt>, <tt>altivec</tt> or a
+///   Power level also disables the features that build on it.
+/// \details The environment variable <tt>CRYPTOPP_CPU_MASK</tt> is applied the same way
+///   when the features are detected, which lets a test run exercise the fallback paths
+///   without a rebuild. Unknown names in the environment variable are ignored.
+/// \details Some algorithms select a code path when they are keyed, and check the features
+///   again when they process data. Change the mask before creating and keying objects, and
+///   before other threads use the library. On x86_64 SSE2 is part of the architecture, so
+///   HasSSE2() is always true there.
+/// \since Crypto++ 8.4
+CRYPTOPP_DLL void CRYPTOPP_API MaskCPUFeatures(const std::string &features);
+
+/// \brief Provides the disabled CPU features
+/// \returns a comma separated list of the features disabled by MaskCPUFeatures()
+///   or <tt>CRYPTOPP_CPU_MASK</tt>, or an empty string if none are disabled
+/// \since Crypto++ 8.4
+CRYPTOPP_DLL std::string CRYPTOPP_API MaskedCPUFeatures();
+
+//@}
+
 // ***************************** L1 cache line ***************************** //
 
 // Non-Intel systems
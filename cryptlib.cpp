@@ -26,6 +26,7 @@
 #include "smartptr.h"
 #include "stdcpp.h"
 #include "misc.h"
+#include "instrument.h"
 
 NAMESPACE_BEGIN(CryptoPP)
 
@@ -57,6 +58,7 @@ Algorithm::Algorithm(bool checkSelfTestStatus)
 
 void SimpleKeyingInterface::SetKey(const byte *key, size_t length, const NameValuePairs &params)
 {
+	InstrumentedCall instrumented(*this, length);
 	this->ThrowIfInvalidKeyLength(length);
 	this->UncheckedSetKey(key, static_cast<unsigned int>(length), params);
 }
@@ -230,6 +232,117 @@ size_t StreamTransformation::ProcessLastBlock(byte *outString, size_t outLength,
 	return outLength;
 }
 
+ANONYMOUS_NAMESPACE_BEGIN
+
+// Runs shorter than this are gathered before ProcessData()
+const size_t SEGMENT_STAGE_SIZE = 256;
+
+// Walks a segment list, skipping empty segments
+template <class T, class S>
+class SegmentCursor
+{
+public:
+	SegmentCursor(const S *segments, size_t count)
+		: m_segments(segments), m_count(count), m_index(0), m_offset(0) {Skip();}
+
+	size_t Available() const
+		{return m_index < m_count ? m_segments[m_index].len - m_offset : 0;}
+	T * Pointer() const
+		{return m_segments[m_index].ptr + m_offset;}
+	void Advance(size_t n)
+		{m_offset += n; Skip();}
+
+private:
+	void Skip()
+	{
+		while (m_index < m_count && m_offset == m_segments[m_index].len)
+			{m_index++; m_offset = 0;}
+	}
+
+	const S *m_segments;
+	size_t m_count, m_index, m_offset;
+};
+
+template <class S>
+lword TotalLength(const S *segments, size_t count)
+{
+	lword total = 0;
+	for (size_t i=0; i<count; ++i)
+		total += segments[i].len;
+	return total;
+}
+
+ANONYMOUS_NAMESPACE_END
+
+size_t StreamTransformation::ProcessSegments(const ByteSegment *outSegments, size_t outCount, const ConstByteSegment *inSegments, size_t inCount)
+{
+	const lword inTotal = TotalLength(inSegments, inCount);
+	if (inTotal > TotalLength(outSegments, outCount))
+		throw InvalidArgument(AlgorithmName() + ": output segments are smaller than the input segments");
+
+	const size_t blockSize = MandatoryBlockSize();
+	if (inTotal % blockSize != 0)
+		throw InvalidArgument(AlgorithmName() + ": input length is not a multiple of the block size");
+
+	SegmentCursor<byte, ByteSegment> out(outSegments, outCount);
+	SegmentCursor<const byte, ConstByteSegment> in(inSegments, inCount);
+	lword remaining = inTotal;
+
+	while (remaining)
+	{
+		// Largest run that is contiguous on both sides
+		size_t run = STDMIN(in.Available(), out.Available());
+		if (run < remaining)
+			run = RoundDownToMultipleOf(run, blockSize);
+
+		if (run >= SEGMENT_STAGE_SIZE || run == remaining)
+		{
+			ProcessData(out.Pointer(), in.Pointer(), run);
+			in.Advance(run);
+			out.Advance(run);
+			remaining -= run;
+			continue;
+		}
+
+		// Gather short fragments so the cipher sees several blocks
+		CRYPTOPP_ALIGN_DATA(16) byte stage[SEGMENT_STAGE_SIZE];
+		const size_t length = (size_t)STDMIN((lword)RoundDownToMultipleOf(SEGMENT_STAGE_SIZE, blockSize), remaining);
+		CRYPTOPP_ASSERT(length > 0);
+
+		for (size_t copied = 0; copied < length; )
+		{
+			const size_t n = STDMIN(in.Available(), length-copied);
+			std::memcpy(stage+copied, in.Pointer(), n);
+			in.Advance(n);
+			copied += n;
+		}
+
+		ProcessData(stage, stage, length);
+
+		for (size_t copied = 0; copied < length; )
+		{
+			const size_t n = STDMIN(out.Available(), length-copied);
+			std::memcpy(out.Pointer(), stage+copied, n);
+			out.Advance(n);
+			copied += n;
+		}
+
+		SecureWipeArray(stage, length);
+		remaining -= length;
+	}
+
+	return (size_t)inTotal;
+}
+
+void HashTransformation::UpdateSegments(const ConstByteSegment *segments, size_t count)
+{
+	for (size_t i=0; i<count; ++i)
+	{
+		if (segments[i].len)
+			Update(segments[i].ptr, segments[i].len);
+	}
+}
+
 void AuthenticatedSymmetricCipher::SpecifyDataLengths(lword headerLength, lword messageLength, lword footerLength)
 {
 	if (headerLength > MaxHeaderLength())
@@ -262,6 +375,24 @@ bool AuthenticatedSymmetricCipher::DecryptAndVerify(byte *message, const byte *m
 	return TruncatedVerify(mac, macLength);
 }
 
+void AuthenticatedSymmetricCipher::EncryptAndAuthenticateSegments(const ByteSegment *ciphertext, size_t ciphertextCount, byte *mac, size_t macSize, const byte *iv, int ivLength, const ConstByteSegment *header, size_t headerCount, const ConstByteSegment *message, size_t messageCount)
+{
+	Resynchronize(iv, ivLength);
+	SpecifyDataLengths(TotalLength(header, headerCount), TotalLength(message, messageCount));
+	UpdateSegments(header, headerCount);
+	ProcessSegments(ciphertext, ciphertextCount, message, messageCount);
+	TruncatedFinal(mac, macSize);
+}
+
+bool AuthenticatedSymmetricCipher::DecryptAndVerifySegments(const ByteSegment *message, size_t messageCount, const byte *mac, size_t macSize, const byte *iv, int ivLength, const ConstByteSegment *header, size_t headerCount, const ConstByteSegment *ciphertext, size_t ciphertextCount)
+{
+	Resynchronize(iv, ivLength);
+	SpecifyDataLengths(TotalLength(header, headerCount), TotalLength(ciphertext, ciphertextCount));
+	UpdateSegments(header, headerCount);
+	ProcessSegments(message, messageCount, ciphertext, ciphertextCount);
+	return TruncatedVerify(mac, macSize);
+}
+
 std::string AuthenticatedSymmetricCipher::AlgorithmName() const
 {
 	// Squash C4505 on Visual Studio 2008 and friends
@@ -932,12 +1063,14 @@ BufferedTransformation * PK_Decryptor::CreateDecryptionFilter(RandomNumberGenera
 
 size_t PK_Signer::Sign(RandomNumberGenerator &rng, PK_MessageAccumulator *messageAccumulator, byte *signature) const
 {
+	InstrumentedCall instrumented(*this, InstrumentedCall::SIGN, 0);
 	member_ptr<PK_MessageAccumulator> m(messageAccumulator);
 	return SignAndRestart(rng, *m, signature, false);
 }
 
 size_t PK_Signer::SignMessage(RandomNumberGenerator &rng, const byte *message, size_t messageLen, byte *signature) const
 {
+	InstrumentedCall instrumented(*this, InstrumentedCall::SIGN, messageLen);
 	member_ptr<PK_MessageAccumulator> m(NewSignatureAccumulator(rng));
 	m->Update(message, messageLen);
 	return SignAndRestart(rng, *m, signature, false);
@@ -946,6 +1079,7 @@ size_t PK_Signer::SignMessage(RandomNumberGenerator &rng, const byte *message, s
 size_t PK_Signer::SignMessageWithRecovery(RandomNumberGenerator &rng, const byte *recoverableMessage, size_t recoverableMessageLength,
 	const byte *nonrecoverableMessage, size_t nonrecoverableMessageLength, byte *signature) const
 {
+	InstrumentedCall instrumented(*this, InstrumentedCall::SIGN, recoverableMessageLength+nonrecoverableMessageLength);
 	member_ptr<PK_MessageAccumulator> m(NewSignatureAccumulator(rng));
 	InputRecoverableMessage(*m, recoverableMessage, recoverableMessageLength);
 	m->Update(nonrecoverableMessage, nonrecoverableMessageLength);
@@ -954,12 +1088,14 @@ size_t PK_Signer::SignMessageWithRecovery(RandomNumberGenerator &rng, const byte
 
 bool PK_Verifier::Verify(PK_MessageAccumulator *messageAccumulator) const
 {
+	InstrumentedCall instrumented(*this, InstrumentedCall::VERIFY, 0);
 	member_ptr<PK_MessageAccumulator> m(messageAccumulator);
 	return VerifyAndRestart(*m);
 }
 
 bool PK_Verifier::VerifyMessage(const byte *message, size_t messageLen, const byte *signature, size_t signatureLen) const
 {
+	InstrumentedCall instrumented(*this, InstrumentedCall::VERIFY, messageLen);
 	member_ptr<PK_MessageAccumulator> m(NewVerificationAccumulator());
 	InputSignature(*m, signature, signatureLen);
 	m->Update(message, messageLen);
@@ -968,6 +1104,7 @@ bool PK_Verifier::VerifyMessage(const byte *message, size_t messageLen, const by
 
 DecodingResult PK_Verifier::Recover(byte *recoveredMessage, PK_MessageAccumulator *messageAccumulator) const
 {
+	InstrumentedCall instrumented(*this, InstrumentedCall::VERIFY, 0);
 	member_ptr<PK_MessageAccumulator> m(messageAccumulator);
 	return RecoverAndRestart(recoveredMessage, *m);
 }
@@ -976,6 +1113,7 @@ DecodingResult PK_Verifier::RecoverMessage(byte *recoveredMessage,
 	const byte *nonrecoverableMessage, size_t nonrecoverableMessageLength,
 	const byte *signature, size_t signatureLength) const
 {
+	InstrumentedCall instrumented(*this, InstrumentedCall::VERIFY, nonrecoverableMessageLength);
 	member_ptr<PK_MessageAccumulator> m(NewVerificationAccumulator());
 	InputSignature(*m, signature, signatureLength);
 	m->Update(nonrecoverableMessage, nonrecoverableMessageLength);
@@ -940,6 +940,36 @@ public:
 	inline CipherDir GetCipherDirection() const {return IsForwardTransformation() ? ENCRYPTION : DECRYPTION;}
 };
 
+/// \brief A writable buffer in a scatter/gather list
+/// \details ByteSegment is the equivalent of POSIX <tt>struct iovec</tt>.
+/// \sa ConstByteSegment, StreamTransformation::ProcessSegments()
+/// \since Crypto++ 8.4
+struct ByteSegment
+{
+	ByteSegment() : ptr(NULLPTR), len(0) {}
+	ByteSegment(byte *p, size_t n) : ptr(p), len(n) {}
+
+	/// \brief Pointer to the first byte
+	byte *ptr;
+	/// \brief Size of the buffer, in bytes
+	size_t len;
+};
+
+/// \brief A read-only buffer in a scatter/gather list
+/// \sa ByteSegment, HashTransformation::UpdateSegments()
+/// \since Crypto++ 8.4
+struct ConstByteSegment
+{
+	ConstByteSegment() : ptr(NULLPTR), len(0) {}
+	ConstByteSegment(const byte *p, size_t n) : ptr(p), len(n) {}
+	ConstByteSegment(const ByteSegment &s) : ptr(s.ptr), len(s.len) {}
+
+	/// \brief Pointer to the first byte
+	const byte *ptr;
+	/// \brief Size of the buffer, in bytes
+	size_t len;
+};
+
 /// \brief Interface for the data processing portion of stream ciphers
 /// \sa StreamTransformationFilter()
 class CRYPTOPP_DLL CRYPTOPP_NO_VTABLE StreamTransformation : public Algorithm
@@ -1068,6 +1098,22 @@ public:
 	inline void ProcessString(byte *outString, const byte *inString, size_t length)
 		{ProcessData(outString, inString, length);}
 
+	/// \brief Encrypt or decrypt a scatter/gather list
+	/// \param outSegments the output segments
+	/// \param outCount the number of output segments
+	/// \param inSegments the input segments
+	/// \param inCount the number of input segments
+	/// \return the number of bytes processed
+	/// \throws InvalidArgument if the output is smaller than the input, or the
+	///  input is not a multiple of MandatoryBlockSize()
+	/// \details The input is processed as if it were one contiguous string. The
+	///  boundaries of the input and output segments do not need to agree.
+	/// \details Long runs are passed to ProcessData() in place so multi-block
+	///  implementations see as many blocks as possible. Fragments shorter than
+	///  256 bytes are gathered into a stack buffer and processed together.
+	/// \since Crypto++ 8.4
+	size_t ProcessSegments(const ByteSegment *outSegments, size_t outCount, const ConstByteSegment *inSegments, size_t inCount);
+
 	/// \brief Encrypt or decrypt a byte
 	/// \param input the input byte to process
 	/// \details Internally, the base class implementation calls ProcessData() with a size of 1.
@@ -1124,6 +1170,14 @@ public:
 	/// \param length the size of the buffer, in bytes
 	virtual void Update(const byte *input, size_t length) =0;
 
+	/// \brief Updates a hash with a scatter/gather list
+	/// \param segments the input segments
+	/// \param count the number of segments
+	/// \details UpdateSegments() is the same as calling Update() on each
+	///  segment in order. Empty segments are skipped.
+	/// \since Crypto++ 8.4
+	void UpdateSegments(const ConstByteSegment *segments, size_t count);
+
 	/// \brief Request space which can be written into by the caller
 	/// \param size the requested size of the buffer
 	/// \details The purpose of this method is to help avoid extra memory allocations.
@@ -1389,6 +1443,42 @@ public:
 	///  is truncated if <tt>macLength < TagSize()</tt>.
 	virtual bool DecryptAndVerify(byte *message, const byte *mac, size_t macSize, const byte *iv, int ivLength, const byte *header, size_t headerLength, const byte *ciphertext, size_t ciphertextLength);
 
+	/// \brief Encrypts and calculates a MAC over scatter/gather lists
+	/// \param ciphertext the output segments
+	/// \param ciphertextCount the number of output segments
+	/// \param mac the mac buffer
+	/// \param macSize the size of the MAC buffer, in bytes
+	/// \param iv the iv buffer
+	/// \param ivLength the size of the IV buffer, in bytes
+	/// \param header the AAD segments
+	/// \param headerCount the number of AAD segments
+	/// \param message the message segments
+	/// \param messageCount the number of message segments
+	/// \details EncryptAndAuthenticateSegments() produces the same output as
+	///  EncryptAndAuthenticate() over the concatenated segments, without copying
+	///  them into a contiguous buffer first. See StreamTransformation::ProcessSegments()
+	///  for the handling of segment boundaries.
+	/// \since Crypto++ 8.4
+	void EncryptAndAuthenticateSegments(const ByteSegment *ciphertext, size_t ciphertextCount, byte *mac, size_t macSize, const byte *iv, int ivLength, const ConstByteSegment *header, size_t headerCount, const ConstByteSegment *message, size_t messageCount);
+
+	/// \brief Decrypts and verifies a MAC over scatter/gather lists
+	/// \param message the output segments
+	/// \param messageCount the number of output segments
+	/// \param mac the mac buffer
+	/// \param macSize the size of the MAC buffer, in bytes
+	/// \param iv the iv buffer
+	/// \param ivLength the size of the IV buffer, in bytes
+	/// \param header the AAD segments
+	/// \param headerCount the number of AAD segments
+	/// \param ciphertext the ciphertext segments
+	/// \param ciphertextCount the number of ciphertext segments
+	/// \return true if the MAC is valid, false otherwise
+	/// \details DecryptAndVerifySegments() produces the same output as
+	///  DecryptAndVerify() over the concatenated segments. Like DecryptAndVerify(),
+	///  the plaintext is written even if verification fails.
+	/// \since Crypto++ 8.4
+	bool DecryptAndVerifySegments(const ByteSegment *message, size_t messageCount, const byte *mac, size_t macSize, const byte *iv, int ivLength, const ConstByteSegment *header, size_t headerCount, const ConstByteSegment *ciphertext, size_t ciphertextCount);
+
 	/// \brief Provides the name of this algorithm
 	/// \return the standard algorithm name
 	/// \details The standard algorithm name can be a name like \a AES or \a AES/GCM. Some algorithms
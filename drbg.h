@@ -13,6 +13,7 @@
 #include "secblock.h"
 #include "hmac.h"
 #include "sha.h"
+#include "aes.h"
 
 NAMESPACE_BEGIN(CryptoPP)
 
@@ -385,6 +386,139 @@ private:
 
 // *************************************************************
 
+/// \tparam BLOCK_CIPHER NIST approved block cipher derived from BlockCipherDocumentation
+/// \tparam KEYLENGTH key length of the block cipher, in bytes
+/// \brief CTR_DRBG from SP 800-90A Rev 1 (June 2015)
+/// \details The NIST CTR DRBG is instantiated with a number of parameters. The key length of the
+///   block cipher determines the Security Strength and Seed Length. The remaining parameters are
+///   included in the class. The parameters and their values are listed in NIST SP 800-90A Rev. 1,
+///   Table 3: Definitions for the CTR_DRBG (p.49). CTR_DRBG always uses the block cipher
+///   derivation function, and the counter field is the full block.
+/// \details The generator produces its output with AdvancedProcessBlocks() on the counter
+///   block, so ciphers like AES use the same multi-block SIMD code as CTR mode. The keystream
+///   is written directly to the caller's buffer in runs of 256 blocks, and only a trailing
+///   partial block is staged in an internal buffer. CTR_DRBG is much faster than Hash_DRBG
+///   and HMAC_DRBG for large requests.
+/// \details Some parameters have been reduce to fit C++ datatypes. For example, NIST allows upto 2<sup>48</sup> requests
+///   before a reseed. However, CTR_DRBG limits it to <tt>INT_MAX</tt> due to the limited data range of an int.
+/// \sa <A HREF="http://nvlpubs.nist.gov/nistpubs/SpecialPublications/NIST.SP.800-90Ar1.pdf">Recommendation
+///   for Random Number Generation Using Deterministic Random Bit Generators, Rev 1 (June 2015)</A>
+/// \since Crypto++ 8.4
+template <typename BLOCK_CIPHER=AES, unsigned int KEYLENGTH=128/8>
+class CTR_DRBG : public NIST_DRBG, public NotCopyable
+{
+public:
+    CRYPTOPP_CONSTANT(BLOCKSIZE=BLOCK_CIPHER::BLOCKSIZE);
+    CRYPTOPP_CONSTANT(SECURITY_STRENGTH=KEYLENGTH);
+    CRYPTOPP_CONSTANT(SEED_LENGTH=KEYLENGTH+BLOCKSIZE);
+    CRYPTOPP_CONSTANT(MINIMUM_ENTROPY=KEYLENGTH);
+    CRYPTOPP_CONSTANT(MINIMUM_NONCE=0);
+    CRYPTOPP_CONSTANT(MINIMUM_ADDITIONAL=0);
+    CRYPTOPP_CONSTANT(MINIMUM_PERSONALIZATION=0);
+    CRYPTOPP_CONSTANT(MAXIMUM_ENTROPY=INT_MAX);
+    CRYPTOPP_CONSTANT(MAXIMUM_NONCE=INT_MAX);
+    CRYPTOPP_CONSTANT(MAXIMUM_ADDITIONAL=INT_MAX);
+    CRYPTOPP_CONSTANT(MAXIMUM_PERSONALIZATION=INT_MAX);
+    CRYPTOPP_CONSTANT(MAXIMUM_BYTES_PER_REQUEST=65536);
+    CRYPTOPP_CONSTANT(MAXIMUM_REQUESTS_BEFORE_RESEED=INT_MAX);
+
+    static std::string StaticAlgorithmName() { return std::string("CTR_DRBG(") + BLOCK_CIPHER::StaticAlgorithmName() + "-" + IntToString(KEYLENGTH*8) + std::string(")"); }
+
+    /// \brief Construct a CTR DRBG
+    /// \param entropy the entropy to instantiate the generator
+    /// \param entropyLength the size of the entropy buffer
+    /// \param nonce additional input to instantiate the generator
+    /// \param nonceLength the size of the nonce buffer
+    /// \param personalization additional input to instantiate the generator
+    /// \param personalizationLength the size of the personalization buffer
+    /// \throws NIST_DRBG::Err if the generator is instantiated with insufficient entropy
+    /// \details All NIST DRBGs must be instaniated with at least <tt>MINIMUM_ENTROPY</tt> bytes of entropy.
+    ///   The byte array for <tt>entropy</tt> must meet <A HREF ="http://csrc.nist.gov/publications/PubsSPs.html">NIST
+    ///   SP 800-90B or SP 800-90C</A> requirements.
+    /// \details The <tt>nonce</tt> and <tt>personalization</tt> are optional byte arrays. If <tt>nonce</tt> is supplied,
+    ///   then it should be at least <tt>SECURITY_STRENGTH/2</tt> bytes of entropy.
+    /// \details An example of instantiating an AES-256 generator is shown below.
+    ///   The <tt>NonblockingRng</tt> meets the requirements of <A HREF ="http://csrc.nist.gov/publications/PubsSPs.html">NIST
+    ///   SP 800-90B or SP 800-90C</A>. RDRAND() and RDSEED() generators would work as well.
+    /// <pre>
+    ///    SecByteBlock entropy(48), result(4096);
+    ///    NonblockingRng prng;
+    ///    RandomNumberSource rns(prng, entropy.size(), new ArraySink(entropy, entropy.size()));
+    ///
+    ///    CTR_DRBG<AES, 256/8> drbg(entropy, 32, entropy+32, 16);
+    ///    drbg.GenerateBlock(result, result.size());
+    /// </pre>
+    CTR_DRBG(const byte* entropy=NULLPTR, size_t entropyLength=KEYLENGTH, const byte* nonce=NULLPTR,
+        size_t nonceLength=0, const byte* personalization=NULLPTR, size_t personalizationLength=0)
+        : NIST_DRBG(), m_v(BLOCKSIZE), m_reseed(0)
+    {
+        const byte zero[KEYLENGTH] = {0};
+        m_cipher.SetKey(zero, KEYLENGTH);
+        std::memset(m_v, 0x00, m_v.size());
+        IncrementCounterByOne(m_v, BLOCKSIZE);
+
+        if (entropy != NULLPTR && entropyLength != 0)
+            DRBG_Instantiate(entropy, entropyLength, nonce, nonceLength, personalization, personalizationLength);
+    }
+
+    unsigned int SecurityStrength() const {return SECURITY_STRENGTH;}
+    unsigned int SeedLength() const {return SEED_LENGTH;}
+    unsigned int MinEntropyLength() const {return MINIMUM_ENTROPY;}
+    unsigned int MaxEntropyLength() const {return MAXIMUM_ENTROPY;}
+    unsigned int MinNonceLength() const {return MINIMUM_NONCE;}
+    unsigned int MaxNonceLength() const {return MAXIMUM_NONCE;}
+    unsigned int MaxBytesPerRequest() const {return MAXIMUM_BYTES_PER_REQUEST;}
+    unsigned int MaxRequestBeforeReseed() const {return MAXIMUM_REQUESTS_BEFORE_RESEED;}
+
+    void IncorporateEntropy(const byte *input, size_t length)
+        {return DRBG_Reseed(input, length, NULLPTR, 0);}
+
+    void IncorporateEntropy(const byte *entropy, size_t entropyLength, const byte* additional, size_t additionaLength)
+        {return DRBG_Reseed(entropy, entropyLength, additional, additionaLength);}
+
+    void GenerateBlock(byte *output, size_t size)
+        {return CTR_Generate(NULLPTR, 0, output, size);}
+
+    void GenerateBlock(const byte* additional, size_t additionaLength, byte *output, size_t size)
+        {return CTR_Generate(additional, additionaLength, output, size);}
+
+    std::string AlgorithmProvider() const
+        {return m_cipher.AlgorithmProvider();}
+
+protected:
+    // 10.2.1.3.2 Instantiation When a Derivation Function is Used (p.55)
+    void DRBG_Instantiate(const byte* entropy, size_t entropyLength, const byte* nonce, size_t nonceLength,
+        const byte* personalization, size_t personalizationLength);
+
+    // 10.2.1.4.2 Reseeding When a Derivation Function is Used (p.57)
+    void DRBG_Reseed(const byte* entropy, size_t entropyLength, const byte* additional, size_t additionaLength);
+
+    // 10.2.1.5.2 Generating Pseudorandom Bits When a Derivation Function is Used (p.59)
+    void CTR_Generate(const byte* additional, size_t additionaLength, byte *output, size_t size);
+
+    // 10.2.1.2 The Update Function (CTR_DRBG_Update) (p.52)
+    void CTR_Update(const byte* provided);
+
+    // 10.3.2 Derivation Function Using a Block Cipher Algorithm (Block_Cipher_df) (p.67)
+    void CTR_DF(const byte* input1, size_t inlen1, const byte* input2, size_t inlen2,
+        const byte* input3, size_t inlen3, byte* output);
+
+    // Encrypts the counter blocks V+1, V+2, ... into output and advances V
+    void CTR_Keystream(byte* output, size_t blocks);
+
+private:
+    typename BLOCK_CIPHER::Encryption m_cipher;
+    // m_v holds V+1, which is the next counter block to encrypt
+    SecByteBlock m_v, m_temp;
+    word64 m_reseed;
+};
+
+// typedef CTR_DRBG<AES, 128/8> CTR_AES128_DRBG;
+// typedef CTR_DRBG<AES, 192/8> CTR_AES192_DRBG;
+// typedef CTR_DRBG<AES, 256/8> CTR_AES256_DRBG;
+
+// *************************************************************
+
 // 10.1.1.2 Instantiation of Hash_DRBG (p.39)
 template <typename HASH, unsigned int STRENGTH, unsigned int SEEDLENGTH>
 void Hash_DRBG<HASH, STRENGTH, SEEDLENGTH>::DRBG_Instantiate(const byte* entropy, size_t entropyLength, const byte* nonce, size_t nonceLength,
@@ -703,6 +837,217 @@ void HMAC_DRBG<HASH, STRENGTH, SEEDLENGTH>::HMAC_Update(const byte* input1, size
     m_hmac.TruncatedFinal(m_v, m_v.size());
 }
 
+// *************************************************************
+
+// 10.2.1.3.2 Instantiation When a Derivation Function is Used (p.55)
+template <typename BLOCK_CIPHER, unsigned int KEYLENGTH>
+void CTR_DRBG<BLOCK_CIPHER, KEYLENGTH>::DRBG_Instantiate(const byte* entropy, size_t entropyLength, const byte* nonce, size_t nonceLength,
+    const byte* personalization, size_t personalizationLength)
+{
+    //  SP 800-90A, 8.6.3: The entropy input shall have entropy that is equal to or greater than the security
+    //  strength of the instantiation. Additional entropy may be provided in the nonce or the optional
+    //  personalization string during instantiation, or in the additional input during reseeding and generation,
+    //  but this is not required and does not increase the "official" security strength of the DRBG
+    //  instantiation that is recorded in the internal state.
+    CRYPTOPP_ASSERT(entropyLength >= MINIMUM_ENTROPY);
+    if (entropyLength < MINIMUM_ENTROPY)
+        throw NIST_DRBG::Err("CTR_DRBG", "Insufficient entropy during instantiate");
+
+    // SP 800-90A, Section 9, says we should throw if we have too much entropy, too large a nonce,
+    // or too large a persoanlization string. We warn in Debug builds, but do nothing in Release builds.
+    CRYPTOPP_ASSERT(entropyLength <= MAXIMUM_ENTROPY);
+    CRYPTOPP_ASSERT(nonceLength <= MAXIMUM_NONCE);
+    CRYPTOPP_ASSERT(personalizationLength <= MAXIMUM_PERSONALIZATION);
+
+    // Steps 1-3
+    SecByteBlock seed(SEED_LENGTH);
+    CTR_DF(entropy, entropyLength, nonce, nonceLength, personalization, personalizationLength, seed);
+
+    // Steps 4-5
+    const byte zero[KEYLENGTH] = {0};
+    m_cipher.SetKey(zero, KEYLENGTH);
+    std::memset(m_v, 0x00, m_v.size());
+    IncrementCounterByOne(m_v, BLOCKSIZE);
+
+    // Steps 6-7
+    CTR_Update(seed);
+    m_reseed = 1;
+}
+
+// 10.2.1.4.2 Reseeding When a Derivation Function is Used (p.57)
+template <typename BLOCK_CIPHER, unsigned int KEYLENGTH>
+void CTR_DRBG<BLOCK_CIPHER, KEYLENGTH>::DRBG_Reseed(const byte* entropy, size_t entropyLength, const byte* additional, size_t additionaLength)
+{
+    //  SP 800-90A, 8.6.3: The entropy input shall have entropy that is equal to or greater than the security
+    //  strength of the instantiation. Additional entropy may be provided in the nonce or the optional
+    //  personalization string during instantiation, or in the additional input during reseeding and generation,
+    //  but this is not required and does not increase the "official" security strength of the DRBG
+    //  instantiation that is recorded in the internal state..
+    CRYPTOPP_ASSERT(entropyLength >= MINIMUM_ENTROPY);
+    if (entropyLength < MINIMUM_ENTROPY)
+        throw NIST_DRBG::Err("CTR_DRBG", "Insufficient entropy during reseed");
+
+    // SP 800-90A, Section 9, says we should throw if we have too much entropy, too large a nonce,
+    // or too large a persoanlization string. We warn in Debug builds, but do nothing in Release builds.
+    CRYPTOPP_ASSERT(entropyLength <= MAXIMUM_ENTROPY);
+    CRYPTOPP_ASSERT(additionaLength <= MAXIMUM_ADDITIONAL);
+
+    SecByteBlock seed(SEED_LENGTH);
+    CTR_DF(entropy, entropyLength, additional, additionaLength, NULLPTR, 0, seed);
+
+    CTR_Update(seed);
+    m_reseed = 1;
+}
+
+// 10.2.1.5.2 Generating Pseudorandom Bits When a Derivation Function is Used (p.59)
+template <typename BLOCK_CIPHER, unsigned int KEYLENGTH>
+void CTR_DRBG<BLOCK_CIPHER, KEYLENGTH>::CTR_Generate(const byte* additional, size_t additionaLength, byte *output, size_t size)
+{
+    // Step 1
+    if (static_cast<word64>(m_reseed) >= static_cast<word64>(MaxRequestBeforeReseed()))
+        throw NIST_DRBG::Err("CTR_DRBG", "Reseed required");
+
+    if (size > MaxBytesPerRequest())
+        throw NIST_DRBG::Err("CTR_DRBG", "Request size exceeds limit");
+
+    // SP 800-90A, Section 9, says we should throw if we have too much entropy, too large a nonce,
+    // or too large a persoanlization string. We warn in Debug builds, but do nothing in Release builds.
+    CRYPTOPP_ASSERT(additionaLength <= MAXIMUM_ADDITIONAL);
+
+    // Step 2
+    SecByteBlock seed(SEED_LENGTH);
+    if (additional && additionaLength)
+    {
+        CTR_DF(additional, additionaLength, NULLPTR, 0, NULLPTR, 0, seed);
+        CTR_Update(seed);
+    }
+    else
+    {
+        std::memset(seed, 0x00, seed.size());
+    }
+
+    // Steps 3-5. Whole blocks go straight to the caller's buffer.
+    const size_t blocks = size / BLOCKSIZE;
+    const size_t tail = size % BLOCKSIZE;
+
+    CTR_Keystream(output, blocks);
+    if (tail)
+    {
+        m_temp.New(BLOCKSIZE);
+        CTR_Keystream(m_temp, 1);
+        std::memcpy(output+blocks*BLOCKSIZE, m_temp, tail);
+    }
+
+    // Steps 6-7
+    CTR_Update(seed);
+    m_reseed++;
+}
+
+// 10.2.1.2 The Update Function (CTR_DRBG_Update) (p.52)
+template <typename BLOCK_CIPHER, unsigned int KEYLENGTH>
+void CTR_DRBG<BLOCK_CIPHER, KEYLENGTH>::CTR_Update(const byte* provided)
+{
+    // Steps 1-3
+    const size_t blocks = (SEED_LENGTH+BLOCKSIZE-1)/BLOCKSIZE;
+    FixedSizeSecBlock<byte, blocks*BLOCKSIZE> temp;
+    CTR_Keystream(temp, blocks);
+
+    // Step 4
+    xorbuf(temp, provided, SEED_LENGTH);
+
+    // Steps 5-7
+    m_cipher.SetKey(temp, KEYLENGTH);
+    std::memcpy(m_v, temp+KEYLENGTH, BLOCKSIZE);
+    IncrementCounterByOne(m_v, BLOCKSIZE);
+}
+
+// 10.3.2 Derivation Function Using a Block Cipher Algorithm (Block_Cipher_df) (p.67)
+template <typename BLOCK_CIPHER, unsigned int KEYLENGTH>
+void CTR_DRBG<BLOCK_CIPHER, KEYLENGTH>::CTR_DF(const byte* input1, size_t inlen1, const byte* input2, size_t inlen2,
+    const byte* input3, size_t inlen3, byte* output)
+{
+    if (!input1) inlen1 = 0;
+    if (!input2) inlen2 = 0;
+    if (!input3) inlen3 = 0;
+
+    // Steps 2-5. S = L || N || input_string || 0x80 || 0x00..., padded to a whole block.
+    //  The first block of the buffer is the IV used by BCC in Step 9.1.
+    const size_t inlen = inlen1 + inlen2 + inlen3;
+    const size_t slen = RoundUpToMultipleOf(8 + inlen + 1, (size_t)BLOCKSIZE);
+    SecByteBlock s(BLOCKSIZE + slen);
+    std::memset(s, 0x00, s.size());
+
+    byte* ptr = s + BLOCKSIZE;
+    PutWord(false, BIG_ENDIAN_ORDER, ptr+0, static_cast<word32>(inlen));
+    PutWord(false, BIG_ENDIAN_ORDER, ptr+4, static_cast<word32>(SEED_LENGTH));
+    ptr += 8;
+
+    if (inlen1)
+        {std::memcpy(ptr, input1, inlen1); ptr += inlen1;}
+    if (inlen2)
+        {std::memcpy(ptr, input2, inlen2); ptr += inlen2;}
+    if (inlen3)
+        {std::memcpy(ptr, input3, inlen3); ptr += inlen3;}
+    *ptr = 0x80;
+
+    // Step 8
+    byte key[KEYLENGTH];
+    for (unsigned int i=0; i<KEYLENGTH; ++i)
+        key[i] = static_cast<byte>(i);
+
+    typename BLOCK_CIPHER::Encryption cipher(key, KEYLENGTH);
+
+    // Steps 9-10. BCC is CBC-MAC with a zero IV over IV || S.
+    const size_t blocks = (SEED_LENGTH+BLOCKSIZE-1)/BLOCKSIZE;
+    FixedSizeSecBlock<byte, blocks*BLOCKSIZE> temp;
+    for (word32 i=0; i<blocks; ++i)
+    {
+        PutWord(false, BIG_ENDIAN_ORDER, s.begin(), i);
+        byte* chain = temp + i*BLOCKSIZE;
+        std::memset(chain, 0x00, BLOCKSIZE);
+
+        for (size_t j=0; j<s.size(); j+=BLOCKSIZE)
+        {
+            xorbuf(chain, s+j, BLOCKSIZE);
+            cipher.ProcessBlock(chain);
+        }
+    }
+
+    // Steps 11-15
+    FixedSizeSecBlock<byte, BLOCKSIZE> x;
+    std::memcpy(x, temp+KEYLENGTH, BLOCKSIZE);
+    cipher.SetKey(temp, KEYLENGTH);
+
+    for (size_t i=0; i<SEED_LENGTH; i+=BLOCKSIZE)
+    {
+        cipher.ProcessBlock(x);
+        std::memcpy(output+i, x, STDMIN(SEED_LENGTH-i, (size_t)BLOCKSIZE));
+    }
+
+    SecureWipeArray(key, KEYLENGTH);
+}
+
+// Encrypts the counter blocks V+1, V+2, ... into output and advances V
+template <typename BLOCK_CIPHER, unsigned int KEYLENGTH>
+void CTR_DRBG<BLOCK_CIPHER, KEYLENGTH>::CTR_Keystream(byte* output, size_t blocks)
+{
+    // The block cipher only increments the low byte of the counter, so the
+    //  keystream is produced in runs that stop at each carry, like CTR mode
+    while (blocks)
+    {
+        const byte lsb = m_v[BLOCKSIZE-1];
+        const size_t count = UnsignedMin(blocks, 256U-lsb);
+
+        m_cipher.AdvancedProcessBlocks(m_v, NULLPTR, output, count*BLOCKSIZE,
+            BlockTransformation::BT_InBlockIsCounter|BlockTransformation::BT_AllowParallel);
+        if ((m_v[BLOCKSIZE-1] = byte(lsb + count)) == 0)
+            IncrementCounterByOne(m_v, BLOCKSIZE-1);
+
+        output += count*BLOCKSIZE;
+        blocks -= count;
+    }
+}
+
 NAMESPACE_END
 
 #endif  // CRYPTOPP_NIST_DRBG_H
@@ -18,9 +18,18 @@
 #include "fltrimpl.h"
 #include "argnames.h"
 #include "smartptr.h"
+#include "hrtimer.h"
 #include "stdcpp.h"
 #include "misc.h"
 
+#include <iostream>
+#include <iomanip>
+#include <typeinfo>
+
+#if defined(__GNUC__)
+# include <cxxabi.h>
+#endif
+
 NAMESPACE_BEGIN(CryptoPP)
 
 Filter::Filter(BufferedTransformation *attachment)
@@ -250,6 +259,252 @@ bool MeterFilter::IsolatedMessageSeriesEnd(bool blocking)
 
 // *************************************************************
 
+ANONYMOUS_NAMESPACE_BEGIN
+
+using namespace CryptoPP;
+
+// Class name without namespace or template arguments, followed by
+//  AlgorithmName() when the object provides one.
+std::string StageName(const BufferedTransformation &stage)
+{
+	std::string name = typeid(stage).name();
+#if defined(__GNUC__)
+	int status = 0;
+	char *demangled = abi::__cxa_demangle(name.c_str(), NULLPTR, NULLPTR, &status);
+	if (demangled)
+	{
+		name = demangled;
+		std::free(demangled);
+	}
+#endif
+
+	name = name.substr(0, name.find('<'));
+	const std::string::size_type pos = name.rfind("::");
+	if (pos != std::string::npos)
+		name = name.substr(pos+2);
+	if (name.compare(0, 6, "class ") == 0)
+		name = name.substr(6);
+
+	const std::string algorithm = stage.AlgorithmName();
+	if (algorithm != "unknown" && algorithm != name)
+		name += "(" + algorithm + ")";
+	return name;
+}
+
+inline unsigned int SizeBucket(size_t length)
+{
+	return STDMIN(BitPrecision(length), (unsigned int)PipelineStageProfile::SIZE_BUCKETS-1);
+}
+
+ANONYMOUS_NAMESPACE_END
+
+PipelineStageProfile::PipelineStageProfile()
+	: putCalls(0), putBytes(0), messageEnds(0), flushCalls(0), putSeconds(0)
+	, flushSeconds(0), exclusiveSeconds(0), maxQueuedBytes(0), queuedBytes(0)
+{
+	std::memset(callSizes, 0, sizeof(callSizes));
+}
+
+ProfilingFilter::ProfilingFilter(BufferedTransformation *attachment)
+{
+	Detach(attachment);
+	ResetProfile();
+}
+
+ProfilingFilter::~ProfilingFilter()
+{
+}
+
+void ProfilingFilter::ResetProfile()
+{
+	m_putTicks = m_flushTicks = 0;
+	m_profile = PipelineStageProfile();
+}
+
+PipelineStageProfile ProfilingFilter::GetProfile() const
+{
+	const double ticksPerSecond = static_cast<double>(Timer().TicksPerSecond());
+	PipelineStageProfile profile(m_profile);
+	profile.name = StageName(*AttachedTransformation());
+	profile.putSeconds = m_putTicks / ticksPerSecond;
+	profile.flushSeconds = m_flushTicks / ticksPerSecond;
+	profile.exclusiveSeconds = profile.putSeconds + profile.flushSeconds;
+	return profile;
+}
+
+void ProfilingFilter::SampleQueue()
+{
+	const FilterWithBufferedInput *stage = dynamic_cast<const FilterWithBufferedInput *>(AttachedTransformation());
+	if (stage)
+	{
+		const size_t queued = stage->QueuedSize();
+		m_profile.maxQueuedBytes = STDMAX(m_profile.maxQueuedBytes, queued);
+		m_profile.queuedBytes += queued;
+	}
+}
+
+size_t ProfilingFilter::PutMaybeModifiable(byte *inString, size_t length, int messageEnd, bool blocking, bool modifiable)
+{
+	Timer timer;
+	const TimerWord start = timer.GetCurrentTimerValue();
+
+	// Pass messageEnd unchanged so the filter is transparent
+	const size_t result = modifiable ?
+		AttachedTransformation()->PutModifiable2(inString, length, messageEnd, blocking) :
+		AttachedTransformation()->Put2(inString, length, messageEnd, blocking);
+
+	m_putTicks += timer.GetCurrentTimerValue() - start;
+	m_profile.putCalls++;
+	m_profile.putBytes += length - result;
+	m_profile.callSizes[SizeBucket(length)]++;
+	if (messageEnd && !result)
+		m_profile.messageEnds++;
+	SampleQueue();
+
+	return result;
+}
+
+size_t ProfilingFilter::Put2(const byte *inString, size_t length, int messageEnd, bool blocking)
+{
+	return PutMaybeModifiable(const_cast<byte *>(inString), length, messageEnd, blocking, false);
+}
+
+size_t ProfilingFilter::PutModifiable2(byte *inString, size_t length, int messageEnd, bool blocking)
+{
+	return PutMaybeModifiable(inString, length, messageEnd, blocking, true);
+}
+
+void ProfilingFilter::Initialize(const NameValuePairs &parameters, int propagation)
+{
+	AttachedTransformation()->Initialize(parameters, propagation);
+}
+
+bool ProfilingFilter::Flush(bool hardFlush, int propagation, bool blocking)
+{
+	Timer timer;
+	const TimerWord start = timer.GetCurrentTimerValue();
+	const bool result = AttachedTransformation()->Flush(hardFlush, propagation, blocking);
+
+	m_flushTicks += timer.GetCurrentTimerValue() - start;
+	m_profile.flushCalls++;
+	SampleQueue();
+
+	return result;
+}
+
+bool ProfilingFilter::MessageSeriesEnd(int propagation, bool blocking)
+{
+	return AttachedTransformation()->MessageSeriesEnd(propagation, blocking);
+}
+
+void ProfilingFilter::InsertAfterEachFilter(BufferedTransformation &head)
+{
+	Filter *filter = dynamic_cast<Filter *>(&head);
+	while (filter && filter->m_attachment.get())
+	{
+		ProfilingFilter *profiler = dynamic_cast<ProfilingFilter *>(filter->m_attachment.get());
+		if (profiler == NULLPTR)
+			filter->Insert(profiler = new ProfilingFilter);
+
+		// Step over the ProfilingFilter to the stage it measures
+		filter = dynamic_cast<Filter *>(profiler->m_attachment.get());
+	}
+}
+
+std::vector<ProfilingFilter *> ProfilingFilter::FindInChain(BufferedTransformation &head)
+{
+	std::vector<ProfilingFilter *> result;
+	Filter *filter = dynamic_cast<Filter *>(&head);
+	while (filter)
+	{
+		ProfilingFilter *profiler = dynamic_cast<ProfilingFilter *>(filter);
+		if (profiler)
+			result.push_back(profiler);
+		filter = dynamic_cast<Filter *>(filter->m_attachment.get());
+	}
+	return result;
+}
+
+void ProfilePipeline(BufferedTransformation &head)
+{
+	ProfilingFilter::InsertAfterEachFilter(head);
+}
+
+std::vector<PipelineStageProfile> GetPipelineProfile(BufferedTransformation &head)
+{
+	const std::vector<ProfilingFilter *> profilers = ProfilingFilter::FindInChain(head);
+	std::vector<PipelineStageProfile> result;
+	for (size_t i=0; i<profilers.size(); ++i)
+		result.push_back(profilers[i]->GetProfile());
+
+	// Each time includes the stages that follow
+	for (size_t i=0; i+1<result.size(); ++i)
+	{
+		const double next = result[i+1].putSeconds + result[i+1].flushSeconds;
+		result[i].exclusiveSeconds = STDMAX(result[i].exclusiveSeconds - next, 0.0);
+	}
+	return result;
+}
+
+void ReportPipelineProfile(BufferedTransformation &head, std::ostream &out)
+{
+	const std::vector<PipelineStageProfile> stages = GetPipelineProfile(head);
+	const std::ios::fmtflags flags = out.flags();
+	const std::streamsize precision = out.precision();
+
+	out << std::left << std::setw(6) << "Stage" << std::setw(40) << "Name" << std::right;
+	out << std::setw(10) << "Calls" << std::setw(14) << "Bytes" << std::setw(11) << "Mean size";
+	out << std::setw(9) << "Out/In" << std::setw(9) << "Flushes" << std::setw(11) << "Total ms";
+	out << std::setw(11) << "Self ms" << std::setw(12) << "Max queued" << std::setw(12) << "Mean queued" << "\n";
+
+	out << std::fixed;
+	for (size_t i=0; i<stages.size(); ++i)
+	{
+		const PipelineStageProfile &stage = stages[i];
+		const word64 dataCalls = stage.putCalls - stage.callSizes[0];
+
+		out << std::left << std::setw(6) << i+1 << std::setw(40) << stage.name.substr(0, 39) << std::right;
+		out << std::setw(10) << stage.putCalls << std::setw(14) << stage.putBytes;
+		out << std::setprecision(1) << std::setw(11) << (dataCalls ? double(stage.putBytes) / dataCalls : 0.0);
+		if (i+1 < stages.size() && stage.putBytes)
+			out << std::setprecision(3) << std::setw(9) << double(stages[i+1].putBytes) / stage.putBytes;
+		else
+			out << std::setw(9) << "-";
+		out << std::setw(9) << stage.flushCalls;
+		out << std::setprecision(3) << std::setw(11) << 1000 * (stage.putSeconds + stage.flushSeconds);
+		out << std::setw(11) << 1000 * stage.exclusiveSeconds;
+		out << std::setw(12) << stage.maxQueuedBytes;
+		out << std::setprecision(1) << std::setw(12);
+		out << (stage.putCalls + stage.flushCalls ? double(stage.queuedBytes) / (stage.putCalls + stage.flushCalls) : 0.0) << "\n";
+	}
+
+	out << "\nCall sizes in bytes\n";
+	for (size_t i=0; i<stages.size(); ++i)
+	{
+		out << std::left << std::setw(6) << i+1 << std::right;
+		for (unsigned int j=0; j<PipelineStageProfile::SIZE_BUCKETS; ++j)
+		{
+			if (stages[i].callSizes[j] == 0)
+				continue;
+			if (j == 0)
+				out << " 0:";
+			else if (j == 1)
+				out << " 1:";
+			else if (j == PipelineStageProfile::SIZE_BUCKETS-1)
+				out << " " << (word64(1) << (j-1)) << "+:";
+			else
+				out << " " << (word64(1) << (j-1)) << "-" << ((word64(1) << j) - 1) << ":";
+			out << stages[i].callSizes[j];
+		}
+		out << "\n";
+	}
+
+	out.flags(flags);
+	out.precision(precision);
+}
+
+// *************************************************************
+
 void FilterWithBufferedInput::BlockQueue::ResetQueue(size_t blockSize, size_t maxBlocks)
 {
 	m_buffer.New(blockSize * maxBlocks);
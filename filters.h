@@ -22,6 +22,8 @@
 #include "algparam.h"
 #include "stdcpp.h"
 
+#include <iosfwd>
+
 NAMESPACE_BEGIN(CryptoPP)
 
 /// \brief Implementation of BufferedTransformation's attachment interface
@@ -159,6 +161,8 @@ protected:
 	bool OutputMessageSeriesEnd(int outputSite, int propagation, bool blocking, const std::string &channel=DEFAULT_CHANNEL);
 
 private:
+	friend class ProfilingFilter;
+
 	member_ptr<BufferedTransformation> m_attachment;
 
 protected:
@@ -332,6 +336,125 @@ public:
 	OpaqueFilter(BufferedTransformation *attachment=NULLPTR) : MeterFilter(attachment, false) {}
 };
 
+/// \brief Profile of one stage in a filter chain
+/// \details Times are inclusive of the stages that follow. putSeconds and
+///  flushSeconds are wall clock times measured with Timer, and exclusiveSeconds
+///  is the time less the time of the next stage.
+/// \sa ProfilingFilter, ProfilePipeline(), GetPipelineProfile()
+/// \since Crypto++ 8.4
+struct CRYPTOPP_DLL PipelineStageProfile
+{
+	/// \brief Number of call size buckets
+	/// \details Bucket 0 counts empty calls. Bucket <tt>i</tt> counts calls of
+	///  <tt>2<sup>i-1</sup></tt> to <tt>2<sup>i</sup>-1</tt> bytes. The last bucket
+	///  counts all calls of at least <tt>2<sup>31</sup></tt> bytes.
+	CRYPTOPP_CONSTANT(SIZE_BUCKETS = 33);
+
+	PipelineStageProfile();
+
+	/// \brief Name of the stage
+	std::string name;
+	/// \brief Number of Put() calls, including those that only signal MessageEnd()
+	word64 putCalls;
+	/// \brief Number of bytes put
+	word64 putBytes;
+	/// \brief Number of MessageEnd() signals
+	word64 messageEnds;
+	/// \brief Number of Flush() calls
+	word64 flushCalls;
+	/// \brief Time spent in Put() calls, in seconds
+	double putSeconds;
+	/// \brief Time spent in Flush() calls, in seconds
+	double flushSeconds;
+	/// \brief Time spent in this stage only, in seconds
+	double exclusiveSeconds;
+	/// \brief Largest number of bytes held in a FilterWithBufferedInput queue after a call
+	size_t maxQueuedBytes;
+	/// \brief Sum of the bytes held in a FilterWithBufferedInput queue after each call
+	word64 queuedBytes;
+	/// \brief Distribution of the Put() call sizes
+	word64 callSizes[SIZE_BUCKETS];
+};
+
+/// \brief Measures the stage a filter is attached to
+/// \details ProfilingFilter is a transparent filter that counts and times the
+///  calls to its attached transformation. It does not consume MessageEnd(),
+///  Flush() or Initialize() propagation, so it can be inserted anywhere in a
+///  chain. ProfilePipeline() inserts one after each filter in a chain.
+/// \details ProfilingFilter only supports the default channel.
+/// \sa ProfilePipeline(), GetPipelineProfile(), ReportPipelineProfile()
+/// \since Crypto++ 8.4
+class CRYPTOPP_DLL ProfilingFilter : public Bufferless<Filter>
+{
+public:
+	virtual ~ProfilingFilter();
+
+	/// \brief Construct a ProfilingFilter
+	/// \param attachment an optional attached transformation
+	ProfilingFilter(BufferedTransformation *attachment=NULLPTR);
+
+	/// \brief Resets the counters
+	void ResetProfile();
+
+	/// \brief Retrieve the profile of the attached transformation
+	/// \return the counters, with name set and exclusiveSeconds equal to the inclusive time
+	PipelineStageProfile GetProfile() const;
+
+	/// \brief Insert a ProfilingFilter after each filter in a chain
+	/// \param head the first object in the chain
+	/// \details The chain is followed through AttachedTransformation() until
+	///  an object that is not a Filter. Filters that already have a
+	///  ProfilingFilter attached are skipped. The first object is not measured.
+	static void InsertAfterEachFilter(BufferedTransformation &head);
+
+	/// \brief Retrieve the ProfilingFilters in a chain
+	/// \param head the first object in the chain
+	/// \return the ProfilingFilters in order
+	static std::vector<ProfilingFilter *> FindInChain(BufferedTransformation &head);
+
+	// BufferedTransformation in cryptlib.h
+	byte * CreatePutSpace(size_t &size) {return AttachedTransformation()->CreatePutSpace(size);}
+	size_t Put2(const byte *inString, size_t length, int messageEnd, bool blocking);
+	size_t PutModifiable2(byte *inString, size_t length, int messageEnd, bool blocking);
+	void Initialize(const NameValuePairs &parameters=g_nullNameValuePairs, int propagation=-1);
+	bool Flush(bool hardFlush, int propagation=-1, bool blocking=true);
+	bool MessageSeriesEnd(int propagation=-1, bool blocking=true);
+
+private:
+	size_t PutMaybeModifiable(byte *inString, size_t length, int messageEnd, bool blocking, bool modifiable);
+	void SampleQueue();
+
+	// Ticks of Timer, which filters.cpp creates on the stack
+	// so hrtimer.h stays out of this header
+	word64 m_putTicks, m_flushTicks;
+	PipelineStageProfile m_profile;
+};
+
+/// \brief Profile a filter chain
+/// \param head the first object in the chain, usually a Source
+/// \details ProfilePipeline() inserts a ProfilingFilter after each filter in
+///  the chain so the calls into every following stage are counted and timed.
+///  It can be called more than once on the same chain.
+/// \sa GetPipelineProfile(), ReportPipelineProfile()
+/// \since Crypto++ 8.4
+CRYPTOPP_DLL void CRYPTOPP_API ProfilePipeline(BufferedTransformation &head);
+
+/// \brief Retrieve the profile of a filter chain
+/// \param head the first object in the chain passed to ProfilePipeline()
+/// \return a profile for each stage after head, in chain order
+/// \details exclusiveSeconds is set by subtracting the time of the next stage.
+/// \since Crypto++ 8.4
+CRYPTOPP_DLL std::vector<PipelineStageProfile> CRYPTOPP_API GetPipelineProfile(BufferedTransformation &head);
+
+/// \brief Write a report on a filter chain
+/// \param head the first object in the chain passed to ProfilePipeline()
+/// \param out the output stream
+/// \details The report lists the calls, bytes, mean call size, output to input
+///  ratio, times and queued bytes of each stage, followed by the call size
+///  distribution of each stage.
+/// \since Crypto++ 8.4
+CRYPTOPP_DLL void CRYPTOPP_API ReportPipelineProfile(BufferedTransformation &head, std::ostream &out);
+
 /// \brief Divides an input stream into discrete blocks
 /// \details FilterWithBufferedInput divides the input stream into a first block, a number of
 ///  middle blocks, and a last block. First and last blocks are optional, and middle blocks may
@@ -379,6 +502,10 @@ public:
 	///  ForceNextPut() forces a call to NextPut() if this is the case.
 	void ForceNextPut();
 
+	/// \brief Number of bytes waiting in the input queue
+	/// \since Crypto++ 8.4
+	size_t QueuedSize() const {return m_queue.CurrentSize();}
+
 protected:
 	virtual bool DidFirstPut() const {return m_firstInputDone;}
 	virtual size_t GetFirstPutSize() const {return m_firstSize;}
@@ -1432,7 +1559,7 @@ public:
 
 	/// \brief Construct a SourceTemplate
 	/// \param attachment an attached transformation
-	SourceTemplate<T>(BufferedTransformation *attachment)
+	SourceTemplate(BufferedTransformation *attachment)
 		: Source(attachment) {}
 	void IsolatedInitialize(const NameValuePairs &parameters)
 		{m_store.IsolatedInitialize(parameters);}
@@ -51,6 +51,22 @@ NAMESPACE_BEGIN(CryptoPP)
 word16 GCM_Base::s_reductionTable[256];
 volatile bool GCM_Base::s_reductionTableInitialized = false;
 
+// The batch interface encrypts up to s_streamStageBlocks counter blocks per
+// call to the block cipher, and gathers up to s_streamStageBlocks blocks of
+// GHASH input per call to AuthenticateBlocks. Payloads of s_streamDirectSize
+// bytes or more run through the cipher's counter mode kernel by themselves.
+// Messages are processed in groups of about s_streamGroupSize bytes so the
+// ciphertext is still in cache when it is authenticated.
+const size_t s_streamStageBlocks = 64;
+const size_t s_streamDirectSize = 256;
+const size_t s_streamGroupSize = 16*1024;
+
+// Payload blocks of a message that go through the stage
+static inline size_t StagedBlocks(size_t length)
+{
+    return length < s_streamDirectSize ? (length+15)/16 : 0;
+}
+
 void GCM_Base::GCTR::IncrementCounterBy256()
 {
     IncrementCounterByOne(m_counterArray+BlockSize()-4, 3);
@@ -850,6 +866,270 @@ void GCM_Base::AuthenticateLastFooterBlock(byte *mac, size_t macSize)
     m_ctr.ProcessData(mac, HashBuffer(), macSize);
 }
 
+size_t GCM_Base::ThrowIfInvalidStreams(const char *function, size_t macSize, int ivLength, const size_t messageLengths[], size_t count)
+{
+    if (m_state < State_KeySet)
+        throw BadState(AlgorithmName(), function, "key is set");
+
+    ThrowIfInvalidTruncatedSize(macSize);
+    const size_t ivLen = ThrowIfInvalidIVLength(ivLength);
+
+    for (size_t i=0; i<count; ++i)
+    {
+        if (messageLengths[i] > MaxMessageLength())
+            throw InvalidArgument(AlgorithmName() + ": message length exceeds maximum");
+    }
+
+    return ivLen;
+}
+
+// Appends data, zero padded to a whole block, to the stage. Full stages and
+// long runs of data go to AuthenticateBlocks(). Returns the number of bytes
+// left in the stage, which is a multiple of the block size and leaves room
+// for at least one more block.
+size_t GCM_Base::AuthenticatePadded(byte *stage, size_t staged, const byte *data, size_t len)
+{
+    const size_t stageSize = s_streamStageBlocks*HASH_BLOCKSIZE;
+    while (len)
+    {
+        if (staged == 0 && len >= stageSize)
+        {
+            const size_t blocks = RoundDownToMultipleOf(len, (size_t)HASH_BLOCKSIZE);
+            GCM_Base::AuthenticateBlocks(data, blocks);
+            data += blocks; len -= blocks;
+            continue;
+        }
+
+        const size_t n = STDMIN(len, stageSize-staged);
+        memcpy(stage+staged, data, n);
+        data += n; len -= n; staged += n;
+
+        if (staged == stageSize)
+        {
+            GCM_Base::AuthenticateBlocks(stage, stageSize);
+            staged = 0;
+        }
+    }
+
+    const size_t partial = staged % HASH_BLOCKSIZE;
+    if (partial)
+    {
+        memset(stage+staged, 0, HASH_BLOCKSIZE-partial);
+        staged += HASH_BLOCKSIZE-partial;
+        if (staged == stageSize)
+        {
+            GCM_Base::AuthenticateBlocks(stage, stageSize);
+            staged = 0;
+        }
+    }
+
+    return staged;
+}
+
+// J0 for each message, as computed by Resync()
+void GCM_Base::CounterStreams(byte *counters, const byte *const ivs[], size_t ivLength, size_t count)
+{
+    if (ivLength == 12)
+    {
+        for (size_t i=0; i<count; ++i)
+        {
+            byte *counter = counters+i*REQUIRED_BLOCKSIZE;
+            memcpy(counter, ivs[i], 12);
+            memset(counter+12, 0, 3);
+            counter[15] = 1;
+        }
+        return;
+    }
+
+    // The hash buffer belongs to the current message, if any
+    FixedSizeAlignedSecBlock<byte, HASH_BLOCKSIZE> saved;
+    FixedSizeAlignedSecBlock<byte, s_streamStageBlocks*HASH_BLOCKSIZE> stage;
+    memcpy(saved, HashBuffer(), HASH_BLOCKSIZE);
+
+    for (size_t i=0; i<count; ++i)
+    {
+        memset(HashBuffer(), 0, HASH_BLOCKSIZE);
+        size_t staged = AuthenticatePadded(stage, 0, ivs[i], ivLength);
+        PutBlock<word64, BigEndian, true>(NULLPTR, stage+staged)(0)((word64)ivLength*8);
+        GCM_Base::AuthenticateBlocks(stage, staged+HASH_BLOCKSIZE);
+
+        ReverseHashBufferIfNeeded();
+        memcpy(counters+i*REQUIRED_BLOCKSIZE, HashBuffer(), REQUIRED_BLOCKSIZE);
+    }
+
+    memcpy(HashBuffer(), saved, HASH_BLOCKSIZE);
+}
+
+// Block 0 of each message is J0, whose encryption masks the tag. Blocks 1
+// and up are the keystream for the payload. The counter blocks of several
+// messages share each call to the block cipher. Long payloads are left out
+// of the stage and go straight from the input to the output buffer.
+void GCM_Base::CipherStreams(byte *tags, byte *const outStrings[], const byte *const inStrings[], const size_t lengths[],
+    const byte *counters, size_t count)
+{
+    const BlockCipher &cipher = GetBlockCipher();
+    FixedSizeAlignedSecBlock<byte, s_streamStageBlocks*REQUIRED_BLOCKSIZE> blocks, keystream;
+
+    for (size_t m=0; m<count; ++m)
+    {
+        if (lengths[m] < s_streamDirectSize)
+            continue;
+
+        // inc32(J0), and counter mode for the rest. The cipher only
+        // increments the low byte of the counter.
+        const byte *in = inStrings[m];
+        byte *out = outStrings[m], *counter = blocks;
+        word32 ctr = GetWord<word32>(false, BIG_ENDIAN_ORDER, counters+m*REQUIRED_BLOCKSIZE+12)+1;
+        memcpy(counter, counters+m*REQUIRED_BLOCKSIZE, 12);
+        PutWord<word32>(false, BIG_ENDIAN_ORDER, counter+12, ctr);
+
+        size_t remaining = lengths[m]/REQUIRED_BLOCKSIZE;
+        while (remaining)
+        {
+            const size_t n = UnsignedMin(remaining, 256U-counter[REQUIRED_BLOCKSIZE-1]);
+            cipher.AdvancedProcessBlocks(counter, in, out, n*REQUIRED_BLOCKSIZE,
+                BlockTransformation::BT_InBlockIsCounter|BlockTransformation::BT_AllowParallel);
+            ctr += (word32)n;
+            PutWord<word32>(false, BIG_ENDIAN_ORDER, counter+12, ctr);
+            in += n*REQUIRED_BLOCKSIZE; out += n*REQUIRED_BLOCKSIZE; remaining -= n;
+        }
+
+        const size_t tail = lengths[m]%REQUIRED_BLOCKSIZE;
+        if (tail)
+        {
+            cipher.ProcessBlock(counter, keystream);
+            xorbuf(out, in, keystream, tail);
+        }
+    }
+
+    size_t i=0, k=0;
+    while (i < count)
+    {
+        const size_t first = i, start = k;
+        size_t n = 0;
+        for ( ; i < count && n < s_streamStageBlocks; ++n)
+        {
+            const byte *j0 = counters+i*REQUIRED_BLOCKSIZE;
+            byte *block = blocks+n*REQUIRED_BLOCKSIZE;
+            memcpy(block, j0, 12);
+            PutWord<word32>(false, BIG_ENDIAN_ORDER, block+12, GetWord<word32>(false, BIG_ENDIAN_ORDER, j0+12)+(word32)k);
+
+            if (++k > StagedBlocks(lengths[i]))
+                {++i; k=0;}
+        }
+
+        cipher.AdvancedProcessBlocks(blocks, NULLPTR, keystream, n*REQUIRED_BLOCKSIZE, BlockTransformation::BT_AllowParallel);
+
+        // Hand out the keystream, one run per message
+        for (size_t j=0, m=first, b=start; j<n; ++m, b=0)
+        {
+            if (b == 0)
+            {
+                xorbuf(tags+m*REQUIRED_BLOCKSIZE, keystream+j*REQUIRED_BLOCKSIZE, REQUIRED_BLOCKSIZE);
+                ++j; ++b;
+            }
+
+            const size_t run = STDMIN(n-j, StagedBlocks(lengths[m])+1-b);
+            if (run)
+            {
+                const size_t offset = (b-1)*REQUIRED_BLOCKSIZE;
+                xorbuf(outStrings[m]+offset, inStrings[m]+offset, keystream+j*REQUIRED_BLOCKSIZE,
+                    STDMIN(run*REQUIRED_BLOCKSIZE, lengths[m]-offset));
+                j += run;
+            }
+        }
+    }
+}
+
+// GHASH of each message. The AAD, the ciphertext and the length block are
+// gathered so AuthenticateBlocks() sees as many blocks per call as possible.
+void GCM_Base::AuthenticateStreams(byte *tags, const byte *const headers[], const size_t headerLengths[],
+    const byte *const ciphertexts[], const size_t lengths[], size_t count)
+{
+    // The hash buffer belongs to the current message, if any
+    FixedSizeAlignedSecBlock<byte, HASH_BLOCKSIZE> saved;
+    FixedSizeAlignedSecBlock<byte, s_streamStageBlocks*HASH_BLOCKSIZE> stage;
+    memcpy(saved, HashBuffer(), HASH_BLOCKSIZE);
+
+    for (size_t i=0; i<count; ++i)
+    {
+        memset(HashBuffer(), 0, HASH_BLOCKSIZE);
+        size_t staged = AuthenticatePadded(stage, 0, headers[i], headerLengths[i]);
+        staged = AuthenticatePadded(stage, staged, ciphertexts[i], lengths[i]);
+        PutBlock<word64, BigEndian, true>(NULLPTR, stage+staged)((word64)headerLengths[i]*8)((word64)lengths[i]*8);
+        GCM_Base::AuthenticateBlocks(stage, staged+HASH_BLOCKSIZE);
+
+        ReverseHashBufferIfNeeded();
+        xorbuf(tags+i*REQUIRED_BLOCKSIZE, HashBuffer(), REQUIRED_BLOCKSIZE);
+    }
+
+    memcpy(HashBuffer(), saved, HASH_BLOCKSIZE);
+}
+
+void GCM_Base::EncryptAndAuthenticateStreams(byte *const ciphertexts[], byte *const macs[], size_t macSize,
+    const byte *const ivs[], int ivLength, const byte *const headers[], const size_t headerLengths[],
+    const byte *const messages[], const size_t messageLengths[], size_t count)
+{
+    const size_t ivLen = ThrowIfInvalidStreams("EncryptAndAuthenticateStreams", macSize, ivLength, messageLengths, count);
+    if (!count) return;
+
+    SecByteBlock counters(count*REQUIRED_BLOCKSIZE), tags;
+    tags.CleanNew(count*REQUIRED_BLOCKSIZE);
+    CounterStreams(counters, ivs, ivLen, count);
+
+    for (size_t first=0, last=0; first<count; first=last)
+    {
+        size_t total = messageLengths[first];
+        for (last=first+1; last<count && total<s_streamGroupSize && messageLengths[last]<=s_streamGroupSize-total; ++last)
+            total += messageLengths[last];
+
+        // authentication is on the ciphertext, so it comes second
+        CipherStreams(tags+first*REQUIRED_BLOCKSIZE, ciphertexts+first, messages+first,
+            messageLengths+first, counters+first*REQUIRED_BLOCKSIZE, last-first);
+        AuthenticateStreams(tags+first*REQUIRED_BLOCKSIZE, headers+first, headerLengths+first,
+            ciphertexts+first, messageLengths+first, last-first);
+    }
+
+    for (size_t i=0; i<count; ++i)
+        memcpy(macs[i], tags+i*REQUIRED_BLOCKSIZE, macSize);
+}
+
+bool GCM_Base::DecryptAndVerifyStreams(byte *const messages[], bool results[], const byte *const macs[], size_t macSize,
+    const byte *const ivs[], int ivLength, const byte *const headers[], const size_t headerLengths[],
+    const byte *const ciphertexts[], const size_t ciphertextLengths[], size_t count)
+{
+    const size_t ivLen = ThrowIfInvalidStreams("DecryptAndVerifyStreams", macSize, ivLength, ciphertextLengths, count);
+    if (!count) return true;
+
+    SecByteBlock counters(count*REQUIRED_BLOCKSIZE), tags;
+    tags.CleanNew(count*REQUIRED_BLOCKSIZE);
+    CounterStreams(counters, ivs, ivLen, count);
+
+    for (size_t first=0, last=0; first<count; first=last)
+    {
+        size_t total = ciphertextLengths[first];
+        for (last=first+1; last<count && total<s_streamGroupSize && ciphertextLengths[last]<=s_streamGroupSize-total; ++last)
+            total += ciphertextLengths[last];
+
+        // authentication is on the ciphertext, so it comes first for in-place operation
+        AuthenticateStreams(tags+first*REQUIRED_BLOCKSIZE, headers+first, headerLengths+first,
+            ciphertexts+first, ciphertextLengths+first, last-first);
+        CipherStreams(tags+first*REQUIRED_BLOCKSIZE, messages+first, ciphertexts+first,
+            ciphertextLengths+first, counters+first*REQUIRED_BLOCKSIZE, last-first);
+    }
+
+    bool verified = true;
+    for (size_t i=0; i<count; ++i)
+    {
+        const bool result = VerifyBufsEqual(tags+i*REQUIRED_BLOCKSIZE, macs[i], macSize);
+        if (results)
+            results[i] = result;
+        verified = result && verified;
+    }
+
+    return verified;
+}
+
 NAMESPACE_END
 
 #endif    // Not CRYPTOPP_GENERATE_X64_MASM
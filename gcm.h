@@ -63,6 +63,53 @@ public:
 	lword MaxMessageLength() const
 		{return ((W64LIT(1)<<39)-256)/8;}
 
+	/// \brief Encrypt and authenticate independent messages in a batch
+	/// \param ciphertexts array of count buffers that receive the ciphertexts
+	/// \param macs array of count buffers that receive the MACs
+	/// \param macSize the size of each MAC, in bytes
+	/// \param ivs array of count nonces
+	/// \param ivLength the size of each nonce, in bytes
+	/// \param headers array of count AAD buffers
+	/// \param headerLengths array of count AAD lengths, in bytes
+	/// \param messages array of count messages
+	/// \param messageLengths array of count message lengths, in bytes
+	/// \param count the number of messages
+	/// \details EncryptAndAuthenticateStreams() produces the same output as
+	///  calling EncryptAndAuthenticate() for each message under the current
+	///  key. The counter blocks of consecutive messages are packed into one
+	///  call to the block cipher, so short messages still fill the cipher's
+	///  multi-block kernel. The GHASH input of each message, including the
+	///  padding and the length block, is fed to the multiply and reduce
+	///  kernel in as few calls as possible.
+	/// \details The object's current message, if any, is neither used nor
+	///  disturbed. A message may be encrypted in place.
+	/// \since Crypto++ 8.4
+	void EncryptAndAuthenticateStreams(byte *const ciphertexts[], byte *const macs[], size_t macSize,
+		const byte *const ivs[], int ivLength, const byte *const headers[], const size_t headerLengths[],
+		const byte *const messages[], const size_t messageLengths[], size_t count);
+
+	/// \brief Decrypt and verify independent messages in a batch
+	/// \param messages array of count buffers that receive the plaintexts
+	/// \param results array of count verification results, or NULL
+	/// \param macs array of count MACs
+	/// \param macSize the size of each MAC, in bytes
+	/// \param ivs array of count nonces
+	/// \param ivLength the size of each nonce, in bytes
+	/// \param headers array of count AAD buffers
+	/// \param headerLengths array of count AAD lengths, in bytes
+	/// \param ciphertexts array of count ciphertexts
+	/// \param ciphertextLengths array of count ciphertext lengths, in bytes
+	/// \param count the number of messages
+	/// \returns true if every message was verified, false otherwise
+	/// \details DecryptAndVerifyStreams() produces the same output as calling
+	///  DecryptAndVerify() for each message under the current key. The result
+	///  for each message is stored in <tt>results[i]</tt> if results is not NULL.
+	///  Like DecryptAndVerify(), the plaintext is written even if verification fails.
+	/// \since Crypto++ 8.4
+	bool DecryptAndVerifyStreams(byte *const messages[], bool results[], const byte *const macs[], size_t macSize,
+		const byte *const ivs[], int ivLength, const byte *const headers[], const size_t headerLengths[],
+		const byte *const ciphertexts[], const size_t ciphertextLengths[], size_t count);
+
 protected:
 	// AuthenticatedSymmetricCipherBase
 	bool AuthenticationIsOnPlaintext() const
@@ -77,6 +124,14 @@ protected:
 	void AuthenticateLastFooterBlock(byte *mac, size_t macSize);
 	SymmetricCipher & AccessSymmetricCipher() {return m_ctr;}
 
+	size_t ThrowIfInvalidStreams(const char *function, size_t macSize, int ivLength, const size_t messageLengths[], size_t count);
+	size_t AuthenticatePadded(byte *stage, size_t staged, const byte *data, size_t len);
+	void CounterStreams(byte *counters, const byte *const ivs[], size_t ivLength, size_t count);
+	void CipherStreams(byte *tags, byte *const outStrings[], const byte *const inStrings[], const size_t lengths[],
+		const byte *counters, size_t count);
+	void AuthenticateStreams(byte *tags, const byte *const headers[], const size_t headerLengths[],
+		const byte *const ciphertexts[], const size_t lengths[], size_t count);
+
 	virtual BlockCipher & AccessBlockCipher() =0;
 	virtual GCM_TablesOption GetTablesOption() const =0;
 
@@ -112,6 +167,38 @@ public:
 	bool IsForwardTransformation() const
 		{return T_IsEncryption;}
 
+	/// \brief Construct a GCM_Final
+	GCM_Final() {}
+
+	/// \brief Copy a GCM_Final
+	/// \param other the object to copy
+	/// \details The copy holds its own copy of the keyed cipher and the
+	///   multiplication table. Neither is recomputed.
+	/// \since Crypto++ 8.4
+	GCM_Final(const GCM_Final &other)
+		: GCM_Base(other), m_cipher(other.m_cipher) {this->m_ctr.RebindCipher(m_cipher);}
+
+	/// \brief Assign a GCM_Final
+	/// \param other the object to copy
+	/// \since Crypto++ 8.4
+	GCM_Final& operator=(const GCM_Final &other)
+	{
+		GCM_Base::operator=(other);
+		m_cipher = other.m_cipher;
+		this->m_ctr.RebindCipher(m_cipher);
+		return *this;
+	}
+
+	/// \brief Create a copy of this object
+	/// \return a copy of this object
+	/// \details Clone() copies the keyed state, including the expanded key
+	///   and the GHASH multiplication table, rather than recomputing it. A
+	///   keyed object that is no longer modified can be cloned by several
+	///   threads at the same time. The caller is responsible for freeing
+	///   the object.
+	/// \since Crypto++ 8.4
+	Clonable * Clone() const {return static_cast<MessageAuthenticationCode *>(new GCM_Final(*this));}
+
 private:
 	GCM_TablesOption GetTablesOption() const {return T_TablesOption;}
 	BlockCipher & AccessBlockCipher() {return m_cipher;}
@@ -29,6 +29,9 @@ public:
 	Element Zero() const
 		{return 0;}
 
+	Element Identity() const
+		{return 0;}
+
 	Element Add(Element a, Element b) const
 		{return a^b;}
 
@@ -50,6 +53,9 @@ public:
 	Element One() const
 		{return 1;}
 
+	Element MultiplicativeIdentity() const
+		{return 1;}
+
 	Element Multiply(Element a, Element b) const;
 
 	Element Square(Element a) const
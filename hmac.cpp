@@ -5,6 +5,7 @@
 #ifndef CRYPTOPP_IMPORTS
 
 #include "hmac.h"
+#include "instrument.h"
 
 NAMESPACE_BEGIN(CryptoPP)
 
@@ -63,6 +64,7 @@ void HMAC_Base::Restart()
 
 void HMAC_Base::Update(const byte *input, size_t length)
 {
+	InstrumentedCall instrumented(*this, InstrumentedCall::UPDATE, length);
 	if (!m_innerHashKeyed)
 		KeyInnerHash();
 	AccessHash().Update(input, length);
@@ -8,6 +8,8 @@
 
 #include "seckey.h"
 #include "secblock.h"
+#include "iterhash.h"
+#include "misc.h"
 
 NAMESPACE_BEGIN(CryptoPP)
 
@@ -69,12 +71,263 @@ public:
 	std::string AlgorithmName() const {return std::string("HMAC(") + m_hash.AlgorithmName() + ")";}
 	std::string AlgorithmProvider() const {return m_hash.AlgorithmProvider();}
 
+	/// \brief Create a copy of this object
+	/// \return a copy of this object
+	/// \details Clone() copies the keyed state, including the ipad and
+	///   opad blocks and the hash state, rather than rekeying. A keyed object
+	///   that is no longer modified can be cloned by several threads at the
+	///   same time. The caller is responsible for freeing the object.
+	/// \since Crypto++ 8.4
+	Clonable * Clone() const {return new HMAC(*this);}
+
 private:
 	HashTransformation & AccessHash() {return m_hash;}
 
 	T m_hash;
 };
 
+/// \brief Determines if a hash can be used with HMAC_KeyState
+/// \tparam T HashTransformation derived class
+/// \details HMAC_KeyStateTraits<T>::SUPPORTED is 1 if T derives from
+///   IteratedHashWithStaticTransform and its digest plus padding fits in
+///   one block, and 0 otherwise.
+/// \since Crypto++ 8.4
+template <class T>
+struct HMAC_KeyStateTraits
+{
+	template <class W, class E, unsigned int B, unsigned int S, class X, unsigned int D, bool A>
+	static char (&Check(const IteratedHashWithStaticTransform<W,E,B,S,X,D,A> *))[((D ? D : S)+1+2*sizeof(W) <= B) ? 2 : 1];
+	static char Check(...);
+
+	CRYPTOPP_CONSTANT(SUPPORTED = (sizeof(Check(static_cast<T *>(NULLPTR))) == 2));
+};
+
+/// \brief HMAC with precomputed inner and outer states
+/// \tparam T IteratedHashWithStaticTransform derived class, like SHA256
+/// \details HMAC_KeyState runs the compression function over the
+///   <tt>K XOR ipad</tt> and <tt>K XOR opad</tt> blocks once, when the key
+///   is set. A message then costs its own compression calls plus one call
+///   for the outer hash. The static transform of T is called directly, without
+///   the buffering and virtual calls of HashTransformation.
+/// \details Iterate() feeds the HMAC its own output, which is the inner loop
+///   of PBKDF2. Each iteration is exactly two calls to the compression function
+///   on word arrays which are padded once.
+/// \details T must use the padding of IteratedHashBase, and its digest plus
+///   padding must fit in one block. This covers MD5, RIPEMD, SHA-1, SHA-2 and
+///   SM3. Available() checks the padding against HMAC<T> at runtime.
+/// \since Crypto++ 8.4
+template <class T>
+class HMAC_KeyState
+{
+public:
+	typedef typename T::HashWordType HashWordType;
+	CRYPTOPP_CONSTANT(DIGESTSIZE=T::DIGESTSIZE);
+	CRYPTOPP_CONSTANT(BLOCKSIZE=T::BLOCKSIZE);
+
+	/// \brief Construct a HMAC_KeyState
+	HMAC_KeyState() {}
+	/// \brief Construct a HMAC_KeyState
+	/// \param key the HMAC key
+	/// \param length the size of the HMAC key
+	HMAC_KeyState(const byte *key, size_t length) {SetKey(key, length);}
+
+	/// \brief Sets the key
+	/// \param key the HMAC key
+	/// \param length the size of the HMAC key
+	/// \details SetKey() computes the inner and outer states.
+	void SetKey(const byte *key, size_t length);
+
+	/// \brief Computes the HMAC of a message
+	/// \param digest the output buffer, DIGESTSIZE bytes
+	/// \param input the message
+	/// \param length the size of the message, in bytes
+	void CalculateDigest(byte *digest, const byte *input, size_t length) const;
+
+	/// \brief Computes the HMAC of its own output
+	/// \param digest the previous output on input, the last output on return, DIGESTSIZE bytes
+	/// \param accumulator the running XOR of the outputs, DIGESTSIZE bytes
+	/// \param count the number of iterations
+	/// \details Iterate() sets <tt>digest = HMAC(K, digest)</tt> and
+	///   <tt>accumulator ^= digest</tt>, count times.
+	void Iterate(byte *digest, byte *accumulator, unsigned int count) const;
+
+	/// \brief Determines if HMAC_KeyState agrees with HMAC<T>
+	/// \return true if the padding of T is compatible, false otherwise
+	/// \details Available() runs a known answer test against HMAC<T> the first
+	///   time it is called and caches the result.
+	static bool Available();
+
+private:
+	CRYPTOPP_COMPILE_ASSERT(DIGESTSIZE + 1 + 2*sizeof(HashWordType) <= BLOCKSIZE);
+	CRYPTOPP_CONSTANT(WORDS=BLOCKSIZE/sizeof(HashWordType));
+	CRYPTOPP_CONSTANT(DIGESTWORDS=DIGESTSIZE/sizeof(HashWordType));
+	typedef FixedSizeAlignedSecBlock<HashWordType, WORDS, true> Block;
+
+	static ByteOrder Order() {return T::ByteOrderClass::ToEnum();}
+	static void SetLength(HashWordType *block, lword length);
+	static void PadDigest(HashWordType *block);
+	static bool SelfTest();
+
+	Block m_inner, m_outer;
+};
+
+template <class T>
+void HMAC_KeyState<T>::SetLength(HashWordType *block, lword length)
+{
+	// The bit count is stored like IteratedHashBase::TruncatedFinal, in
+	// the last two words of the endian corrected block
+	const lword bits = length * 8;
+	const HashWordType lo = static_cast<HashWordType>(bits);
+	const HashWordType hi = (sizeof(HashWordType) == 8) ? 0 : static_cast<HashWordType>(bits >> 32);
+	const unsigned int order = (Order() == BIG_ENDIAN_ORDER) ? 1 : 0;
+	block[WORDS-2+order] = lo;
+	block[WORDS-1-order] = hi;
+}
+
+template <class T>
+void HMAC_KeyState<T>::PadDigest(HashWordType *block)
+{
+	// A digest sized message followed by 0x80, zeros and the length
+	const HashWordType pad = (Order() == BIG_ENDIAN_ORDER) ?
+		HashWordType(HashWordType(0x80) << (8*(sizeof(HashWordType)-1))) : HashWordType(0x80);
+	block[DIGESTWORDS] = pad;
+	for (unsigned int i=DIGESTWORDS+1; i<WORDS; ++i)
+		block[i] = 0;
+	SetLength(block, BLOCKSIZE+DIGESTSIZE);
+}
+
+template <class T>
+void HMAC_KeyState<T>::SetKey(const byte *key, size_t length)
+{
+	FixedSizeSecBlock<byte, BLOCKSIZE> ipad, opad;
+	std::memset(ipad, 0, BLOCKSIZE);
+
+	if (length > BLOCKSIZE)
+		T().CalculateDigest(ipad, key, length);
+	else if (length)
+		std::memcpy(ipad, key, length);
+
+	for (unsigned int i=0; i<BLOCKSIZE; i++)
+	{
+		opad[i] = ipad[i] ^ 0x5c;
+		ipad[i] ^= 0x36;
+	}
+
+	Block data;
+	T::InitState(m_inner);
+	ConditionalByteReverse(Order(), data.data(), reinterpret_cast<const HashWordType *>(ipad.data()), BLOCKSIZE);
+	T::Transform(m_inner, data);
+
+	T::InitState(m_outer);
+	ConditionalByteReverse(Order(), data.data(), reinterpret_cast<const HashWordType *>(opad.data()), BLOCKSIZE);
+	T::Transform(m_outer, data);
+}
+
+template <class T>
+void HMAC_KeyState<T>::CalculateDigest(byte *digest, const byte *input, size_t length) const
+{
+	Block state, data;
+	std::memcpy(state, m_inner, BLOCKSIZE);
+	byte *buf = reinterpret_cast<byte *>(data.data());
+	const lword total = lword(BLOCKSIZE) + length;
+
+	while (length >= BLOCKSIZE)
+	{
+		std::memcpy(buf, input, BLOCKSIZE);
+		ConditionalByteReverse(Order(), data.data(), data.data(), BLOCKSIZE);
+		T::Transform(state, data);
+		input += BLOCKSIZE; length -= BLOCKSIZE;
+	}
+
+	const size_t last = BLOCKSIZE - 2*sizeof(HashWordType);
+	if (length)
+		std::memcpy(buf, input, length);
+	buf[length++] = 0x80;
+
+	if (length > last)
+	{
+		std::memset(buf+length, 0, BLOCKSIZE-length);
+		ConditionalByteReverse(Order(), data.data(), data.data(), BLOCKSIZE);
+		T::Transform(state, data);
+		length = 0;
+	}
+
+	std::memset(buf+length, 0, BLOCKSIZE-length);
+	ConditionalByteReverse(Order(), data.data(), data.data(), BLOCKSIZE);
+	SetLength(data, total);
+	T::Transform(state, data);
+
+	// The inner digest is already in the word order of the outer block
+	std::memcpy(data, state, DIGESTSIZE);
+	PadDigest(data);
+	std::memcpy(state, m_outer, BLOCKSIZE);
+	T::Transform(state, data);
+
+	ConditionalByteReverse(Order(), state.data(), state.data(), DIGESTSIZE);
+	std::memcpy(digest, state, DIGESTSIZE);
+}
+
+template <class T>
+void HMAC_KeyState<T>::Iterate(byte *digest, byte *accumulator, unsigned int count) const
+{
+	Block state, inner, outer, acc;
+	std::memcpy(inner, digest, DIGESTSIZE);
+	ConditionalByteReverse(Order(), inner.data(), inner.data(), DIGESTSIZE);
+	std::memcpy(acc, accumulator, DIGESTSIZE);
+	ConditionalByteReverse(Order(), acc.data(), acc.data(), DIGESTSIZE);
+	PadDigest(inner);
+	PadDigest(outer);
+
+	for (unsigned int i=0; i<count; ++i)
+	{
+		std::memcpy(state, m_inner, BLOCKSIZE);
+		T::Transform(state, inner);
+		std::memcpy(outer, state, DIGESTSIZE);
+
+		std::memcpy(state, m_outer, BLOCKSIZE);
+		T::Transform(state, outer);
+		std::memcpy(inner, state, DIGESTSIZE);
+
+		for (unsigned int j=0; j<DIGESTWORDS; ++j)
+			acc[j] ^= state[j];
+	}
+
+	ConditionalByteReverse(Order(), inner.data(), inner.data(), DIGESTSIZE);
+	std::memcpy(digest, inner, DIGESTSIZE);
+	ConditionalByteReverse(Order(), acc.data(), acc.data(), DIGESTSIZE);
+	std::memcpy(accumulator, acc, DIGESTSIZE);
+}
+
+template <class T>
+bool HMAC_KeyState<T>::SelfTest()
+{
+	// A digest sized message and a key longer than a block take
+	// the same padding paths as PBKDF2
+	FixedSizeSecBlock<byte, BLOCKSIZE+1> key;
+	for (unsigned int i=0; i<key.size(); ++i)
+		key[i] = static_cast<byte>(i);
+
+	FixedSizeSecBlock<byte, DIGESTSIZE> expected, calculated, acc;
+	HMAC<T> mac(key, key.size());
+	mac.CalculateDigest(expected, key, DIGESTSIZE);
+	mac.CalculateDigest(expected, expected, DIGESTSIZE);
+
+	HMAC_KeyState<T> state(key, key.size());
+	state.CalculateDigest(calculated, key, DIGESTSIZE);
+	std::memset(acc, 0, DIGESTSIZE);
+	state.Iterate(calculated, acc, 1);
+
+	return VerifyBufsEqual(expected, calculated, DIGESTSIZE) &&
+		VerifyBufsEqual(expected, acc, DIGESTSIZE);
+}
+
+template <class T>
+bool HMAC_KeyState<T>::Available()
+{
+	static const bool available = SelfTest();
+	return available;
+}
+
 NAMESPACE_END
 
 #endif
@@ -8,9 +8,70 @@
 #include "algebra.h"
 #include "polynomi.h"
 #include "polynomi.cpp"
+#include "cpu.h"
 
 NAMESPACE_BEGIN(CryptoPP)
 
+#if (CRYPTOPP_AVX2_AVAILABLE)
+extern size_t GF256Combine_AVX2(byte *const *outputs, const byte *const *tables, unsigned int nOutputs,
+	const byte *const *inputs, unsigned int nInputs, size_t length);
+#endif
+
+#if (CRYPTOPP_SSSE3_AVAILABLE)
+extern size_t GF256Combine_SSSE3(byte *const *outputs, const byte *const *tables, unsigned int nOutputs,
+	const byte *const *inputs, unsigned int nInputs, size_t processed, size_t length);
+#endif
+
+#if (CRYPTOPP_ARM_NEON_AVAILABLE)
+extern size_t GF256Combine_NEON(byte *const *outputs, const byte *const *tables, unsigned int nOutputs,
+	const byte *const *inputs, unsigned int nInputs, size_t length);
+#endif
+
+ANONYMOUS_NAMESPACE_BEGIN
+
+// Bytes of each channel processed at a time in GF(2^8)
+const size_t STRIPE_SIZE = 2048;
+
+// Each output is the sum of the inputs multiplied by its coefficients.
+// The tables of an output have 32 bytes for each input. The first 16
+// bytes are the products of the low nibble and the last 16 bytes are
+// the products of the high nibble.
+void GF256Combine(byte *const *outputs, const byte *const *tables, unsigned int nOutputs,
+	const byte *const *inputs, unsigned int nInputs, size_t length)
+{
+	size_t processed = 0;
+#if (CRYPTOPP_AVX2_AVAILABLE)
+	// 32 bytes at a time. The SSSE3 kernel takes a 16 byte remainder.
+	if (HasAVX2())
+		processed = GF256Combine_AVX2(outputs, tables, nOutputs, inputs, nInputs, length);
+#endif
+#if (CRYPTOPP_SSSE3_AVAILABLE)
+	if (HasSSSE3())
+		processed = GF256Combine_SSSE3(outputs, tables, nOutputs, inputs, nInputs, processed, length);
+	else
+#endif
+#if (CRYPTOPP_ARM_NEON_AVAILABLE)
+	if (HasNEON())
+		processed = GF256Combine_NEON(outputs, tables, nOutputs, inputs, nInputs, length);
+	else
+#endif
+	{}
+
+	for (unsigned int i=0; i<nOutputs; i++)
+	{
+		for (size_t k=processed; k<length; k++)
+		{
+			const byte *table = tables[i];
+			byte sum = 0;
+			for (unsigned int j=0; j<nInputs; j++, table += 32)
+				sum ^= table[inputs[j][k] & 15] ^ table[16 + (inputs[j][k] >> 4)];
+			outputs[i][k] = sum;
+		}
+	}
+}
+
+ANONYMOUS_NAMESPACE_END
+
 #if (defined(_MSC_VER) && (_MSC_VER < 1400)) && !defined(__MWERKS__)
 	// VC60 and VC7 workaround: built-in reverse_iterator has two template parameters, Dinkumware only has one
 	typedef std::reverse_bidirectional_iterator<const byte *, const byte> RevIt;
@@ -29,6 +90,14 @@ void RawIDA::IsolatedInitialize(const NameValuePairs &parameters)
 	if (m_threshold <= 0)
 		throw InvalidArgument("RawIDA: RecoveryThreshold must be greater than 0");
 
+	int field = parameters.GetIntValueWithDefault("Field", FIELD_GF2_32);
+	if (field != FIELD_GF2_32 && field != FIELD_GF2_8)
+		throw InvalidArgument("RawIDA: Field must be FIELD_GF2_32 or FIELD_GF2_8");
+	m_field = Field(field);
+
+	if (m_field == FIELD_GF2_8 && m_threshold > 256)
+		throw InvalidArgument("RawIDA: RecoveryThreshold must be 256 or less in GF(2^8)");
+
 	m_lastMapPosition = m_inputChannelMap.end();
 	m_channelsReady = 0;
 	m_channelsFinished = 0;
@@ -70,6 +139,8 @@ skipFind:
 	{
 		if (m_inputChannelIds.size() == size_t(m_threshold))
 			return m_threshold;
+		if (m_field == FIELD_GF2_8 && channelId > 255)
+			throw InvalidArgument("RawIDA: channel ID must be less than 256 in GF(2^8)");
 
 		m_lastMapPosition = m_inputChannelMap.insert(InputChannelMap::value_type(channelId, (unsigned int)m_inputChannelIds.size())).first;
 		m_inputQueues.push_back(MessageQueue());
@@ -95,9 +166,10 @@ void RawIDA::ChannelData(word32 channelId, const byte *inString, size_t length,
 	int i = InsertInputChannel(channelId);
 	if (i < m_threshold)
 	{
+		const unsigned int wordSize = WordSize();
 		lword size = m_inputQueues[i].MaxRetrievable();
 		m_inputQueues[i].Put(inString, length);
-		if (size < 4 && size + length >= 4)
+		if (size < wordSize && size + length >= wordSize)
 		{
 			m_channelsReady++;
 			if (m_channelsReady == size_t(m_threshold))
@@ -133,11 +205,31 @@ void RawIDA::ComputeV(unsigned int i)
 	if (i >= m_v.size())
 	{
 		m_v.resize(i+1);
+		m_tables.resize(i+1);
 		m_outputToInput.resize(i+1);
 	}
 
 	m_outputToInput[i] = LookupInputChannel(m_outputChannelIds[i]);
-	if (m_outputToInput[i] == size_t(m_threshold) && i * size_t(m_threshold) <= 1000*1000)
+	if (m_field == FIELD_GF2_8)
+	{
+		if (m_outputToInput[i] == size_t(m_threshold))
+		{
+			SecByteBlock v(m_threshold);
+			PrepareBulkPolynomialInterpolationAt(m_gf8, v.begin(), byte(m_outputChannelIds[i]), m_x8.begin(), m_w8.begin(), m_threshold);
+
+			// Split nibble tables of the coefficients for GF256Combine()
+			m_tables[i].New(32*m_threshold);
+			for (unsigned int j=0; j<(unsigned int)m_threshold; j++)
+			{
+				for (unsigned int k=0; k<16; k++)
+				{
+					m_tables[i][32*j+k] = m_gf8.Multiply(v[j], byte(k));
+					m_tables[i][32*j+16+k] = m_gf8.Multiply(v[j], byte(k << 4));
+				}
+			}
+		}
+	}
+	else if (m_outputToInput[i] == size_t(m_threshold) && i * size_t(m_threshold) <= 1000*1000)
 	{
 		m_v[i].resize(m_threshold);
 		PrepareBulkPolynomialInterpolationAt(m_gf32, m_v[i].begin(), m_outputChannelIds[i], &(m_inputChannelIds[0]), m_w.begin(), m_threshold);
@@ -146,6 +238,9 @@ void RawIDA::ComputeV(unsigned int i)
 
 void RawIDA::AddOutputChannel(word32 channelId)
 {
+	if (m_field == FIELD_GF2_8 && channelId > 255)
+		throw InvalidArgument("RawIDA: channel ID must be less than 256 in GF(2^8)");
+
 	m_outputChannelIds.push_back(channelId);
 	m_outputChannelIdStrings.push_back(WordToString(channelId));
 	m_outputQueues.push_back(ByteQueue());
@@ -156,7 +251,16 @@ void RawIDA::AddOutputChannel(word32 channelId)
 void RawIDA::PrepareInterpolation()
 {
 	CRYPTOPP_ASSERT(m_inputChannelIds.size() == size_t(m_threshold));
-	PrepareBulkPolynomialInterpolation(m_gf32, m_w.begin(), &(m_inputChannelIds[0]), (unsigned int)(m_threshold));
+	if (m_field == FIELD_GF2_8)
+	{
+		m_x8.New(m_threshold);
+		m_w8.New(m_threshold);
+		for (unsigned int i=0; i<(unsigned int)m_threshold; i++)
+			m_x8[i] = byte(m_inputChannelIds[i]);
+		PrepareBulkPolynomialInterpolation(m_gf8, m_w8.begin(), m_x8.begin(), (unsigned int)(m_threshold));
+	}
+	else
+		PrepareBulkPolynomialInterpolation(m_gf32, m_w.begin(), &(m_inputChannelIds[0]), (unsigned int)(m_threshold));
 	for (unsigned int i=0; i<m_outputChannelIds.size(); i++)
 		ComputeV(i);
 }
@@ -166,6 +270,10 @@ void RawIDA::ProcessInputQueues()
 	bool finished = (m_channelsFinished == size_t(m_threshold));
 	unsigned int i;
 
+	// Leaves m_channelsReady below the threshold, so the loop below does not run
+	if (m_field == FIELD_GF2_8)
+		ProcessStripes(finished);
+
 	while (finished ? m_channelsReady > 0 : m_channelsReady == size_t(m_threshold))
 	{
 		m_channelsReady = 0;
@@ -205,6 +313,7 @@ void RawIDA::ProcessInputQueues()
 		m_channelsReady = 0;
 		m_channelsFinished = 0;
 		m_v.clear();
+		m_tables.clear();
 
 		std::vector<MessageQueue> inputQueues;
 		std::vector<word32> inputChannelIds;
@@ -222,6 +331,79 @@ void RawIDA::ProcessInputQueues()
 	}
 }
 
+void RawIDA::ProcessStripes(bool finished)
+{
+	const unsigned int threshold = (unsigned int)m_threshold;
+	const unsigned int outputs = (unsigned int)m_outputChannelIds.size();
+	unsigned int i;
+
+	// Rows ready in every channel. A channel whose message ended supplies zeros, like GetWord32().
+	lword rows = finished ? 0 : LWORD_MAX;
+	for (i=0; i<threshold; i++)
+	{
+		const MessageQueue &queue = m_inputQueues[i];
+		if (finished)
+			rows = STDMAX(rows, queue.MaxRetrievable());
+		else if (queue.NumberOfMessages() == 0)
+			rows = STDMIN(rows, queue.MaxRetrievable());
+	}
+	CRYPTOPP_ASSERT(rows != LWORD_MAX);
+
+	// The stripes of the inputs are followed by the stripes of the computed outputs
+	std::vector<unsigned int> computed;
+	for (i=0; i<outputs; i++)
+	{
+		if (m_outputToInput[i] == threshold)
+			computed.push_back(i);
+	}
+
+	const unsigned int nComputed = (unsigned int)computed.size();
+	m_stripes.New(STRIPE_SIZE*(threshold+nComputed));
+
+	std::vector<const byte *> inputStripes(threshold), tables(nComputed+1);
+	std::vector<byte *> outputStripes(nComputed+1);
+	for (i=0; i<threshold; i++)
+		inputStripes[i] = m_stripes+STRIPE_SIZE*i;
+	for (i=0; i<nComputed; i++)
+	{
+		outputStripes[i] = m_stripes+STRIPE_SIZE*(threshold+i);
+		tables[i] = m_tables[computed[i]];
+	}
+
+	while (rows > 0)
+	{
+		const size_t length = (size_t)STDMIN(rows, lword(STRIPE_SIZE));
+		for (i=0; i<threshold; i++)
+		{
+			byte *stripe = m_stripes+STRIPE_SIZE*i;
+			const size_t size = m_inputQueues[i].Get(stripe, length);
+			std::memset(stripe+size, 0, length-size);
+		}
+
+		GF256Combine(&outputStripes[0], &tables[0], nComputed, &inputStripes[0], threshold, length);
+
+		for (i=0; i<outputs; i++)
+		{
+			if (m_outputToInput[i] != threshold)
+				m_outputQueues[i].Put(inputStripes[m_outputToInput[i]], length);
+		}
+		for (i=0; i<nComputed; i++)
+			m_outputQueues[computed[i]].Put(outputStripes[i], length);
+
+		rows -= length;
+	}
+
+	m_channelsReady = 0;
+	for (i=0; i<threshold; i++)
+	{
+		const MessageQueue &queue = m_inputQueues[i];
+		if (finished)
+			m_channelsReady += queue.AnyRetrievable();
+		else
+			m_channelsReady += queue.NumberOfMessages() > 0 || queue.AnyRetrievable();
+	}
+}
+
 void RawIDA::FlushOutputQueues()
 {
 	for (unsigned int i=0; i<m_outputChannelIds.size(); i++)
@@ -322,13 +504,22 @@ size_t InformationDispersal::Put2(const byte *begin, size_t length, int messageE
 	if (!blocking)
 		throw BlockingInputOnly("InformationDispersal");
 
-	while (length--)
+	const unsigned int threshold = m_ida.GetThreshold();
+	SecByteBlock buf(length ? UnsignedMin(4096, (length+threshold-1)/threshold) : 0);
+	while (length > 0)
 	{
-		m_ida.ChannelData(m_nextChannel, begin, 1, false);
-		begin++;
-		m_nextChannel++;
-		if (m_nextChannel == m_ida.GetThreshold())
-			m_nextChannel = 0;
+		// Deals the bytes to the channels, one channel at a time
+		size_t len = STDMIN(length, buf.size()*threshold);
+		for (unsigned int i=0; i<threshold && i<len; i++)
+		{
+			size_t count = 0;
+			for (size_t j=i; j<len; j+=threshold)
+				buf[count++] = begin[j];
+			m_ida.ChannelData((m_nextChannel+i) % threshold, buf, count, false);
+		}
+		m_nextChannel = (unsigned int)((m_nextChannel+len) % threshold);
+		length -= len;
+		begin += len;
 	}
 
 	if (messageEnd)
@@ -351,14 +542,26 @@ void InformationRecovery::IsolatedInitialize(const NameValuePairs &parameters)
 
 void InformationRecovery::FlushOutputQueues()
 {
-	while (m_outputQueues[0].AnyRetrievable())
+	// Interleaves the output queues, which have the same size
+	const size_t count = m_outputChannelIds.size();
+	lword size = m_outputQueues[0].MaxRetrievable();
+	SecByteBlock column(size ? (size_t)STDMIN(size, lword(4096)) : 0), rows(column.size()*count);
+	while (size > 0)
 	{
-		for (unsigned int i=0; i<m_outputChannelIds.size(); i++)
-			m_outputQueues[i].TransferTo(m_queue, 1);
+		size_t len = (size_t)STDMIN(size, lword(column.size()));
+		for (size_t i=0; i<count; i++)
+		{
+			CRYPTOPP_ASSERT(m_outputQueues[i].MaxRetrievable() >= len);
+			m_outputQueues[i].Get(column, len);
+			for (size_t j=0; j<len; j++)
+				rows[j*count+i] = column[j];
+		}
+		m_queue.Put(rows, len*count);
+		size -= len;
 	}
 
 	if (m_pad)
-		m_queue.TransferTo(*AttachedTransformation(), m_queue.MaxRetrievable()-4*m_threshold);
+		m_queue.TransferTo(*AttachedTransformation(), m_queue.MaxRetrievable()-WordSize()*m_threshold);
 	else
 		m_queue.TransferTo(*AttachedTransformation());
 }
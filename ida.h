@@ -12,6 +12,7 @@
 #include "channels.h"
 #include "secblock.h"
 #include "gf2_32.h"
+#include "gf256.h"
 #include "stdcpp.h"
 #include "misc.h"
 
@@ -22,11 +23,27 @@ NAMESPACE_BEGIN(CryptoPP)
 class RawIDA : public AutoSignaling<Unflushable<Multichannel<Filter> > >
 {
 public:
+	/// \brief Finite field of the dispersal
+	/// \details The field is selected with the <tt>"Field"</tt> parameter. Shares
+	///  made in one field can only be recovered in the same field.
+	/// \since Crypto++ 8.4
+	enum Field {
+		/// \brief GF(2<sup>32</sup>), which processes 4 bytes of each channel at a time
+		FIELD_GF2_32 = 32,
+		/// \brief GF(2<sup>8</sup>), which processes stripes of each channel at a time
+		/// \details GF(2<sup>8</sup>) is a Reed-Solomon style code. Stripes are encoded
+		///  and decoded with SSSE3, AVX2 or NEON when available. Channel IDs must be
+		///  less than 256.
+		FIELD_GF2_8 = 8
+	};
+
 	RawIDA(BufferedTransformation *attachment=NULLPTR)
-		: m_channelsReady(0), m_channelsFinished(0), m_threshold (0)
+		: m_gf8(0x1d), m_channelsReady(0), m_channelsFinished(0), m_threshold (0)
+		, m_field(FIELD_GF2_32)
 			{Detach(attachment);}
 
 	unsigned int GetThreshold() const {return m_threshold;}
+	Field GetField() const {return m_field;}
 	void AddOutputChannel(word32 channelId);
 	void ChannelData(word32 channelId, const byte *inString, size_t length, bool messageEnd);
 	lword InputBuffered(word32 channelId) const;
@@ -49,6 +66,8 @@ protected:
 	void ComputeV(unsigned int);
 	void PrepareInterpolation();
 	void ProcessInputQueues();
+	void ProcessStripes(bool finished);
+	unsigned int WordSize() const {return m_field == FIELD_GF2_8 ? 1 : 4;}
 
 	typedef std::map<word32, unsigned int> InputChannelMap;
 	InputChannelMap m_inputChannelMap;
@@ -59,9 +78,13 @@ protected:
 	std::vector<ByteQueue> m_outputQueues;
 	std::vector<SecBlock<word32> > m_v;
 	SecBlock<word32> m_u, m_w, m_y;
+	std::vector<SecByteBlock> m_tables;
+	SecByteBlock m_x8, m_w8, m_stripes;
 	const GF2_32 m_gf32;
+	const GF256 m_gf8;
 	unsigned int m_channelsReady, m_channelsFinished;
 	int m_threshold;
+	Field m_field;
 };
 
 /// \brief Shamir's Secret Sharing Algorithm
@@ -120,11 +143,17 @@ class InformationDispersal : public CustomFlushPropagation<Filter>
 {
 public:
 	/// \brief Construct a InformationDispersal
-	InformationDispersal(int threshold, int nShares, BufferedTransformation *attachment=NULLPTR, bool addPadding=true)
+	/// \param threshold the number of shares needed to recover the message
+	/// \param nShares the number of shares
+	/// \param attachment a BufferedTransformation to attach to this object
+	/// \param addPadding flag indicating whether to pad the message
+	/// \param field the finite field of the dispersal
+	/// \details FIELD_GF2_8 allows at most 256 shares. The recovery must use the same field.
+	InformationDispersal(int threshold, int nShares, BufferedTransformation *attachment=NULLPTR, bool addPadding=true, RawIDA::Field field=RawIDA::FIELD_GF2_32)
 		: m_ida(new OutputProxy(*this, true)), m_pad(false), m_nextChannel(0)
 	{
 		Detach(attachment);
-		IsolatedInitialize(MakeParameters("RecoveryThreshold", threshold)("NumberOfShares", nShares)("AddPadding", addPadding));
+		IsolatedInitialize(MakeParameters("RecoveryThreshold", threshold)("NumberOfShares", nShares)("AddPadding", addPadding)("Field", int(field)));
 	}
 
 	void IsolatedInitialize(const NameValuePairs &parameters=g_nullNameValuePairs);
@@ -145,9 +174,13 @@ class InformationRecovery : public RawIDA
 {
 public:
 	/// \brief Construct a InformationRecovery
-	InformationRecovery(int threshold, BufferedTransformation *attachment=NULLPTR, bool removePadding=true)
+	/// \param threshold the number of shares needed to recover the message
+	/// \param attachment a BufferedTransformation to attach to this object
+	/// \param removePadding flag indicating whether to remove the padding
+	/// \param field the finite field of the dispersal
+	InformationRecovery(int threshold, BufferedTransformation *attachment=NULLPTR, bool removePadding=true, RawIDA::Field field=RawIDA::FIELD_GF2_32)
 		: RawIDA(attachment), m_pad(false)
-		{IsolatedInitialize(MakeParameters("RecoveryThreshold", threshold)("RemovePadding", removePadding));}
+		{IsolatedInitialize(MakeParameters("RecoveryThreshold", threshold)("RemovePadding", removePadding)("Field", int(field)));}
 
 	void IsolatedInitialize(const NameValuePairs &parameters=g_nullNameValuePairs);
 
@@ -0,0 +1,66 @@
+// ida_avx.cpp - written and placed in the public domain by the Crypto++ project.
+//
+//    This source file uses intrinsics to gain access to AVX2
+//    instructions. A separate source file is needed because
+//    additional CXXFLAGS are required to enable the appropriate
+//    instructions sets in some build configurations.
+//
+//    The kernel is the SSSE3 kernel in ida_simd.cpp with two
+//    128-bit lanes. Both lanes use the same nibble tables.
+
+#include "pch.h"
+#include "config.h"
+#include "misc.h"
+
+#if defined(CRYPTOPP_AVX2_AVAILABLE)
+# include <xmmintrin.h>
+# include <emmintrin.h>
+# include <immintrin.h>
+#endif
+
+// Squash MS LNK4221 and libtool warnings
+extern const char IDA_AVX_FNAME[] = __FILE__;
+
+// Clang intrinsic casts, http://bugs.llvm.org/show_bug.cgi?id=20670
+#define CONST_M128_CAST(x) ((const __m128i *)(const void *)(x))
+#define M256_CAST(x) ((__m256i *)(void *)(x))
+#define CONST_M256_CAST(x) ((const __m256i *)(const void *)(x))
+
+NAMESPACE_BEGIN(CryptoPP)
+
+#if (CRYPTOPP_AVX2_AVAILABLE)
+
+size_t GF256Combine_AVX2(byte *const *outputs, const byte *const *tables, unsigned int nOutputs,
+	const byte *const *inputs, unsigned int nInputs, size_t length)
+{
+	const __m256i mask = _mm256_set1_epi8(0x0f);
+	size_t processed = 0;
+
+	// Each output is computed from all the inputs before moving on
+	for (; length - processed >= 32; processed += 32)
+	{
+		for (unsigned int i=0; i<nOutputs; i++)
+		{
+			const byte *table = tables[i];
+			__m256i acc = _mm256_setzero_si256();
+			for (unsigned int j=0; j<nInputs; j++, table += 32)
+			{
+				const __m256i x = _mm256_loadu_si256(CONST_M256_CAST(inputs[j]+processed));
+				const __m256i lo = _mm256_broadcastsi128_si256(_mm_loadu_si128(CONST_M128_CAST(table+ 0)));
+				const __m256i hi = _mm256_broadcastsi128_si256(_mm_loadu_si128(CONST_M128_CAST(table+16)));
+				acc = _mm256_xor_si256(acc, _mm256_xor_si256(
+					_mm256_shuffle_epi8(lo, _mm256_and_si256(x, mask)),
+					_mm256_shuffle_epi8(hi, _mm256_and_si256(_mm256_srli_epi16(x, 4), mask))));
+			}
+			_mm256_storeu_si256(M256_CAST(outputs[i]+processed), acc);
+		}
+	}
+
+	// Avoid AVX to SSE transition penalties
+	_mm256_zeroupper();
+	return processed;
+}
+
+#endif  // CRYPTOPP_AVX2_AVAILABLE
+
+NAMESPACE_END
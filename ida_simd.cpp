@@ -0,0 +1,110 @@
+// ida_simd.cpp - written and placed in the public domain by the Crypto++ project.
+//
+//    This source file uses intrinsics to gain access to SSSE3 and
+//    ARMv7a/ARMv8a NEON instructions. A separate source file is
+//    needed because additional CXXFLAGS are required to enable the
+//    appropriate instructions sets in some build configurations.
+//
+//    The GF(2^8) kernels multiply with split nibble tables. Each
+//    coefficient has a 16 byte table for the low nibble and a 16 byte
+//    table for the high nibble, and a byte shuffle looks up 16 bytes
+//    at a time. The tables are prepared by RawIDA in ida.cpp.
+
+#include "pch.h"
+#include "config.h"
+#include "misc.h"
+
+#if (CRYPTOPP_SSSE3_AVAILABLE)
+# include <emmintrin.h>
+# include <tmmintrin.h>
+#endif
+
+#if (CRYPTOPP_ARM_NEON_HEADER)
+# include <arm_neon.h>
+#endif
+
+// Clang intrinsic casts, http://bugs.llvm.org/show_bug.cgi?id=20670
+#define M128_CAST(x) ((__m128i *)(void *)(x))
+#define CONST_M128_CAST(x) ((const __m128i *)(const void *)(x))
+
+// Squash MS LNK4221 and libtool warnings
+extern const char IDA_SIMD_FNAME[] = __FILE__;
+
+NAMESPACE_BEGIN(CryptoPP)
+
+#if (CRYPTOPP_SSSE3_AVAILABLE)
+
+// Starts at processed, so the kernel can finish what the AVX2 kernel leaves
+size_t GF256Combine_SSSE3(byte *const *outputs, const byte *const *tables, unsigned int nOutputs,
+	const byte *const *inputs, unsigned int nInputs, size_t processed, size_t length)
+{
+	const __m128i mask = _mm_set1_epi8(0x0f);
+
+	for (; length - processed >= 16; processed += 16)
+	{
+		for (unsigned int i=0; i<nOutputs; i++)
+		{
+			const byte *table = tables[i];
+			__m128i acc = _mm_setzero_si128();
+			for (unsigned int j=0; j<nInputs; j++, table += 32)
+			{
+				const __m128i x = _mm_loadu_si128(CONST_M128_CAST(inputs[j]+processed));
+				const __m128i lo = _mm_shuffle_epi8(_mm_loadu_si128(CONST_M128_CAST(table+ 0)), _mm_and_si128(x, mask));
+				const __m128i hi = _mm_shuffle_epi8(_mm_loadu_si128(CONST_M128_CAST(table+16)), _mm_and_si128(_mm_srli_epi16(x, 4), mask));
+				acc = _mm_xor_si128(acc, _mm_xor_si128(lo, hi));
+			}
+			_mm_storeu_si128(M128_CAST(outputs[i]+processed), acc);
+		}
+	}
+	return processed;
+}
+
+#endif  // CRYPTOPP_SSSE3_AVAILABLE
+
+#if (CRYPTOPP_ARM_NEON_AVAILABLE)
+
+ANONYMOUS_NAMESPACE_BEGIN
+
+// Table lookup of 16 entries. vqtbl1q_u8 is only available on Aarch64.
+inline uint8x16_t Lookup16(const uint8x16_t table, const uint8x16_t index)
+{
+#if defined(__aarch64__)
+	return vqtbl1q_u8(table, index);
+#else
+	uint8x8x2_t t;
+	t.val[0] = vget_low_u8(table);
+	t.val[1] = vget_high_u8(table);
+	return vcombine_u8(vtbl2_u8(t, vget_low_u8(index)), vtbl2_u8(t, vget_high_u8(index)));
+#endif
+}
+
+ANONYMOUS_NAMESPACE_END
+
+size_t GF256Combine_NEON(byte *const *outputs, const byte *const *tables, unsigned int nOutputs,
+	const byte *const *inputs, unsigned int nInputs, size_t length)
+{
+	const uint8x16_t mask = vdupq_n_u8(0x0f);
+	size_t processed = 0;
+
+	for (; length - processed >= 16; processed += 16)
+	{
+		for (unsigned int i=0; i<nOutputs; i++)
+		{
+			const byte *table = tables[i];
+			uint8x16_t acc = vdupq_n_u8(0);
+			for (unsigned int j=0; j<nInputs; j++, table += 32)
+			{
+				const uint8x16_t x = vld1q_u8(inputs[j]+processed);
+				const uint8x16_t lo = Lookup16(vld1q_u8(table+ 0), vandq_u8(x, mask));
+				const uint8x16_t hi = Lookup16(vld1q_u8(table+16), vshrq_n_u8(x, 4));
+				acc = veorq_u8(acc, veorq_u8(lo, hi));
+			}
+			vst1q_u8(outputs[i]+processed, acc);
+		}
+	}
+	return processed;
+}
+
+#endif  // CRYPTOPP_ARM_NEON_AVAILABLE
+
+NAMESPACE_END
@@ -0,0 +1,239 @@
+// instrument.cpp - written and placed in public domain by the Crypto++ project.
+
+#include "pch.h"
+#include "config.h"
+
+#ifndef CRYPTOPP_IMPORTS
+
+#include "instrument.h"
+#include "misc.h"
+
+#include <iostream>
+
+#if defined(CRYPTOPP_CXX11_SYNCHRONIZATION)
+# include <chrono>
+# include <map>
+# include <mutex>
+#endif
+
+#if defined(CRYPTOPP_CXX11_SYNCHRONIZATION)
+
+ANONYMOUS_NAMESPACE_BEGIN
+
+using namespace CryptoPP;
+
+struct Counters
+{
+	Counters() : calls(0), bytes(0), nanoseconds(0) {}
+
+	std::atomic<word64> calls, bytes, nanoseconds;
+};
+
+const char *OperationName(InstrumentedCall::Operation operation)
+{
+	static const char *const names[] = {"process", "update", "setkey", "sign", "verify"};
+	return names[operation];
+}
+
+// The key is algorithm, provider and operation separated by NUL.
+//  Counters are never freed so a caller can update them outside the lock.
+class Registry
+{
+public:
+	Counters& Find(const std::string &key)
+	{
+		std::lock_guard<std::mutex> guard(m_mutex);
+		Counters *&counters = m_counters[key];
+		if (counters == NULLPTR)
+			counters = new Counters;
+		return *counters;
+	}
+
+	void Reset()
+	{
+		std::lock_guard<std::mutex> guard(m_mutex);
+		for (CounterMap::iterator it = m_counters.begin(); it != m_counters.end(); ++it)
+		{
+			it->second->calls.store(0);
+			it->second->bytes.store(0);
+			it->second->nanoseconds.store(0);
+		}
+	}
+
+	std::vector<InstrumentationRecord> Snapshot()
+	{
+		std::vector<InstrumentationRecord> records;
+		std::lock_guard<std::mutex> guard(m_mutex);
+		for (CounterMap::const_iterator it = m_counters.begin(); it != m_counters.end(); ++it)
+		{
+			InstrumentationRecord record;
+			record.calls = it->second->calls.load();
+			if (record.calls == 0)
+				continue;
+
+			record.bytes = it->second->bytes.load();
+			record.nanoseconds = it->second->nanoseconds.load();
+
+			const std::string::size_type first = it->first.find('\0');
+			const std::string::size_type second = it->first.find('\0', first+1);
+			record.algorithm = it->first.substr(0, first);
+			record.provider = it->first.substr(first+1, second-first-1);
+			record.operation = it->first.substr(second+1);
+			records.push_back(record);
+		}
+		return records;
+	}
+
+private:
+	typedef std::map<std::string, Counters *> CounterMap;
+
+	std::mutex m_mutex;
+	CounterMap m_counters;
+};
+
+Registry& GetRegistry()
+{
+	static Registry registry;
+	return registry;
+}
+
+inline word64 Now()
+{
+	return static_cast<word64>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+#if defined(CRYPTOPP_CXX11_THREAD_LOCAL)
+thread_local bool t_active = false;
+#endif
+
+ANONYMOUS_NAMESPACE_END
+
+NAMESPACE_BEGIN(CryptoPP)
+
+std::atomic<bool> InstrumentedCall::s_enabled(false);
+
+void InstrumentedCall::Begin(const Algorithm *algorithm)
+{
+#if defined(CRYPTOPP_CXX11_THREAD_LOCAL)
+	// Only the outermost call is counted
+	if (t_active || algorithm == NULLPTR)
+		return;
+	t_active = true;
+#endif
+	m_algorithm = algorithm;
+	m_start = Now();
+}
+
+void InstrumentedCall::Begin(const SimpleKeyingInterface *keying)
+{
+	// Stream ciphers are also random number generators, and authenticated
+	//  ciphers are also MACs, so a cross cast to Algorithm is ambiguous.
+	if (const StreamTransformation *cipher = dynamic_cast<const StreamTransformation *>(keying))
+		Begin(cipher);
+	else if (const HashTransformation *hash = dynamic_cast<const HashTransformation *>(keying))
+		Begin(hash);
+	else
+		Begin(dynamic_cast<const Algorithm *>(keying));
+}
+
+void InstrumentedCall::End()
+{
+	const word64 elapsed = Now() - m_start;
+#if defined(CRYPTOPP_CXX11_THREAD_LOCAL)
+	t_active = false;
+#endif
+
+	// Exceptions cannot leave a destructor
+	try
+	{
+		const std::string key = m_algorithm->AlgorithmName() + '\0' +
+			m_algorithm->AlgorithmProvider() + '\0' + OperationName(m_operation);
+
+		Counters &counters = GetRegistry().Find(key);
+		counters.calls.fetch_add(1, std::memory_order_relaxed);
+		counters.bytes.fetch_add(m_bytes, std::memory_order_relaxed);
+		counters.nanoseconds.fetch_add(elapsed, std::memory_order_relaxed);
+	}
+	catch (const std::exception&)
+	{
+	}
+}
+
+bool Instrumentation::Available()
+{
+	return true;
+}
+
+void Instrumentation::Enable(bool enable)
+{
+	InstrumentedCall::s_enabled.store(enable);
+}
+
+bool Instrumentation::Enabled()
+{
+	return InstrumentedCall::s_enabled.load();
+}
+
+void Instrumentation::Reset()
+{
+	GetRegistry().Reset();
+}
+
+std::vector<InstrumentationRecord> Instrumentation::Snapshot()
+{
+	return GetRegistry().Snapshot();
+}
+
+NAMESPACE_END
+
+#else  // CRYPTOPP_CXX11_SYNCHRONIZATION
+
+NAMESPACE_BEGIN(CryptoPP)
+
+bool Instrumentation::Available()
+{
+	return false;
+}
+
+void Instrumentation::Enable(bool enable)
+{
+	if (enable)
+		throw NotImplemented("Instrumentation: C++11 synchronization is not available");
+}
+
+bool Instrumentation::Enabled()
+{
+	return false;
+}
+
+void Instrumentation::Reset()
+{
+}
+
+std::vector<InstrumentationRecord> Instrumentation::Snapshot()
+{
+	return std::vector<InstrumentationRecord>();
+}
+
+NAMESPACE_END
+
+#endif  // CRYPTOPP_CXX11_SYNCHRONIZATION
+
+NAMESPACE_BEGIN(CryptoPP)
+
+void Instrumentation::Export(std::ostream &out)
+{
+	const std::vector<InstrumentationRecord> records = Snapshot();
+	out << "algorithm,provider,operation,calls,bytes,nanoseconds\n";
+	for (size_t i=0; i<records.size(); ++i)
+	{
+		const InstrumentationRecord &r = records[i];
+		out << '"' << r.algorithm << "\",\"" << r.provider << "\"," << r.operation << ',';
+		out << r.calls << ',' << r.bytes << ',' << r.nanoseconds << '\n';
+	}
+}
+
+NAMESPACE_END
+
+#endif  // CRYPTOPP_IMPORTS
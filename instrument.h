@@ -0,0 +1,152 @@
+// instrument.h - written and placed in public domain by the Crypto++ project.
+
+/// \file instrument.h
+/// \brief Opt-in counters of calls, bytes and time for each algorithm
+/// \details Instrumentation counts the calls, bytes and time spent in
+///   StreamTransformation::ProcessData(), HashTransformation::Update(),
+///   SimpleKeyingInterface::SetKey() and the PK_Signer and PK_Verifier entry
+///   points. Counters are kept for each AlgorithmName(), AlgorithmProvider()
+///   and operation, so a metrics pipeline can attribute cost by algorithm and
+///   see when a host uses a slow provider.
+/// \details Instrumentation is off by default. When it is off each hooked call
+///   costs one relaxed atomic load. When it is on each call also reads the
+///   clock twice and looks up its counters under a lock, so leave it off in
+///   latency sensitive code.
+/// \details Only the outermost hooked call on a thread is counted. For example,
+///   HMAC<SHA256>::Update() is counted as HMAC(SHA-256) and not also as SHA-256.
+///   Nested calls are only suppressed when the compiler provides
+///   <tt>thread_local</tt>. Work a MAC does in Final(), like the outer hash
+///   of HMAC, is counted as an Update() of the underlying hash.
+/// \details Instrumentation requires C++11 synchronization. Available()
+///   returns false when it is missing.
+/// \since Crypto++ 8.4
+
+#ifndef CRYPTOPP_INSTRUMENT_H
+#define CRYPTOPP_INSTRUMENT_H
+
+#include "cryptlib.h"
+
+#include <iosfwd>
+
+#if defined(CRYPTOPP_CXX11_SYNCHRONIZATION)
+# include <atomic>
+#endif
+
+NAMESPACE_BEGIN(CryptoPP)
+
+/// \brief Counters for one operation of one algorithm and provider
+/// \since Crypto++ 8.4
+struct CRYPTOPP_DLL InstrumentationRecord
+{
+	InstrumentationRecord() : calls(0), bytes(0), nanoseconds(0) {}
+
+	/// \brief AlgorithmName() of the object
+	std::string algorithm;
+	/// \brief AlgorithmProvider() of the object
+	std::string provider;
+	/// \brief the operation, one of process, update, setkey, sign and verify
+	std::string operation;
+	/// \brief number of calls
+	word64 calls;
+	/// \brief number of bytes, which is the key length for setkey
+	word64 bytes;
+	/// \brief wall clock time spent in the calls
+	word64 nanoseconds;
+};
+
+/// \brief Opt-in per-algorithm instrumentation counters
+/// \since Crypto++ 8.4
+class CRYPTOPP_DLL Instrumentation
+{
+public:
+	/// \brief Determines if instrumentation is available
+	/// \returns true if the library was built with C++11 synchronization
+	static bool Available();
+
+	/// \brief Turns instrumentation on or off
+	/// \param enable true to count calls, false to stop counting
+	/// \throws NotImplemented if enable is true and Available() is false
+	/// \details The counters keep their values when instrumentation is
+	///   turned off. Use Reset() to clear them.
+	static void Enable(bool enable=true);
+
+	/// \brief Determines if instrumentation is on
+	static bool Enabled();
+
+	/// \brief Clears the counters
+	static void Reset();
+
+	/// \brief Copies the counters
+	/// \returns the counters, sorted by algorithm, provider and operation
+	/// \details Records with no calls are not returned.
+	static std::vector<InstrumentationRecord> Snapshot();
+
+	/// \brief Writes the counters as CSV
+	/// \param out the output stream
+	/// \details The first line is the header
+	///   <tt>algorithm,provider,operation,calls,bytes,nanoseconds</tt>.
+	static void Export(std::ostream &out);
+};
+
+/// \brief Records one instrumented call
+/// \details InstrumentedCall is used by the library at the hooked entry points.
+///   It records the call when it goes out of scope. It does nothing when
+///   instrumentation is off.
+/// \since Crypto++ 8.4
+class CRYPTOPP_DLL InstrumentedCall
+{
+public:
+	/// \brief Operations that are counted
+	enum Operation {PROCESS, UPDATE, SET_KEY, SIGN, VERIFY};
+
+#if defined(CRYPTOPP_CXX11_SYNCHRONIZATION)
+	InstrumentedCall(const Algorithm &algorithm, Operation operation, size_t bytes)
+		: m_algorithm(NULLPTR), m_operation(operation), m_bytes(bytes), m_start(0)
+	{
+		if (s_enabled.load(std::memory_order_relaxed))
+			Begin(&algorithm);
+	}
+
+	/// \details SimpleKeyingInterface is not an Algorithm, so the object is
+	///   found with a cross cast when instrumentation is on.
+	InstrumentedCall(const SimpleKeyingInterface &keying, size_t bytes)
+		: m_algorithm(NULLPTR), m_operation(SET_KEY), m_bytes(bytes), m_start(0)
+	{
+		if (s_enabled.load(std::memory_order_relaxed))
+			Begin(&keying);
+	}
+
+	~InstrumentedCall()
+	{
+		if (m_algorithm)
+			End();
+	}
+
+private:
+	friend class Instrumentation;
+
+	void Begin(const Algorithm *algorithm);
+	void Begin(const SimpleKeyingInterface *keying);
+	void End();
+
+	static std::atomic<bool> s_enabled;
+
+	const Algorithm *m_algorithm;
+	Operation m_operation;
+	size_t m_bytes;
+	word64 m_start;
+#else
+	InstrumentedCall(const Algorithm &algorithm, Operation operation, size_t bytes)
+		{CRYPTOPP_UNUSED(algorithm); CRYPTOPP_UNUSED(operation); CRYPTOPP_UNUSED(bytes);}
+	InstrumentedCall(const SimpleKeyingInterface &keying, size_t bytes)
+		{CRYPTOPP_UNUSED(keying); CRYPTOPP_UNUSED(bytes);}
+#endif
+
+private:
+	InstrumentedCall(const InstrumentedCall &);
+	void operator=(const InstrumentedCall &);
+};
+
+NAMESPACE_END
+
+#endif  // CRYPTOPP_INSTRUMENT_H
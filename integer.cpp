@@ -2975,6 +2975,18 @@ Integer::Integer(const Integer& t)
 	CopyWords(reg, t.reg, reg.size());
 }
 
+#if defined(CRYPTOPP_CXX11_RVALUES)
+// The moves cannot throw. A block that is not transferred is at most
+// 16 words and lands in the inline storage of the destination, and the
+// two words left in t fit the inline storage t just gave up.
+Integer::Integer(Integer&& t) CRYPTOPP_NO_THROW
+	: reg(std::move(t.reg)), sign(t.sign)
+{
+	t.reg.CleanNew(2);
+	t.sign = POSITIVE;
+}
+#endif
+
 Integer::Integer(Sign s, lword value)
 	: reg(2), sign(s)
 {
@@ -3108,6 +3120,20 @@ Integer& Integer::operator=(const Integer& t)
 	return *this;
 }
 
+#if defined(CRYPTOPP_CXX11_RVALUES)
+Integer& Integer::operator=(Integer&& t) CRYPTOPP_NO_THROW
+{
+	if (this != &t)
+	{
+		reg = std::move(t.reg);
+		sign = t.sign;
+		t.reg.CleanNew(2);
+		t.sign = POSITIVE;
+	}
+	return *this;
+}
+#endif
+
 bool Integer::GetBit(size_t n) const
 {
 	// Profiling guided the flow below.
@@ -3781,28 +3807,19 @@ Integer& Integer::operator--()
 
 // This is a bit operation. We set sign to POSITIVE, so there's no need to
 //  worry about negative zero. Also see http://stackoverflow.com/q/11644362.
+// The copy constructor trims the register to the word count, so the copy
+//  may be shorter than the operand's register. The compound operators size
+//  the result from both registers.
 Integer Integer::And(const Integer& t) const
 {
 	if (this == &t)
 	{
 		return AbsoluteValue();
 	}
-	else if (reg.size() >= t.reg.size())
-	{
-		Integer result(t);
-		AndWords(result.reg, reg, t.reg.size());
-
-		result.sign = POSITIVE;
-		return result;
-	}
-	else // reg.size() < t.reg.size()
-	{
-		Integer result(*this);
-		AndWords(result.reg, t.reg, reg.size());
 
-		result.sign = POSITIVE;
-		return result;
-	}
+	Integer result(*this);
+	result &= t;
+	return result;
 }
 
 // This is a bit operation. We set sign to POSITIVE, so there's no need to
@@ -3813,22 +3830,10 @@ Integer Integer::Or(const Integer& t) const
 	{
 		return AbsoluteValue();
 	}
-	else if (reg.size() >= t.reg.size())
-	{
-		Integer result(*this);
-		OrWords(result.reg, t.reg, t.reg.size());
-
-		result.sign = POSITIVE;
-		return result;
-	}
-	else // reg.size() < t.reg.size()
-	{
-		Integer result(t);
-		OrWords(result.reg, reg, reg.size());
 
-		result.sign = POSITIVE;
-		return result;
-	}
+	Integer result(*this);
+	result |= t;
+	return result;
 }
 
 // This is a bit operation. We set sign to POSITIVE, so there's no need to
@@ -3839,22 +3844,10 @@ Integer Integer::Xor(const Integer& t) const
 	{
 		return Integer::Zero();
 	}
-	else if (reg.size() >= t.reg.size())
-	{
-		Integer result(*this);
-		XorWords(result.reg, t.reg, t.reg.size());
-
-		result.sign = POSITIVE;
-		return result;
-	}
-	else // reg.size() < t.reg.size()
-	{
-		Integer result(t);
-		XorWords(result.reg, reg, reg.size());
 
-		result.sign = POSITIVE;
-		return result;
-	}
+	Integer result(*this);
+	result ^= t;
+	return result;
 }
 
 void PositiveAdd(Integer &sum, const Integer &a, const Integer& b)
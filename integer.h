@@ -31,8 +31,10 @@ struct InitializeInteger
 	InitializeInteger();
 };
 
-// Always align, http://github.com/weidai11/cryptopp/issues/256
-typedef SecBlock<word, AllocatorWithCleanup<word, true> > IntegerSecBlock;
+// Always align, http://github.com/weidai11/cryptopp/issues/256. Up to 16
+// words are held in place so P-256 products and P-521 coordinates do not
+// touch the heap. Larger values spill into the fallback allocator.
+typedef SecBlock<word, FixedSizeAllocatorWithCleanup<word, 16, AllocatorWithCleanup<word, true>, true> > IntegerSecBlock;
 
 /// \brief Multiple precision integer with arithmetic operations
 /// \details The Integer class can represent positive and negative integers
@@ -103,6 +105,17 @@ public:
 		/// copy constructor
 		Integer(const Integer& t);
 
+#if defined(CRYPTOPP_CXX11_RVALUES)
+		/// \brief Move constructor
+		/// \param t the other Integer
+		/// \details t is left as zero. Any storage t held that could not be
+		///   transferred is zeroized.
+		/// \details The move does not throw, so containers like <tt>std::vector</tt>
+		///   move Integers instead of copying them when they grow.
+		/// \since Crypto++ 8.4
+		Integer(Integer&& t) CRYPTOPP_NO_THROW;
+#endif
+
 		/// \brief Convert from signed long
 		Integer(signed long value);
 
@@ -360,6 +373,15 @@ public:
 		/// \param t the other Integer
 		/// \returns the result of assignment
 		Integer&  operator=(const Integer& t);
+#if defined(CRYPTOPP_CXX11_RVALUES)
+		/// \brief Move assignment
+		/// \param t the other Integer
+		/// \returns the result of assignment
+		/// \details t is left as zero. Any storage t held that could not be
+		///   transferred is zeroized.
+		/// \since Crypto++ 8.4
+		Integer&  operator=(Integer&& t) CRYPTOPP_NO_THROW;
+#endif
 		/// \brief Addition Assignment
 		/// \param t the other Integer
 		/// \returns the result of <tt>*this + t</tt>
@@ -7,11 +7,13 @@
 #include "iterhash.h"
 #include "misc.h"
 #include "cpu.h"
+#include "instrument.h"
 
 NAMESPACE_BEGIN(CryptoPP)
 
 template <class T, class BASE> void IteratedHashBase<T, BASE>::Update(const byte *input, size_t length)
 {
+	InstrumentedCall instrumented(*this, InstrumentedCall::UPDATE, length);
 	CRYPTOPP_ASSERT(!(input == NULLPTR && length != 0));
 	if (length == 0) { return; }
 
@@ -19,6 +19,7 @@ http://creativecommons.org/publicdomain/zero/1.0/
 
 #include "pch.h"
 #include "keccak.h"
+#include "instrument.h"
 
 NAMESPACE_BEGIN(CryptoPP)
 
@@ -27,6 +28,7 @@ extern void KeccakF1600(word64 *state);
 
 void Keccak::Update(const byte *input, size_t length)
 {
+    InstrumentedCall instrumented(*this, InstrumentedCall::UPDATE, length);
     CRYPTOPP_ASSERT(!(input == NULLPTR && length != 0));
     if (length == 0) { return; }
 
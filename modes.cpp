@@ -6,11 +6,26 @@
 
 #include "modes.h"
 #include "misc.h"
+#include "instrument.h"
 
 #if defined(CRYPTOPP_DEBUG)
 #include "des.h"
 #endif
 
+ANONYMOUS_NAMESPACE_BEGIN
+
+using CryptoPP::byte;
+
+// Orders chains from longest to shortest
+struct LongerStream
+{
+	LongerStream(const size_t *blocks) : m_blocks(blocks) {}
+	bool operator()(size_t a, size_t b) const {return m_blocks[a] > m_blocks[b];}
+	const size_t *m_blocks;
+};
+
+ANONYMOUS_NAMESPACE_END
+
 NAMESPACE_BEGIN(CryptoPP)
 
 #if defined(CRYPTOPP_DEBUG) && !defined(CRYPTOPP_DOXYGEN_PROCESSING)
@@ -188,14 +203,57 @@ void BlockOrientedCipherModeBase::ResizeBuffers()
 	m_buffer.New(BlockSize());
 }
 
+void CBC_ProcessStreams(const BlockCipher &cipher, byte *const chains[],
+	byte *const outStrings[], const byte *const inStrings[], const size_t blocks[], size_t count)
+{
+	if (!count) return;
+
+	// Sorting longest first means the unfinished chains are always
+	// the leading lanes, and the lanes never need to be compacted.
+	std::vector<size_t> order(count);
+	for (size_t i=0; i<count; ++i)
+		order[i] = i;
+	std::stable_sort(order.begin(), order.end(), LongerStream(blocks));
+
+	const unsigned int blockSize = cipher.BlockSize();
+	SecByteBlock lanes(count*blockSize);
+	for (size_t j=0; j<count; ++j)
+		std::memcpy(lanes+j*blockSize, chains[order[j]], blockSize);
+
+	size_t active = count;
+	for (size_t r=0, offset=0; ; ++r, offset+=blockSize)
+	{
+		while (active && blocks[order[active-1]] <= r)
+			active--;
+		if (!active)
+			break;
+
+		for (size_t j=0; j<active; ++j)
+			xorbuf(lanes+j*blockSize, inStrings[order[j]]+offset, blockSize);
+
+		cipher.AdvancedProcessBlocks(lanes, NULLPTR, lanes, active*blockSize, BlockTransformation::BT_AllowParallel);
+
+		if (outStrings)
+		{
+			for (size_t j=0; j<active; ++j)
+				std::memcpy(outStrings[order[j]]+offset, lanes+j*blockSize, blockSize);
+		}
+	}
+
+	for (size_t j=0; j<count; ++j)
+		std::memcpy(chains[order[j]], lanes+j*blockSize, blockSize);
+}
+
 void ECB_OneWay::ProcessData(byte *outString, const byte *inString, size_t length)
 {
+	InstrumentedCall instrumented(*this, InstrumentedCall::PROCESS, length);
 	CRYPTOPP_ASSERT(length%BlockSize()==0);
 	m_cipher->AdvancedProcessBlocks(inString, NULLPTR, outString, length, BlockTransformation::BT_AllowParallel);
 }
 
 void CBC_Encryption::ProcessData(byte *outString, const byte *inString, size_t length)
 {
+	InstrumentedCall instrumented(*this, InstrumentedCall::PROCESS, length);
 	CRYPTOPP_ASSERT(length%BlockSize()==0);
 	CRYPTOPP_ASSERT(m_register.size() == BlockSize());
 	if (!length) return;
@@ -207,6 +265,24 @@ void CBC_Encryption::ProcessData(byte *outString, const byte *inString, size_t l
 	memcpy(m_register, PtrAdd(outString, length - blockSize), blockSize);
 }
 
+void CBC_Encryption::ProcessStreams(byte *const outStrings[], const byte *const inStrings[],
+	byte *const ivs[], const size_t lengths[], size_t count)
+{
+	if (!count) return;
+
+	const unsigned int blockSize = BlockSize();
+	std::vector<size_t> blocks(count);
+	for (size_t i=0; i<count; ++i)
+	{
+		CRYPTOPP_ASSERT(lengths[i]%blockSize==0);
+		if (lengths[i]%blockSize != 0)
+			throw InvalidArgument(AlgorithmName() + ": message length is not a multiple of the block size");
+		blocks[i] = lengths[i]/blockSize;
+	}
+
+	CBC_ProcessStreams(*m_cipher, ivs, outStrings, inStrings, &blocks[0], count);
+}
+
 size_t CBC_CTS_Encryption::ProcessLastBlock(byte *outString, size_t outLength, const byte *inString, size_t inLength)
 {
 	CRYPTOPP_UNUSED(outLength);
@@ -248,6 +324,7 @@ void CBC_Decryption::ResizeBuffers()
 
 void CBC_Decryption::ProcessData(byte *outString, const byte *inString, size_t length)
 {
+	InstrumentedCall instrumented(*this, InstrumentedCall::PROCESS, length);
 	CRYPTOPP_ASSERT(length%BlockSize()==0);
 	if (!length) {return;}
 
@@ -296,6 +296,26 @@ class CRYPTOPP_DLL CRYPTOPP_NO_VTABLE CBC_Encryption : public CBC_ModeBase
 {
 public:
 	void ProcessData(byte *outString, const byte *inString, size_t length);
+
+	/// \brief Encrypt independent messages in lockstep
+	/// \param outStrings array of count output buffers
+	/// \param inStrings array of count input buffers
+	/// \param ivs array of count initialization vectors
+	/// \param lengths array of count message lengths, in bytes
+	/// \param count the number of messages
+	/// \throws InvalidArgument if a length is not a multiple of BlockSize()
+	/// \details ProcessStreams() encrypts each message as if by
+	///  <tt>Resynchronize(ivs[i])</tt> followed by
+	///  <tt>ProcessData(outStrings[i], inStrings[i], lengths[i])</tt>. The
+	///  chains are advanced together so the block cipher's multi-block
+	///  kernel has one independent block from every message on each call.
+	/// \details On return each <tt>ivs[i]</tt> holds the last ciphertext block
+	///  so a message can be continued with another call. The object's own
+	///  IV is not used or changed.
+	/// \sa CBC_ProcessStreams
+	/// \since Crypto++ 8.4
+	void ProcessStreams(byte *const outStrings[], const byte *const inStrings[],
+		byte *const ivs[], const size_t lengths[], size_t count);
 };
 
 /// \brief CBC-CTS block cipher mode of operation encryption operation
@@ -341,6 +361,29 @@ public:
 	size_t ProcessLastBlock(byte *outString, size_t outLength, const byte *inString, size_t inLength);
 };
 
+/// \brief Advance independent CBC chains in lockstep
+/// \param cipher the block cipher in the forward direction
+/// \param chains array of count chaining values
+/// \param outStrings array of count output buffers, or NULL
+/// \param inStrings array of count input buffers
+/// \param blocks array of count block counts
+/// \param count the number of chains
+/// \details CBC_ProcessStreams() computes <tt>C = E(C xor P)</tt> for
+///  <tt>blocks[i]</tt> blocks of <tt>inStrings[i]</tt> using chaining
+///  value <tt>chains[i]</tt>. CBC encryption, CBC-MAC, CMAC and CCM are
+///  serial within one message, so a single message keeps only one of the
+///  cipher's pipelines busy. Here the next block of every unfinished chain
+///  is gathered and encrypted with one call to AdvancedProcessBlocks(), which
+///  lets AES-NI, ARMv8 and POWER8 process 4 to 8 blocks in flight.
+/// \details If outStrings is not NULL then each ciphertext block is written
+///  to <tt>outStrings[i]</tt>. On return <tt>chains[i]</tt> holds the final
+///  chaining value. Input and output buffers can be the same. All chains
+///  use the same key. Messages under different keys should be grouped by
+///  key and each group processed with its own cipher.
+/// \since Crypto++ 8.4
+CRYPTOPP_DLL void CRYPTOPP_API CBC_ProcessStreams(const BlockCipher &cipher, byte *const chains[],
+	byte *const outStrings[], const byte *const inStrings[], const size_t blocks[], size_t count);
+
 /// \brief Block cipher mode of operation aggregate
 template <class CIPHER, class BASE>
 class CipherModeFinalTemplate_CipherHolder : protected ObjectHolder<CIPHER>, public AlgorithmImpl<BASE, CipherModeFinalTemplate_CipherHolder<CIPHER, BASE> >
@@ -397,6 +440,34 @@ public:
 		this->SetKey(key, length, MakeParameters(Name::IV(), ConstByteArrayParameter(iv, this->m_cipher->BlockSize()))(Name::FeedbackSize(), feedbackSize));
 	}
 
+	/// \brief Copy a CipherModeFinalTemplate
+	/// \param other the object to copy
+	/// \details The copy holds its own copy of the keyed cipher. The key
+	///    schedule and the mode's state are copied rather than recomputed.
+	/// \since Crypto++ 8.4
+	CipherModeFinalTemplate_CipherHolder(const CipherModeFinalTemplate_CipherHolder &other)
+		: ObjectHolder<CIPHER>(other), AlgorithmImpl<BASE, CipherModeFinalTemplate_CipherHolder<CIPHER, BASE> >(other)
+	{
+		this->m_cipher = &this->m_object;
+	}
+
+	/// \brief Assign a CipherModeFinalTemplate
+	/// \param other the object to copy
+	/// \since Crypto++ 8.4
+	CipherModeFinalTemplate_CipherHolder& operator=(const CipherModeFinalTemplate_CipherHolder &other)
+	{
+		ObjectHolder<CIPHER>::operator=(other);
+		AlgorithmImpl<BASE, CipherModeFinalTemplate_CipherHolder<CIPHER, BASE> >::operator=(other);
+		this->m_cipher = &this->m_object;
+		return *this;
+	}
+
+	/// \brief Create a copy of this object
+	/// \return a copy of this object
+	/// \details The caller is responsible for freeing the object.
+	/// \since Crypto++ 8.4
+	Clonable * Clone() const {return static_cast<SymmetricCipher *>(new CipherModeFinalTemplate_CipherHolder(*this));}
+
 	// Algorithm class
 	std::string AlgorithmProvider() const {
 		return this->m_cipher->AlgorithmProvider();
@@ -427,6 +498,17 @@ public:
 	CipherModeFinalTemplate_ExternalCipher(BlockCipher &cipher, const byte *iv, int feedbackSize = 0)
 		{this->SetCipherWithIV(cipher, iv, feedbackSize);}
 
+	/// \brief Replace the external cipher
+	/// \param cipher An external block cipher
+	/// \details RebindCipher() points the mode at a copy of the cipher it
+	///    already uses. Unlike SetCipher(), the mode is not resynchronized
+	///    and its position in the message is kept. An object holding both
+	///    a cipher and a mode uses it after being copied. RebindCipher() does
+	///    nothing if the mode has no cipher.
+	/// \since Crypto++ 8.4
+	void RebindCipher(BlockCipher &cipher)
+		{if (this->m_cipher) this->m_cipher = &cipher;}
+
 	/// \brief Provides the name of this algorithm
 	/// \return the standard algorithm name
 	/// \details The standard algorithm name can be a name like \a AES or \a AES/GCM. Some algorithms
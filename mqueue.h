@@ -30,6 +30,18 @@ public:
 		}
 		return 0;
 	}
+	/// \brief Moves bytes from a ByteQueue into the current message
+	/// \param source the ByteQueue to drain
+	/// \param transferMax the maximum number of bytes to move
+	/// \returns the number of bytes moved
+	/// \details Filled nodes are moved without copying. See ByteQueue::MoveTo().
+	/// \since Crypto++ 8.4
+	lword MoveFrom(ByteQueue &source, lword transferMax=LWORD_MAX)
+	{
+		const lword length = source.MoveTo(m_queue, transferMax);
+		m_lengths.back() += length;
+		return length;
+	}
 	bool IsolatedFlush(bool hardFlush, bool blocking)
 		{CRYPTOPP_UNUSED(hardFlush), CRYPTOPP_UNUSED(blocking); return false;}
 	bool IsolatedMessageSeriesEnd(bool blocking)
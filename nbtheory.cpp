@@ -291,27 +291,41 @@ public:
 	bool NextCandidate(Integer &c);
 
 	void DoSieve();
-	static void SieveSingle(std::vector<bool> &sieve, word16 p, const Integer &first, const Integer &step, word16 stepInv);
+	static void SieveSingle(std::vector<word> &sieve, size_t sieveSize, word16 p, const Integer &first, const Integer &step, word16 stepInv);
 
 	Integer m_first, m_last, m_step;
 	signed int m_delta;
 	word m_next;
-	std::vector<bool> m_sieve;
+	size_t m_sieveSize;
+	// one bit per candidate, set when the candidate is composite
+	std::vector<word> m_sieve;
 };
 
 PrimeSieve::PrimeSieve(const Integer &first, const Integer &last, const Integer &step, signed int delta)
-	: m_first(first), m_last(last), m_step(step), m_delta(delta), m_next(0)
+	: m_first(first), m_last(last), m_step(step), m_delta(delta), m_next(0), m_sieveSize(0)
 {
 	DoSieve();
 }
 
 bool PrimeSieve::NextCandidate(Integer &c)
 {
-	bool safe = SafeConvert(std::find(m_sieve.begin()+m_next, m_sieve.end(), false) - m_sieve.begin(), m_next);
+	const size_t sieveWords = m_sieve.size();
+	size_t i = m_next / WORD_BITS;
+	word bits = 0;
+	if (i < sieveWords)
+	{
+		bits = ~m_sieve[i] & (~word(0) << (m_next % WORD_BITS));
+		while (!bits && ++i < sieveWords)
+			bits = ~m_sieve[i];
+	}
+
+	// bits past the end of the last window may be clear
+	const size_t next = bits ? STDMIN(i*WORD_BITS + TrailingZeros(bits), m_sieveSize) : m_sieveSize;
+	bool safe = SafeConvert(next, m_next);
 	CRYPTOPP_UNUSED(safe); CRYPTOPP_ASSERT(safe);
-	if (m_next == m_sieve.size())
+	if (m_next == m_sieveSize)
 	{
-		m_first += long(m_sieve.size())*m_step;
+		m_first += long(m_sieveSize)*m_step;
 		if (m_first > m_last)
 			return false;
 		else
@@ -329,17 +343,35 @@ bool PrimeSieve::NextCandidate(Integer &c)
 	}
 }
 
-void PrimeSieve::SieveSingle(std::vector<bool> &sieve, word16 p, const Integer &first, const Integer &step, word16 stepInv)
+void PrimeSieve::SieveSingle(std::vector<word> &sieve, size_t sieveSize, word16 p, const Integer &first, const Integer &step, word16 stepInv)
 {
 	if (stepInv)
 	{
-		size_t sieveSize = sieve.size();
 		size_t j = (word32(p-(first%p))*stepInv) % p;
 		// if the first multiple of p is p, skip it
 		if (first.WordCount() <= 1 && first + step*long(j) == p)
 			j += p;
+		else if (p < WORD_BITS)
+		{
+			// the marks of a small prime repeat every p words, so build
+			// one period of the wheel and OR it across the window
+			word pattern[WORD_BITS];
+			std::memset(pattern, 0, sizeof(pattern));
+			for (size_t k = j; k < size_t(p)*WORD_BITS; k += p)
+				pattern[k / WORD_BITS] |= word(1) << (k % WORD_BITS);
+
+			const size_t sieveWords = sieve.size();
+			for (size_t w = 0, k = 0; w < sieveWords; ++w)
+			{
+				sieve[w] |= pattern[k];
+				if (++k == p)
+					k = 0;
+			}
+			return;
+		}
+
 		for (; j < sieveSize; j += p)
-			sieve[j] = true;
+			sieve[j / WORD_BITS] |= word(1) << (j % WORD_BITS);
 	}
 }
 
@@ -349,15 +381,15 @@ void PrimeSieve::DoSieve()
 	const word16 * primeTable = GetPrimeTable(primeTableSize);
 
 	const unsigned int maxSieveSize = 32768;
-	unsigned int sieveSize = STDMIN(Integer(maxSieveSize), (m_last-m_first)/m_step+1).ConvertToLong();
+	m_sieveSize = STDMIN(Integer(maxSieveSize), (m_last-m_first)/m_step+1).ConvertToLong();
 
 	m_sieve.clear();
-	m_sieve.resize(sieveSize, false);
+	m_sieve.resize((m_sieveSize+WORD_BITS-1)/WORD_BITS, 0);
 
 	if (m_delta == 0)
 	{
 		for (unsigned int i = 0; i < primeTableSize; ++i)
-			SieveSingle(m_sieve, primeTable[i], m_first, m_step, (word16)m_step.InverseMod(primeTable[i]));
+			SieveSingle(m_sieve, m_sieveSize, primeTable[i], m_first, m_step, (word16)m_step.InverseMod(primeTable[i]));
 	}
 	else
 	{
@@ -368,12 +400,88 @@ void PrimeSieve::DoSieve()
 		{
 			word16 p = primeTable[i];
 			word16 stepInv = (word16)m_step.InverseMod(p);
-			SieveSingle(m_sieve, p, m_first, m_step, stepInv);
+			SieveSingle(m_sieve, m_sieveSize, p, m_first, m_step, stepInv);
 
 			word16 halfStepInv = 2*stepInv < p ? 2*stepInv : 2*stepInv-p;
-			SieveSingle(m_sieve, p, qFirst, halfStep, halfStepInv);
+			SieveSingle(m_sieve, m_sieveSize, p, qFirst, halfStep, halfStepInv);
+		}
+	}
+}
+
+// With delta != 0 both p and q = (p-delta)/2 must be prime
+static bool IsPrimeCandidate(const Integer &p, signed int delta)
+{
+	if (delta == 0)
+		return FastProbablePrimeTest(p) && IsPrime(p);
+
+	CRYPTOPP_ASSERT(IsSmallPrime(p) || SmallDivisorsTest(p));
+	const Integer q = (p-delta) >> 1;
+	CRYPTOPP_ASSERT(IsSmallPrime(q) || SmallDivisorsTest(q));
+	return FastProbablePrimeTest(q) && FastProbablePrimeTest(p) && IsPrime(q) && IsPrime(p);
+}
+
+// Returns the first candidate from the sieve that is acceptable and prime.
+// Under OpenMP the candidates are drawn in batches and tested by the worker
+// threads. A thread skips a candidate once a lower one in the batch is found
+// to be prime, and the lowest prime in the batch wins, so the result is the
+// same as testing the candidates one at a time.
+static bool NextPrime(PrimeSieve &sieve, Integer &p, const PrimeSelector *pSelector, signed int delta)
+{
+#ifdef _OPENMP
+	// below this size a probable prime test is cheaper than a thread handoff
+	const unsigned int minParallelBits = 256;
+	const int threads = omp_get_max_threads();
+
+	if (threads > 1 && !omp_in_parallel() && sieve.m_first.BitCount() >= minParallelBits)
+	{
+		std::vector<Integer> batch;
+		batch.reserve(2*threads);
+
+		while (true)
+		{
+			// the selector is called here, so it need not be thread safe
+			batch.clear();
+			while (batch.size() < size_t(2*threads) && sieve.NextCandidate(p))
+			{
+				if (!pSelector || pSelector->IsAcceptable(p))
+					batch.push_back(p);
+			}
+
+			const int count = static_cast<int>(batch.size());
+			if (count == 0)
+				return false;
+
+			int found = count;
+			#pragma omp parallel for schedule(dynamic, 1) num_threads(threads)
+			for (int i = 0; i < count; ++i)
+			{
+				int lowest;
+				#pragma omp critical(nbtheory_next_prime)
+				lowest = found;
+
+				if (i < lowest && IsPrimeCandidate(batch[i], delta))
+				{
+					#pragma omp critical(nbtheory_next_prime)
+					found = STDMIN(found, i);
+				}
+			}
+
+			if (found < count)
+			{
+				p = batch[found];
+				return true;
+			}
 		}
 	}
+#endif
+
+	while (sieve.NextCandidate(p))
+	{
+		if ((!pSelector || pSelector->IsAcceptable(p)) && IsPrimeCandidate(p, delta))
+			return true;
+	}
+
+	return false;
 }
 
 bool FirstPrime(Integer &p, const Integer &max, const Integer &equiv, const Integer &mod, const PrimeSelector *pSelector)
@@ -429,14 +537,7 @@ bool FirstPrime(Integer &p, const Integer &max, const Integer &equiv, const Inte
 		return false;
 
 	PrimeSieve sieve(p, max, mod);
-
-	while (sieve.NextCandidate(p))
-	{
-		if ((!pSelector || pSelector->IsAcceptable(p)) && FastProbablePrimeTest(p) && IsPrime(p))
-			return true;
-	}
-
-	return false;
+	return NextPrime(sieve, p, pSelector, 0);
 }
 
 // the following two functions are based on code and comments provided by Preda Mihailescu
@@ -1067,20 +1168,11 @@ void PrimeAndGenerator::Generate(signed int delta, RandomNumberGenerator &rng, u
 		{
 			p.Randomize(rng, minP, maxP, Integer::ANY, 6+5*delta, 12);
 			PrimeSieve sieve(p, STDMIN(p+PrimeSearchInterval(maxP)*12, maxP), 12, delta);
-
-			while (sieve.NextCandidate(p))
-			{
-				CRYPTOPP_ASSERT(IsSmallPrime(p) || SmallDivisorsTest(p));
-				q = (p-delta) >> 1;
-				CRYPTOPP_ASSERT(IsSmallPrime(q) || SmallDivisorsTest(q));
-				if (FastProbablePrimeTest(q) && FastProbablePrimeTest(p) && IsPrime(q) && IsPrime(p))
-				{
-					success = true;
-					break;
-				}
-			}
+			success = NextPrime(sieve, p, NULLPTR, delta);
 		}
 
+		q = (p-delta) >> 1;
+
 		if (delta == 1)
 		{
 			// find g such that g is a quadratic residue mod p, then g has order q
@@ -128,6 +128,10 @@ public:
 ///   returns false, then no such prime exists and the value of p is undefined
 /// \details FirstPrime() uses a fast sieve to find the first probable prime
 ///   in <tt>{x | p<=x<=max and x%mod==equiv}</tt>
+/// \details When the library is built with OpenMP, large candidates are tested
+///   by a team of threads. The result is the same prime a single thread finds.
+///   pSelector is only called from the calling thread, but it may be asked about
+///   candidates beyond the prime that is returned.
 CRYPTOPP_DLL bool CRYPTOPP_API FirstPrime(Integer &p, const Integer &max, const Integer &equiv, const Integer &mod, const PrimeSelector *pSelector);
 
 CRYPTOPP_DLL unsigned int CRYPTOPP_API PrimeSearchInterval(const Integer &max);
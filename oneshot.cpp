@@ -0,0 +1,164 @@
+// oneshot.cpp - written and placed in public domain by the Crypto++ project.
+
+#include "pch.h"
+#include "config.h"
+
+#ifndef CRYPTOPP_IMPORTS
+
+#include "oneshot.h"
+#include "secblock.h"
+#include "misc.h"
+
+ANONYMOUS_NAMESPACE_BEGIN
+
+using namespace CryptoPP;
+
+// ProcessLastBlock() may write ahead of the input it reads, so
+// in-place callers get a copy of the last block or two.
+size_t ProcessLast(StreamTransformation &cipher, byte *output, size_t outputLength, const byte *input, size_t inputLength)
+{
+	if (input == output && inputLength)
+	{
+		SecByteBlock temp(input, inputLength);
+		return cipher.ProcessLastBlock(output, outputLength, temp, inputLength);
+	}
+	return cipher.ProcessLastBlock(output, outputLength, input, inputLength);
+}
+
+ANONYMOUS_NAMESPACE_END
+
+NAMESPACE_BEGIN(CryptoPP)
+
+size_t EncryptAndAuthenticate(AuthenticatedSymmetricCipher &cipher,
+	byte *output, size_t outputLength, const byte *iv, size_t ivLength, const byte *aad,
+	size_t aadLength, const byte *message, size_t messageLength, int truncatedDigestSize)
+{
+	const size_t macSize = truncatedDigestSize < 0 ? cipher.TagSize() : truncatedDigestSize;
+	if (outputLength < macSize || outputLength - macSize < messageLength)
+		throw InvalidArgument("EncryptAndAuthenticate: output buffer is too small");
+
+	cipher.EncryptAndAuthenticate(output, output+messageLength, macSize, iv, (int)ivLength,
+		aad, aadLength, message, messageLength);
+	return messageLength + macSize;
+}
+
+size_t DecryptAndVerify(AuthenticatedSymmetricCipher &cipher,
+	byte *output, size_t outputLength, const byte *iv, size_t ivLength, const byte *aad,
+	size_t aadLength, const byte *ciphertext, size_t ciphertextLength, int truncatedDigestSize)
+{
+	const size_t macSize = truncatedDigestSize < 0 ? cipher.TagSize() : truncatedDigestSize;
+	if (ciphertextLength < macSize)
+		throw HashVerificationFilter::HashVerificationFailed();
+
+	const size_t messageLength = ciphertextLength - macSize;
+	if (outputLength < messageLength)
+		throw InvalidArgument("DecryptAndVerify: output buffer is too small");
+
+	if (!cipher.DecryptAndVerify(output, ciphertext+messageLength, macSize, iv, (int)ivLength,
+		aad, aadLength, ciphertext, messageLength))
+	{
+		// The filter does not release unverified plaintext
+		SecureWipeBuffer(output, messageLength);
+		throw HashVerificationFilter::HashVerificationFailed();
+	}
+
+	return messageLength;
+}
+
+size_t ProcessMessage(StreamTransformation &cipher,
+	byte *output, size_t outputLength, const byte *input, size_t inputLength,
+	BlockPaddingSchemeDef::BlockPaddingScheme padding)
+{
+	const size_t blockSize = cipher.MandatoryBlockSize();
+	const size_t minLastBlockSize = cipher.MinLastBlockSize();
+	const bool isForward = cipher.IsForwardTransformation();
+	const bool isBlockCipher = (blockSize > 1 && minLastBlockSize == 0);
+
+	// Same selection as StreamTransformationFilter
+	if (padding == BlockPaddingSchemeDef::DEFAULT_PADDING)
+		padding = isBlockCipher ? BlockPaddingSchemeDef::PKCS_PADDING : BlockPaddingSchemeDef::NO_PADDING;
+
+	if (padding != BlockPaddingSchemeDef::NO_PADDING && padding != BlockPaddingSchemeDef::PKCS_PADDING)
+		throw InvalidArgument("ProcessMessage: padding scheme is not supported");
+	if (padding == BlockPaddingSchemeDef::PKCS_PADDING && !isBlockCipher)
+		throw InvalidArgument("ProcessMessage: PKCS_PADDING cannot be used with " + cipher.AlgorithmName());
+
+	const size_t required = (padding == BlockPaddingSchemeDef::PKCS_PADDING && isForward) ?
+		RoundDownToMultipleOf(inputLength, blockSize) + blockSize : inputLength;
+	if (outputLength < required)
+		throw InvalidArgument("ProcessMessage: output buffer is too small");
+
+	if (cipher.IsLastBlockSpecial() && blockSize > 1)
+	{
+		// The mode pads or steals from the last block itself
+		const size_t length = RoundDownToMultipleOf(inputLength, blockSize);
+		if (length)
+			cipher.ProcessData(output, input, length);
+		return length + ProcessLast(cipher, output+length, outputLength-length,
+			inputLength > length ? input+length : NULLPTR, inputLength-length);
+	}
+
+	if (padding == BlockPaddingSchemeDef::NO_PADDING)
+	{
+		if (minLastBlockSize == 0)
+		{
+			if (inputLength % blockSize != 0)
+			{
+				if (isForward)
+					throw InvalidDataFormat("ProcessMessage: plaintext length is not a multiple of block size and NO_PADDING is specified");
+				else
+					throw InvalidCiphertext("ProcessMessage: ciphertext length is not a multiple of block size");
+			}
+
+			if (inputLength)
+				cipher.ProcessData(output, input, inputLength);
+			return inputLength;
+		}
+
+		// Modes like CBC-CTS hold back MinLastBlockSize() bytes for the last call
+		size_t length = 0;
+		if (inputLength > minLastBlockSize)
+		{
+			length = RoundDownToMultipleOf(inputLength - minLastBlockSize, blockSize);
+			if (length)
+				cipher.ProcessData(output, input, length);
+		}
+		if (inputLength == length)
+			return length;
+		return length + ProcessLast(cipher, output+length, outputLength-length,
+			input+length, inputLength-length);
+	}
+
+	// PKCS_PADDING on ECB or CBC
+	CRYPTOPP_ASSERT(blockSize > 1 && blockSize < 256);
+	if (isForward)
+	{
+		const size_t length = RoundDownToMultipleOf(inputLength, blockSize);
+		const size_t leftOver = inputLength - length;
+		if (length)
+			cipher.ProcessData(output, input, length);
+
+		byte *last = output+length;
+		if (leftOver)
+			std::memmove(last, input+length, leftOver);
+		std::memset(last+leftOver, static_cast<byte>(blockSize-leftOver), blockSize-leftOver);
+		cipher.ProcessData(last, last, blockSize);
+		return length + blockSize;
+	}
+	else
+	{
+		if (inputLength == 0 || inputLength % blockSize != 0)
+			throw InvalidCiphertext("ProcessMessage: ciphertext length is not a multiple of block size");
+
+		cipher.ProcessData(output, input, inputLength);
+		const byte *last = output+inputLength-blockSize;
+		const byte pad = last[blockSize-1];
+		if (pad < 1 || pad > blockSize || FindIfNot(last+blockSize-pad, last+blockSize, pad) != last+blockSize)
+			throw InvalidCiphertext("ProcessMessage: invalid PKCS #7 block padding found");
+		return inputLength - pad;
+	}
+}
+
+NAMESPACE_END
+
+#endif  // CRYPTOPP_IMPORTS
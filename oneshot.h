@@ -0,0 +1,154 @@
+// oneshot.h - written and placed in public domain by the Crypto++ project.
+
+/// \file oneshot.h
+/// \brief One-shot functions that operate on caller buffers
+/// \details The functions in this header produce the same output as the
+///   corresponding filters, like AuthenticatedEncryptionFilter and
+///   StreamTransformationFilter, but they write directly into a caller
+///   supplied buffer. They do not allocate memory, and they avoid the
+///   BufferedTransformation pipeline. They are intended for small messages
+///   where the cost of the pipeline exceeds the cost of the algorithm.
+/// \details When the compiler provides C++20 <tt>std::span</tt>, overloads
+///   taking spans are also available.
+/// \since Crypto++ 8.4
+
+#ifndef CRYPTOPP_ONESHOT_H
+#define CRYPTOPP_ONESHOT_H
+
+#include "cryptlib.h"
+#include "filters.h"
+
+#if defined(CRYPTOPP_CXX20_SPAN)
+# include <span>
+#endif
+
+NAMESPACE_BEGIN(CryptoPP)
+
+/// \brief Encrypts and authenticates a message into a caller buffer
+/// \param cipher a keyed encryption object
+/// \param output the buffer for the ciphertext and tag
+/// \param outputLength the size of the output buffer, in bytes
+/// \param iv the iv buffer
+/// \param ivLength the size of the iv buffer, in bytes
+/// \param aad the additional authenticated data buffer
+/// \param aadLength the size of the aad buffer, in bytes
+/// \param message the message buffer
+/// \param messageLength the size of the message buffer, in bytes
+/// \param truncatedDigestSize the size of the tag, or -1 for TagSize()
+/// \return the number of bytes written to output
+/// \throws InvalidArgument if outputLength is too small
+/// \details The output is the ciphertext followed by the tag, which is the same
+///   as AuthenticatedEncryptionFilter. outputLength must be at least
+///   <tt>messageLength+truncatedDigestSize</tt>.
+/// \since Crypto++ 8.4
+CRYPTOPP_DLL size_t CRYPTOPP_API EncryptAndAuthenticate(AuthenticatedSymmetricCipher &cipher,
+	byte *output, size_t outputLength, const byte *iv, size_t ivLength, const byte *aad,
+	size_t aadLength, const byte *message, size_t messageLength, int truncatedDigestSize=-1);
+
+/// \brief Decrypts and verifies a message into a caller buffer
+/// \param cipher a keyed decryption object
+/// \param output the buffer for the recovered message
+/// \param outputLength the size of the output buffer, in bytes
+/// \param iv the iv buffer
+/// \param ivLength the size of the iv buffer, in bytes
+/// \param aad the additional authenticated data buffer
+/// \param aadLength the size of the aad buffer, in bytes
+/// \param ciphertext the ciphertext and tag buffer
+/// \param ciphertextLength the size of the ciphertext and tag buffer, in bytes
+/// \param truncatedDigestSize the size of the tag, or -1 for TagSize()
+/// \return the number of bytes written to output
+/// \throws HashVerificationFilter::HashVerificationFailed if the tag is not valid
+/// \throws InvalidArgument if outputLength is too small
+/// \details The input is the ciphertext followed by the tag, which is the same
+///   as AuthenticatedDecryptionFilter with MAC_AT_END and THROW_EXCEPTION.
+///   The output buffer is zeroized when verification fails.
+/// \since Crypto++ 8.4
+CRYPTOPP_DLL size_t CRYPTOPP_API DecryptAndVerify(AuthenticatedSymmetricCipher &cipher,
+	byte *output, size_t outputLength, const byte *iv, size_t ivLength, const byte *aad,
+	size_t aadLength, const byte *ciphertext, size_t ciphertextLength, int truncatedDigestSize=-1);
+
+/// \brief Encrypts or decrypts a message into a caller buffer
+/// \param cipher a keyed encryption or decryption object
+/// \param output the buffer for the processed message
+/// \param outputLength the size of the output buffer, in bytes
+/// \param input the input buffer
+/// \param inputLength the size of the input buffer, in bytes
+/// \param padding the padding scheme
+/// \return the number of bytes of the processed message
+/// \throws InvalidArgument if outputLength is too small or the padding is not supported
+/// \throws InvalidDataFormat if the plaintext length is not valid for the mode
+/// \throws InvalidCiphertext if the ciphertext or its padding is not valid
+/// \details ProcessMessage() processes the message in the same way as
+///   StreamTransformationFilter. DEFAULT_PADDING means PKCS_PADDING for
+///   ECB and CBC modes and NO_PADDING otherwise. ZEROS_PADDING, W3C_PADDING
+///   and ONE_AND_ZEROS_PADDING are not supported; use
+///   StreamTransformationFilter for them.
+/// \details outputLength must be at least <tt>inputLength+MandatoryBlockSize()</tt>
+///   when encrypting with padding, and at least <tt>inputLength</tt> otherwise.
+///   When decrypting with padding the padding bytes are written to output but
+///   they are not included in the return value.
+/// \details input and output may be the same buffer.
+/// \since Crypto++ 8.4
+CRYPTOPP_DLL size_t CRYPTOPP_API ProcessMessage(StreamTransformation &cipher,
+	byte *output, size_t outputLength, const byte *input, size_t inputLength,
+	BlockPaddingSchemeDef::BlockPaddingScheme padding=BlockPaddingSchemeDef::DEFAULT_PADDING);
+
+#if defined(CRYPTOPP_CXX20_SPAN)
+
+/// \brief Encrypts and authenticates a message into a caller buffer
+/// \details See the pointer overload of EncryptAndAuthenticate().
+/// \since Crypto++ 8.4
+inline size_t EncryptAndAuthenticate(AuthenticatedSymmetricCipher &cipher, std::span<byte> output,
+	std::span<const byte> iv, std::span<const byte> aad, std::span<const byte> message, int truncatedDigestSize=-1)
+{
+	return EncryptAndAuthenticate(cipher, output.data(), output.size(), iv.data(), iv.size(),
+		aad.data(), aad.size(), message.data(), message.size(), truncatedDigestSize);
+}
+
+/// \brief Decrypts and verifies a message into a caller buffer
+/// \details See the pointer overload of DecryptAndVerify().
+/// \since Crypto++ 8.4
+inline size_t DecryptAndVerify(AuthenticatedSymmetricCipher &cipher, std::span<byte> output,
+	std::span<const byte> iv, std::span<const byte> aad, std::span<const byte> ciphertext, int truncatedDigestSize=-1)
+{
+	return DecryptAndVerify(cipher, output.data(), output.size(), iv.data(), iv.size(),
+		aad.data(), aad.size(), ciphertext.data(), ciphertext.size(), truncatedDigestSize);
+}
+
+/// \brief Encrypts or decrypts a message into a caller buffer
+/// \details See the pointer overload of ProcessMessage().
+/// \since Crypto++ 8.4
+inline size_t ProcessMessage(StreamTransformation &cipher, std::span<byte> output, std::span<const byte> input,
+	BlockPaddingSchemeDef::BlockPaddingScheme padding=BlockPaddingSchemeDef::DEFAULT_PADDING)
+{
+	return ProcessMessage(cipher, output.data(), output.size(), input.data(), input.size(), padding);
+}
+
+/// \brief Computes the digest or MAC of a message
+/// \param hash a hash or keyed MAC object
+/// \param digest the buffer for the digest
+/// \param input the message
+/// \details The digest is truncated to <tt>digest.size()</tt>, which cannot exceed DigestSize().
+/// \since Crypto++ 8.4
+inline void CalculateDigest(HashTransformation &hash, std::span<byte> digest, std::span<const byte> input)
+{
+	hash.CalculateTruncatedDigest(digest.data(), digest.size(), input.data(), input.size());
+}
+
+/// \brief Verifies the digest or MAC of a message
+/// \param hash a hash or keyed MAC object
+/// \param digest the existing digest
+/// \param input the message
+/// \return true if the digest is valid, false otherwise
+/// \details The comparison is constant time. <tt>digest.size()</tt> cannot exceed DigestSize().
+/// \since Crypto++ 8.4
+inline bool VerifyDigest(HashTransformation &hash, std::span<const byte> digest, std::span<const byte> input)
+{
+	return hash.VerifyTruncatedDigest(digest.data(), digest.size(), input.data(), input.size());
+}
+
+#endif  // CRYPTOPP_CXX20_SPAN
+
+NAMESPACE_END
+
+#endif  // CRYPTOPP_ONESHOT_H
@@ -20,6 +20,7 @@
 
 #include "osrng.h"
 #include "rng.h"
+#include "drbg.h"
 
 #ifdef CRYPTOPP_WIN32_AVAILABLE
 #define WIN32_LEAN_AND_MEAN
@@ -53,6 +54,23 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+// getrandom() arrived in Linux 3.17. It is called through syscall()
+//  so we don't depend on glibc 2.25 and <sys/random.h>.
+#if defined(__linux__)
+# include <sys/syscall.h>
+# if defined(SYS_getrandom)
+#  define CRYPTOPP_LINUX_GETRANDOM 1
+#  ifndef GRND_NONBLOCK
+#   define GRND_NONBLOCK 0x0001
+#  endif
+# endif
+#endif
+
+#if defined(CRYPTOPP_UNIX_AVAILABLE) && !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
+# define MAP_ANONYMOUS MAP_ANON
 #endif
 
 NAMESPACE_BEGIN(CryptoPP)
@@ -134,6 +152,15 @@ MicrosoftCryptoProvider::~MicrosoftCryptoProvider()
 NonblockingRng::NonblockingRng()
 {
 #ifndef CRYPTOPP_WIN32_AVAILABLE
+# if defined(CRYPTOPP_LINUX_GETRANDOM)
+	// An empty request succeeds when the kernel provides getrandom() and
+	//  the pool is initialized. Once initialized, getrandom() never blocks.
+	//  Before that it fails with EAGAIN, and /dev/urandom is used instead.
+	m_fd = -1;
+	if (syscall(SYS_getrandom, NULLPTR, 0, GRND_NONBLOCK) == 0)
+		return;
+# endif
+
 	m_fd = open("/dev/urandom",O_RDONLY);
 	if (m_fd == -1)
 		throw OS_RNG_Err("open /dev/urandom");
@@ -146,7 +173,8 @@ NonblockingRng::NonblockingRng()
 NonblockingRng::~NonblockingRng()
 {
 #ifndef CRYPTOPP_WIN32_AVAILABLE
-	close(m_fd);
+	if (m_fd >= 0)
+		close(m_fd);
 #endif
 }
 
@@ -189,6 +217,28 @@ void NonblockingRng::GenerateBlock(byte *output, size_t size)
 	}
 # endif
 #else
+# if defined(CRYPTOPP_LINUX_GETRANDOM)
+	if (m_fd < 0)
+	{
+		while (size)
+		{
+			// Large requests can return short, and a signal can interrupt the call
+			long len = syscall(SYS_getrandom, output, size, 0);
+			if (len < 0)
+			{
+				if (errno != EINTR)
+					throw OS_RNG_Err("getrandom");
+
+				continue;
+			}
+
+			output += len;
+			size -= len;
+		}
+		return;
+	}
+# endif
+
 	while (size)
 	{
 		ssize_t len = read(m_fd, output, size);
@@ -293,6 +343,197 @@ void AutoSeededRandomPool::Reseed(bool blocking, unsigned int seedSize)
 	IncorporateEntropy(seed, seedSize);
 }
 
+// *************************************************************
+
+#if defined(CRYPTOPP_CXX11_THREAD_LOCAL)
+
+ANONYMOUS_NAMESPACE_BEGIN
+
+// Per-thread generator behind ThreadLocalRandomPool. The seeded flag and
+//  the output buffer share one mapping. On Linux the mapping is marked
+//  MADV_WIPEONFORK, so a child process finds a zero flag and reseeds.
+class ThreadRandomState
+{
+public:
+	ThreadRandomState();
+	~ThreadRandomState();
+
+	void GenerateBlock(byte *output, size_t size);
+	void Reseed(const byte *input, size_t length);
+
+	std::string AlgorithmProvider() const
+		{return m_drbg.AlgorithmProvider();}
+
+private:
+	enum {HEADER_SIZE=64, BUFFER_SIZE=4096, SEED_SIZE=48};
+	enum {RESEED_INTERVAL=1<<16};
+
+	bool Forked() const;
+	void Generate(byte *output, size_t size);
+
+	word32& SeededFlag() const
+		{return *reinterpret_cast<word32*>(m_page);}
+	byte* Buffer() const
+		{return m_page+HEADER_SIZE;}
+
+	CTR_DRBG<AES, 256/8> m_drbg;
+	byte *m_page;
+	size_t m_pageSize, m_available;
+	word32 m_requests;
+#if defined(CRYPTOPP_UNIX_AVAILABLE)
+	pid_t m_pid;
+	bool m_wipeOnFork;
+#endif
+};
+
+ThreadRandomState::ThreadRandomState()
+	: m_page(NULLPTR), m_pageSize(0), m_available(0), m_requests(0)
+{
+#if defined(CRYPTOPP_UNIX_AVAILABLE)
+	m_pid = 0; m_wipeOnFork = false;
+
+	const long pageSize = sysconf(_SC_PAGESIZE);
+	m_pageSize = RoundUpToMultipleOf((size_t)HEADER_SIZE+BUFFER_SIZE,
+		pageSize > 0 ? (size_t)pageSize : (size_t)4096);
+
+	void *p = mmap(NULLPTR, m_pageSize, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+	if (p == MAP_FAILED)
+		throw OS_RNG_Err("mmap");
+	m_page = static_cast<byte*>(p);
+
+# if defined(MADV_WIPEONFORK)
+	m_wipeOnFork = (madvise(p, m_pageSize, MADV_WIPEONFORK) == 0);
+# endif
+# if defined(MADV_DONTDUMP)
+	(void)madvise(p, m_pageSize, MADV_DONTDUMP);
+# endif
+#else
+	m_pageSize = HEADER_SIZE+BUFFER_SIZE;
+	m_page = static_cast<byte*>(AlignedAllocate(m_pageSize));
+#endif
+
+	// Anonymous mappings are zero filled, but AlignedAllocate is not
+	SeededFlag() = 0;
+}
+
+ThreadRandomState::~ThreadRandomState()
+{
+	SecureWipeBuffer(m_page, m_pageSize);
+#if defined(CRYPTOPP_UNIX_AVAILABLE)
+	munmap(m_page, m_pageSize);
+#else
+	AlignedDeallocate(m_page);
+#endif
+}
+
+bool ThreadRandomState::Forked() const
+{
+	// Zero on first use, or in a child after the kernel wiped the mapping
+	if (SeededFlag() == 0)
+		return true;
+
+#if defined(CRYPTOPP_UNIX_AVAILABLE)
+	if (!m_wipeOnFork && getpid() != m_pid)
+		return true;
+#endif
+
+	return false;
+}
+
+void ThreadRandomState::Reseed(const byte *input, size_t length)
+{
+	SecByteBlock seed(SEED_SIZE);
+	OS_GenerateRandomBlock(false, seed, seed.size());
+	m_drbg.IncorporateEntropy(seed, seed.size(), input, length);
+
+	SecureWipeBuffer(Buffer(), BUFFER_SIZE);
+	m_available = 0;
+	m_requests = 0;
+
+#if defined(CRYPTOPP_UNIX_AVAILABLE)
+	m_pid = getpid();
+#endif
+	SeededFlag() = 1;
+}
+
+void ThreadRandomState::Generate(byte *output, size_t size)
+{
+	while (size)
+	{
+		if (m_requests >= RESEED_INTERVAL)
+			Reseed(NULLPTR, 0);
+
+		const size_t len = STDMIN(size, (size_t)m_drbg.MaxBytesPerRequest());
+		m_drbg.GenerateBlock(output, len);
+		m_requests++;
+
+		output += len;
+		size -= len;
+	}
+}
+
+void ThreadRandomState::GenerateBlock(byte *output, size_t size)
+{
+	if (Forked())
+		Reseed(NULLPTR, 0);
+
+	while (size)
+	{
+		if (m_available == 0)
+		{
+			// Large requests bypass the buffer
+			if (size >= BUFFER_SIZE)
+				return Generate(output, size);
+
+			Generate(Buffer(), BUFFER_SIZE);
+			m_available = BUFFER_SIZE;
+		}
+
+		// Hand out bytes from the front and wipe them, so output that
+		//  was already returned can't be recovered from the buffer
+		byte *ptr = Buffer() + (BUFFER_SIZE - m_available);
+		const size_t len = STDMIN(size, m_available);
+		std::memcpy(output, ptr, len);
+		SecureWipeBuffer(ptr, len);
+
+		m_available -= len;
+		output += len;
+		size -= len;
+	}
+}
+
+ThreadRandomState& GetThreadRandomState()
+{
+	static thread_local member_ptr<ThreadRandomState> s_state;
+	if (s_state.get() == NULLPTR)
+		s_state.reset(new ThreadRandomState);
+	return *s_state;
+}
+
+ANONYMOUS_NAMESPACE_END
+
+void ThreadLocalRandomPool::IncorporateEntropy(const byte *input, size_t length)
+{
+	GetThreadRandomState().Reseed(input, length);
+}
+
+void ThreadLocalRandomPool::GenerateBlock(byte *output, size_t size)
+{
+	GetThreadRandomState().GenerateBlock(output, size);
+}
+
+void ThreadLocalRandomPool::Reseed()
+{
+	GetThreadRandomState().Reseed(NULLPTR, 0);
+}
+
+std::string ThreadLocalRandomPool::AlgorithmProvider() const
+{
+	return GetThreadRandomState().AlgorithmProvider();
+}
+
+#endif  // CRYPTOPP_CXX11_THREAD_LOCAL
+
 NAMESPACE_END
 
 #endif  // OS_RNG_AVAILABLE
@@ -82,6 +82,9 @@ private:
 /// \brief Wrapper class for /dev/random and /dev/srandom
 /// \details Encapsulates CryptoAPI's CryptGenRandom() or CryptoNG's BCryptGenRandom()
 ///   on Windows, or /dev/urandom on Unix and compatibles.
+/// \details On Linux the getrandom() system call is used when the kernel provides
+///   it and the entropy pool is initialized, and /dev/urandom is not opened.
+///   An object created before the pool is initialized reads /dev/urandom.
 class CRYPTOPP_DLL NonblockingRng : public RandomNumberGenerator
 {
 public:
@@ -174,6 +177,62 @@ public:
 	void Reseed(bool blocking = false, unsigned int seedSize = 32);
 };
 
+#if defined(CRYPTOPP_CXX11_THREAD_LOCAL) || defined(CRYPTOPP_DOXYGEN_PROCESSING)
+
+/// \brief Thread local, automatically seeded random number generator
+/// \details ThreadLocalRandomPool forwards requests to a generator owned by the
+///   calling thread. Each thread lazily creates a CTR_DRBG<AES, 256/8> seeded from
+///   NonblockingRng, and serves small requests like IVs and nonces from a 4 KiB
+///   output buffer. Bytes are wiped from the buffer as they are handed out. The
+///   fast path does not take a lock, so a single ThreadLocalRandomPool can be shared
+///   by any number of threads, or one can be constructed wherever it is needed.
+/// \details The generator reseeds itself in a child process after fork(). On Linux
+///   the output buffer is mapped with MADV_WIPEONFORK, so the kernel discards the
+///   buffer and the seeded flag in the child. Where MADV_WIPEONFORK is not available
+///   the process id is checked on each request. The generator also reseeds after
+///   2<sup>16</sup> requests to the underlying DRBG.
+/// \details The per-thread state is destroyed and wiped when the thread exits.
+///   ThreadLocalRandomPool is only available when the compiler supports C++11
+///   <tt>thread_local</tt>.
+/// \since Crypto++ 8.4
+class CRYPTOPP_DLL ThreadLocalRandomPool : public RandomNumberGenerator
+{
+public:
+	CRYPTOPP_STATIC_CONSTEXPR const char* StaticAlgorithmName() { return "ThreadLocalRandomPool"; }
+
+	virtual ~ThreadLocalRandomPool() {}
+
+	/// \brief Construct a ThreadLocalRandomPool
+	/// \details The constructor does not seed anything. The calling thread's
+	///   generator is created and seeded on first use.
+	ThreadLocalRandomPool() {}
+
+	/// \brief Determines if a generator can accept additional entropy
+	/// \return true
+	bool CanIncorporateEntropy() const {return true;}
+
+	/// \brief Update the calling thread's generator with additional entropy
+	/// \param input the entropy to add to the generator
+	/// \param length the size of the input buffer
+	/// \details The input is used as additional input to a reseed from the
+	///   operating system RNG, and any buffered output is discarded.
+	void IncorporateEntropy(const byte *input, size_t length);
+
+	/// \brief Generate random array of bytes
+	/// \param output the byte buffer
+	/// \param size the length of the buffer, in bytes
+	void GenerateBlock(byte *output, size_t size);
+
+	/// \brief Reseed the calling thread's generator
+	/// \details Reseed() reseeds the generator from the operating system RNG and
+	///   discards any buffered output.
+	void Reseed();
+
+	std::string AlgorithmProvider() const;
+};
+
+#endif  // CRYPTOPP_CXX11_THREAD_LOCAL
+
 /// \tparam BLOCK_CIPHER a block cipher
 /// \brief Automatically Seeded X9.17 RNG
 /// \details AutoSeededX917RNG is from ANSI X9.17 Appendix C, seeded using an OS provided RNG.
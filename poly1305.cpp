@@ -24,6 +24,7 @@
 #include "poly1305.h"
 #include "aes.h"
 #include "cpu.h"
+#include "instrument.h"
 
 ////////////////////////////// Common Poly1305 //////////////////////////////
 
@@ -218,6 +219,7 @@ void Poly1305_Base<T>::UncheckedSetKey(const byte *key, unsigned int length, con
 template <class T>
 void Poly1305_Base<T>::Update(const byte *input, size_t length)
 {
+	InstrumentedCall instrumented(*this, InstrumentedCall::UPDATE, length);
 	CRYPTOPP_ASSERT((input && length) || !length);
 	if (!length) return;
 
@@ -334,6 +336,7 @@ void Poly1305TLS_Base::UncheckedSetKey(const byte *key, unsigned int length, con
 
 void Poly1305TLS_Base::Update(const byte *input, size_t length)
 {
+	InstrumentedCall instrumented(*this, InstrumentedCall::UPDATE, length);
 	CRYPTOPP_ASSERT((input && length) || !length);
 	if (!length) return;
 
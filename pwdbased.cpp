@@ -0,0 +1,31 @@
+// pwdbased.cpp - written and placed in public domain by the Crypto++ project.
+
+#include "pch.h"
+#include "config.h"
+
+#ifndef CRYPTOPP_IMPORTS
+
+#include "pwdbased.h"
+
+#ifdef _OPENMP
+# include <omp.h>
+#endif
+
+NAMESPACE_BEGIN(CryptoPP)
+
+void PBKDF2_DeriveBlocks(const PBKDF2_BlockDeriver &deriver, unsigned int first, unsigned int last)
+{
+	if (first >= last)
+		return;
+
+#ifdef _OPENMP
+	int threads = STDMIN(omp_get_max_threads(), int(last-first));
+	#pragma omp parallel for num_threads(threads)
+#endif
+	for (int i = int(first); i < int(last); ++i)
+		deriver.DeriveBlock(static_cast<unsigned int>(i));
+}
+
+NAMESPACE_END
+
+#endif  // CRYPTOPP_IMPORTS
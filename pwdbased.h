@@ -240,6 +240,138 @@ size_t PKCS5_PBKDF2_HMAC<T>::DeriveKey(byte *derived, size_t derivedLen,
 	return DeriveKey(derived, derivedLen, purpose, secret, secretLen, salt.begin(), salt.size(), iterations, timeInSeconds);
 }
 
+/// \brief Derives one block of PBKDF2 output
+/// \details PBKDF2_BlockDeriver is the interface PBKDF2_DeriveBlocks() uses
+///  to derive the blocks of PBKDF2 output.
+/// \since Crypto++ 8.4
+class CRYPTOPP_DLL PBKDF2_BlockDeriver
+{
+public:
+	virtual ~PBKDF2_BlockDeriver() {}
+
+	/// \brief Derives a block of output
+	/// \param block the zero-based block number
+	/// \details DeriveBlock() may be called concurrently for different blocks.
+	virtual void DeriveBlock(unsigned int block) const =0;
+};
+
+/// \brief Derives a range of PBKDF2 output blocks
+/// \param deriver the object that derives each block
+/// \param first the first block
+/// \param last one past the last block
+/// \details The blocks are derived concurrently when the library is built with OpenMP.
+/// \since Crypto++ 8.4
+CRYPTOPP_DLL void CRYPTOPP_API PBKDF2_DeriveBlocks(const PBKDF2_BlockDeriver &deriver, unsigned int first, unsigned int last);
+
+/// \brief PBKDF2 using precomputed HMAC states
+/// \tparam T a HashTransformation class
+/// \tparam SUPPORTED flag indicating HMAC_KeyState can be used with T
+/// \details PBKDF2_HMAC_KeyState is used by PKCS5_PBKDF2_HMAC when T
+///  derives from IteratedHashWithStaticTransform. DeriveKey() returns 0
+///  when the precomputed states cannot be used, and the caller falls back
+///  to HMAC<T>.
+/// \since Crypto++ 8.4
+template <class T, bool SUPPORTED = HMAC_KeyStateTraits<T>::SUPPORTED>
+struct PBKDF2_HMAC_KeyState
+{
+	static unsigned int DeriveKey(byte *derived, size_t derivedLen, const byte *secret, size_t secretLen,
+		const byte *salt, size_t saltLen, unsigned int iterations, double timeInSeconds)
+	{
+		CRYPTOPP_UNUSED(derived); CRYPTOPP_UNUSED(derivedLen); CRYPTOPP_UNUSED(secret);
+		CRYPTOPP_UNUSED(secretLen); CRYPTOPP_UNUSED(salt); CRYPTOPP_UNUSED(saltLen);
+		CRYPTOPP_UNUSED(iterations); CRYPTOPP_UNUSED(timeInSeconds);
+		return 0;
+	}
+};
+
+template <class T>
+struct PBKDF2_HMAC_KeyState<T, true>
+{
+	// Output blocks are independent once the iteration count is known
+	class BlockDeriver : public PBKDF2_BlockDeriver
+	{
+	public:
+		BlockDeriver(const HMAC_KeyState<T> &state, byte *derived, size_t derivedLen,
+			const byte *salt, size_t saltLen, unsigned int iterations)
+			: m_state(state), m_derived(derived), m_derivedLen(derivedLen),
+			  m_salt(salt), m_saltLen(saltLen), m_iterations(iterations) {}
+
+		void DeriveBlock(unsigned int block) const
+		{
+			const unsigned int digestSize = T::DIGESTSIZE;
+			SecByteBlock buffer(digestSize), input(m_saltLen+4);
+			if (m_saltLen) std::memcpy(input, m_salt, m_saltLen);
+			PutWord(false, BIG_ENDIAN_ORDER, input+m_saltLen, word32(block+1));
+
+			m_state.CalculateDigest(buffer, input, input.size());
+			SecByteBlock acc(buffer, digestSize);
+			m_state.Iterate(buffer, acc, m_iterations-1);
+
+			const size_t offset = size_t(block) * digestSize;
+			std::memcpy(m_derived+offset, acc, STDMIN(m_derivedLen-offset, size_t(digestSize)));
+		}
+
+	private:
+		const HMAC_KeyState<T> &m_state;
+		byte *m_derived;
+		size_t m_derivedLen;
+		const byte *m_salt;
+		size_t m_saltLen;
+		unsigned int m_iterations;
+	};
+
+	static unsigned int DeriveKey(byte *derived, size_t derivedLen, const byte *secret, size_t secretLen,
+		const byte *salt, size_t saltLen, unsigned int iterations, double timeInSeconds)
+	{
+		if (!HMAC_KeyState<T>::Available())
+			return 0;
+
+		// Nothing to derive, and no block to time
+		if (derivedLen == 0)
+			return iterations;
+
+		const unsigned int digestSize = T::DIGESTSIZE;
+		const HMAC_KeyState<T> state(secret, secretLen);
+		const size_t blocks = (derivedLen + digestSize - 1) / digestSize;
+		unsigned int first = 0;
+
+		// The first block calibrates the iteration count, like HMAC<T>
+		if (timeInSeconds)
+		{
+			SecByteBlock buffer(digestSize), input(saltLen+4);
+			if (saltLen) std::memcpy(input, salt, saltLen);
+			PutWord(false, BIG_ENDIAN_ORDER, input+saltLen, word32(1));
+
+			state.CalculateDigest(buffer, input, input.size());
+			const size_t segmentLen = STDMIN(derivedLen, size_t(digestSize));
+			std::memcpy(derived, buffer, segmentLen);
+			SecByteBlock acc(buffer, digestSize);
+
+			ThreadUserTimer timer;
+			timeInSeconds = timeInSeconds / blocks;
+			timer.StartTimer();
+
+			unsigned int j = 1;
+			do
+			{
+				const unsigned int count = 128 - j%128;
+				state.Iterate(buffer, acc, count);
+				j += count;
+			}
+			while (j < iterations || timer.ElapsedTimeAsDouble() < timeInSeconds);
+
+			std::memcpy(derived, acc, segmentLen);
+			iterations = j;
+			first = 1;
+		}
+
+		const BlockDeriver deriver(state, derived, derivedLen, salt, saltLen, iterations);
+		PBKDF2_DeriveBlocks(deriver, first, static_cast<unsigned int>(blocks));
+
+		return iterations;
+	}
+};
+
 template <class T>
 size_t PKCS5_PBKDF2_HMAC<T>::DeriveKey(byte *derived, size_t derivedLen, byte purpose, const byte *secret, size_t secretLen, const byte *salt, size_t saltLen, unsigned int iterations, double timeInSeconds) const
 {
@@ -254,6 +386,12 @@ size_t PKCS5_PBKDF2_HMAC<T>::DeriveKey(byte *derived, size_t derivedLen, byte pu
 	// Business logic
 	if (!iterations) { iterations = 1; }
 
+	// Two compression calls per iteration when T has a static transform
+	const unsigned int count = PBKDF2_HMAC_KeyState<T>::DeriveKey(derived, derivedLen,
+		secret, secretLen, salt, saltLen, iterations, timeInSeconds);
+	if (count)
+		return count;
+
 	// DigestSize check due to https://github.com/weidai11/cryptopp/issues/855
 	HMAC<T> hmac(secret, secretLen);
 	if (hmac.DigestSize() == 0)
@@ -8,9 +8,13 @@
 #include "filters.h"
 #include "misc.h"
 
+#include <typeinfo>
+
 NAMESPACE_BEGIN(CryptoPP)
 
 static const unsigned int s_maxAutoNodeSize = 16*1024;
+// High water mark for the free list of each ByteQueue
+static const unsigned int s_maxFreeNodes = 4;
 
 // this class for use by ByteQueue only
 class ByteQueueNode
@@ -35,6 +39,11 @@ public:
 		return (m_head==MaxSize());
 	}
 
+	inline bool Full() const
+	{
+		return (m_tail==MaxSize());
+	}
+
 	inline void Clear()
 	{
 		m_head = m_tail = 0;
@@ -133,7 +142,8 @@ public:
 
 ByteQueue::ByteQueue(size_t nodeSize)
 	: Bufferless<BufferedTransformation>(), m_autoNodeSize(!nodeSize), m_nodeSize(nodeSize)
-	, m_head(NULLPTR), m_tail(NULLPTR), m_lazyString(NULLPTR), m_lazyLength(0), m_lazyStringModifiable(false)
+	, m_head(NULLPTR), m_tail(NULLPTR), m_free(NULLPTR), m_freeCount(0)
+	, m_lazyString(NULLPTR), m_lazyLength(0), m_lazyStringModifiable(false)
 {
 	SetNodeSize(nodeSize);
 	m_head = m_tail = new ByteQueueNode(m_nodeSize);
@@ -146,7 +156,8 @@ void ByteQueue::SetNodeSize(size_t nodeSize)
 }
 
 ByteQueue::ByteQueue(const ByteQueue &copy)
-	: Bufferless<BufferedTransformation>(copy), m_lazyString(NULLPTR), m_lazyLength(0)
+	: Bufferless<BufferedTransformation>(copy), m_free(NULLPTR), m_freeCount(0)
+	, m_lazyString(NULLPTR), m_lazyLength(0)
 {
 	CopyFrom(copy);
 }
@@ -181,6 +192,72 @@ void ByteQueue::Destroy()
 		next=current->m_next;
 		delete current;
 	}
+
+	for (ByteQueueNode *next, *current=m_free; current; current=next)
+	{
+		next=current->m_next;
+		delete current;
+	}
+
+	m_free = NULLPTR;
+	m_freeCount = 0;
+}
+
+ByteQueueNode * ByteQueue::NewNode(size_t size)
+{
+	// Nodes too small for the request are dropped. With automatic
+	// node sizing the free list drains as the node size grows.
+	while (m_free)
+	{
+		ByteQueueNode *node = m_free;
+		m_free = node->m_next;
+		m_freeCount--;
+
+		if (node->MaxSize() >= size)
+		{
+			node->Clear();
+			node->m_next = NULLPTR;
+			return node;
+		}
+		delete node;
+	}
+
+	return new ByteQueueNode(size);
+}
+
+void ByteQueue::RecycleNode(ByteQueueNode *node)
+{
+	if (m_freeCount < s_maxFreeNodes)
+	{
+		// A free node must not keep the data it carried. The whole
+		// buffer is wiped because CreatePutSpace() hands out the
+		// space past m_tail.
+		SecureWipeArray(node->m_buf.begin(), node->m_buf.size());
+		node->Clear();
+		node->m_next = m_free;
+		m_free = node;
+		m_freeCount++;
+	}
+	else
+		delete node;
+}
+
+void ByteQueue::AppendNode(ByteQueueNode *node)
+{
+	// Nodes other than the tail must be full. An empty queue gives
+	// its only node up; a partial tail is filled by the caller first.
+	node->m_next = NULLPTR;
+	if (m_head == m_tail && m_head->CurrentSize() == 0)
+	{
+		RecycleNode(m_head);
+		m_head = m_tail = node;
+	}
+	else
+	{
+		CRYPTOPP_ASSERT(m_tail->Full());
+		m_tail->m_next = node;
+		m_tail = node;
+	}
 }
 
 void ByteQueue::IsolatedInitialize(const NameValuePairs &parameters)
@@ -209,7 +286,7 @@ void ByteQueue::Clear()
 	for (ByteQueueNode *next, *current=m_head->m_next; current; current=next)
 	{
 		next=current->m_next;
-		delete current;
+		RecycleNode(current);
 	}
 
 	m_tail = m_head;
@@ -236,7 +313,7 @@ size_t ByteQueue::Put2(const byte *inString, size_t length, int messageEnd, bool
 				m_nodeSize *= 2;
 			}
 			while (m_nodeSize < length && m_nodeSize < s_maxAutoNodeSize);
-		m_tail->m_next = new ByteQueueNode(STDMAX(m_nodeSize, length));
+		m_tail->m_next = NewNode(STDMAX(m_nodeSize, length));
 		m_tail = m_tail->m_next;
 	}
 
@@ -250,7 +327,7 @@ void ByteQueue::CleanupUsedNodes()
 	{
 		ByteQueueNode *temp=m_head;
 		m_head=m_head->m_next;
-		delete temp;
+		RecycleNode(temp);
 	}
 
 	// Test for m_head due to Enterprise Anlysis finding
@@ -343,6 +420,16 @@ size_t ByteQueue::Peek(byte *outString, size_t peekMax) const
 
 size_t ByteQueue::TransferTo2(BufferedTransformation &target, lword &transferBytes, const std::string &channel, bool blocking)
 {
+	// Exact types only. A derived class may override Put2.
+	if (blocking && channel == DEFAULT_CHANNEL)
+	{
+		if (typeid(target) == typeid(ByteQueue))
+		{
+			transferBytes = MoveTo(static_cast<ByteQueue&>(target), transferBytes);
+			return 0;
+		}
+	}
+
 	if (blocking)
 	{
 		lword bytesLeft = transferBytes;
@@ -373,6 +460,53 @@ size_t ByteQueue::TransferTo2(BufferedTransformation &target, lword &transferByt
 	}
 }
 
+lword ByteQueue::MoveTo(ByteQueue &target, lword transferMax)
+{
+	if (&target == this)
+		return 0;
+
+	if (target.m_lazyLength > 0)
+		target.FinalizeLazyPut();
+
+	lword moved = 0;
+	while (moved < transferMax && m_head->CurrentSize() > 0)
+	{
+		ByteQueueNode *node = m_head;
+		const size_t size = node->CurrentSize();
+		ByteQueueNode *tail = target.m_tail;
+		const bool targetReady = tail->Full() || (target.m_head == tail && tail->CurrentSize() == 0);
+
+		if (node != m_tail && size <= transferMax-moved && targetReady)
+		{
+			// The source keeps at least its tail node
+			m_head = node->m_next;
+			target.AppendNode(node);
+			moved += size;
+		}
+		else
+		{
+			// Top off a partial target tail so later nodes can move
+			lword len = UnsignedMin(size, transferMax-moved);
+			if (!targetReady)
+				len = UnsignedMin(len, tail->MaxSize()-tail->m_tail);
+
+			moved += node->TransferTo(target, len);
+			CleanupUsedNodes();
+		}
+	}
+
+	const size_t len = (size_t)UnsignedMin(transferMax-moved, m_lazyLength);
+	if (len)
+	{
+		target.Put(m_lazyString, len);
+		m_lazyString = PtrAdd(m_lazyString, len);
+		m_lazyLength -= len;
+		moved += len;
+	}
+
+	return moved;
+}
+
 size_t ByteQueue::CopyRangeTo2(BufferedTransformation &target, lword &begin, lword end, const std::string &channel, bool blocking) const
 {
 	Walker walker(*this);
@@ -423,7 +557,7 @@ byte * ByteQueue::CreatePutSpace(size_t &size)
 
 	if (m_tail->m_tail == m_tail->MaxSize())
 	{
-		m_tail->m_next = new ByteQueueNode(STDMAX(m_nodeSize, size));
+		m_tail->m_next = NewNode(STDMAX(m_nodeSize, size));
 		m_tail = m_tail->m_next;
 	}
 
@@ -475,6 +609,8 @@ void ByteQueue::swap(ByteQueue &rhs)
 	std::swap(m_nodeSize, rhs.m_nodeSize);
 	std::swap(m_head, rhs.m_head);
 	std::swap(m_tail, rhs.m_tail);
+	std::swap(m_free, rhs.m_free);
+	std::swap(m_freeCount, rhs.m_freeCount);
 	std::swap(m_lazyString, rhs.m_lazyString);
 	std::swap(m_lazyLength, rhs.m_lazyLength);
 	std::swap(m_lazyStringModifiable, rhs.m_lazyStringModifiable);
@@ -51,6 +51,17 @@ public:
 	// these member functions are not inherited
 	void SetNodeSize(size_t nodeSize);
 
+	/// \brief Moves bytes to another ByteQueue
+	/// \param target the destination ByteQueue
+	/// \param transferMax the maximum number of bytes to move
+	/// \returns the number of bytes moved
+	/// \details Filled nodes are unlinked from this queue and linked into
+	///   the target without copying. Partial nodes and lazy strings are copied.
+	/// \details TransferTo2() calls MoveTo() when the target is a ByteQueue on
+	///   the default channel. MessageQueue::MoveFrom() moves into a MessageQueue.
+	/// \since Crypto++ 8.4
+	lword MoveTo(ByteQueue &target, lword transferMax=LWORD_MAX);
+
 	lword CurrentSize() const;
 	bool IsEmpty() const;
 
@@ -114,9 +125,16 @@ private:
 	void CopyFrom(const ByteQueue &copy);
 	void Destroy();
 
+	// Nodes are recycled through a short free list rather than deleted
+	ByteQueueNode * NewNode(size_t size);
+	void RecycleNode(ByteQueueNode *node);
+	void AppendNode(ByteQueueNode *node);
+
 	bool m_autoNodeSize;
 	size_t m_nodeSize;
 	ByteQueueNode *m_head, *m_tail;
+	ByteQueueNode *m_free;
+	size_t m_freeCount;
 	byte *m_lazyString;
 	size_t m_lazyLength;
 	bool m_lazyStringModifiable;
@@ -146,6 +146,8 @@ void RegisterFactories1()
 	RegisterDefaultFactoryFor<NIST_DRBG, Hash_DRBG<SHA256> >("Hash_DRBG(SHA256)");
 	RegisterDefaultFactoryFor<NIST_DRBG, HMAC_DRBG<SHA1> >("HMAC_DRBG(SHA1)");
 	RegisterDefaultFactoryFor<NIST_DRBG, HMAC_DRBG<SHA256> >("HMAC_DRBG(SHA256)");
+	RegisterDefaultFactoryFor<NIST_DRBG, CTR_DRBG<AES, 128/8> >("CTR_DRBG(AES-128)");
+	RegisterDefaultFactoryFor<NIST_DRBG, CTR_DRBG<AES, 256/8> >("CTR_DRBG(AES-256)");
 
 	RegisterDefaultFactoryFor<KeyDerivationFunction, HKDF<SHA1> >();
 	RegisterDefaultFactoryFor<KeyDerivationFunction, HKDF<SHA256> >();
@@ -318,6 +318,9 @@ extern size_t Rijndael_Enc_AdvancedProcessBlocks_AESNI(const word32 *subkeys, si
         const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags);
 extern size_t Rijndael_Dec_AdvancedProcessBlocks_AESNI(const word32 *subkeys, size_t rounds,
         const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags);
+extern void Rijndael_Enc_ExpandKeys_AESNI(const byte *userKeys, size_t keyLen, word32 *rk, size_t stride, size_t count);
+extern void Rijndael_Enc_ProcessMultiKey_AESNI(const word32 *keys, size_t stride, size_t rounds,
+        const size_t *keyIndexes, const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t count);
 #endif
 
 #if (CRYPTOPP_ARM_AES_AVAILABLE)
@@ -325,6 +328,8 @@ extern size_t Rijndael_Enc_AdvancedProcessBlocks_ARMV8(const word32 *subkeys, si
         const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags);
 extern size_t Rijndael_Dec_AdvancedProcessBlocks_ARMV8(const word32 *subkeys, size_t rounds,
         const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t length, word32 flags);
+extern void Rijndael_Enc_ProcessMultiKey_ARMV8(const word32 *keys, size_t stride, size_t rounds,
+        const size_t *keyIndexes, const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t count);
 #endif
 
 #if (CRYPTOGAMS_ARM_AES)
@@ -392,6 +397,43 @@ std::string Rijndael::Base::AlgorithmProvider() const
 	return "C++";
 }
 
+void Rijndael::Base::ExpandKey(const byte *userKey, unsigned int keyLen, word32 *rk)
+{
+	const word32 *end = rk + 4*(keyLen/4 + 6 + 1);
+	GetUserKey(BIG_ENDIAN_ORDER, rk, keyLen/4, userKey, keyLen);
+	const word32 *rc = rcon;
+	word32 temp;
+
+	while (true)
+	{
+		temp  = rk[keyLen/4-1];
+		word32 x = (word32(Se[GETBYTE(temp, 2)]) << 24) ^ (word32(Se[GETBYTE(temp, 1)]) << 16) ^
+					(word32(Se[GETBYTE(temp, 0)]) << 8) ^ Se[GETBYTE(temp, 3)];
+		rk[keyLen/4] = rk[0] ^ x ^ *(rc++);
+		rk[keyLen/4+1] = rk[1] ^ rk[keyLen/4];
+		rk[keyLen/4+2] = rk[2] ^ rk[keyLen/4+1];
+		rk[keyLen/4+3] = rk[3] ^ rk[keyLen/4+2];
+
+		if (rk + keyLen/4 + 4 == end)
+			break;
+
+		if (keyLen == 24)
+		{
+			rk[10] = rk[ 4] ^ rk[ 9];
+			rk[11] = rk[ 5] ^ rk[10];
+		}
+		else if (keyLen == 32)
+		{
+    		temp = rk[11];
+    		rk[12] = rk[ 4] ^ (word32(Se[GETBYTE(temp, 3)]) << 24) ^ (word32(Se[GETBYTE(temp, 2)]) << 16) ^ (word32(Se[GETBYTE(temp, 1)]) << 8) ^ Se[GETBYTE(temp, 0)];
+    		rk[13] = rk[ 5] ^ rk[12];
+    		rk[14] = rk[ 6] ^ rk[13];
+    		rk[15] = rk[ 7] ^ rk[14];
+		}
+		rk += keyLen/4;
+	}
+}
+
 void Rijndael::Base::UncheckedSetKey(const byte *userKey, unsigned int keyLen, const NameValuePairs &)
 {
 	AssertValidKeyLength(keyLen);
@@ -445,41 +487,9 @@ void Rijndael::Base::UncheckedSetKey(const byte *userKey, unsigned int keyLen, c
 	}
 #endif
 
-	GetUserKey(BIG_ENDIAN_ORDER, rk, keyLen/4, userKey, keyLen);
-	const word32 *rc = rcon;
+	ExpandKey(userKey, keyLen, rk);
 	word32 temp;
 
-	while (true)
-	{
-		temp  = rk[keyLen/4-1];
-		word32 x = (word32(Se[GETBYTE(temp, 2)]) << 24) ^ (word32(Se[GETBYTE(temp, 1)]) << 16) ^
-					(word32(Se[GETBYTE(temp, 0)]) << 8) ^ Se[GETBYTE(temp, 3)];
-		rk[keyLen/4] = rk[0] ^ x ^ *(rc++);
-		rk[keyLen/4+1] = rk[1] ^ rk[keyLen/4];
-		rk[keyLen/4+2] = rk[2] ^ rk[keyLen/4+1];
-		rk[keyLen/4+3] = rk[3] ^ rk[keyLen/4+2];
-
-		if (rk + keyLen/4 + 4 == m_key.end())
-			break;
-
-		if (keyLen == 24)
-		{
-			rk[10] = rk[ 4] ^ rk[ 9];
-			rk[11] = rk[ 5] ^ rk[10];
-		}
-		else if (keyLen == 32)
-		{
-    		temp = rk[11];
-    		rk[12] = rk[ 4] ^ (word32(Se[GETBYTE(temp, 3)]) << 24) ^ (word32(Se[GETBYTE(temp, 2)]) << 16) ^ (word32(Se[GETBYTE(temp, 1)]) << 8) ^ Se[GETBYTE(temp, 0)];
-    		rk[13] = rk[ 5] ^ rk[12];
-    		rk[14] = rk[ 6] ^ rk[13];
-    		rk[15] = rk[ 7] ^ rk[14];
-		}
-		rk += keyLen/4;
-	}
-
-	rk = m_key;
-
 	if (IsForwardTransformation())
 	{
 		if (!s_TeFilled)
@@ -527,50 +537,17 @@ void Rijndael::Base::UncheckedSetKey(const byte *userKey, unsigned int keyLen, c
 #endif
 }
 
-void Rijndael::Enc::ProcessAndXorBlock(const byte *inBlock, const byte *xorBlock, byte *outBlock) const
+// Used by Rijndael::Enc and Rijndael::KeyArray. The key schedule is
+// in the portable format, with the first and last round keys in
+// native byte order.
+static inline void Rijndael_Enc_ProcessAndXorBlock_CXX(const word32 *rk, unsigned int rounds,
+	const byte *inBlock, const byte *xorBlock, byte *outBlock)
 {
-#if CRYPTOPP_SSE2_ASM_AVAILABLE || defined(CRYPTOPP_X64_MASM_AVAILABLE) || CRYPTOPP_AESNI_AVAILABLE
-# if (CRYPTOPP_SSE2_ASM_AVAILABLE || defined(CRYPTOPP_X64_MASM_AVAILABLE)) && !defined(CRYPTOPP_DISABLE_RIJNDAEL_ASM)
-	if (HasSSE2())
-# else
-	if (HasAESNI())
-# endif
-	{
-		(void)Rijndael::Enc::AdvancedProcessBlocks(inBlock, xorBlock, outBlock, 16, 0);
-		return;
-	}
-#endif
-
-#if (CRYPTOPP_ARM_AES_AVAILABLE)
-	if (HasAES())
-	{
-		(void)Rijndael::Enc::AdvancedProcessBlocks(inBlock, xorBlock, outBlock, 16, 0);
-		return;
-	}
-#endif
-
-#if (CRYPTOGAMS_ARM_AES)
-	if (HasARMv7())
-	{
-		CRYPTOGAMS_encrypt(inBlock, xorBlock, outBlock, m_key.begin());
-		return;
-	}
-#endif
-
-#if (CRYPTOPP_POWER8_AES_AVAILABLE)
-	if (HasAES())
-	{
-		(void)Rijndael::Enc::AdvancedProcessBlocks(inBlock, xorBlock, outBlock, 16, 0);
-		return;
-	}
-#endif
-
 	typedef BlockGetAndPut<word32, NativeByteOrder> Block;
 
 	word32 s0, s1, s2, s3, t0, t1, t2, t3;
 	Block::Get(inBlock)(s0)(s1)(s2)(s3);
 
-	const word32 *rk = m_key;
 	s0 ^= rk[0];
 	s1 ^= rk[1];
 	s2 ^= rk[2];
@@ -602,7 +579,7 @@ void Rijndael::Enc::ProcessAndXorBlock(const byte *inBlock, const byte *xorBlock
 	QUARTER_ROUND_FE(s0, t1, t2, t3, t0)
 
 	// Nr - 2 full rounds:
-	unsigned int r = m_rounds/2 - 1;
+	unsigned int r = rounds/2 - 1;
 	do
 	{
 		s0 = rk[0]; s1 = rk[1]; s2 = rk[2]; s3 = rk[3];
@@ -633,6 +610,47 @@ void Rijndael::Enc::ProcessAndXorBlock(const byte *inBlock, const byte *xorBlock
 	Block::Put(xorBlock, outBlock)(tbw[0]^rk[0])(tbw[1]^rk[1])(tbw[2]^rk[2])(tbw[3]^rk[3]);
 }
 
+void Rijndael::Enc::ProcessAndXorBlock(const byte *inBlock, const byte *xorBlock, byte *outBlock) const
+{
+#if CRYPTOPP_SSE2_ASM_AVAILABLE || defined(CRYPTOPP_X64_MASM_AVAILABLE) || CRYPTOPP_AESNI_AVAILABLE
+# if (CRYPTOPP_SSE2_ASM_AVAILABLE || defined(CRYPTOPP_X64_MASM_AVAILABLE)) && !defined(CRYPTOPP_DISABLE_RIJNDAEL_ASM)
+	if (HasSSE2())
+# else
+	if (HasAESNI())
+# endif
+	{
+		(void)Rijndael::Enc::AdvancedProcessBlocks(inBlock, xorBlock, outBlock, 16, 0);
+		return;
+	}
+#endif
+
+#if (CRYPTOPP_ARM_AES_AVAILABLE)
+	if (HasAES())
+	{
+		(void)Rijndael::Enc::AdvancedProcessBlocks(inBlock, xorBlock, outBlock, 16, 0);
+		return;
+	}
+#endif
+
+#if (CRYPTOGAMS_ARM_AES)
+	if (HasARMv7())
+	{
+		CRYPTOGAMS_encrypt(inBlock, xorBlock, outBlock, m_key.begin());
+		return;
+	}
+#endif
+
+#if (CRYPTOPP_POWER8_AES_AVAILABLE)
+	if (HasAES())
+	{
+		(void)Rijndael::Enc::AdvancedProcessBlocks(inBlock, xorBlock, outBlock, 16, 0);
+		return;
+	}
+#endif
+
+	Rijndael_Enc_ProcessAndXorBlock_CXX(m_key, m_rounds, inBlock, xorBlock, outBlock);
+}
+
 void Rijndael::Dec::ProcessAndXorBlock(const byte *inBlock, const byte *xorBlock, byte *outBlock) const
 {
 #if CRYPTOPP_AESNI_AVAILABLE
@@ -746,6 +764,111 @@ void Rijndael::Dec::ProcessAndXorBlock(const byte *inBlock, const byte *xorBlock
 	Block::Put(xorBlock, outBlock)(tbw[0]^rk[0])(tbw[1]^rk[1])(tbw[2]^rk[2])(tbw[3]^rk[3]);
 }
 
+// ************************* Key Array ****************************************
+
+Rijndael::KeyArray::KeyArray(size_t count, size_t keyLength)
+	: m_keyLength(static_cast<unsigned int>(keyLength)), m_rounds(static_cast<unsigned int>(keyLength/4 + 6))
+{
+	if (keyLength != 16 && keyLength != 24 && keyLength != 32)
+		throw InvalidKeyLength("AES", keyLength);
+
+	m_keys.New(count * KeyScheduleWords());
+}
+
+void Rijndael::KeyArray::Resize(size_t count)
+{
+	m_keys.Grow(count * KeyScheduleWords());
+	m_keys.resize(count * KeyScheduleWords());
+}
+
+void Rijndael::KeyArray::SetKey(size_t index, const byte *key, size_t length)
+{
+	if (length != m_keyLength)
+		throw InvalidKeyLength("AES", length);
+
+	SetKeys(index, key, 1);
+}
+
+void Rijndael::KeyArray::SetKeys(size_t index, const byte *keys, size_t count)
+{
+	if (index > Count() || count > Count() - index)
+		throw InvalidArgument("AES: key index " + IntToString(index) + " plus count " + IntToString(count) + " exceeds key count");
+
+	const size_t stride = KeyScheduleWords();
+	word32 *rk = m_keys + index * stride;
+
+#if (CRYPTOPP_AESNI_AVAILABLE && CRYPTOPP_SSE41_AVAILABLE && (!defined(_MSC_VER) || _MSC_VER >= 1600 || CRYPTOPP_BOOL_X86 || CRYPTOPP_BOOL_X32))
+	if (HasAESNI() && HasSSE41())
+	{
+		Rijndael_Enc_ExpandKeys_AESNI(keys, m_keyLength, rk, stride, count);
+		return;
+	}
+#endif
+
+	if (!s_TeFilled)
+		Base::FillEncTable();
+
+	// Same layout as Rijndael::Enc, without the Power8 and ARMv7
+	// formats. Those platforms use the portable code.
+	for (size_t i=0; i<count; ++i, keys += m_keyLength, rk += stride)
+	{
+		Base::ExpandKey(keys, m_keyLength, rk);
+		ConditionalByteReverse(BIG_ENDIAN_ORDER, rk, rk, 16);
+		ConditionalByteReverse(BIG_ENDIAN_ORDER, rk + m_rounds*4, rk + m_rounds*4, 16);
+
+#if CRYPTOPP_AESNI_AVAILABLE
+		if (HasAESNI())
+			ConditionalByteReverse(BIG_ENDIAN_ORDER, rk+4, rk+4, (m_rounds-1)*16);
+#endif
+#if CRYPTOPP_ARM_AES_AVAILABLE
+		if (HasAES())
+			ConditionalByteReverse(BIG_ENDIAN_ORDER, rk+4, rk+4, (m_rounds-1)*16);
+#endif
+	}
+}
+
+void Rijndael::KeyArray::EncryptBlocks(const byte *inBlocks, const byte *xorBlocks, byte *outBlocks,
+	size_t count, const size_t *keyIndexes) const
+{
+	const size_t keys = Count();
+	if (keyIndexes)
+	{
+		for (size_t i=0; i<count; ++i)
+		{
+			if (keyIndexes[i] >= keys)
+				throw InvalidArgument("AES: key index " + IntToString(keyIndexes[i]) + " is out of range");
+		}
+	}
+	else if (count > keys)
+		throw InvalidArgument("AES: block count " + IntToString(count) + " exceeds key count");
+
+	const size_t stride = KeyScheduleWords();
+
+#if CRYPTOPP_AESNI_AVAILABLE
+	if (HasAESNI())
+	{
+		Rijndael_Enc_ProcessMultiKey_AESNI(m_keys, stride, m_rounds,
+			keyIndexes, inBlocks, xorBlocks, outBlocks, count);
+		return;
+	}
+#endif
+#if CRYPTOPP_ARM_AES_AVAILABLE
+	if (HasAES())
+	{
+		Rijndael_Enc_ProcessMultiKey_ARMV8(m_keys, stride, m_rounds,
+			keyIndexes, inBlocks, xorBlocks, outBlocks, count);
+		return;
+	}
+#endif
+
+	for (size_t i=0; i<count; ++i)
+	{
+		const size_t index = keyIndexes ? keyIndexes[i] : i;
+		Rijndael_Enc_ProcessAndXorBlock_CXX(m_keys + index*stride, m_rounds,
+			inBlocks+16*i, xorBlocks ? xorBlocks+16*i : NULLPTR, outBlocks+16*i);
+	}
+}
+
 // ************************* Assembly Code ************************************
 
 #if CRYPTOPP_MSC_VERSION
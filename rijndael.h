@@ -44,6 +44,10 @@ struct Rijndael_Info : public FixedBlockSize<16>, public VariableKeyLength<16, 1
 /// \sa <a href="http://www.cryptopp.com/wiki/Rijndael">Rijndael</a>
 class CRYPTOPP_DLL Rijndael : public Rijndael_Info, public BlockCipherDocumentation
 {
+public:
+	class KeyArray;
+
+private:
 	/// \brief Rijndael block cipher transformation functions
 	/// \details Provides implementation common to encryption and decryption
 	class CRYPTOPP_DLL CRYPTOPP_NO_VTABLE Base : public BlockCipherImpl<Rijndael_Info>
@@ -54,6 +58,9 @@ class CRYPTOPP_DLL Rijndael : public Rijndael_Info, public BlockCipherDocumentat
 		unsigned int OptimalDataAlignment() const;
 
 	protected:
+		friend class KeyArray;
+
+		static void ExpandKey(const byte *userKey, unsigned int keyLength, word32 *rk);
 		static void FillEncTable();
 		static void FillDecTable();
 
@@ -99,6 +106,82 @@ class CRYPTOPP_DLL Rijndael : public Rijndael_Info, public BlockCipherDocumentat
 public:
 	typedef BlockCipherFinal<ENCRYPTION, Enc> Encryption;
 	typedef BlockCipherFinal<DECRYPTION, Dec> Decryption;
+
+	/// \brief Expanded encryption keys for many keys
+	/// \details KeyArray holds the expanded encryption keys of many AES keys
+	///   of the same length, packed one after another in a single block of
+	///   memory. SetKey() expands a key in place and does not allocate.
+	///   EncryptBlocks() encrypts each block under its own key, and keeps
+	///   several keys in flight at once through the AES-NI or ARMv8 AES unit.
+	/// \details KeyArray is intended for work that encrypts a few blocks
+	///   under each of many keys, like QUIC header protection or per-object
+	///   key wrapping. Keying an Encryption object for each key costs more
+	///   than the encryption itself in that case.
+	/// \details Only encryption is provided. KeyArray is not thread safe
+	///   while keys are being set.
+	/// \since Crypto++ 8.4
+	class CRYPTOPP_DLL KeyArray
+	{
+	public:
+		/// \brief Construct a KeyArray
+		/// \param count the number of keys
+		/// \param keyLength the length of each key, in bytes
+		/// \throws InvalidKeyLength if keyLength is not 16, 24 or 32
+		/// \details The slots hold no valid key until they are set with SetKey()
+		///   or SetKeys(). Encrypting under an unset slot does not give AES under
+		///   any key.
+		KeyArray(size_t count=0, size_t keyLength=DEFAULT_KEYLENGTH);
+
+		/// \brief Provides the number of keys
+		/// \return the number of keys
+		size_t Count() const {return m_keys.size() / KeyScheduleWords();}
+
+		/// \brief Provides the key length
+		/// \return the length of each key, in bytes
+		size_t KeyLength() const {return m_keyLength;}
+
+		/// \brief Change the number of keys
+		/// \param count the number of keys
+		/// \details Keys below the new count are kept. New slots hold no valid
+		///   key and must be set with SetKey() or SetKeys() before use.
+		void Resize(size_t count);
+
+		/// \brief Set a key
+		/// \param index the index of the key
+		/// \param key the key
+		/// \param length the size of the key, in bytes
+		/// \throws InvalidKeyLength if length is not KeyLength()
+		/// \throws InvalidArgument if index is not less than Count()
+		void SetKey(size_t index, const byte *key, size_t length);
+
+		/// \brief Set consecutive keys
+		/// \param index the index of the first key
+		/// \param keys the keys, each KeyLength() bytes, one after another
+		/// \param count the number of keys
+		/// \throws InvalidArgument if <tt>index+count</tt> exceeds Count()
+		/// \details SetKeys() is faster than calling SetKey() for each key
+		///   because the key expansions overlap.
+		void SetKeys(size_t index, const byte *keys, size_t count);
+
+		/// \brief Encrypt blocks under different keys
+		/// \param inBlocks the input blocks
+		/// \param xorBlocks optional blocks to xor with the output, or NULL
+		/// \param outBlocks the output blocks
+		/// \param count the number of blocks
+		/// \param keyIndexes array of count key indexes, or NULL
+		/// \throws InvalidArgument if a key index is not less than Count()
+		/// \details Block i is encrypted under key <tt>keyIndexes[i]</tt>, or
+		///   under key i if keyIndexes is NULL. inBlocks and outBlocks may be
+		///   the same buffer.
+		void EncryptBlocks(const byte *inBlocks, const byte *xorBlocks, byte *outBlocks,
+			size_t count, const size_t *keyIndexes=NULLPTR) const;
+
+	private:
+		size_t KeyScheduleWords() const {return 4*(m_rounds+1);}
+
+		SecBlock<word32, AllocatorWithCleanup<word32, true> > m_keys;
+		unsigned int m_keyLength, m_rounds;
+	};
 };
 
 typedef Rijndael::Encryption RijndaelEncryption;
@@ -244,6 +244,37 @@ static inline void ARMV8_Enc_6_Blocks(uint64x2_t &data0, uint64x2_t &data1,
     data5 = vreinterpretq_u64_u8(veorq_u8(block5, key));
 }
 
+// Encrypts each block under its own key. The rounds of the
+// blocks are interleaved to keep the AES unit busy.
+static inline void ARMV8_Enc_8_Keys(uint8x16_t &block0, uint8x16_t &block1, uint8x16_t &block2, uint8x16_t &block3,
+    uint8x16_t &block4, uint8x16_t &block5, uint8x16_t &block6, uint8x16_t &block7,
+    const byte *keys0, const byte *keys1, const byte *keys2, const byte *keys3,
+    const byte *keys4, const byte *keys5, const byte *keys6, const byte *keys7, unsigned int rounds)
+{
+    for (unsigned int i=0; i<rounds-1; ++i)
+    {
+        // AES single round encryption and mix columns
+        block0 = vaesmcq_u8(vaeseq_u8(block0, vld1q_u8(keys0+i*16)));
+        block1 = vaesmcq_u8(vaeseq_u8(block1, vld1q_u8(keys1+i*16)));
+        block2 = vaesmcq_u8(vaeseq_u8(block2, vld1q_u8(keys2+i*16)));
+        block3 = vaesmcq_u8(vaeseq_u8(block3, vld1q_u8(keys3+i*16)));
+        block4 = vaesmcq_u8(vaeseq_u8(block4, vld1q_u8(keys4+i*16)));
+        block5 = vaesmcq_u8(vaeseq_u8(block5, vld1q_u8(keys5+i*16)));
+        block6 = vaesmcq_u8(vaeseq_u8(block6, vld1q_u8(keys6+i*16)));
+        block7 = vaesmcq_u8(vaeseq_u8(block7, vld1q_u8(keys7+i*16)));
+    }
+
+    // AES single round encryption and final Add (bitwise Xor)
+    block0 = veorq_u8(vaeseq_u8(block0, vld1q_u8(keys0+(rounds-1)*16)), vld1q_u8(keys0+rounds*16));
+    block1 = veorq_u8(vaeseq_u8(block1, vld1q_u8(keys1+(rounds-1)*16)), vld1q_u8(keys1+rounds*16));
+    block2 = veorq_u8(vaeseq_u8(block2, vld1q_u8(keys2+(rounds-1)*16)), vld1q_u8(keys2+rounds*16));
+    block3 = veorq_u8(vaeseq_u8(block3, vld1q_u8(keys3+(rounds-1)*16)), vld1q_u8(keys3+rounds*16));
+    block4 = veorq_u8(vaeseq_u8(block4, vld1q_u8(keys4+(rounds-1)*16)), vld1q_u8(keys4+rounds*16));
+    block5 = veorq_u8(vaeseq_u8(block5, vld1q_u8(keys5+(rounds-1)*16)), vld1q_u8(keys5+rounds*16));
+    block6 = veorq_u8(vaeseq_u8(block6, vld1q_u8(keys6+(rounds-1)*16)), vld1q_u8(keys6+rounds*16));
+    block7 = veorq_u8(vaeseq_u8(block7, vld1q_u8(keys7+(rounds-1)*16)), vld1q_u8(keys7+rounds*16));
+}
+
 static inline void ARMV8_Dec_Block(uint64x2_t &data, const word32 *subkeys, unsigned int rounds)
 {
     CRYPTOPP_ASSERT(subkeys);
@@ -354,6 +385,49 @@ size_t Rijndael_Dec_AdvancedProcessBlocks_ARMV8(const word32 *subKeys, size_t ro
             subKeys, rounds, inBlocks, xorBlocks, outBlocks, length, flags);
 }
 
+void Rijndael_Enc_ProcessMultiKey_ARMV8(const word32 *keys, size_t stride, size_t rounds,
+        const size_t *keyIndexes, const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t count)
+{
+    const unsigned int lanes = 8;
+    const byte* skeys[lanes];
+    uint8x16_t blocks[lanes];
+
+    if (count == 1)
+    {
+        const word32* sk = keys + stride*(keyIndexes ? keyIndexes[0] : 0);
+        uint64x2_t block = vreinterpretq_u64_u8(vld1q_u8(inBlocks));
+        ARMV8_Enc_Block(block, sk, (unsigned int)rounds);
+        uint8x16_t result = vreinterpretq_u8_u64(block);
+        if (xorBlocks)
+            result = veorq_u8(result, vld1q_u8(xorBlocks));
+        vst1q_u8(outBlocks, result);
+        return;
+    }
+
+    // A short last group repeats its last block in the unused lanes.
+    // Interleaving still beats encrypting the blocks one at a time.
+    for (size_t i = 0; i < count; i += lanes)
+    {
+        const unsigned int n = (unsigned int)STDMIN(size_t(lanes), count-i);
+        for (unsigned int j=0; j<lanes; ++j)
+        {
+            const size_t k = i + STDMIN(j, n-1);
+            skeys[j] = reinterpret_cast<const byte*>(keys + stride*(keyIndexes ? keyIndexes[k] : k));
+            blocks[j] = vld1q_u8(inBlocks+16*k);
+        }
+
+        ARMV8_Enc_8_Keys(blocks[0], blocks[1], blocks[2], blocks[3], blocks[4], blocks[5], blocks[6], blocks[7],
+            skeys[0], skeys[1], skeys[2], skeys[3], skeys[4], skeys[5], skeys[6], skeys[7], (unsigned int)rounds);
+
+        for (unsigned int j=0; j<n; ++j)
+        {
+            if (xorBlocks)
+                blocks[j] = veorq_u8(blocks[j], vld1q_u8(xorBlocks+16*(i+j)));
+            vst1q_u8(outBlocks+16*(i+j), blocks[j]);
+        }
+    }
+}
+
 #endif  // CRYPTOPP_ARM_AES_AVAILABLE
 
 // ***************************** AES-NI ***************************** //
@@ -407,6 +481,116 @@ static inline void AESNI_Enc_4_Blocks(__m128i &block0, __m128i &block1, __m128i
     block3 = _mm_aesenclast_si128(block3, rk);
 }
 
+// SubWord of the last word, optionally rotated, in all four words
+// plus the round constant. ShiftRows has no effect when the four
+// columns are equal, so AESENCLAST performs SubWord. The schedule
+// has no scalar extracts, so several keys can be in flight at once.
+static inline __m128i AESNI_SubWord(const __m128i &key, const __m128i &mask, const __m128i &rcon)
+{
+    return _mm_aesenclast_si128(_mm_shuffle_epi8(key, mask), rcon);
+}
+
+static inline __m128i AESNI_NextKey(__m128i key, const __m128i &temp)
+{
+    key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+    key = _mm_xor_si128(key, _mm_slli_si128(key, 8));
+    return _mm_xor_si128(key, temp);
+}
+
+static inline void AESNI_ExpandKey_128(const byte *userKey, __m128i *rk)
+{
+    const __m128i rot = _mm_set_epi8(12,15,14,13, 12,15,14,13, 12,15,14,13, 12,15,14,13);
+
+    __m128i key = _mm_loadu_si128(CONST_M128_CAST(userKey));
+    _mm_store_si128(rk, key);
+    for (unsigned int i=0; i<10; ++i)
+    {
+        key = AESNI_NextKey(key, AESNI_SubWord(key, rot, _mm_set1_epi32(s_rconLE[i])));
+        _mm_store_si128(rk+i+1, key);
+    }
+}
+
+static inline void AESNI_ExpandKey_4x128(const byte *userKeys, __m128i *rk, size_t stride)
+{
+    const __m128i rot = _mm_set_epi8(12,15,14,13, 12,15,14,13, 12,15,14,13, 12,15,14,13);
+
+    __m128i key0 = _mm_loadu_si128(CONST_M128_CAST(userKeys+ 0));
+    __m128i key1 = _mm_loadu_si128(CONST_M128_CAST(userKeys+16));
+    __m128i key2 = _mm_loadu_si128(CONST_M128_CAST(userKeys+32));
+    __m128i key3 = _mm_loadu_si128(CONST_M128_CAST(userKeys+48));
+    _mm_store_si128(rk+0*stride, key0);
+    _mm_store_si128(rk+1*stride, key1);
+    _mm_store_si128(rk+2*stride, key2);
+    _mm_store_si128(rk+3*stride, key3);
+    for (unsigned int i=0; i<10; ++i)
+    {
+        const __m128i rcon = _mm_set1_epi32(s_rconLE[i]);
+        key0 = AESNI_NextKey(key0, AESNI_SubWord(key0, rot, rcon));
+        key1 = AESNI_NextKey(key1, AESNI_SubWord(key1, rot, rcon));
+        key2 = AESNI_NextKey(key2, AESNI_SubWord(key2, rot, rcon));
+        key3 = AESNI_NextKey(key3, AESNI_SubWord(key3, rot, rcon));
+        _mm_store_si128(rk+0*stride+i+1, key0);
+        _mm_store_si128(rk+1*stride+i+1, key1);
+        _mm_store_si128(rk+2*stride+i+1, key2);
+        _mm_store_si128(rk+3*stride+i+1, key3);
+    }
+}
+
+static inline void AESNI_ExpandKey_256(const byte *userKey, __m128i *rk)
+{
+    const __m128i rot = _mm_set_epi8(12,15,14,13, 12,15,14,13, 12,15,14,13, 12,15,14,13);
+    const __m128i bcast = _mm_set_epi8(15,14,13,12, 15,14,13,12, 15,14,13,12, 15,14,13,12);
+
+    __m128i key0 = _mm_loadu_si128(CONST_M128_CAST(userKey));
+    __m128i key1 = _mm_loadu_si128(CONST_M128_CAST(userKey+16));
+    _mm_store_si128(rk, key0);
+    _mm_store_si128(rk+1, key1);
+    for (unsigned int i=0; i<7; ++i)
+    {
+        key0 = AESNI_NextKey(key0, AESNI_SubWord(key1, rot, _mm_set1_epi32(s_rconLE[i])));
+        _mm_store_si128(rk+2*i+2, key0);
+        if (i == 6) break;
+        key1 = AESNI_NextKey(key1, AESNI_SubWord(key0, bcast, _mm_setzero_si128()));
+        _mm_store_si128(rk+2*i+3, key1);
+    }
+}
+
+// Encrypts each block under its own key. The rounds of the
+// blocks are interleaved to keep the AES unit busy.
+static inline void AESNI_Enc_8_Keys(__m128i &block0, __m128i &block1, __m128i &block2, __m128i &block3,
+        __m128i &block4, __m128i &block5, __m128i &block6, __m128i &block7,
+        const __m128i *skeys0, const __m128i *skeys1, const __m128i *skeys2, const __m128i *skeys3,
+        const __m128i *skeys4, const __m128i *skeys5, const __m128i *skeys6, const __m128i *skeys7, unsigned int rounds)
+{
+    block0 = _mm_xor_si128(block0, skeys0[0]);
+    block1 = _mm_xor_si128(block1, skeys1[0]);
+    block2 = _mm_xor_si128(block2, skeys2[0]);
+    block3 = _mm_xor_si128(block3, skeys3[0]);
+    block4 = _mm_xor_si128(block4, skeys4[0]);
+    block5 = _mm_xor_si128(block5, skeys5[0]);
+    block6 = _mm_xor_si128(block6, skeys6[0]);
+    block7 = _mm_xor_si128(block7, skeys7[0]);
+    for (unsigned int i=1; i<rounds; i++)
+    {
+        block0 = _mm_aesenc_si128(block0, skeys0[i]);
+        block1 = _mm_aesenc_si128(block1, skeys1[i]);
+        block2 = _mm_aesenc_si128(block2, skeys2[i]);
+        block3 = _mm_aesenc_si128(block3, skeys3[i]);
+        block4 = _mm_aesenc_si128(block4, skeys4[i]);
+        block5 = _mm_aesenc_si128(block5, skeys5[i]);
+        block6 = _mm_aesenc_si128(block6, skeys6[i]);
+        block7 = _mm_aesenc_si128(block7, skeys7[i]);
+    }
+    block0 = _mm_aesenclast_si128(block0, skeys0[rounds]);
+    block1 = _mm_aesenclast_si128(block1, skeys1[rounds]);
+    block2 = _mm_aesenclast_si128(block2, skeys2[rounds]);
+    block3 = _mm_aesenclast_si128(block3, skeys3[rounds]);
+    block4 = _mm_aesenclast_si128(block4, skeys4[rounds]);
+    block5 = _mm_aesenclast_si128(block5, skeys5[rounds]);
+    block6 = _mm_aesenclast_si128(block6, skeys6[rounds]);
+    block7 = _mm_aesenclast_si128(block7, skeys7[rounds]);
+}
+
 static inline void AESNI_Dec_Block(__m128i &block, MAYBE_CONST word32 *subkeys, unsigned int rounds)
 {
     const __m128i* skeys = reinterpret_cast<const __m128i*>(subkeys);
@@ -534,6 +718,68 @@ size_t Rijndael_Dec_AdvancedProcessBlocks_AESNI(const word32 *subKeys, size_t ro
                 sk, rounds, ib, xb, outBlocks, length, flags);
 }
 
+void Rijndael_Enc_ExpandKeys_AESNI(const byte *userKeys, size_t keyLen, word32 *rk, size_t stride, size_t count)
+{
+    size_t i=0;
+    if (keyLen == 16)
+    {
+        for (; i+4 <= count; i += 4, userKeys += 4*16, rk += 4*stride)
+            AESNI_ExpandKey_4x128(userKeys, M128_CAST(rk), stride/4);
+    }
+
+    for (; i<count; ++i, userKeys += keyLen, rk += stride)
+    {
+        if (keyLen == 16)
+            AESNI_ExpandKey_128(userKeys, M128_CAST(rk));
+        else if (keyLen == 32)
+            AESNI_ExpandKey_256(userKeys, M128_CAST(rk));
+        else
+            Rijndael_UncheckedSetKey_SSE4_AESNI(userKeys, keyLen, rk);
+    }
+}
+
+void Rijndael_Enc_ProcessMultiKey_AESNI(const word32 *keys, size_t stride, size_t rounds,
+        const size_t *keyIndexes, const byte *inBlocks, const byte *xorBlocks, byte *outBlocks, size_t count)
+{
+    const unsigned int lanes = 8;
+    const __m128i* skeys[lanes];
+    __m128i blocks[lanes];
+
+    if (count == 1)
+    {
+        const word32* sk = keys + stride*(keyIndexes ? keyIndexes[0] : 0);
+        __m128i block = _mm_loadu_si128(CONST_M128_CAST(inBlocks));
+        AESNI_Enc_Block(block, MAYBE_UNCONST_CAST(word32*, sk), (unsigned int)rounds);
+        if (xorBlocks)
+            block = _mm_xor_si128(block, _mm_loadu_si128(CONST_M128_CAST(xorBlocks)));
+        _mm_storeu_si128(M128_CAST(outBlocks), block);
+        return;
+    }
+
+    // A short last group repeats its last block in the unused lanes.
+    // Interleaving still beats encrypting the blocks one at a time.
+    for (size_t i = 0; i < count; i += lanes)
+    {
+        const unsigned int n = (unsigned int)STDMIN(size_t(lanes), count-i);
+        for (unsigned int j=0; j<lanes; ++j)
+        {
+            const size_t k = i + STDMIN(j, n-1);
+            skeys[j] = CONST_M128_CAST(keys + stride*(keyIndexes ? keyIndexes[k] : k));
+            blocks[j] = _mm_loadu_si128(CONST_M128_CAST(inBlocks+16*k));
+        }
+
+        AESNI_Enc_8_Keys(blocks[0], blocks[1], blocks[2], blocks[3], blocks[4], blocks[5], blocks[6], blocks[7],
+            skeys[0], skeys[1], skeys[2], skeys[3], skeys[4], skeys[5], skeys[6], skeys[7], (unsigned int)rounds);
+
+        for (unsigned int j=0; j<n; ++j)
+        {
+            if (xorBlocks)
+                blocks[j] = _mm_xor_si128(blocks[j], _mm_loadu_si128(CONST_M128_CAST(xorBlocks+16*(i+j))));
+            _mm_storeu_si128(M128_CAST(outBlocks+16*(i+j)), blocks[j]);
+        }
+    }
+}
+
 #endif  // CRYPTOPP_AESNI_AVAILABLE
 
 // ************************** Power 8 Crypto ************************** //
@@ -78,6 +78,21 @@ public:
 	CRYPTOPP_CONSTEXPR size_type max_size(size_type n) const {return SIZE_MAX/n;}
 #endif
 
+	/// \brief Determines if a memory block can change owners
+	/// \param ptr a pointer to a memory block provided by the allocator
+	/// \returns true if the block can be released by another allocator
+	///  of the same type, false otherwise
+	/// \details SecBlock uses IsTransferable() to decide if its move and swap
+	///  operations can exchange pointers, or if elements must be copied and
+	///  the source wiped. The default implementation returns false, which is
+	///  always safe.
+	/// \since Crypto++ 8.4
+	bool IsTransferable(const T *ptr) const
+	{
+		CRYPTOPP_UNUSED(ptr);
+		return false;
+	}
+
 #if defined(CRYPTOPP_CXX11_VARIADIC_TEMPLATES) || defined(CRYPTOPP_DOXYGEN_PROCESSING)
 
 	/// \brief Constructs a new V using variadic arguments
@@ -183,6 +198,9 @@ typename A::pointer StandardReallocate(A& alloc, T *oldPtr, typename A::size_typ
 ///  UnalignedAllocate() for memory allocations.
 /// \details Template parameter T_Align16 is effectively controlled by cryptlib.h and mirrors
 ///  CRYPTOPP_BOOL_ALIGN16. CRYPTOPP_BOOL_ALIGN16 is often used as the template parameter.
+/// \details If CRYPTOPP_ALLOCATOR_POOL is defined, then AllocatorWithCleanup calls
+///  PoolAllocate() and PoolDeallocate() instead. Released blocks are wiped and kept on
+///  per-thread free lists.
 template <class T, bool T_Align16 = false>
 class AllocatorWithCleanup : public AllocatorBase<T>
 {
@@ -210,12 +228,17 @@ public:
 		if (size == 0)
 			return NULLPTR;
 
-#if CRYPTOPP_BOOL_ALIGN16
+#if defined(CRYPTOPP_ALLOCATOR_POOL)
+		// Pool blocks are always 16-byte aligned
+		return reinterpret_cast<pointer>(PoolAllocate(size*sizeof(T)));
+#else
+# if CRYPTOPP_BOOL_ALIGN16
 		if (T_Align16)
 			return reinterpret_cast<pointer>(AlignedAllocate(size*sizeof(T)));
-#endif
+# endif
 
 		return reinterpret_cast<pointer>(UnalignedAllocate(size*sizeof(T)));
+#endif
 	}
 
 	/// \brief Deallocates a block of memory
@@ -234,12 +257,16 @@ public:
 		{
 			SecureWipeArray(reinterpret_cast<pointer>(ptr), size);
 
-#if CRYPTOPP_BOOL_ALIGN16
+#if defined(CRYPTOPP_ALLOCATOR_POOL)
+			PoolDeallocate(ptr);
+#else
+# if CRYPTOPP_BOOL_ALIGN16
 			if (T_Align16)
 				return AlignedDeallocate(ptr);
-#endif
+# endif
 
 			UnalignedDeallocate(ptr);
+#endif
 		}
 	}
 
@@ -262,6 +289,18 @@ public:
 		return StandardReallocate(*this, oldPtr, oldSize, newSize, preserve);
 	}
 
+	/// \brief Determines if a memory block can change owners
+	/// \param ptr a pointer to a memory block provided by the allocator
+	/// \returns true
+	/// \details AllocatorWithCleanup is stateless, so a heap block can be
+	///  released by any AllocatorWithCleanup of the same type.
+	/// \since Crypto++ 8.4
+	bool IsTransferable(const T *ptr) const
+	{
+		CRYPTOPP_UNUSED(ptr);
+		return true;
+	}
+
 	/// \brief Template class member Rebind
 	/// \tparam V bound class or type
 	/// \details Rebind allows a container class to allocate a different type of object
@@ -287,6 +326,88 @@ CRYPTOPP_DLL_TEMPLATE_CLASS AllocatorWithCleanup<word128, true>; // for Integer
 CRYPTOPP_DLL_TEMPLATE_CLASS AllocatorWithCleanup<word, true>;	 // for Integer
 #endif
 
+/// \brief Allocates a block of locked memory with cleanup
+/// \tparam T class or type
+/// \details LockedAllocatorWithCleanup takes memory from LockedAllocate(). The
+///  memory is locked so it is not swapped out, excluded from core dumps, and
+///  bounded by guard pages. Use it for long-lived secrets like private keys and
+///  key schedules. Allocations are aligned on a 16-byte boundary.
+/// \details The arena is shared by the process, so the allocator is
+///  stateless like AllocatorWithCleanup.
+/// \since Crypto++ 8.4
+/// \sa LockedSecByteBlock, GetLockedArenaStatistics
+template <class T>
+class LockedAllocatorWithCleanup : public AllocatorBase<T>
+{
+public:
+	CRYPTOPP_INHERIT_ALLOCATOR_TYPES
+
+	/// \brief Allocates a block of memory
+	/// \param ptr unused hint
+	/// \param size the size of the allocation, in elements
+	/// \returns a memory block
+	/// \throws InvalidArgument
+	/// \details ptr is not used, and the function asserts in Debug builds
+	///  if ptr is non-NULL.
+	/// \note size is the count of elements, and not the number of bytes
+	pointer allocate(size_type size, const void *ptr = NULLPTR)
+	{
+		CRYPTOPP_UNUSED(ptr); CRYPTOPP_ASSERT(ptr == NULLPTR);
+		this->CheckSize(size);
+		if (size == 0)
+			return NULLPTR;
+
+		return reinterpret_cast<pointer>(LockedAllocate(size*sizeof(T)));
+	}
+
+	/// \brief Deallocates a block of memory
+	/// \param ptr the pointer for the allocation
+	/// \param size the size of the allocation, in elements
+	/// \details Internally, SecureWipeArray() is called before the block is
+	///  returned to the arena. LockedDeallocate() then wipes the entire block.
+	void deallocate(void *ptr, size_type size)
+	{
+		if (ptr)
+		{
+			SecureWipeArray(reinterpret_cast<pointer>(ptr), size);
+			LockedDeallocate(ptr);
+		}
+	}
+
+	/// \brief Reallocates a block of memory
+	/// \param oldPtr the previous allocation
+	/// \param oldSize the size of the previous allocation
+	/// \param newSize the new, requested size
+	/// \param preserve flag that indicates if the old allocation should be preserved
+	/// \returns pointer to the new memory block
+	/// \details Internally, reallocate() calls StandardReallocate().
+	/// \note oldSize and newSize are the count of elements, and not the
+	///  number of bytes.
+	pointer reallocate(T *oldPtr, size_type oldSize, size_type newSize, bool preserve)
+	{
+		CRYPTOPP_ASSERT((oldPtr && oldSize) || !(oldPtr || oldSize));
+		return StandardReallocate(*this, oldPtr, oldSize, newSize, preserve);
+	}
+
+	/// \brief Determines if a memory block can change owners
+	/// \param ptr a pointer to a memory block provided by the allocator
+	/// \returns true
+	/// \since Crypto++ 8.4
+	bool IsTransferable(const T *ptr) const
+	{
+		CRYPTOPP_UNUSED(ptr);
+		return true;
+	}
+
+	/// \brief Template class member Rebind
+	/// \tparam V bound class or type
+    template <class V> struct rebind { typedef LockedAllocatorWithCleanup<V> other; };
+#if _MSC_VER >= 1500
+	LockedAllocatorWithCleanup() {}
+	template <class V> LockedAllocatorWithCleanup(const LockedAllocatorWithCleanup<V> &) {}
+#endif
+};
+
 /// \brief NULL allocator
 /// \tparam T class or type
 /// \details A NullAllocator is useful for fixed-size, stack based allocations
@@ -483,6 +604,20 @@ public:
 		return STDMAX(m_fallbackAllocator.max_size(), S);
 	}
 
+	/// \brief Determines if a memory block can change owners
+	/// \param ptr a pointer to a memory block provided by the allocator
+	/// \returns true if the block can be released by another allocator
+	///  of the same type, false otherwise
+	/// \details The statically allocated array belongs to this object and
+	///  can never change owners. Blocks from the fallback allocator can
+	///  change owners if the fallback allocator allows it.
+	/// \since Crypto++ 8.4
+	bool IsTransferable(const T *ptr) const
+	{
+		const T* array = const_cast<FixedSizeAllocatorWithCleanup*>(this)->GetAlignedArray();
+		return ptr != array && m_fallbackAllocator.IsTransferable(ptr);
+	}
+
 private:
 
 #if defined(CRYPTOPP_BOOL_ALIGN16) && (defined(_M_X64) || defined(__x86_64__))
@@ -686,6 +821,20 @@ public:
 		return STDMAX(m_fallbackAllocator.max_size(), S);
 	}
 
+	/// \brief Determines if a memory block can change owners
+	/// \param ptr a pointer to a memory block provided by the allocator
+	/// \returns true if the block can be released by another allocator
+	///  of the same type, false otherwise
+	/// \details The statically allocated array belongs to this object and
+	///  can never change owners. Blocks from the fallback allocator can
+	///  change owners if the fallback allocator allows it.
+	/// \since Crypto++ 8.4
+	bool IsTransferable(const T *ptr) const
+	{
+		const T* array = const_cast<FixedSizeAllocatorWithCleanup*>(this)->GetAlignedArray();
+		return ptr != array && m_fallbackAllocator.IsTransferable(ptr);
+	}
+
 private:
 
 	// The 8-byte alignments follows convention of Linux and Windows.
@@ -751,6 +900,21 @@ public:
 			if (t.m_ptr) {memcpy_s(m_ptr, m_size*sizeof(T), t.m_ptr, t.m_size*sizeof(T));}
 		}
 
+#if defined(CRYPTOPP_CXX11_RVALUES)
+	/// \brief Move construct a SecBlock from another SecBlock
+	/// \param t the other SecBlock
+	/// \throws std::bad_alloc
+	/// \details If the allocator allows it, the memory block of t is
+	///  transferred to this SecBlock without copying. Otherwise the elements
+	///  are copied and the memory block of t is zeroized. In both cases t is
+	///  left empty.
+	/// \since Crypto++ 8.4
+	SecBlock(SecBlock<T, A> &&t)
+		: m_mark(ELEMS_MAX), m_size(0), m_ptr(NULLPTR) {
+			MoveFrom(t);
+		}
+#endif
+
 	/// \brief Construct a SecBlock from an array of elements.
 	/// \param ptr a pointer to an array of T
 	/// \param len the number of elements in the memory block
@@ -921,6 +1085,22 @@ public:
 		return *this;
 	}
 
+#if defined(CRYPTOPP_CXX11_RVALUES)
+	/// \brief Move contents from another SecBlock
+	/// \param t the other SecBlock
+	/// \details The previous memory block of this SecBlock is zeroized. If
+	///  the allocator allows it, the memory block of t is transferred to this
+	///  SecBlock without copying. Otherwise the elements are copied and the
+	///  memory block of t is zeroized. In both cases t is left empty.
+	/// \since Crypto++ 8.4
+	SecBlock<T, A>& operator=(SecBlock<T, A> &&t)
+	{
+		if (this != &t)
+			MoveFrom(t);
+		return *this;
+	}
+#endif
+
 	/// \brief Append contents from another SecBlock
 	/// \param t the other SecBlock
 	/// \details Internally, this SecBlock calls Grow and then appends t.
@@ -1069,17 +1249,53 @@ public:
 
 	/// \brief Swap contents with another SecBlock
 	/// \param b the other SecBlock
-	/// \details Internally, std::swap() is called on m_alloc, m_size and m_ptr.
+	/// \details If both allocators allow it, std::swap() is called on m_mark,
+	///  m_size and m_ptr. Otherwise the elements are exchanged by copying.
+	///  A FixedSizeAllocatorWithCleanup array is never exchanged by pointer
+	///  because it lives inside the SecBlock.
 	void swap(SecBlock<T, A> &b)
 	{
-		// Swap must occur on the allocator in case its FixedSize that spilled into the heap.
-		std::swap(m_alloc, b.m_alloc);
-		std::swap(m_mark, b.m_mark);
-		std::swap(m_size, b.m_size);
-		std::swap(m_ptr, b.m_ptr);
+		if (this == &b)
+			return;
+
+		if (m_alloc.IsTransferable(m_ptr) && b.m_alloc.IsTransferable(b.m_ptr))
+		{
+			std::swap(m_mark, b.m_mark);
+			std::swap(m_size, b.m_size);
+			std::swap(m_ptr, b.m_ptr);
+		}
+		else
+		{
+			const size_type mark = b.m_mark;
+			SecBlock<T, A> t(*this);
+			Assign(b); b.Assign(t);
+			m_mark = mark; b.m_mark = t.m_mark;
+		}
 	}
 
 protected:
+	/// \brief Move contents from another SecBlock
+	/// \param t the other SecBlock
+	/// \details MoveFrom() transfers the memory block of t if the allocator
+	///  allows it, and copies the elements otherwise. The previous memory
+	///  block of this SecBlock and any block left behind by t are zeroized.
+	///  t is empty on return.
+	void MoveFrom(SecBlock<T, A> &t)
+	{
+		if (t.m_alloc.IsTransferable(t.m_ptr))
+		{
+			m_alloc.deallocate(m_ptr, STDMIN(m_size, m_mark));
+			m_mark = t.m_mark; m_size = t.m_size; m_ptr = t.m_ptr;
+			t.m_mark = ELEMS_MAX; t.m_size = 0; t.m_ptr = NULLPTR;
+		}
+		else
+		{
+			const size_type mark = t.m_mark;
+			Assign(t); t.New(0);
+			m_mark = mark;
+		}
+	}
+
 	A m_alloc;
 	size_type m_mark, m_size;
 	T *m_ptr;
@@ -1092,10 +1308,14 @@ class SecByteBlock : public SecBlock<byte> {};
 class SecWordBlock : public SecBlock<word> {};
 /// \brief SecBlock using \ref AllocatorWithCleanup "AllocatorWithCleanup<byte, true>" typedef
 class AlignedSecByteBlock : public SecBlock<byte, AllocatorWithCleanup<byte, true> > {};
+/// \brief SecBlock using \ref LockedAllocatorWithCleanup "LockedAllocatorWithCleanup<byte>" typedef
+/// \since Crypto++ 8.4
+class LockedSecByteBlock : public SecBlock<byte, LockedAllocatorWithCleanup<byte> > {};
 #else
 typedef SecBlock<byte> SecByteBlock;
 typedef SecBlock<word> SecWordBlock;
 typedef SecBlock<byte, AllocatorWithCleanup<byte, true> > AlignedSecByteBlock;
+typedef SecBlock<byte, LockedAllocatorWithCleanup<byte> > LockedSecByteBlock;
 #endif
 
 // No need for move semantics on derived class *if* the class does not add any
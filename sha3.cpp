@@ -19,6 +19,7 @@ http://creativecommons.org/publicdomain/zero/1.0/
 
 #include "pch.h"
 #include "sha3.h"
+#include "instrument.h"
 
 NAMESPACE_BEGIN(CryptoPP)
 
@@ -31,6 +32,7 @@ NAMESPACE_BEGIN(CryptoPP)
 
 void SHA3::Update(const byte *input, size_t length)
 {
+    InstrumentedCall instrumented(*this, InstrumentedCall::UPDATE, length);
     CRYPTOPP_ASSERT(!(input == NULLPTR && length != 0));
     if (length == 0) { return; }
 
@@ -5,6 +5,7 @@
 #ifndef CRYPTOPP_IMPORTS
 
 #include "strciphr.h"
+#include "instrument.h"
 
 // Squash MS LNK4221 and libtool warnings
 #ifndef CRYPTOPP_MANUALLY_INSTANTIATE_TEMPLATES
@@ -68,6 +69,7 @@ void AdditiveCipherTemplate<S>::GenerateBlock(byte *outString, size_t length)
 template <class S>
 void AdditiveCipherTemplate<S>::ProcessData(byte *outString, const byte *inString, size_t length)
 {
+	InstrumentedCall instrumented(static_cast<const StreamTransformation &>(*this), InstrumentedCall::PROCESS, length);
 	if (m_leftOver > 0)
 	{
 		const size_t len = STDMIN(m_leftOver, length);
@@ -171,6 +173,7 @@ void CFB_CipherTemplate<BASE>::Resynchronize(const byte *iv, int length)
 template <class BASE>
 void CFB_CipherTemplate<BASE>::ProcessData(byte *outString, const byte *inString, size_t length)
 {
+	InstrumentedCall instrumented(static_cast<const StreamTransformation &>(*this), InstrumentedCall::PROCESS, length);
 	CRYPTOPP_ASSERT(outString); CRYPTOPP_ASSERT(inString);
 	CRYPTOPP_ASSERT(length % this->MandatoryBlockSize() == 0);
 
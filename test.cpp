@@ -1000,6 +1000,7 @@ bool Validate(int alg, bool thorough)
 	case 66: result = ValidateCamellia(); break;
 	case 67: result = ValidateWhirlpool(); break;
 	case 68: result = ValidateTTMAC(); break;
+	case 69: result = ValidateArgon2(); break;
 	case 70: result = ValidateSalsa(); break;
 	case 71: result = ValidateChaCha(); break;
 	case 72: result = ValidateChaChaTLS(); break;
@@ -1020,6 +1021,13 @@ bool Validate(int alg, bool thorough)
 	case 90: result = ValidateHashDRBG(); break;
 	case 91: result = ValidateHmacDRBG(); break;
 	case 92: result = ValidateNaCl(); break;
+	case 93: result = ValidateCtrDRBG(); break;
+	case 94: result = ValidateOneShot(); break;
+	case 95: result = ValidateScatterGather(); break;
+	case 96: result = ValidateChaCha20Poly1305(); break;
+	case 97: result = TestCPUFeatureMask(); break;
+	case 98: result = TestInstrumentation(); break;
+	case 99: result = ValidatePipelineProfile(); break;
 
 	case 100: result = ValidateCHAM(); break;
 	case 101: result = ValidateSIMECK(); break;
@@ -1056,6 +1064,7 @@ bool Validate(int alg, bool thorough)
 # if defined(CRYPTOPP_ALTIVEC_AVAILABLE)
 	case 9990: result = TestAltivecOps(); break;
 # endif
+	case 9989: result = TestByteQueue(); break;
 #endif
 
 	default: return false;
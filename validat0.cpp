@@ -16,6 +16,8 @@
 #include "integer.h"
 #include "polynomi.h"
 #include "channels.h"
+#include "mqueue.h"
+#include "queue.h"
 
 #include "ida.h"
 #include "gzip.h"
@@ -731,6 +733,148 @@ bool TestSharing()
 
     std::cout << (fail ? "FAILED:" : "passed:") << "  " << INFORMATION_SHARES << " information dispersals\n";
 
+    // ********** Information Dispersal in GF(2^8) **********//
+
+    for (unsigned int shares=3; shares<INFORMATION_SHARES; ++shares)
+    {
+        std::string message;
+        unsigned int len = GlobalRNG().GenerateWord32(0, 0x10000);
+        unsigned int threshold = GlobalRNG().GenerateWord32(1, shares-1);
+
+        RandomNumberSource(GlobalRNG(), len, true, new StringSink(message));
+
+        ChannelSwitch *channelSwitch = NULLPTR;
+        StringSource source(message, false, new InformationDispersal(threshold, shares, channelSwitch = new ChannelSwitch, true, RawIDA::FIELD_GF2_8));
+
+        std::vector<std::string> strShares(shares);
+        vector_member_ptrs<StringSink> strSinks(shares);
+        std::string channel;
+
+        // ********** Create Shares
+        for (unsigned int i=0; i<shares; i++)
+        {
+            strSinks[i].reset(new StringSink(strShares[i]));
+            channel = WordToString<word32>(i);
+            strSinks[i]->Put((const byte *)channel.data(), CHID_LENGTH);
+            channelSwitch->AddRoute(channel, *strSinks[i], DEFAULT_CHANNEL);
+        }
+        source.PumpAll();
+
+        // ********** Randomize shares
+
+        GlobalRNG().Shuffle(strShares.begin(), strShares.end());
+
+        // ********** Recover message
+        try
+        {
+            std::string recovered;
+            InformationRecovery recovery(threshold, new StringSink(recovered), true, RawIDA::FIELD_GF2_8);
+
+            vector_member_ptrs<StringSource> strSources(threshold);
+            channel.resize(CHID_LENGTH);
+
+            for (unsigned int i=0; i<threshold; i++)
+            {
+                strSources[i].reset(new StringSource(strShares[i], false));
+                strSources[i]->Pump(CHID_LENGTH);
+                strSources[i]->Get((byte*)&channel[0], CHID_LENGTH);
+                strSources[i]->Attach(new ChannelSwitch(recovery, channel));
+            }
+
+            // Uneven pumps leave the channels at different positions
+            const unsigned int pump = GlobalRNG().GenerateWord32(1, 5000);
+            while (strSources[0]->Pump(pump))
+            {
+                for (unsigned int i=1; i<threshold; i++)
+                    strSources[i]->Pump(GlobalRNG().GenerateWord32(0, 2*pump));
+            }
+
+            for (unsigned int i=0; i<threshold; i++)
+                strSources[i]->PumpAll();
+
+            fail = (message != recovered);
+        }
+        catch (const Exception&)
+        {
+            fail = true;
+        }
+
+        pass &= !fail;
+    }
+
+    std::cout << (fail ? "FAILED:" : "passed:") << "  " << INFORMATION_SHARES << " information dispersals in GF(2^8)\n";
+
+    // ********** Known answers in GF(2^8) **********//
+
+    // Polynomial 0x11d, threshold 3. Shares 0 to 2 are the columns of the
+    // padded message, and shares 3 and 4 are the polynomial through them
+    // evaluated at 3 and 4. The 51 rows run the 32 and 16 byte kernels
+    // and the byte loop. Each kernel is tried by masking the faster ones.
+    {
+        const char *expected[] = {
+            "030209080f0e15141b1a212027262d2c333239383f3e45444b4a515057565d5c636269686f6e75747b7a818087868d8c939200",
+            "042f2a1d08b30e011c379235207b3639341f1a2d38f95e514c670245500b4649644f4a7d68d36e617c57489580db969994bfcb"
+        };
+#if (CRYPTOPP_BOOL_X86 || CRYPTOPP_BOOL_X32 || CRYPTOPP_BOOL_X64)
+        const char *masks[] = {"", "avx2", "avx2,ssse3"};
+#elif (CRYPTOPP_BOOL_ARM32 || CRYPTOPP_BOOL_ARMV8)
+        const char *masks[] = {"", "neon"};
+#else
+        const char *masks[] = {""};
+#endif
+
+        std::string message;
+        for (unsigned int i=0; i<152; i++)
+            message += char(i);
+
+        const std::string original = MaskedCPUFeatures();
+        fail = false;
+        try
+        {
+            for (size_t m=0; m<COUNTOF(masks); m++)
+            {
+                if (*masks[m] != '\0')
+                    MaskCPUFeatures(std::string(masks[m]) + (original.empty() ? "" : ",") + original);
+
+                std::string strShares[5];
+                ChannelSwitch *channelSwitch = NULLPTR;
+                StringSource source(message, false, new InformationDispersal(3, 5, channelSwitch = new ChannelSwitch, true, RawIDA::FIELD_GF2_8));
+                vector_member_ptrs<StringSink> strSinks(5);
+                for (unsigned int i=0; i<5; i++)
+                {
+                    strSinks[i].reset(new StringSink(strShares[i]));
+                    channelSwitch->AddRoute(WordToString<word32>(i), *strSinks[i], DEFAULT_CHANNEL);
+                }
+                source.PumpAll();
+
+                for (unsigned int i=0; i<2; i++)
+                {
+                    std::string share;
+                    StringSource(expected[i], true, new HexDecoder(new StringSink(share)));
+                    fail = (strShares[3+i] != share) || fail;
+                }
+                for (unsigned int i=0; i<3; i++)
+                {
+                    // The padding byte 1 follows the message, then zeros
+                    std::string column;
+                    for (unsigned int j=i; j<153; j+=3)
+                        column += (j < 152 ? char(j) : char(1));
+                    fail = (strShares[i] != column) || fail;
+                }
+                MaskCPUFeatures(original);
+            }
+        }
+        catch (const Exception&)
+        {
+            MaskCPUFeatures(original);
+            fail = true;
+        }
+
+        pass &= !fail;
+    }
+
+    std::cout << (fail ? "FAILED:" : "passed:") << "  " << "known answers in GF(2^8)\n";
+
     // ********** Secret Sharing **********//
 
     for (unsigned int shares=3; shares<SECRET_SHARES; ++shares)
@@ -1572,5 +1716,127 @@ bool TestStringSink()
 }
 #endif
 
+#if defined(CRYPTOPP_EXTENDED_VALIDATION)
+bool TestByteQueue()
+{
+    std::cout << "\nTesting ByteQueue...\n\n";
+    bool pass = true, temp;
+
+    SecByteBlock data(8192);
+    GlobalRNG().GenerateBlock(data, data.size());
+
+    //********** MoveTo **********//
+
+    {
+        temp = true;
+        const size_t chunks[] = {0, 1, 255, 256, 257, 700, 4000};
+        for (size_t i = 0; i < COUNTOF(chunks); ++i)
+        {
+            for (size_t j = 0; j < COUNTOF(chunks); ++j)
+            {
+                // Partial target tail, consumed source head
+                ByteQueue source(256), target(256);
+                target.Put(data, chunks[i]);
+                source.Put(data, data.size());
+                source.Skip(chunks[j]);
+
+                const lword moved = source.MoveTo(target, 3000);
+                const lword expected = STDMIN((lword)3000, (lword)(data.size()-chunks[j]));
+                temp &= (moved == expected);
+                temp &= (target.MaxRetrievable() == chunks[i]+expected);
+                temp &= (source.MaxRetrievable() == data.size()-chunks[j]-expected);
+
+                SecByteBlock out(chunks[i]+(size_t)expected);
+                temp &= (target.Get(out, out.size()) == out.size());
+                temp &= (std::memcmp(out, data, chunks[i]) == 0);
+                temp &= (std::memcmp(out+chunks[i], data+chunks[j], (size_t)expected) == 0);
+
+                // Drain the rest and compare
+                const size_t rest = (size_t)source.MaxRetrievable();
+                source.MoveTo(target);
+                out.New(rest);
+                temp &= (target.Get(out, out.size()) == rest);
+                temp &= (std::memcmp(out, data+chunks[j]+expected, rest) == 0);
+                temp &= (source.MaxRetrievable() == 0 && target.MaxRetrievable() == 0);
+            }
+        }
+
+        pass &= temp;
+        if (!temp)
+            std::cout << "FAILED:";
+        else
+            std::cout << "passed:";
+        std::cout << "  ByteQueue to ByteQueue\n";
+    }
+
+    //********** TransferTo **********//
+
+    {
+        // Lazy strings are copied after the nodes
+        ByteQueue source, target;
+        source.Put(data, 5000);
+        source.LazyPut(data+5000, 3192);
+        temp = (source.TransferTo(target) == data.size());
+
+        SecByteBlock out(data.size());
+        temp &= (target.Get(out, out.size()) == out.size());
+        temp &= (out == data);
+
+        // Recycled nodes are cleared before reuse
+        for (size_t i = 0; i < 16; ++i)
+        {
+            source.Put(data, data.size());
+            source.TransferTo(target, 6000);
+            target.Skip(3000);
+            source.Clear();
+        }
+        // 96000 bytes in, 48000 skipped; a 6000 byte chunk starts here
+        temp &= (target.MaxRetrievable() == 16*3000);
+        temp &= (target.Get(out, 6000) == 6000);
+        temp &= (std::memcmp(out, data, 6000) == 0);
+
+        pass &= temp;
+        if (!temp)
+            std::cout << "FAILED:";
+        else
+            std::cout << "passed:";
+        std::cout << "  ByteQueue TransferTo\n";
+    }
+
+    //********** MessageQueue **********//
+
+    {
+        ByteQueue source(256);
+        MessageQueue target;
+        target.Put(data, 100);
+        source.Put(data+100, 4000);
+        temp = (source.TransferTo(target) == 4000);
+        target.MessageEnd();
+        source.Put(data+4100, 1000);
+        temp &= (target.MoveFrom(source, 600) == 600);
+        target.MessageEnd();
+
+        temp &= (target.NumberOfMessages() == 2);
+        temp &= (target.MaxRetrievable() == 4100);
+
+        SecByteBlock out(4700);
+        temp &= (target.Get(out, 4100) == 4100);
+        temp &= (target.GetNextMessage() && target.MaxRetrievable() == 600);
+        temp &= (target.Get(out+4100, 600) == 600);
+        temp &= (std::memcmp(out, data, out.size()) == 0);
+        temp &= (source.MaxRetrievable() == 400);
+
+        pass &= temp;
+        if (!temp)
+            std::cout << "FAILED:";
+        else
+            std::cout << "passed:";
+        std::cout << "  ByteQueue to MessageQueue\n";
+    }
+
+    return pass;
+}
+#endif
+
 NAMESPACE_END  // Test
 NAMESPACE_END  // CryptoPP
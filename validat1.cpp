@@ -39,7 +39,7 @@ bool TestSecBlock()
 {
     std::cout << "\nTesting SecBlock...\n\n";
 
-    bool pass1=true, pass2=true, pass3=true, pass4=true, pass5=true, pass6=true, pass7=true, temp=false;
+    bool pass1=true, pass2=true, pass3=true, pass4=true, pass5=true, pass6=true, pass7=true, pass8=true, temp=false;
 
     //************ Allocators ************//
 
@@ -994,7 +994,157 @@ bool TestSecBlock()
     std::cout << "  FixedSizeAllocator Grow with word128\n";
 #endif
 
-    return pass1 && pass2 && pass3 && pass4 && pass5 && pass6 && pass7;
+    //********** Swap and Move **********//
+
+    {
+        typedef SecBlock<byte, FixedSizeAllocatorWithCleanup<byte, 8, AllocatorWithCleanup<byte> > > HintBlock;
+        const byte abc[] = {'a','b','c'}, defghijklm[] = {'d','e','f','g','h','i','j','k','l','m'};
+
+        // Heap blocks exchange pointers
+        SecByteBlock h1(abc, sizeof(abc)), h2(defghijklm, sizeof(defghijklm));
+        const byte *p1 = h1.begin(), *p2 = h2.begin();
+        h1.swap(h2);
+        temp = (h1.begin() == p2 && h2.begin() == p1);
+        temp &= (h1.size() == sizeof(defghijklm) && std::memcmp(h1, defghijklm, h1.size()) == 0);
+        temp &= (h2.size() == sizeof(abc) && std::memcmp(h2, abc, h2.size()) == 0);
+
+        // Inline arrays stay put and exchange elements
+        HintBlock f1(abc, sizeof(abc)), f2(defghijklm, 5), f3(defghijklm, sizeof(defghijklm));
+        p1 = f1.begin(); p2 = f2.begin();
+        f1.swap(f2);
+        temp &= (f1.begin() == p1 && f2.begin() == p2);
+        temp &= (f1.size() == 5 && std::memcmp(f1, defghijklm, f1.size()) == 0);
+        temp &= (f2.size() == sizeof(abc) && std::memcmp(f2, abc, f2.size()) == 0);
+
+        // An inline array swapped with a spilled block
+        f2.swap(f3);
+        temp &= (f2.size() == sizeof(defghijklm) && std::memcmp(f2, defghijklm, f2.size()) == 0);
+        temp &= (f3.size() == sizeof(abc) && std::memcmp(f3, abc, f3.size()) == 0);
+
+        FixedSizeSecBlock<byte, 3> s1, s2;
+        std::memcpy(s1, abc, 3); std::memcpy(s2, defghijklm, 3);
+        std::swap(s1, s2);
+        temp &= (std::memcmp(s1, defghijklm, 3) == 0 && std::memcmp(s2, abc, 3) == 0);
+
+        pass8 &= temp;
+        if (!temp)
+            std::cout << "FAILED:";
+        else
+            std::cout << "passed:";
+        std::cout << "  Swap SecBlock\n";
+    }
+
+#if defined(CRYPTOPP_CXX11_RVALUES)
+    {
+        typedef SecBlock<byte, FixedSizeAllocatorWithCleanup<byte, 8, AllocatorWithCleanup<byte> > > HintBlock;
+        const byte abc[] = {'a','b','c'}, defghijklm[] = {'d','e','f','g','h','i','j','k','l','m'};
+
+        // Heap blocks change owners without a copy
+        SecByteBlock h1(defghijklm, sizeof(defghijklm));
+        const byte* p = h1.begin();
+        SecByteBlock h2(std::move(h1));
+        temp = (h2.begin() == p && h2.size() == sizeof(defghijklm) && h1.empty());
+        h1 = std::move(h2);
+        temp &= (h1.begin() == p && h1.size() == sizeof(defghijklm) && h2.empty());
+
+        // Inline arrays are copied and wiped
+        HintBlock f1(abc, sizeof(abc));
+        p = f1.begin();
+        HintBlock f2(std::move(f1));
+        temp &= (f2.size() == sizeof(abc) && std::memcmp(f2, abc, f2.size()) == 0 && f1.empty());
+        temp &= (p[0] == 0 && p[1] == 0 && p[2] == 0);
+
+        HintBlock f3(defghijklm, sizeof(defghijklm));
+        f2 = std::move(f3);
+        temp &= (f2.size() == sizeof(defghijklm) && std::memcmp(f2, defghijklm, f2.size()) == 0 && f3.empty());
+
+        FixedSizeSecBlock<byte, 3> s1, s2;
+        std::memcpy(s1, abc, 3);
+        p = s1.begin();
+        s2 = std::move(s1);
+        temp &= (std::memcmp(s2, abc, 3) == 0 && s1.empty());
+        temp &= (p[0] == 0 && p[1] == 0 && p[2] == 0);
+
+        pass8 &= temp;
+        if (!temp)
+            std::cout << "FAILED:";
+        else
+            std::cout << "passed:";
+        std::cout << "  Move SecBlock\n";
+    }
+#endif
+
+    //********** Allocator pool **********//
+
+    {
+        ReleaseAllocatorPool();
+        const AllocatorPoolStatistics s0 = GetAllocatorPoolStatistics();
+
+        // 100 and 120 bytes share the 128-byte size class
+        byte* p1 = static_cast<byte*>(PoolAllocate(100));
+        temp = IsAlignedOn(p1, 16);
+        std::memset(p1, 0xaa, 100);
+        PoolDeallocate(p1);
+        byte* p2 = static_cast<byte*>(PoolAllocate(120));
+        temp &= IsAlignedOn(p2, 16);
+        std::memset(p2, 0xbb, 120);
+
+        // Large blocks bypass the free lists
+        byte* p3 = static_cast<byte*>(PoolAllocate(1024*1024));
+        temp &= IsAlignedOn(p3, 16);
+        PoolDeallocate(p3);
+
+        const AllocatorPoolStatistics s1 = GetAllocatorPoolStatistics();
+        PoolDeallocate(p2);
+        ReleaseAllocatorPool();
+        const AllocatorPoolStatistics s2 = GetAllocatorPoolStatistics();
+
+#if defined(CRYPTOPP_CXX11_THREAD_LOCAL)
+        temp &= (p1 == p2);
+        temp &= (s1.hits == s0.hits+1 && s1.misses == s0.misses+2);
+        temp &= (s1.bytes == s0.bytes+128 && s1.cached == 0);
+#endif
+        temp &= (s2.cached == 0);
+
+        pass8 &= temp;
+        if (!temp)
+            std::cout << "FAILED:";
+        else
+            std::cout << "passed:";
+        std::cout << "  Allocator pool\n";
+    }
+
+    //********** Locked arena **********//
+
+    {
+        const LockedArenaStatistics s0 = GetLockedArenaStatistics();
+
+        LockedSecByteBlock k1(32), k2(1000);
+        std::memset(k1, 0xaa, k1.size());
+        std::memset(k2, 0xbb, k2.size());
+        temp = IsAlignedOn(k1.begin(), 16) && IsAlignedOn(k2.begin(), 16);
+
+        const LockedArenaStatistics s1 = GetLockedArenaStatistics();
+        temp &= (s1.reserved >= 1032 && s1.inUse >= s0.inUse + 1032);
+
+        // Larger than a region
+        k2.CleanGrow(512*1024);
+        temp &= (k2[0] == 0xbb && k2[999] == 0xbb && k2[1000] == 0);
+        temp &= (k1[0] == 0xaa && k1[31] == 0xaa);
+
+        k1.New(0); k2.New(0);
+        const LockedArenaStatistics s2 = GetLockedArenaStatistics();
+        temp &= (s2.inUse == s0.inUse);
+
+        pass8 &= temp;
+        if (!temp)
+            std::cout << "FAILED:";
+        else
+            std::cout << "passed:";
+        std::cout << "  Locked arena\n";
+    }
+
+    return pass1 && pass2 && pass3 && pass4 && pass5 && pass6 && pass7 && pass8;
 }
 #endif
 
@@ -13,6 +13,8 @@
 #include "algebra.h"
 #include "integer.h"
 #include "nbtheory.h"
+#include "modes.h"
+#include "aes.h"
 
 #include <iostream>
 #include <iomanip>
@@ -844,6 +846,115 @@ bool TestIntegerOps()
         std::cout << "FAILED:";
     std::cout << "  Carmichael pseudo-primes\n";
 
+    // ****************************** Prime sieve ******************************
+
+    {
+        // Accepts candidates at or above a floor, which makes FirstPrime
+        // walk several sieve windows before it finds a prime
+        class FloorSelector : public PrimeSelector
+        {
+        public:
+            FloorSelector(const Integer &floor) : m_floor(floor) {}
+            bool IsAcceptable(const Integer &candidate) const {return candidate >= m_floor;}
+            Integer m_floor;
+        };
+
+        result = true;
+        for (unsigned int i=0; i<64 && result; ++i)
+        {
+            // Small starts exercise the prime table and the sieve boundary at 32719
+            Integer first = (i%4 == 0) ? Integer(GlobalRNG(), 2, 70000) : Integer(GlobalRNG(), 16+i);
+            Integer mod = Integer(GlobalRNG(), 1, 64), equiv = Integer(GlobalRNG(), Integer::Zero(), mod-1);
+            Integer max = first + mod*Integer(GlobalRNG(), 0, 4096);
+
+            Integer p = first, q;
+            for (q = first; q <= max; ++q)
+            {
+                if (q%mod == equiv && IsPrime(q))
+                    break;
+            }
+
+            const bool found = FirstPrime(p, max, equiv, mod, NULLPTR);
+            result = (found == (q <= max)) && (!found || p == q);
+        }
+
+        for (unsigned int i=0; i<4 && result; ++i)
+        {
+            Integer first(GlobalRNG(), 40+i*20);
+            FloorSelector selector(first + 3*32768*2 + Integer(GlobalRNG(), 0, 4096));
+
+            Integer p = first, q = selector.m_floor;
+            while (q.IsEven() || !IsPrime(q))
+                ++q;
+
+            result = FirstPrime(p, first + 8*32768*2, 1, 2, &selector) && p == q;
+        }
+
+        // 256 bits and up, so an OpenMP build tests the candidates in batches
+        for (unsigned int i=0; i<4 && result; ++i)
+        {
+            const unsigned int bits = 256+i*128;
+            Integer first(GlobalRNG(), Integer::Power2(bits-1), Integer::Power2(bits)-1);
+            Integer mod = Integer(GlobalRNG(), 1, 64), equiv = Integer(GlobalRNG(), Integer::Zero(), mod-1);
+            Integer max = first + mod*Integer(GlobalRNG(), 1024, 4096);
+
+            Integer p = first, q;
+            for (q = first; q <= max; ++q)
+            {
+                if (q%mod == equiv && IsPrime(q))
+                    break;
+            }
+
+            const bool found = FirstPrime(p, max, equiv, mod, NULLPTR);
+            result = (found == (q <= max)) && (!found || p == q);
+        }
+
+        // Safe primes of 256 bits against a sequential search that draws
+        // the same starting points from a second copy of the generator
+        for (unsigned int i=0; i<2 && result; ++i)
+        {
+            const int delta = (i%2 == 0) ? 1 : -1;
+            const unsigned int bits = 256;
+
+            SecByteBlock key(16), iv(16);
+            GlobalRNG().GenerateBlock(key, key.size());
+            GlobalRNG().GenerateBlock(iv, iv.size());
+            OFB_Mode<AES>::Encryption rng1(key, key.size(), iv), rng2(key, key.size(), iv);
+
+            PrimeAndGenerator pg(delta, rng1, bits);
+
+            const Integer minP = Integer::Power2(bits-1), maxP = Integer::Power2(bits)-1;
+            Integer p;
+            bool found = false;
+            while (!found)
+            {
+                p.Randomize(rng2, minP, maxP, Integer::ANY, 6+5*delta, 12);
+                const Integer last = STDMIN(p+PrimeSearchInterval(maxP)*12, maxP);
+                for (; p <= last && !found; p += 12)
+                    found = IsPrime(p) && IsPrime((p-delta) >> 1);
+            }
+            p -= 12;
+
+            result = (pg.Prime() == p);
+        }
+
+        for (unsigned int i=0; i<4 && result; ++i)
+        {
+            const int delta = (i%2 == 0) ? 1 : -1;
+            PrimeAndGenerator pg(delta, GlobalRNG(), 128+i*64);
+
+            result = pg.Prime().BitCount() == 128+i*64 && pg.Prime() == pg.SubPrime()*2+delta &&
+                VerifyPrime(GlobalRNG(), pg.Prime()) && VerifyPrime(GlobalRNG(), pg.SubPrime());
+        }
+
+        pass = result && pass;
+        if (result)
+            std::cout << "passed:";
+        else
+            std::cout << "FAILED:";
+        std::cout << "  Prime sieve and safe primes\n";
+    }
+
     // ****************************** Integer Double ******************************
 
     try {
@@ -1262,6 +1373,50 @@ bool TestIntegerOps()
        std::cout << "FAILED:";
     std::cout << "  Exponentiation operations\n";
 
+    // ****************************** Swap and Move ******************************
+
+    // Sizes straddle the inline storage of IntegerSecBlock
+    const unsigned int bits[] = {64, 256, 1024, 2048};
+    for (unsigned int i=0; i<COUNTOF(bits); ++i)
+    {
+        for (unsigned int j=0; j<COUNTOF(bits); ++j)
+        {
+            const Integer a(prng, bits[i]), b = -Integer(prng, bits[j]);
+            Integer x(a), y(b);
+
+            x.swap(y);
+            result = (x == b && y == a);
+            std::swap(x, y);
+            result &= (x == a && y == b);
+
+#if defined(CRYPTOPP_CXX11_RVALUES)
+# if defined(CRYPTOPP_CXX11_NOEXCEPT)
+            // std::vector only moves elements it relocates if the move cannot throw
+            result &= noexcept(Integer(std::move(x))) && noexcept(x = std::move(y));
+# endif
+            Integer z(std::move(x));
+            result &= (z == a && x.IsZero() && x.NotNegative());
+            x = std::move(y);
+            result &= (x == b && y.IsZero() && y.NotNegative());
+            y = std::move(z);
+            result &= (y == a && z.IsZero());
+            // Moved-from objects are usable
+            z = x + y;
+            result &= (z == a + b);
+#endif
+
+            pass = result && pass;
+            if (!result)
+                std::cout << "FAILED:  Swap and move operation\n";
+        }
+    }
+
+    if (pass)
+       std::cout << "passed:";
+    else
+       std::cout << "FAILED:";
+    std::cout << "  Swap and move operations\n";
+
     return pass;
 }
 #endif
@@ -8,6 +8,7 @@
 
 #include "cryptlib.h"
 #include "cpu.h"
+#include "instrument.h"
 #include "validate.h"
 
 #include "rng.h"
@@ -22,10 +23,24 @@
 #include "gzip.h"
 #include "channels.h"
 
+#include "aes.h"
+#include "gcm.h"
+#include "sha.h"
+#include "chacha.h"
+#include "blake2.h"
+#include "hmac.h"
+#include "modes.h"
+#include "xed25519.h"
+
 #include <iostream>
 #include <iomanip>
 #include <sstream>
 
+#if defined(CRYPTOPP_UNIX_AVAILABLE)
+# include <unistd.h>
+# include <sys/wait.h>
+#endif
+
 // Aggressive stack checking with VS2005 SP1 and above.
 #if (_MSC_VER >= 1500)
 # pragma strict_gs_check (on)
@@ -41,6 +56,8 @@ NAMESPACE_BEGIN(Test)
 bool ValidateAll(bool thorough)
 {
 	bool pass=TestSettings();
+	pass=TestCPUFeatureMask() && pass;
+	pass=TestInstrumentation() && pass;
 	pass=TestOS_RNG() && pass;
 	pass=TestRandomPool() && pass;
 #if !defined(NO_OS_DEPENDENCE) && defined(OS_RNG_AVAILABLE)
@@ -75,6 +92,7 @@ bool ValidateAll(bool thorough)
 	pass=TestASN1Parse() && pass;
 	// https://github.com/weidai11/cryptopp/pull/334
 	pass=TestStringSink() && pass;
+	pass=TestByteQueue() && pass;
 	// Always part of the self tests; call in Debug
 # if defined(CRYPTOPP_ALTIVEC_AVAILABLE)
 	pass=TestAltivecOps() && pass;
@@ -108,6 +126,7 @@ bool ValidateAll(bool thorough)
 
 	pass=ValidateHashDRBG() && pass;
 	pass=ValidateHmacDRBG() && pass;
+	pass=ValidateCtrDRBG() && pass;
 
 	pass=ValidateTiger() && pass;
 	pass=ValidateRIPEMD() && pass;
@@ -126,6 +145,7 @@ bool ValidateAll(bool thorough)
 	pass=ValidatePBKDF() && pass;
 	pass=ValidateHKDF() && pass;
 	pass=ValidateScrypt() && pass;
+	pass=ValidateArgon2() && pass;
 
 	pass=ValidateDES() && pass;
 	pass=ValidateCipherModes() && pass;
@@ -170,8 +190,12 @@ bool ValidateAll(bool thorough)
 	pass=ValidateVMAC() && pass;
 	pass=ValidateCCM() && pass;
 	pass=ValidateGCM() && pass;
+	pass=ValidateChaCha20Poly1305() && pass;
 	pass=ValidateXTS() && pass;
 	pass=ValidateCMAC() && pass;
+	pass=ValidateOneShot() && pass;
+	pass=ValidateScatterGather() && pass;
+	pass=ValidatePipelineProfile() && pass;
 	pass=RunTestDataFile("TestVectors/eax.txt") && pass;
 
 	pass=ValidateBBS() && pass;
@@ -411,6 +435,10 @@ bool TestSettings()
 
 #endif
 
+	const std::string masked = MaskedCPUFeatures();
+	if (!masked.empty())
+		std::cout << "passed:  masked CPU features == " << masked << "\n";
+
 	if (!pass)
 	{
 		std::cerr << "Some critical setting in config.h is in error.  Please fix it and recompile.\n";
@@ -419,6 +447,209 @@ bool TestSettings()
 	return pass;
 }
 
+// Runs a few algorithms with SIMD code paths and returns their output
+std::string CPUFeatureMaskOutputs(std::string &providers)
+{
+	const byte key[32] = {1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,17,18,19,20,21,22,23,24,25,26,27,28,29,30,31,32};
+	byte message[1000];
+	for (size_t i=0; i<sizeof(message); ++i)
+		message[i] = static_cast<byte>(i*7+1);
+
+	std::string result;
+	byte buffer[sizeof(message)+16];
+
+	AES::Encryption aes(key, 16);
+	aes.ProcessBlock(message, buffer);
+	result.append(reinterpret_cast<const char*>(buffer), 16);
+
+	SHA256 sha;
+	sha.CalculateDigest(buffer, message, sizeof(message));
+	result.append(reinterpret_cast<const char*>(buffer), sha.DigestSize());
+
+	GCM<AES>::Encryption gcm;
+	gcm.SetKeyWithIV(key, 16, key, 12);
+	gcm.EncryptAndAuthenticate(buffer, buffer+sizeof(message), 16, key, 12, key, 7, message, sizeof(message));
+	result.append(reinterpret_cast<const char*>(buffer), sizeof(buffer));
+
+	ChaCha::Encryption chacha(key, 32, key);
+	chacha.ProcessData(buffer, message, sizeof(message));
+	result.append(reinterpret_cast<const char*>(buffer), sizeof(message));
+
+	BLAKE2s blake2s;
+	blake2s.CalculateDigest(buffer, message, sizeof(message));
+	result.append(reinterpret_cast<const char*>(buffer), blake2s.DigestSize());
+
+	providers = aes.AlgorithmProvider() + "," + sha.AlgorithmProvider() + "," +
+		static_cast<StreamTransformation &>(gcm).AlgorithmProvider() + "," +
+		static_cast<StreamTransformation &>(chacha).AlgorithmProvider() + "," + blake2s.AlgorithmProvider();
+	return result;
+}
+
+bool TestCPUFeatureMask()
+{
+	std::cout << "\nTesting CPU feature masks...\n\n";
+	bool pass = true;
+
+#if (CRYPTOPP_BOOL_X86 || CRYPTOPP_BOOL_X32 || CRYPTOPP_BOOL_X64)
+	const char *masks[] = {"aesni", "shani", "clmul", "avx2", "aesni,clmul,shani,sse4.1,ssse3", "sse2"};
+#elif (CRYPTOPP_BOOL_ARM32 || CRYPTOPP_BOOL_ARMV8)
+	const char *masks[] = {"aes", "pmull", "sha1,sha2", "aes,pmull,sha1,sha2,neon"};
+#elif (CRYPTOPP_BOOL_PPC32 || CRYPTOPP_BOOL_PPC64)
+	const char *masks[] = {"power8", "power9", "altivec"};
+#else
+	const char *masks[] = {""};
+#endif
+
+	// Keep a mask from CRYPTOPP_CPU_MASK in place for the other tests
+	const std::string original = MaskedCPUFeatures();
+	std::string expectedProviders, providers;
+	const std::string expected = CPUFeatureMaskOutputs(expectedProviders);
+
+	try
+	{
+		for (size_t i=0; i<COUNTOF(masks); ++i)
+		{
+			MaskCPUFeatures(std::string(masks[i]) + (original.empty() ? "" : ",") + original);
+			const bool result = (CPUFeatureMaskOutputs(providers) == expected);
+			pass = result && pass;
+
+			std::cout << (result ? "passed:  " : "FAILED:  ") << "mask " << masks[i];
+			std::cout << ", providers " << providers << "\n";
+		}
+
+		bool result = true;
+#if (CRYPTOPP_BOOL_X86 || CRYPTOPP_BOOL_X32 || CRYPTOPP_BOOL_X64)
+		MaskCPUFeatures("AESNI, avx");
+		result = !HasAESNI() && !HasAVX() && !HasAVX2() && MaskedCPUFeatures() == "avx,aesni";
+#endif
+		MaskCPUFeatures("");
+		result = MaskedCPUFeatures().empty() && result;
+
+		try
+		{
+			MaskCPUFeatures("no-such-feature");
+			result = false;
+		}
+		catch (const InvalidArgument&) {}
+
+		pass = result && pass;
+		std::cout << (result ? "passed:  " : "FAILED:  ") << "masking and restoring features\n";
+	}
+	catch (...)
+	{
+		MaskCPUFeatures(original);
+		throw;
+	}
+
+	MaskCPUFeatures(original);
+	return pass;
+}
+
+InstrumentationRecord FindInstrumentationRecord(const std::vector<InstrumentationRecord> &records,
+	const std::string &algorithm, const std::string &operation)
+{
+	for (size_t i=0; i<records.size(); ++i)
+	{
+		if (records[i].algorithm == algorithm && records[i].operation == operation)
+			return records[i];
+	}
+	return InstrumentationRecord();
+}
+
+bool TestInstrumentation()
+{
+	std::cout << "\nTesting instrumentation...\n\n";
+	bool pass = true, result = true;
+
+	if (!Instrumentation::Available())
+	{
+		try
+		{
+			Instrumentation::Enable();
+			result = false;
+		}
+		catch (const NotImplemented&) {}
+
+		std::cout << (result ? "passed:  " : "FAILED:  ") << "instrumentation is not available\n";
+		return result;
+	}
+
+	const bool enabled = Instrumentation::Enabled();
+	byte key[16], iv[16], message[100], digest[32], signature[64];
+	std::memset(key, 0x01, sizeof(key));
+	std::memset(iv, 0x02, sizeof(iv));
+	std::memset(message, 0x03, sizeof(message));
+
+	SHA512 sha;
+	HMAC<SHA256> hmac;
+	CTR_Mode<AES>::Encryption ctr;
+	ed25519Signer signer(GlobalRNG());
+
+	Instrumentation::Reset();
+	Instrumentation::Enable();
+	try
+	{
+		sha.Update(message, sizeof(message));
+		sha.Update(message, 50);
+		sha.Final(digest);
+
+		// HMAC calls SHA-256 internally, which is not counted again
+		hmac.SetKey(key, sizeof(key));
+		hmac.Update(message, sizeof(message));
+		hmac.Final(digest);
+
+		ctr.SetKeyWithIV(key, sizeof(key), iv, sizeof(iv));
+		ctr.ProcessData(message, message, 64);
+
+		signer.SignMessage(GlobalRNG(), message, 32, signature);
+	}
+	catch (...)
+	{
+		Instrumentation::Enable(enabled);
+		throw;
+	}
+	Instrumentation::Enable(false);
+
+	// Not counted
+	sha.Update(message, sizeof(message));
+	sha.Final(digest);
+
+	std::vector<InstrumentationRecord> records = Instrumentation::Snapshot();
+	InstrumentationRecord record = FindInstrumentationRecord(records, sha.AlgorithmName(), "update");
+	result = record.calls == 2 && record.bytes == 150 && record.provider == sha.AlgorithmProvider();
+	record = FindInstrumentationRecord(records, hmac.AlgorithmName(), "update");
+	result = record.calls == 1 && record.bytes == 100 && result;
+	pass = result && pass;
+	std::cout << (result ? "passed:  " : "FAILED:  ") << "hash and MAC updates\n";
+
+	record = FindInstrumentationRecord(records, hmac.AlgorithmName(), "setkey");
+	result = record.calls == 1 && record.bytes == sizeof(key);
+	record = FindInstrumentationRecord(records, ctr.AlgorithmName(), "setkey");
+	result = record.calls == 1 && record.bytes == sizeof(key) && result;
+	record = FindInstrumentationRecord(records, ctr.AlgorithmName(), "process");
+	result = record.calls == 1 && record.bytes == 64 && record.provider == ctr.AlgorithmProvider() && result;
+	pass = result && pass;
+	std::cout << (result ? "passed:  " : "FAILED:  ") << "key setup and ProcessData\n";
+
+	record = FindInstrumentationRecord(records, signer.AlgorithmName(), "sign");
+	result = record.calls == 1 && record.bytes == 32;
+	pass = result && pass;
+	std::cout << (result ? "passed:  " : "FAILED:  ") << "signing\n";
+
+	std::ostringstream oss;
+	Instrumentation::Export(oss);
+	result = oss.str().find("algorithm,provider,operation,calls,bytes,nanoseconds\n") == 0;
+	result = oss.str().find("\"" + hmac.AlgorithmName() + "\",") != std::string::npos && result;
+
+	Instrumentation::Reset();
+	result = Instrumentation::Snapshot().empty() && result;
+	pass = result && pass;
+	std::cout << (result ? "passed:  " : "FAILED:  ") << "export and reset\n";
+
+	Instrumentation::Enable(enabled);
+	return pass;
+}
+
 bool Test_RandomNumberGenerator(RandomNumberGenerator& prng, bool drain=false)
 {
 	bool pass = true, result = true;
@@ -639,6 +870,50 @@ bool TestRandomPool()
 	}
 #endif
 
+#if !defined(NO_OS_DEPENDENCE) && defined(OS_RNG_AVAILABLE) && defined(CRYPTOPP_CXX11_THREAD_LOCAL)
+	{
+		std::cout << "\nTesting ThreadLocalRandomPool generator...\n\n";
+		ThreadLocalRandomPool tlrng;
+		pass = Test_RandomNumberGenerator(tlrng) && pass;
+
+# if defined(CRYPTOPP_UNIX_AVAILABLE)
+		// The child must reseed instead of repeating the parent's buffered output
+		byte parent[16], child[16];
+		tlrng.GenerateBlock(parent, 1);
+
+		bool fail = true;
+		int fds[2];
+		if (pipe(fds) == 0)
+		{
+			pid_t pid = fork();
+			if (pid == 0)
+			{
+				tlrng.GenerateBlock(child, sizeof(child));
+				ssize_t ret = write(fds[1], child, sizeof(child));
+				_exit(ret == (ssize_t)sizeof(child) ? 0 : 1);
+			}
+
+			tlrng.GenerateBlock(parent, sizeof(parent));
+			if (pid > 0)
+			{
+				ssize_t ret = read(fds[0], child, sizeof(child));
+				waitpid(pid, NULLPTR, 0);
+				fail = (ret != (ssize_t)sizeof(child)) || std::memcmp(parent, child, sizeof(child)) == 0;
+			}
+
+			close(fds[0]); close(fds[1]);
+		}
+		pass = !fail && pass;
+
+		if (fail)
+			std::cout << "FAILED:";
+		else
+			std::cout << "passed:";
+		std::cout << "  child process output differs after fork\n";
+# endif
+	}
+#endif
+
 	// Old, PGP 2.6 style RandomPool. Added because users were still having problems
 	//  with it in 2017. The missing functionality was a barrier to upgrades.
 	try {prng.reset(new OldRandomPool);}
@@ -44,11 +44,19 @@
 #include "sosemanuk.h"
 
 #include "modes.h"
+#include "xts.h"
 #include "cmac.h"
+#include "cbcmac.h"
+#include "ccm.h"
+#include "gcm.h"
 #include "dmac.h"
 #include "hmac.h"
 #include "vmac.h"
 #include "ttmac.h"
+#include "chachapoly.h"
+#include "oneshot.h"
+#include "sha.h"
+#include "filters.h"
 
 #include "drbg.h"
 
@@ -325,6 +333,181 @@ bool TestFilter(BufferedTransformation &bt, const byte *in, size_t inLen, const
 	return ft->GetResult();
 }
 
+bool ValidateCtrDRBG()
+{
+	std::cout << "\nTesting NIST CTR DRBGs...\n\n";
+	bool pass=true, fail;
+
+	// The vectors use the block cipher derivation function. Expected values
+	//  were cross-checked with the OpenSSL 3.0 CTR-DRBG provider.
+
+	{
+		// [AES-128], [EntropyInputLen = 128], [NonceLen = 64], reseed
+		const byte entropy1[] = "\x03\x78\x1c\xc3\x64\x24\xaf\x0b\x23\xf3\x1c\x89\x3b\xb6\xc1\x23";
+		const byte nonce[] = "\x25\xfb\xbd\x08\xa9\x0f\x22\x3b";
+		const byte entropy2[] = "\x89\xbb\x72\x86\x69\x34\xff\x97\x17\x1e\x05\xc5\xf0\xe3\x67\x57";
+
+		CTR_DRBG<AES, 128/8> drbg(entropy1, 16, nonce, 8);
+
+		SecByteBlock result(64);
+		drbg.GenerateBlock(result, result.size());
+		drbg.IncorporateEntropy(entropy2, 16);
+		drbg.GenerateBlock(result, result.size());
+
+		const byte expected[] = "\xa0\x49\xe3\xe0\x78\x6e\xd7\x06\xfb\xff\xbb\x5d\xbc\x5d\x2b\x52\x84\x78\xec\x63"
+			"\x09\x5d\x15\xa6\x22\x41\x91\xa5\x8e\xe1\xe4\xc1\xb9\xa8\x55\x2d\x32\xad\x77\xc7"
+			"\x09\x19\x91\x42\x4b\x57\x4d\x13\x00\xfa\x91\xe6\x10\x7b\x3e\x38\x46\x14\xc2\x4b"
+			"\x67\xcb\x57\x06";
+
+		fail = !!memcmp(result, expected, 64);
+		pass = !fail && pass;
+
+		std::cout << (fail ? "FAILED   " : "passed   ") << "CTR_DRBG AES-128 (E=16, N=8, reseed)\n";
+	}
+
+	{
+		// [AES-128], [EntropyInputLen = 128], [NonceLen = 64], [PersonalizationStringLen = 128], [AdditionalInputLen = 128]
+		const byte entropy1[] = "\x32\x34\x54\x64\x5d\x98\xf4\x3f\x35\xb9\x37\x6a\x95\xa9\x8c\x0f";
+		const byte nonce[] = "\xf4\x0d\xd6\x2e\x5b\x22\x34\x25";
+		const byte personalization[] = "\xd6\xcb\xfd\x60\x07\x16\xbc\x87\xde\x70\xa6\xcf\x37\x35\xcb\x6e";
+		const byte additional1[] = "\xba\x5e\x31\x54\xa4\xd1\x38\x7b\x0a\x43\x56\x4b\x55\x92\x65\x7b";
+		const byte additional2[] = "\xa5\xa6\xd6\x50\xf6\x36\xf9\xbf\xfe\x18\xca\xc5\x4e\xe5\x2d\x8f";
+
+		CTR_DRBG<AES, 128/8> drbg(entropy1, 16, nonce, 8, personalization, 16);
+
+		SecByteBlock result(64);
+		drbg.GenerateBlock(additional1, 16, result, result.size());
+		drbg.GenerateBlock(additional2, 16, result, result.size());
+
+		const byte expected[] = "\x11\xfc\xc4\xdc\xd7\xe2\xdd\x5d\x58\xad\x16\x4e\xe0\x65\x27\xfa\x09\xbc\xc1\x8f"
+			"\x28\x0a\xcb\xb9\x5d\x36\x37\xbc\xe6\x30\x09\xae\x1f\xa1\x33\xbf\x54\x74\x5d\xba"
+			"\xd2\x02\x01\x57\x69\x42\x7c\x78\x9d\x30\x22\xad\xa1\x0f\xfd\x9c\x28\xb8\x33\x4b"
+			"\xe3\x7c\x74\x89";
+
+		fail = !!memcmp(result, expected, 64);
+		pass = !fail && pass;
+
+		std::cout << (fail ? "FAILED   " : "passed   ") << "CTR_DRBG AES-128 (E=16, N=8, A=16, P=16)\n";
+	}
+
+	{
+		// [AES-192], [EntropyInputLen = 192], [NonceLen = 96], [PersonalizationStringLen = 192], [AdditionalInputLen = 192], reseed
+		const byte entropy1[] = "\x9f\xef\x8b\xd6\xac\x4b\x17\x2c\x31\x07\xeb\xcb\x99\x5f\xb2\xf4\x18\xab\x66\x48"
+			"\xe8\x4e\xa6\xd6";
+		const byte nonce[] = "\xfd\xe2\x32\x1d\x74\x33\xcc\x55\x71\x67\xc9\x0c";
+		const byte personalization[] = "\x8f\xb6\x1e\x44\x19\xdf\xfb\xa3\x1e\xf5\x31\x33\x55\x29\xb6\xfd\xda\x26\x79\x0e"
+			"\x7f\x9c\xc9\x83";
+		const byte additional1[] = "\x47\xdc\x5f\xfb\x9c\x7d\xa2\x97\x09\xda\x1c\x7c\x23\xcc\xb9\x9b\xb1\x7f\xf9\xd4"
+			"\xc4\x06\x41\x7d";
+		const byte additional2[] = "\xc3\xc8\xfc\x78\x59\x3c\x02\x18\x60\x95\x48\x72\x2d\xfe\x0b\x21\x1f\x91\xdd\x9d"
+			"\x0c\xec\x9d\xe3";
+		const byte entropy2[] = "\x34\xc9\x31\xf2\xd2\xdd\x4c\xb0\x2f\x8d\x74\x8e\xb1\x83\x86\xb5\xdc\x80\x66\x3a"
+			"\x86\x31\xb7\x9d";
+		const byte additional3[] = "\x76\x4e\xb7\xd1\x77\x53\x22\x5f\x1f\x85\xc8\x58\xbe\x31\xf1\x4a\xb0\x61\x94\xc5"
+			"\x2a\x0a\xda\xab";
+
+		CTR_DRBG<AES, 192/8> drbg(entropy1, 24, nonce, 12, personalization, 24);
+
+		SecByteBlock result(64);
+		drbg.GenerateBlock(additional1, 24, result, result.size());
+		drbg.IncorporateEntropy(entropy2, 24, additional3, 24);
+		drbg.GenerateBlock(additional2, 24, result, result.size());
+
+		const byte expected[] = "\x6c\xd4\x06\x5e\x30\xd9\x29\x62\x72\x7c\xa0\x0d\xc8\x9c\x78\xe3\x54\xaf\xf5\xe9"
+			"\x19\x49\x97\x16\xab\x9b\x26\xb7\x78\x91\xc0\xb5\x7d\xfc\xe7\x88\x53\x0c\xe5\x85"
+			"\xba\x44\xa6\x98\xc6\x9c\x1a\x01\x97\x5f\xb0\x48\x6f\x1a\x2c\xd4\x2f\x2b\x9c\x6c"
+			"\x84\xdf\xaa\x14";
+
+		fail = !!memcmp(result, expected, 64);
+		pass = !fail && pass;
+
+		std::cout << (fail ? "FAILED   " : "passed   ") << "CTR_DRBG AES-192 (E=24, N=12, A=24, P=24, reseed)\n";
+	}
+
+	{
+		// [AES-256], [EntropyInputLen = 256], [NonceLen = 128], [PersonalizationStringLen = 256], [AdditionalInputLen = 256], reseed
+		const byte entropy1[] = "\x1e\xbb\x6c\x35\x24\x3e\x61\xe1\x4e\x34\x6c\xe3\xb6\x4e\x8a\x96\x3e\xeb\xc7\x44"
+			"\xbc\xf0\xd3\x09\x08\x78\x9d\xd3\xe5\x46\x42\x89";
+		const byte nonce[] = "\x33\x6f\xd0\xb3\x5d\x35\x66\x08\xd1\x71\x62\xb5\x32\x3d\x36\x52";
+		const byte personalization[] = "\x58\x4c\xb2\xf5\x5e\x1c\xc5\x37\x10\xf8\x3f\xe2\x9f\xb1\x7a\xe3\x7f\x73\xef\xa6"
+			"\x47\xa8\x2e\x6a\x08\x11\x7b\x27\x4c\xce\x79\xd4";
+		const byte additional1[] = "\x01\xfb\x00\x46\x61\x45\xc1\x48\x4c\xe3\xe9\x3e\x94\x4e\x67\xe4\xc6\xf8\x3b\x3d"
+			"\x9a\x24\xd8\xa1\x8a\xc4\x51\xd9\x18\xab\x92\xb5";
+		const byte additional2[] = "\x30\x05\x5f\xe8\x8a\x7e\xf0\x4e\xac\x78\x84\xf0\xdb\x42\x4f\xca\x63\x65\xad\x36"
+			"\x8d\xe2\x38\xc4\x69\x0c\xd2\x92\x3e\xf5\xb4\x3d";
+		const byte entropy2[] = "\x0c\xd9\xf4\x69\xaf\xe9\x52\x45\xfb\x1b\xcb\x8c\x0f\x53\x3f\xba\x7d\xc2\xff\x6d"
+			"\x24\xc4\x0c\x4f\x50\xcc\x0b\xef\x68\x39\x89\xdc";
+		const byte additional3[] = "\x70\x8b\x24\x13\x05\x7e\xcd\x79\x70\x45\x7a\xc2\x7a\xaa\xaf\x00\xe6\xad\xd3\xfa"
+			"\xba\xa6\x56\x3c\x2b\xfe\x16\x77\xdb\x5b\x0e\xef";
+
+		CTR_DRBG<AES, 256/8> drbg(entropy1, 32, nonce, 16, personalization, 32);
+
+		SecByteBlock result(64);
+		drbg.GenerateBlock(additional1, 32, result, result.size());
+		drbg.IncorporateEntropy(entropy2, 32, additional3, 32);
+		drbg.GenerateBlock(additional2, 32, result, result.size());
+
+		const byte expected[] = "\xfd\xc9\xa7\x3b\x68\x66\xf0\x30\x18\xf5\x51\x4a\x3a\xed\xe8\x65\x11\x33\xab\xa0"
+			"\x30\x86\x71\x50\x18\x32\x6d\x25\x52\xca\x2c\x59\x4d\xbf\xce\xa9\x42\xe1\x13\x68"
+			"\xd0\x2f\xb2\xbe\x33\xc3\x3c\xaa\x0f\x13\x63\x4f\x4a\x4d\xec\x09\xa3\x53\x60\xf6"
+			"\xd8\x5b\x46\x0b";
+
+		fail = !!memcmp(result, expected, 64);
+		pass = !fail && pass;
+
+		std::cout << (fail ? "FAILED   " : "passed   ") << "CTR_DRBG AES-256 (E=32, N=16, A=32, P=32, reseed)\n";
+	}
+
+	{
+		// [AES-256], [EntropyInputLen = 256], [NonceLen = 128], [ReturnedBitsLen = 32824], last 64 bytes.
+		//   The request crosses several counter carries and ends in a partial block.
+		const byte entropy1[] = "\x91\x64\xe8\xde\x52\x9e\x63\x33\x6b\x38\xf1\x0e\xaf\xde\xd6\x72\x09\xe2\xba\x69"
+			"\x73\xc0\x66\x22\xd1\xf7\xbc\xc9\xe9\xf4\xbd\x84";
+		const byte nonce[] = "\xe8\x51\x6d\x3d\x8e\x41\xc8\x17\x74\x0e\x23\xde\x95\x4e\xdf\xb5";
+		const byte entropy2[] = "\xde\x32\x20\xa5\x61\x77\x3a\x46\x57\x57\xf5\xeb\x6b\xc6\x50\xd5\x45\x99\x70\xd2"
+			"\xab\x6b\x57\x11\x2f\xa6\x39\xe5\x42\xd0\xe7\xf7";
+
+		CTR_DRBG<AES, 256/8> drbg(entropy1, 32, nonce, 16);
+
+		SecByteBlock result(4103);
+		drbg.GenerateBlock(result, result.size());
+		drbg.IncorporateEntropy(entropy2, 32);
+		drbg.GenerateBlock(result, result.size());
+
+		const byte expected[] = "\x61\x90\xbc\xf3\x21\x62\xa1\x06\x8d\x30\x38\xc9\xdc\x80\x02\x6f\x26\xcc\x3f\xc8"
+			"\x21\xec\x31\xb4\x67\x14\x42\xbf\x85\x32\xd7\x09\x89\x69\xfe\xa4\x9d\xcb\xb1\x0d"
+			"\x6f\xda\xd6\x5e\x97\x54\x20\xee\x31\xdf\xb4\xe5\x1f\xa5\xf9\x1b\x4e\xcc\xc0\x61"
+			"\xd7\x14\x46\xd8";
+
+		fail = !!memcmp(result+result.size()-64, expected, 64);
+		pass = !fail && pass;
+
+		std::cout << (fail ? "FAILED   " : "passed   ") << "CTR_DRBG AES-256 (E=32, N=16, reseed, 4103 bytes)\n";
+	}
+
+	{
+		// Requests are limited to MAXIMUM_BYTES_PER_REQUEST
+		const byte entropy[] = "\x00\x01\x02\x03\x04\x05\x06\x07\x08\x09\x0a\x0b\x0c\x0d\x0e\x0f";
+		CTR_DRBG<AES, 128/8> drbg(entropy, 16);
+
+		SecByteBlock result(drbg.MaxBytesPerRequest()+1);
+		try
+		{
+			drbg.GenerateBlock(result, result.size());
+			fail = true;
+		}
+		catch (const NIST_DRBG::Err&)
+		{
+			fail = false;
+		}
+		pass = !fail && pass;
+
+		std::cout << (fail ? "FAILED   " : "passed   ") << "CTR_DRBG request size limit\n";
+	}
+
+	return pass;
+}
+
 bool ValidateDES()
 {
 	std::cout << "\nDES validation suite running...\n\n";
@@ -971,6 +1154,78 @@ bool ValidateMARS()
 	return pass1 && pass2 && pass3;
 }
 
+// Rijndael::KeyArray must agree with AES::Encryption keyed with each key
+bool TestRijndaelKeyArray(size_t keyLength)
+{
+	const size_t keyCount = 21;
+	SecByteBlock keys(keyLength*keyCount);
+	SecByteBlock in(16*keyCount), xorBlocks(16*keyCount);
+	SecByteBlock out(16*keyCount), expected(16*keyCount);
+	GlobalRNG().GenerateBlock(keys, keys.size());
+	GlobalRNG().GenerateBlock(in, in.size());
+	GlobalRNG().GenerateBlock(xorBlocks, xorBlocks.size());
+
+	Rijndael::KeyArray keyArray(keyCount-1, keyLength);
+	keyArray.Resize(keyCount);
+	bool fail = keyArray.Count() != keyCount || keyArray.KeyLength() != keyLength;
+	keyArray.SetKeys(0, keys, keyCount-5);
+	for (size_t i=keyCount-5; i<keyCount; ++i)
+		keyArray.SetKey(i, keys+keyLength*i, keyLength);
+
+	size_t indexes[keyCount];
+	for (size_t i=0; i<keyCount; ++i)
+		indexes[i] = (i*7+3) % keyCount;
+
+	AES::Encryption enc;
+	for (size_t count=1; count<=keyCount && !fail; ++count)
+	{
+		for (size_t i=0; i<count; ++i)
+		{
+			enc.SetKey(keys+keyLength*i, keyLength);
+			enc.ProcessBlock(in+16*i, expected+16*i);
+		}
+		keyArray.EncryptBlocks(in, NULLPTR, out, count);
+		fail = !VerifyBufsEqual(out, expected, 16*count) || fail;
+
+		for (size_t i=0; i<count; ++i)
+		{
+			enc.SetKey(keys+keyLength*indexes[i], keyLength);
+			enc.ProcessAndXorBlock(in+16*i, xorBlocks+16*i, expected+16*i);
+		}
+		keyArray.EncryptBlocks(in, xorBlocks, out, count, indexes);
+		fail = !VerifyBufsEqual(out, expected, 16*count) || fail;
+
+		std::memcpy(out, in, 16*count);
+		keyArray.EncryptBlocks(out, xorBlocks, out, count, indexes);
+		fail = !VerifyBufsEqual(out, expected, 16*count) || fail;
+	}
+
+	try
+	{
+		indexes[0] = keyCount;
+		keyArray.EncryptBlocks(in, NULLPTR, out, 1, indexes);
+		fail = true;
+	}
+	catch (const InvalidArgument&) {}
+
+	try
+	{
+		keyArray.SetKeys(1, keys, keyCount);
+		fail = true;
+	}
+	catch (const InvalidArgument&) {}
+
+	try
+	{
+		keyArray.SetKey(0, keys, keyLength == 16 ? 24 : 16);
+		fail = true;
+	}
+	catch (const InvalidKeyLength&) {}
+
+	std::cout << (fail ? "FAILED" : "passed") << "    AES key array, " << keyLength << "-byte keys\n";
+	return !fail;
+}
+
 bool ValidateRijndael()
 {
 	std::cout << "\nRijndael (AES) validation suite running...\n\n";
@@ -1002,6 +1257,11 @@ bool ValidateRijndael()
 	pass3 = BlockTransformationTest(FixedRoundsCipherFactory<RijndaelEncryption, RijndaelDecryption>(24), valdata, 3) && pass3;
 	pass3 = BlockTransformationTest(FixedRoundsCipherFactory<RijndaelEncryption, RijndaelDecryption>(32), valdata, 2) && pass3;
 	pass3 = RunTestDataFile("TestVectors/aes.txt") && pass3;
+
+	std::cout << "\n";
+	pass3 = TestRijndaelKeyArray(16) && pass3;
+	pass3 = TestRijndaelKeyArray(24) && pass3;
+	pass3 = TestRijndaelKeyArray(32) && pass3;
 	return pass1 && pass2 && pass3;
 }
 
@@ -1335,6 +1595,110 @@ bool ValidateSEAL()
 	return pass;
 }
 
+// Encodes a bit at a time, which is BaseN_Encoder without the group fast paths
+std::string BitwiseEncode(const std::string &message, const char *alphabet, unsigned int bits, bool pad)
+{
+	std::string encoded;
+	word32 acc = 0;
+	unsigned int count = 0;
+	for (size_t i=0; i<message.size(); i++)
+	{
+		acc = (acc << 8) | byte(message[i]);
+		count += 8;
+		while (count >= bits)
+		{
+			count -= bits;
+			encoded += alphabet[(acc >> count) & ((1 << bits) - 1)];
+		}
+	}
+	if (count)
+		encoded += alphabet[(acc << (bits-count)) & ((1 << bits) - 1)];
+	while (pad && encoded.size() % 4)
+		encoded += '=';
+	return encoded;
+}
+
+// Adds line breaks and characters that are not in any alphabet
+std::string AddNoise(const std::string &encoded)
+{
+	const char noise[] = " \r\n\t=*\x80\xff";
+	std::string result;
+	for (size_t i=0; i<encoded.size(); i++)
+	{
+		if (i % 76 == 75)
+			result += '\n';
+		if (GlobalRNG().GenerateWord32(0, 199) == 0)
+			result += noise[GlobalRNG().GenerateWord32(0, COUNTOF(noise)-2)];
+		result += encoded[i];
+	}
+	return result;
+}
+
+// Puts message into filter in random pieces, and returns the output
+std::string PutInPieces(BufferedTransformation &filter, const std::string &message)
+{
+	std::string output;
+	filter.Attach(new StringSink(output));
+	for (size_t i=0, n=0; i<message.size(); i+=n)
+	{
+		n = STDMIN(message.size()-i, (size_t)GlobalRNG().GenerateWord32(0, 1000));
+		filter.Put(ConstBytePtr(message)+i, n);
+	}
+	filter.MessageEnd();
+	return output;
+}
+
+// Compares the group at a time encoders and decoders with BitwiseEncode
+bool TestBaseCodeGroups()
+{
+	const char hexUpper[] = "0123456789ABCDEF", hexLower[] = "0123456789abcdef";
+	const char base64[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+	const char base64URL[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+	const char custom[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz.,";
+	bool pass = true;
+
+	int customLookup[256];
+	BaseN_Decoder::InitializeDecodingLookupArray(customLookup, (const byte *)custom, 64, false);
+
+	for (unsigned int i=0; i<64; i++)
+	{
+		std::string message, expected;
+		message.resize(i < 32 ? i : GlobalRNG().GenerateWord32(0, 10000));
+		GlobalRNG().GenerateBlock(BytePtr(message), BytePtrSize(message));
+
+		HexEncoder hexEncoder(NULLPTR, true, 0), hexLowerEncoder(NULLPTR, false, 0);
+		Base64Encoder base64Encoder(NULLPTR, false);
+		Base64URLEncoder base64URLEncoder(NULLPTR, false);
+		BaseN_Encoder customEncoder((const byte *)custom, 6);
+
+		expected = BitwiseEncode(message, hexUpper, 4, false);
+		pass = PutInPieces(hexEncoder, message) == expected && pass;
+		HexDecoder hexDecoder;
+		pass = PutInPieces(hexDecoder, AddNoise(expected)) == message && pass;
+
+		expected = BitwiseEncode(message, hexLower, 4, false);
+		pass = PutInPieces(hexLowerEncoder, message) == expected && pass;
+		pass = PutInPieces(hexDecoder, AddNoise(expected)) == message && pass;
+
+		expected = BitwiseEncode(message, base64, 6, true);
+		pass = PutInPieces(base64Encoder, message) == expected && pass;
+		Base64Decoder base64Decoder;
+		pass = PutInPieces(base64Decoder, AddNoise(expected)) == message && pass;
+
+		expected = BitwiseEncode(message, base64URL, 6, false);
+		pass = PutInPieces(base64URLEncoder, message) == expected && pass;
+		Base64URLDecoder base64URLDecoder;
+		pass = PutInPieces(base64URLDecoder, AddNoise(expected)) == message && pass;
+
+		expected = BitwiseEncode(message, custom, 6, false);
+		pass = PutInPieces(customEncoder, message) == expected && pass;
+		BaseN_Decoder customDecoder(customLookup, 6);
+		pass = PutInPieces(customDecoder, AddNoise(expected)) == message && pass;
+	}
+
+	return pass;
+}
+
 bool ValidateBaseCode()
 {
 	bool pass = true, fail;
@@ -1436,6 +1800,11 @@ bool ValidateBaseCode()
 	std::cout << "  Base64 URL Decoding\n";
 	pass = pass && !fail;
 
+	fail = !TestBaseCodeGroups();
+	std::cout << (fail ? "FAILED:" : "passed:");
+	std::cout << "  Random messages, pieces and noise\n";
+	pass = pass && !fail;
+
 	return pass;
 }
 
@@ -1782,10 +2151,126 @@ bool ValidateVMAC()
 	return RunTestDataFile("TestVectors/vmac.txt");
 }
 
+// The clone must carry the keyed state and the position in the
+// message, and must not refer back to the object it was cloned from.
+template <class T>
+bool TestAuthenticatedClone(const char *name)
+{
+	SecByteBlock key(16), iv(12), aad(20), plain(100);
+	SecByteBlock expected(plain.size()), actual(plain.size()), tag1(12), tag2(12);
+	GlobalRNG().GenerateBlock(key, key.size());
+	GlobalRNG().GenerateBlock(iv, iv.size());
+	GlobalRNG().GenerateBlock(aad, aad.size());
+	GlobalRNG().GenerateBlock(plain, plain.size());
+
+	member_ptr<T> original(new T);
+	original->SetKeyWithIV(key, key.size(), iv, iv.size());
+	original->EncryptAndAuthenticate(expected, tag1, tag1.size(), iv, (int)iv.size(), aad, aad.size(), plain, plain.size());
+
+	// keyed template, destroyed before the clone is used
+	member_ptr<AuthenticatedSymmetricCipher> clone(dynamic_cast<AuthenticatedSymmetricCipher*>(original->Clone()));
+	original->Resynchronize(iv, (int)iv.size());
+	original->SpecifyDataLengths(aad.size(), plain.size());
+	original->Update(aad, aad.size());
+	original->ProcessString(actual, plain, 40);
+	T copy(*original);
+	original.reset();
+
+	clone->EncryptAndAuthenticate(actual, tag2, tag2.size(), iv, (int)iv.size(), aad, aad.size(), plain, plain.size());
+	bool fail = actual != expected || tag1 != tag2;
+
+	// copy taken part way through a message
+	copy.ProcessString(actual+40, plain+40, plain.size()-40);
+	copy.TruncatedFinal(tag2, tag2.size());
+	fail = actual != expected || tag1 != tag2 || fail;
+
+	std::cout << (fail ? "FAILED" : "passed") << "    " << name << " Clone and copy\n";
+	return !fail;
+}
+
+// EncryptAndAuthenticateStreams and DecryptAndVerifyStreams must
+// agree with EncryptAndAuthenticate and DecryptAndVerify
+template <class T>
+bool TestAuthenticatedStreams(const char *name, size_t ivSize, size_t macSize,
+	const size_t headerLengths[], const size_t messageLengths[], size_t count)
+{
+	size_t total = 0;
+	for (size_t i=0; i<count; ++i)
+		total += headerLengths[i] + 3*messageLengths[i] + macSize;
+
+	typename T::Encryption enc;
+	typename T::Decryption dec;
+	SecByteBlock key(enc.DefaultKeyLength()), ivs(count*ivSize), buffer(total);
+	GlobalRNG().GenerateBlock(key, key.size());
+	GlobalRNG().GenerateBlock(ivs, ivs.size());
+	GlobalRNG().GenerateBlock(buffer, buffer.size());
+
+	std::vector<const byte *> iv(count), header(count), message(count), cipherText(count), tag(count);
+	std::vector<byte *> out(count), mac(count), recovered(count);
+	for (size_t i=0, offset=0; i<count; ++i)
+	{
+		iv[i] = ivs+i*ivSize;
+		header[i] = buffer+offset; offset += headerLengths[i];
+		message[i] = buffer+offset; offset += messageLengths[i];
+		out[i] = buffer+offset; cipherText[i] = out[i]; offset += messageLengths[i];
+		mac[i] = buffer+offset; tag[i] = mac[i]; offset += macSize;
+		recovered[i] = buffer+offset; offset += messageLengths[i];
+	}
+
+	enc.SetKeyWithIV(key, key.size(), ivs, ivSize);
+	enc.EncryptAndAuthenticateStreams(&out[0], &mac[0], macSize, &iv[0], (int)ivSize, &header[0], headerLengths, &message[0], messageLengths, count);
+
+	bool pass = true, fail = false;
+	for (size_t i=0; i<count; ++i)
+	{
+		SecByteBlock c(messageLengths[i]), t(macSize);
+		enc.EncryptAndAuthenticate(c, t, t.size(), iv[i], (int)ivSize, header[i], headerLengths[i], message[i], messageLengths[i]);
+		fail = !VerifyBufsEqual(c, out[i], c.size()) || !VerifyBufsEqual(t, mac[i], t.size()) || fail;
+	}
+	pass = !fail && pass;
+	std::cout << (fail ? "FAILED" : "passed") << "    " << name << " EncryptAndAuthenticateStreams\n";
+
+	dec.SetKeyWithIV(key, key.size(), ivs, ivSize);
+	SecBlock<bool> verified(count);
+	fail = !dec.DecryptAndVerifyStreams(&recovered[0], verified, &tag[0], macSize, &iv[0], (int)ivSize, &header[0], headerLengths, &cipherText[0], messageLengths, count);
+	for (size_t i=0; i<count; ++i)
+		fail = !verified[i] || !VerifyBufsEqual(recovered[i], message[i], messageLengths[i]) || fail;
+
+	// a single damaged tag must only fail its own message
+	mac[3][0] ^= 1;
+	fail = dec.DecryptAndVerifyStreams(&recovered[0], verified, &tag[0], macSize, &iv[0], (int)ivSize, &header[0], headerLengths, &cipherText[0], messageLengths, count) || fail;
+	for (size_t i=0; i<count; ++i)
+		fail = (verified[i] != (i != 3)) || fail;
+	mac[3][0] ^= 1;
+
+	// in place
+	for (size_t i=0; i<count; ++i)
+		std::memcpy(recovered[i], cipherText[i], messageLengths[i]);
+	std::vector<const byte *> inPlace(recovered.begin(), recovered.end());
+	fail = !dec.DecryptAndVerifyStreams(&recovered[0], verified, &tag[0], macSize, &iv[0], (int)ivSize, &header[0], headerLengths, &inPlace[0], messageLengths, count) || fail;
+	for (size_t i=0; i<count; ++i)
+		fail = !VerifyBufsEqual(recovered[i], message[i], messageLengths[i]) || fail;
+
+	pass = !fail && pass;
+	std::cout << (fail ? "FAILED" : "passed") << "    " << name << " DecryptAndVerifyStreams\n";
+
+	return pass;
+}
+
 bool ValidateCCM()
 {
 	std::cout << "\nAES/CCM validation suite running...\n";
-	return RunTestDataFile("TestVectors/ccm.txt");
+	bool pass = RunTestDataFile("TestVectors/ccm.txt");
+
+	std::cout << "\n";
+
+	const size_t headerLengths[] = {0, 13, 0, 14, 15, 16, 20, 300, 65300};
+	const size_t messageLengths[] = {0, 0, 1, 15, 16, 17, 64, 1000, 33};
+	pass = TestAuthenticatedStreams<CCM<AES, 12> >("AES/CCM", 13, 12, headerLengths, messageLengths, COUNTOF(messageLengths)) && pass;
+
+	pass = TestAuthenticatedClone<CCM<AES, 12>::Encryption>("AES/CCM") && pass;
+
+	return pass;
 }
 
 bool ValidateGCM()
@@ -1794,19 +2279,524 @@ bool ValidateGCM()
 	std::cout << "\n2K tables:";
 	bool pass = RunTestDataFile("TestVectors/gcm.txt", MakeParameters(Name::TableSize(), (int)2048));
 	std::cout << "\n64K tables:";
-	return RunTestDataFile("TestVectors/gcm.txt", MakeParameters(Name::TableSize(), (int)64*1024)) && pass;
+	pass = RunTestDataFile("TestVectors/gcm.txt", MakeParameters(Name::TableSize(), (int)64*1024)) && pass;
+
+	std::cout << "\n";
+	pass = TestAuthenticatedClone<GCM<AES, GCM_2K_Tables>::Encryption>("AES/GCM 2K tables") && pass;
+	pass = TestAuthenticatedClone<GCM<AES, GCM_64K_Tables>::Encryption>("AES/GCM 64K tables") && pass;
+
+	// Packet sized messages that share counter and GHASH stages, and
+	// messages larger than a stage or a group
+	const size_t headerLengths[] = {0, 13, 0, 14, 15, 16, 20, 300, 1100, 0, 8, 8, 8, 8, 8, 8, 8, 8, 1, 2000};
+	const size_t messageLengths[] = {0, 0, 1, 15, 16, 17, 64, 1000, 33, 40000, 100, 1500, 1500, 1500, 576, 1, 9000, 20, 1023, 1025};
+	pass = TestAuthenticatedStreams<GCM<AES, GCM_2K_Tables> >("AES/GCM 2K tables", 12, 16, headerLengths, messageLengths, COUNTOF(messageLengths)) && pass;
+	pass = TestAuthenticatedStreams<GCM<AES, GCM_64K_Tables> >("AES/GCM 64K tables", 12, 16, headerLengths, messageLengths, COUNTOF(messageLengths)) && pass;
+	pass = TestAuthenticatedStreams<GCM<AES> >("AES/GCM, 16-byte IV", 16, 12, headerLengths, messageLengths, COUNTOF(messageLengths)) && pass;
+	pass = TestAuthenticatedStreams<GCM<AES> >("AES/GCM, 1-byte IV", 1, 16, headerLengths, messageLengths, COUNTOF(messageLengths)) && pass;
+	pass = TestAuthenticatedStreams<GCM<AES> >("AES/GCM, 1025-byte IV", 1025, 16, headerLengths, messageLengths, COUNTOF(messageLengths)) && pass;
+
+	return pass;
+}
+
+bool ValidateChaCha20Poly1305()
+{
+	std::cout << "\nChaCha20/Poly1305 validation suite running...\n";
+	bool pass = RunTestDataFile("TestVectors/chacha20poly1305.txt");
+
+	std::cout << "\n";
+
+	const size_t headerLengths[] = {0, 13, 0, 14, 15, 16, 20, 300, 1100, 0, 8, 8, 8, 8, 8, 8, 8, 8, 1, 2000};
+	const size_t messageLengths[] = {0, 0, 1, 15, 16, 17, 64, 1000, 33, 40000, 100, 1500, 1500, 1500, 576, 1, 9000, 20, 1984, 1985};
+	pass = TestAuthenticatedStreams<ChaCha20Poly1305>("ChaCha20/Poly1305", 12, 16, headerLengths, messageLengths, COUNTOF(messageLengths)) && pass;
+	pass = TestAuthenticatedStreams<ChaCha20Poly1305>("ChaCha20/Poly1305, truncated MAC", 12, 10, headerLengths, messageLengths, COUNTOF(messageLengths)) && pass;
+
+	return pass;
 }
 
 bool ValidateXTS()
 {
 	std::cout << "\nAES/XTS validation suite running...\n";
-	return RunTestDataFile("TestVectors/xts.txt");
+	bool pass = RunTestDataFile("TestVectors/xts.txt");
+
+	std::cout << "\n";
+
+	// ProcessSectors must agree with Resynchronize and ProcessData
+	const size_t sectorSizes[] = {16, 48, 512, 4096};
+	const size_t counts[] = {1, 7, 8, 19};
+	for (size_t i=0; i<COUNTOF(sectorSizes); ++i)
+	{
+		bool fail = false;
+		const size_t sectorSize = sectorSizes[i], count = counts[i];
+		const word64 sector = (word64(1) << 32) - 3;
+
+		SecByteBlock key(64), iv(16), plain(sectorSize*count), cipher(plain.size());
+		SecByteBlock batch(plain.size()), recovered(plain.size());
+		GlobalRNG().GenerateBlock(key, key.size());
+		GlobalRNG().GenerateBlock(plain, plain.size());
+
+		XTS_Mode<AES>::Encryption enc;
+		enc.SetKeyWithIV(key, key.size(), iv, iv.size());
+		for (size_t j=0; j<count; ++j)
+		{
+			enc.Resynchronize(sector+j, LITTLE_ENDIAN_ORDER);
+			enc.ProcessData(cipher+j*sectorSize, plain+j*sectorSize, sectorSize);
+		}
+
+		enc.ProcessSectors(batch, plain, sector, sectorSize, count, LITTLE_ENDIAN_ORDER);
+		fail = (batch != cipher) || fail;
+
+		XTS_Mode<AES>::Decryption dec;
+		dec.SetKeyWithIV(key, key.size(), iv, iv.size());
+		dec.ProcessSectors(recovered, batch, sector, sectorSize, count, LITTLE_ENDIAN_ORDER);
+		fail = (recovered != plain) || fail;
+
+		// in-place
+		dec.ProcessSectors(batch, batch, sector, sectorSize, count, LITTLE_ENDIAN_ORDER);
+		fail = (batch != plain) || fail;
+
+		pass = !fail && pass;
+		std::cout << (fail ? "FAILED" : "passed") << "    ProcessSectors, " << count << " sectors of " << sectorSize << " bytes\n";
+	}
+
+	return pass;
 }
 
 bool ValidateCMAC()
 {
 	std::cout << "\nCMAC validation suite running...\n";
-	return RunTestDataFile("TestVectors/cmac.txt");
+	bool pass = RunTestDataFile("TestVectors/cmac.txt");
+
+	std::cout << "\n";
+
+	// Lockstep processing must agree with one message at a time
+	const size_t COUNT = 8;
+	const size_t lengths[COUNT] = {0, 1, 15, 16, 17, 64, 250, 4096};
+	const byte *message[COUNT];
+	byte *mac[COUNT], *out[COUNT], *chain[COUNT];
+
+	SecByteBlock key(16), iv(16), buffer(8192), macs(COUNT*16), outs(COUNT*4096), chains(COUNT*16);
+	GlobalRNG().GenerateBlock(key, key.size());
+	GlobalRNG().GenerateBlock(iv, iv.size());
+	GlobalRNG().GenerateBlock(buffer, buffer.size());
+	for (size_t i=0; i<COUNT; ++i)
+	{
+		message[i] = buffer+i*512;
+		mac[i] = macs+i*16;
+		out[i] = outs+i*4096;
+		chain[i] = chains+i*16;
+	}
+
+	bool fail = false;
+	CMAC<AES> cmac(key, key.size());
+	cmac.CalculateDigests(mac, 16, message, lengths, COUNT);
+	for (size_t i=0; i<COUNT; ++i)
+	{
+		byte digest[16];
+		cmac.CalculateDigest(digest, message[i], lengths[i]);
+		fail = !VerifyBufsEqual(digest, mac[i], 16) || fail;
+	}
+	pass = !fail && pass;
+	std::cout << (fail ? "FAILED" : "passed") << "    CMAC CalculateDigests\n";
+
+	fail = false;
+	CBC_MAC<AES> cbcmac(key, key.size());
+	cbcmac.CalculateDigests(mac, 16, message, lengths, COUNT);
+	for (size_t i=0; i<COUNT; ++i)
+	{
+		byte digest[16];
+		cbcmac.CalculateDigest(digest, message[i], lengths[i]);
+		fail = !VerifyBufsEqual(digest, mac[i], 16) || fail;
+	}
+	pass = !fail && pass;
+	std::cout << (fail ? "FAILED" : "passed") << "    CBC-MAC CalculateDigests\n";
+
+	// CBC needs whole blocks
+	size_t blockLengths[COUNT];
+	for (size_t i=0; i<COUNT; ++i)
+	{
+		blockLengths[i] = RoundDownToMultipleOf(lengths[i], (size_t)16);
+		std::memcpy(chain[i], iv, 16);
+	}
+
+	fail = false;
+	CBC_Mode<AES>::Encryption cbc(key, key.size(), iv);
+	cbc.ProcessStreams(out, message, chain, blockLengths, COUNT);
+	for (size_t i=0; i<COUNT; ++i)
+	{
+		SecByteBlock c(blockLengths[i]);
+		cbc.Resynchronize(iv);
+		cbc.ProcessString(c, message[i], c.size());
+		fail = !VerifyBufsEqual(c, out[i], c.size()) || fail;
+		if (c.size())
+			fail = !VerifyBufsEqual(c+c.size()-16, chain[i], 16) || fail;
+	}
+	pass = !fail && pass;
+	std::cout << (fail ? "FAILED" : "passed") << "    CBC ProcessStreams\n";
+
+	// Clone copies the keyed state
+	{
+		member_ptr<CMAC<AES> > original(new CMAC<AES>(key, key.size()));
+		member_ptr<MessageAuthenticationCode> clone(dynamic_cast<MessageAuthenticationCode*>(original->Clone()));
+		byte expected[16], actual[16];
+		original->CalculateDigest(expected, buffer, 100);
+		original.reset();
+
+		clone->CalculateDigest(actual, buffer, 100);
+		fail = !VerifyBufsEqual(expected, actual, 16);
+		pass = !fail && pass;
+		std::cout << (fail ? "FAILED" : "passed") << "    CMAC Clone\n";
+	}
+
+	{
+		member_ptr<CBC_Mode<AES>::Encryption> original(new CBC_Mode<AES>::Encryption(key, key.size(), iv));
+		member_ptr<SymmetricCipher> clone(dynamic_cast<SymmetricCipher*>(original->Clone()));
+		SecByteBlock expected(64), actual(64);
+		original->ProcessString(expected, buffer, 64);
+		original.reset();
+
+		clone->ProcessString(actual, buffer, 64);
+		fail = (expected != actual);
+		pass = !fail && pass;
+		std::cout << (fail ? "FAILED" : "passed") << "    CBC Clone\n";
+	}
+
+	return pass;
+}
+
+// The one-shot functions must agree with the filters
+template <class T>
+bool TestOneShotAEAD(const char *name)
+{
+	const size_t lengths[] = {0, 1, 15, 16, 17, 64, 1000};
+	SecByteBlock key(32), iv(12), aad(20), message(1000);
+	GlobalRNG().GenerateBlock(key, key.size());
+	GlobalRNG().GenerateBlock(iv, iv.size());
+	GlobalRNG().GenerateBlock(aad, aad.size());
+	GlobalRNG().GenerateBlock(message, message.size());
+
+	typename T::Encryption enc;
+	typename T::Decryption dec;
+	enc.SetKeyWithIV(key, enc.DefaultKeyLength(), iv, iv.size());
+	dec.SetKeyWithIV(key, dec.DefaultKeyLength(), iv, iv.size());
+
+	bool fail = false;
+	for (size_t i=0; i<COUNTOF(lengths); ++i)
+	{
+		const size_t length = lengths[i];
+		const int tagSizes[] = {-1, 12};
+		for (size_t j=0; j<COUNTOF(tagSizes); ++j)
+		{
+			std::string expected;
+			enc.Resynchronize(iv, (int)iv.size());
+			AuthenticatedEncryptionFilter ef(enc, new StringSink(expected), false, tagSizes[j]);
+			ef.ChannelPut(AAD_CHANNEL, aad, aad.size());
+			ef.ChannelMessageEnd(AAD_CHANNEL);
+			ef.Put(message, length);
+			ef.MessageEnd();
+
+			SecByteBlock actual(length+16), recovered(length);
+			size_t n = EncryptAndAuthenticate(enc, actual, actual.size(), iv, iv.size(),
+				aad, aad.size(), message, length, tagSizes[j]);
+			fail = (n != expected.size()) || fail;
+			fail = !VerifyBufsEqual(actual, ConstBytePtr(expected), expected.size()) || fail;
+
+			n = DecryptAndVerify(dec, recovered, recovered.size(), iv, iv.size(),
+				aad, aad.size(), actual, expected.size(), tagSizes[j]);
+			fail = (n != length) || !VerifyBufsEqual(recovered, message, length) || fail;
+
+			// Tampered tag
+			actual[expected.size()-1] ^= 1;
+			bool thrown = false;
+			try {
+				DecryptAndVerify(dec, recovered, recovered.size(), iv, iv.size(),
+					aad, aad.size(), actual, expected.size(), tagSizes[j]);
+			}
+			catch (const HashVerificationFilter::HashVerificationFailed&) {
+				thrown = true;
+			}
+			fail = !thrown || fail;
+		}
+	}
+
+	std::cout << (fail ? "FAILED" : "passed") << "    " << name << " one-shot\n";
+	return !fail;
+}
+
+template <class T>
+bool TestOneShotCipher(const char *name, BlockPaddingSchemeDef::BlockPaddingScheme padding, bool blocksOnly=false)
+{
+	const size_t lengths[] = {0, 1, 15, 16, 17, 32, 33, 64, 1000};
+	SecByteBlock key(16), iv(16), message(1024);
+	GlobalRNG().GenerateBlock(key, key.size());
+	GlobalRNG().GenerateBlock(iv, iv.size());
+	GlobalRNG().GenerateBlock(message, message.size());
+
+	typename T::Encryption enc;
+	typename T::Decryption dec;
+
+	// ECB does not take an IV
+	AlgorithmParameters params = MakeParameters(Name::IV(), ConstByteArrayParameter(iv), false);
+
+	bool fail = false;
+	for (size_t i=0; i<COUNTOF(lengths); ++i)
+	{
+		const size_t length = lengths[i];
+		if (blocksOnly && length % 16 != 0)
+			continue;
+
+		// CBC-CTS needs more than one block
+		if (enc.MinLastBlockSize() > length && length != 0)
+			continue;
+
+		std::string expected;
+		enc.SetKey(key, key.size(), params);
+		StringSource(message.begin(), length, true, new StreamTransformationFilter(enc, new StringSink(expected), padding));
+
+		SecByteBlock actual(length+16), recovered(length+16);
+		enc.SetKey(key, key.size(), params);
+		size_t n = ProcessMessage(enc, actual, actual.size(), message, length, padding);
+		fail = (n != expected.size()) || fail;
+		fail = !VerifyBufsEqual(actual, ConstBytePtr(expected), expected.size()) || fail;
+
+		dec.SetKey(key, key.size(), params);
+		n = ProcessMessage(dec, recovered, recovered.size(), actual, expected.size(), padding);
+		fail = (n != length) || !VerifyBufsEqual(recovered, message, length) || fail;
+
+		// in-place
+		enc.SetKey(key, key.size(), params);
+		std::memcpy(recovered, message, length);
+		n = ProcessMessage(enc, recovered, recovered.size(), recovered, length, padding);
+		fail = (n != expected.size()) || !VerifyBufsEqual(recovered, actual, n) || fail;
+	}
+
+	std::cout << (fail ? "FAILED" : "passed") << "    " << name << " one-shot\n";
+	return !fail;
+}
+
+bool ValidateOneShot()
+{
+	std::cout << "\nOne-shot validation suite running...\n\n";
+	bool pass = true;
+
+	pass = TestOneShotAEAD<GCM<AES> >("AES/GCM") && pass;
+	pass = TestOneShotAEAD<ChaCha20Poly1305>("ChaCha20/Poly1305") && pass;
+
+	pass = TestOneShotCipher<CBC_Mode<AES> >("AES/CBC", BlockPaddingSchemeDef::DEFAULT_PADDING) && pass;
+	pass = TestOneShotCipher<CBC_Mode<AES> >("AES/CBC (no padding)", BlockPaddingSchemeDef::NO_PADDING, true) && pass;
+	pass = TestOneShotCipher<ECB_Mode<AES> >("AES/ECB", BlockPaddingSchemeDef::PKCS_PADDING) && pass;
+	pass = TestOneShotCipher<CTR_Mode<AES> >("AES/CTR", BlockPaddingSchemeDef::DEFAULT_PADDING) && pass;
+	pass = TestOneShotCipher<CBC_CTS_Mode<AES> >("AES/CBC-CTS", BlockPaddingSchemeDef::DEFAULT_PADDING) && pass;
+
+	// Bad padding is rejected like the filter
+	{
+		SecByteBlock key(16), iv(16), block(16);
+		CBC_Mode<AES>::Decryption dec(key, key.size(), iv);
+		bool thrown = false;
+		try {
+			ProcessMessage(dec, block, block.size(), block, block.size());
+		}
+		catch (const InvalidCiphertext&) {
+			thrown = true;
+		}
+		pass = thrown && pass;
+		std::cout << (thrown ? "passed" : "FAILED") << "    AES/CBC one-shot, invalid padding\n";
+	}
+
+	return pass;
+}
+
+// Cuts a buffer at random points. Some segments are empty.
+template <class S, class T>
+void RandomSegments(std::vector<S> &segments, T *buffer, size_t length, size_t maxSegment)
+{
+	segments.clear();
+	while (length)
+	{
+		size_t n = STDMIN(length, (size_t)GlobalRNG().GenerateWord32(0, (word32)maxSegment));
+		segments.push_back(S(buffer, n));
+		buffer += n;
+		length -= n;
+	}
+	segments.push_back(S(buffer, 0));
+}
+
+template <class T>
+bool TestSegmentsAEAD(const char *name)
+{
+	SecByteBlock key(32), iv(12), aad(37), message(1500), expected(1500), actual(1500), recovered(1500);
+	byte tag1[16], tag2[16];
+	GlobalRNG().GenerateBlock(key, key.size());
+	GlobalRNG().GenerateBlock(iv, iv.size());
+	GlobalRNG().GenerateBlock(aad, aad.size());
+	GlobalRNG().GenerateBlock(message, message.size());
+
+	typename T::Encryption enc;
+	typename T::Decryption dec;
+	enc.SetKeyWithIV(key, enc.DefaultKeyLength(), iv, iv.size());
+	dec.SetKeyWithIV(key, dec.DefaultKeyLength(), iv, iv.size());
+
+	std::vector<ConstByteSegment> aadSegs, inSegs, cipherSegs;
+	std::vector<ByteSegment> outSegs, plainSegs;
+
+	bool fail = false;
+	const size_t maxSegments[] = {1, 7, 16, 100, 600, 2000};
+	for (size_t i=0; i<COUNTOF(maxSegments); ++i)
+	{
+		const size_t length = GlobalRNG().GenerateWord32(0, (word32)message.size());
+		enc.EncryptAndAuthenticate(expected, tag1, 16, iv, (int)iv.size(), aad, aad.size(), message, length);
+
+		RandomSegments(aadSegs, aad.begin(), aad.size(), maxSegments[i]);
+		RandomSegments(inSegs, message.begin(), length, maxSegments[i]);
+		RandomSegments(outSegs, actual.begin(), length, maxSegments[COUNTOF(maxSegments)-1-i]);
+
+		enc.EncryptAndAuthenticateSegments(&outSegs[0], outSegs.size(), tag2, 16, iv, (int)iv.size(),
+			&aadSegs[0], aadSegs.size(), &inSegs[0], inSegs.size());
+		fail = !VerifyBufsEqual(expected, actual, length) || !VerifyBufsEqual(tag1, tag2, 16) || fail;
+
+		RandomSegments(cipherSegs, actual.begin(), length, maxSegments[i]);
+		RandomSegments(plainSegs, recovered.begin(), length, maxSegments[i]);
+		fail = !dec.DecryptAndVerifySegments(&plainSegs[0], plainSegs.size(), tag2, 16, iv, (int)iv.size(),
+			&aadSegs[0], aadSegs.size(), &cipherSegs[0], cipherSegs.size()) || fail;
+		fail = !VerifyBufsEqual(recovered, message, length) || fail;
+
+		tag2[0] ^= 1;
+		fail = dec.DecryptAndVerifySegments(&plainSegs[0], plainSegs.size(), tag2, 16, iv, (int)iv.size(),
+			&aadSegs[0], aadSegs.size(), &cipherSegs[0], cipherSegs.size()) || fail;
+	}
+
+	std::cout << (fail ? "FAILED" : "passed") << "    " << name << " scatter/gather\n";
+	return !fail;
+}
+
+template <class T>
+bool TestSegmentsCipher(const char *name)
+{
+	SecByteBlock key(16), iv(16), message(4096), expected(4096), actual(4096);
+	GlobalRNG().GenerateBlock(key, key.size());
+	GlobalRNG().GenerateBlock(iv, iv.size());
+	GlobalRNG().GenerateBlock(message, message.size());
+
+	typename T::Encryption enc;
+	std::vector<ConstByteSegment> inSegs;
+	std::vector<ByteSegment> outSegs;
+
+	bool fail = false;
+	const size_t maxSegments[] = {1, 15, 64, 300, 5000};
+	for (size_t i=0; i<COUNTOF(maxSegments); ++i)
+	{
+		const size_t length = RoundDownToMultipleOf((size_t)GlobalRNG().GenerateWord32(0, 4096), (size_t)enc.MandatoryBlockSize());
+		enc.SetKeyWithIV(key, key.size(), iv);
+		enc.ProcessString(expected, message, length);
+
+		RandomSegments(inSegs, message.begin(), length, maxSegments[i]);
+		RandomSegments(outSegs, actual.begin(), length, maxSegments[COUNTOF(maxSegments)-1-i]);
+		enc.SetKeyWithIV(key, key.size(), iv);
+		fail = (enc.ProcessSegments(&outSegs[0], outSegs.size(), &inSegs[0], inSegs.size()) != length) || fail;
+		fail = !VerifyBufsEqual(expected, actual, length) || fail;
+	}
+
+	std::cout << (fail ? "FAILED" : "passed") << "    " << name << " scatter/gather\n";
+	return !fail;
+}
+
+bool ValidateScatterGather()
+{
+	std::cout << "\nScatter/gather validation suite running...\n\n";
+	bool pass = true;
+
+	pass = TestSegmentsAEAD<GCM<AES> >("AES/GCM") && pass;
+	pass = TestSegmentsAEAD<ChaCha20Poly1305>("ChaCha20/Poly1305") && pass;
+	pass = TestSegmentsCipher<CTR_Mode<AES> >("AES/CTR") && pass;
+	pass = TestSegmentsCipher<CBC_Mode<AES> >("AES/CBC") && pass;
+
+	{
+		SecByteBlock message(3000);
+		GlobalRNG().GenerateBlock(message, message.size());
+		byte expected[32], actual[32];
+		SHA256().CalculateDigest(expected, message, message.size());
+
+		std::vector<ConstByteSegment> segments;
+		RandomSegments(segments, message.begin(), message.size(), 200);
+		SHA256 sha;
+		sha.UpdateSegments(&segments[0], segments.size());
+		sha.Final(actual);
+
+		const bool fail = !VerifyBufsEqual(expected, actual, 32);
+		pass = !fail && pass;
+		std::cout << (fail ? "FAILED" : "passed") << "    SHA-256 scatter/gather\n";
+	}
+
+	{
+		// Output smaller than input
+		SecByteBlock key(16), iv(16), buffer(64);
+		CTR_Mode<AES>::Encryption enc(key, key.size(), iv);
+		ConstByteSegment in(buffer, 64);
+		ByteSegment out(buffer, 63);
+		bool thrown = false;
+		try {
+			enc.ProcessSegments(&out, 1, &in, 1);
+		}
+		catch (const InvalidArgument&) {
+			thrown = true;
+		}
+		pass = thrown && pass;
+		std::cout << (thrown ? "passed" : "FAILED") << "    AES/CTR scatter/gather, short output\n";
+	}
+
+	return pass;
+}
+
+bool ValidatePipelineProfile()
+{
+	std::cout << "\nPipeline profile validation suite running...\n\n";
+	bool pass = true, fail;
+
+	SecByteBlock message(5000), key(16), iv(16);
+	GlobalRNG().GenerateBlock(message, message.size());
+	GlobalRNG().GenerateBlock(key, key.size());
+	GlobalRNG().GenerateBlock(iv, iv.size());
+
+	std::string expected, actual;
+	CBC_Mode<AES>::Encryption enc(key, key.size(), iv);
+	StringSource(message, message.size(), true, new StreamTransformationFilter(enc, new HexEncoder(new StringSink(expected))));
+
+	enc.Resynchronize(iv);
+	StringSource source(message, message.size(), false, new StreamTransformationFilter(enc, new HexEncoder(new StringSink(actual))));
+	ProfilePipeline(source);
+	ProfilePipeline(source);
+
+	// 50 writes of 100 bytes, then empty writes for the end of the message
+	for (unsigned int i=0; i<50; ++i)
+		source.Pump(100);
+	source.PumpAll();
+
+	const std::vector<PipelineStageProfile> stages = GetPipelineProfile(source);
+	fail = stages.size() != 3 || actual != expected;
+	pass = !fail && pass;
+	std::cout << (fail ? "FAILED" : "passed") << "    transparent profiling of each stage\n";
+
+	if (stages.size() == 3)
+	{
+		fail = stages[0].name != "StreamTransformationFilter(" + enc.AlgorithmName() + ")";
+		fail = stages[0].putCalls != 50 + stages[0].callSizes[0] || stages[0].putBytes != message.size() || fail;
+		fail = stages[0].callSizes[BitPrecision(100)] != 50 || stages[0].messageEnds != 1 || fail;
+		fail = stages[1].putBytes != 5008 || stages[2].putBytes != 2*5008 || stages[2].messageEnds != 1 || fail;
+		pass = !fail && pass;
+		std::cout << (fail ? "FAILED" : "passed") << "    call counts, bytes and call sizes\n";
+
+		// StreamTransformationFilter holds back the last block for padding
+		fail = stages[0].maxQueuedBytes == 0 || stages[0].maxQueuedBytes > 2*AES::BLOCKSIZE || stages[1].maxQueuedBytes != 0;
+		pass = !fail && pass;
+		std::cout << (fail ? "FAILED" : "passed") << "    queued bytes\n";
+	}
+
+	std::ostringstream report;
+	ReportPipelineProfile(source, report);
+	fail = report.str().find("HexEncoder") == std::string::npos || report.str().find("Call sizes") == std::string::npos;
+	pass = !fail && pass;
+	std::cout << (fail ? "FAILED" : "passed") << "    report\n";
+
+	return pass;
 }
 
 NAMESPACE_END  // Test
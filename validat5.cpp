@@ -32,6 +32,7 @@
 #include "pssr.h"
 #include "hkdf.h"
 #include "scrypt.h"
+#include "argon2.h"
 #include "pwdbased.h"
 
 #include "cmac.h"
@@ -588,7 +589,28 @@ bool ValidateMD5MAC()
 
 bool ValidateHMAC()
 {
-	return RunTestDataFile("TestVectors/hmac.txt");
+	bool pass = RunTestDataFile("TestVectors/hmac.txt");
+
+	// Clone copies the keyed state, including a message in progress
+	const byte key[] = "Jefe", message[] = "what do ya want for nothing?";
+	member_ptr<HMAC<SHA256> > original(new HMAC<SHA256>(key, 4));
+	original->Update(message, 10);
+	member_ptr<MessageAuthenticationCode> clone(dynamic_cast<MessageAuthenticationCode*>(original->Clone()));
+	original.reset();
+
+	// RFC 4231, Test Case 2
+	const byte expected[] = {
+		0x5b,0xdc,0xc1,0x46,0xbf,0x60,0x75,0x4e,0x6a,0x04,0x24,0x26,0x08,0x95,0x75,0xc7,
+		0x5a,0x00,0x3f,0x08,0x9d,0x27,0x39,0x83,0x9d,0xec,0x58,0xb9,0x64,0xec,0x38,0x43};
+	byte actual[32];
+	clone->Update(message+10, 18);
+	clone->Final(actual);
+
+	bool fail = !VerifyBufsEqual(expected, actual, 32);
+	pass = !fail && pass;
+	std::cout << "\n" << (fail ? "FAILED" : "passed") << "    HMAC Clone\n";
+
+	return pass;
 }
 
 #ifdef CRYPTOPP_REMOVED
@@ -752,6 +774,55 @@ bool TestPBKDF(KeyDerivationFunction &pbkdf, const PBKDF_TestTuple *testSet, uns
 	return pass;
 }
 
+template <class T>
+bool TestPBKDF2_KeyState()
+{
+	// Password longer than a block, several output blocks with a partial last block
+	SecByteBlock password(T::BLOCKSIZE+3), salt(13);
+	for (size_t i=0; i<password.size(); ++i)
+		password[i] = static_cast<byte>(i*7+1);
+	for (size_t i=0; i<salt.size(); ++i)
+		salt[i] = static_cast<byte>(i*3+5);
+
+	const unsigned int iterations = 5;
+	const size_t derivedLen = T::DIGESTSIZE*2 + T::DIGESTSIZE/2;
+	SecByteBlock expected(derivedLen), derived(derivedLen), buffer(T::DIGESTSIZE), block(T::DIGESTSIZE);
+
+	HMAC<T> hmac(password, password.size());
+	for (size_t i=0; i*T::DIGESTSIZE < derivedLen; ++i)
+	{
+		byte count[4];
+		PutWord(false, BIG_ENDIAN_ORDER, count, word32(i+1));
+		hmac.Update(salt, salt.size());
+		hmac.Update(count, 4);
+		hmac.Final(buffer);
+		std::memcpy(block, buffer, buffer.size());
+		for (unsigned int j=1; j<iterations; ++j)
+		{
+			hmac.CalculateDigest(buffer, buffer, buffer.size());
+			xorbuf(block, buffer, buffer.size());
+		}
+		const size_t segmentLen = STDMIN(size_t(T::DIGESTSIZE), derivedLen-i*T::DIGESTSIZE);
+		std::memcpy(expected+i*T::DIGESTSIZE, block, segmentLen);
+	}
+
+	PKCS5_PBKDF2_HMAC<T> pbkdf;
+	pbkdf.DeriveKey(derived, derived.size(), 0, password, password.size(), salt, salt.size(), iterations);
+	bool fail = !VerifyBufsEqual(derived, expected, derived.size());
+
+	// The timed derivation must reproduce with the iteration count it returns
+	unsigned int count = pbkdf.DeriveKey(expected, expected.size(), 0, password, password.size(), salt, salt.size(), 0, 0.01);
+	pbkdf.DeriveKey(derived, derived.size(), 0, password, password.size(), salt, salt.size(), count);
+	fail = !VerifyBufsEqual(derived, expected, derived.size()) || fail;
+
+	// An empty timed derivation has no block to time and returns at once
+	fail = pbkdf.DeriveKey(derived, 0, 0, password, password.size(), salt, salt.size(), 0, 0.01) != 1 || fail;
+
+	std::cout << (fail ? "FAILED   " : "passed   ") << pbkdf.AlgorithmName() << ", ";
+	std::cout << iterations << " and " << count << " iterations\n";
+	return !fail;
+}
+
 bool ValidatePBKDF()
 {
 	bool pass = true;
@@ -783,7 +854,10 @@ bool ValidatePBKDF()
 	PBKDF_TestTuple testSet[] =
 	{
 		{0, 5, "70617373776f7264", "1234567878563412", "D1DAA78615F287E6"},
-		{0, 500, "416C6C206E2D656E746974696573206D75737420636F6D6D756E69636174652077697468206F74686572206E2d656E74697469657320766961206E2D3120656E746974656568656568656573", "1234567878563412","6A8970BF68C92CAEA84A8DF28510858607126380CC47AB2D"}
+		{0, 500, "416C6C206E2D656E746974696573206D75737420636F6D6D756E69636174652077697468206F74686572206E2d656E74697469657320766961206E2D3120656E746974656568656568656573", "1234567878563412","6A8970BF68C92CAEA84A8DF28510858607126380CC47AB2D"},
+		// from RFC 6070
+		{0, 2, "70617373776f7264", "73616c74", "EA6C014DC72D6F8CCD1ED92ACE1D41F0D8DE8957"},
+		{0, 4096, "70617373776f7264", "73616c74", "4B007901B765489ABEAD49D926F721D065A429C1"}
 	};
 
 	PKCS5_PBKDF2_HMAC<SHA1> pbkdf;
@@ -792,6 +866,21 @@ bool ValidatePBKDF()
 	pass = TestPBKDF(pbkdf, testSet, COUNTOF(testSet)) && pass;
 	}
 
+	{
+	// precomputed HMAC states against HMAC<T>, and the HMAC<T> fallback
+	std::cout << "\nPKCS #5 PBKDF2 precomputed state validation suite running...\n\n";
+	pass = TestPBKDF2_KeyState<SHA1>() && pass;
+	pass = TestPBKDF2_KeyState<SHA224>() && pass;
+	pass = TestPBKDF2_KeyState<SHA256>() && pass;
+	pass = TestPBKDF2_KeyState<SHA384>() && pass;
+	pass = TestPBKDF2_KeyState<SHA512>() && pass;
+	pass = TestPBKDF2_KeyState<Weak::MD5>() && pass;
+	pass = TestPBKDF2_KeyState<RIPEMD160>() && pass;
+	pass = TestPBKDF2_KeyState<Tiger>() && pass;
+	pass = TestPBKDF2_KeyState<Whirlpool>() && pass;
+	pass = TestPBKDF2_KeyState<SHA3_256>() && pass;
+	}
+
 	return pass;
 }
 
@@ -995,6 +1084,76 @@ bool ValidateScrypt()
 	return pass;
 }
 
+bool ValidateArgon2()
+{
+	std::cout << "\nRFC 9106 Argon2 validation suite running...\n\n";
+	bool pass = true;
+
+	// https://www.rfc-editor.org/rfc/rfc9106.html, Section 5
+	const char *expected[] = {
+		"512b391b6f1162975371d30919734294f868e3be3984f3c1a13a4db9fabe4acb",
+		"c814d9d1dc7f37aa13f0d77f2494bda1c8de6b016dd388d29952a4c4672b6ce8",
+		"0d640df58d78766c08c037a34a8b53c9d01ef0452d75b65eb52520e96b01e659"
+	};
+
+	byte password[32], salt[16], secret[8], ad[12];
+	std::memset(password, 0x01, sizeof(password));
+	std::memset(salt, 0x02, sizeof(salt));
+	std::memset(secret, 0x03, sizeof(secret));
+	std::memset(ad, 0x04, sizeof(ad));
+
+	for (unsigned int i=0; i<COUNTOF(expected); ++i)
+	{
+		std::string expect;
+		StringSource(expected[i], true, new HexDecoder(new StringSink(expect)));
+
+		Argon2 kdf(static_cast<Argon2::Variant>(i));
+		SecByteBlock derived(expect.size());
+		kdf.DeriveKey(derived, derived.size(), password, sizeof(password), salt, sizeof(salt),
+			3, 32, 4, secret, sizeof(secret), ad, sizeof(ad));
+		bool fail = !VerifyBufsEqual(derived, ConstBytePtr(expect), BytePtrSize(expect));
+
+		// Same derivation through the NameValuePairs interface
+		AlgorithmParameters params = MakeParameters("TimeCost", (word32)3)
+			("MemoryCost", (word32)32)("Parallelization", (word32)4)
+			(Name::Salt(), ConstByteArrayParameter(salt, sizeof(salt), false))
+			(Name::Key(), ConstByteArrayParameter(secret, sizeof(secret), false))
+			("AssociatedData", ConstByteArrayParameter(ad, sizeof(ad), false));
+		std::memset(derived, 0x00, derived.size());
+		kdf.DeriveKey(derived, derived.size(), password, sizeof(password), params);
+		fail = !VerifyBufsEqual(derived, ConstBytePtr(expect), BytePtrSize(expect)) || fail;
+		pass = pass && !fail;
+
+		std::cout << (fail ? "FAILED   " : "passed   ") << kdf.AlgorithmName();
+		std::cout << " (" << kdf.AlgorithmProvider() << ") t=3, m=32, p=4 " << expected[i] << std::endl;
+	}
+
+	// Parameter checks
+	{
+		Argon2 kdf;
+		byte derived[32];
+		bool fail = true;
+		try {
+			// salt is too short
+			kdf.DeriveKey(derived, sizeof(derived), password, sizeof(password), salt, 4, 1, 32, 1);
+		} catch (const InvalidArgument&) {
+			fail = false;
+		}
+
+		try {
+			// memory is less than 8 blocks per lane
+			kdf.DeriveKey(derived, sizeof(derived), password, sizeof(password), salt, sizeof(salt), 1, 31, 4);
+			fail = true;
+		} catch (const InvalidArgument&) {
+		}
+
+		pass = pass && !fail;
+		std::cout << (fail ? "FAILED   " : "passed   ") << "parameter validation" << std::endl;
+	}
+
+	return pass;
+}
+
 struct Poly1305_TestTuples
 {
 	const char *key, *message, *nonce, *digest;
@@ -28,6 +28,8 @@ extern std::string g_argvPathHint;
 
 bool ValidateAll(bool thorough);
 bool TestSettings();
+bool TestCPUFeatureMask();
+bool TestInstrumentation();
 bool TestOS_RNG();
 // bool TestSecRandom();
 bool TestRandomPool();
@@ -74,6 +76,7 @@ bool ValidateCipherModes();
 bool ValidatePBKDF();
 bool ValidateHKDF();
 bool ValidateScrypt();
+bool ValidateArgon2();
 
 bool ValidateDES();
 bool ValidateIDEA();
@@ -119,6 +122,10 @@ bool ValidateCCM();
 bool ValidateGCM();
 bool ValidateXTS();
 bool ValidateCMAC();
+bool ValidateOneShot();
+bool ValidateScatterGather();
+bool ValidatePipelineProfile();
+bool ValidateChaCha20Poly1305();
 
 bool ValidateBBS();
 bool ValidateDH();
@@ -145,6 +152,7 @@ bool ValidateESIGN();
 
 bool ValidateHashDRBG();
 bool ValidateHmacDRBG();
+bool ValidateCtrDRBG();
 
 bool TestX25519();
 bool TestEd25519();
@@ -174,6 +182,7 @@ bool TestHuffmanCodes();
 bool TestASN1Parse();
 // https://github.com/weidai11/cryptopp/pull/334
 bool TestStringSink();
+bool TestByteQueue();
 // Additional tests due to no coverage
 bool TestCompressors();
 bool TestEncryptors();
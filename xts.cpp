@@ -175,6 +175,62 @@ inline void GF_Double(byte *inout, unsigned int len)
     GF_Double(inout, inout, len);
 }
 
+// Calculate T*alpha^1 through T*alpha^(count-1) given T in the first
+// block. The 16-byte case keeps the tweak in a SIMD register and uses
+// a shift and a masked carry rather than the word-at-a-time GF_Double.
+inline void GF_Double_Blocks(byte *tweaks, unsigned int len, unsigned int count)
+{
+    CRYPTOPP_ASSERT(count >= 1);
+
+#if defined(CRYPTOPP_DISABLE_ASM)
+    for (unsigned int i=1; i<count; ++i)
+        GF_Double(tweaks+i*len, tweaks+(i-1)*len, len);
+
+#elif defined(__SSE2__) || defined(_M_X64)
+    if (len == 16)
+    {
+        // Carry bit 63 into bit 64, and bit 127 into the polynomial
+        const __m128i poly = _mm_set_epi32(0, 1, 0, 0x87);
+        __m128i x = _mm_loadu_si128(CONST_M128_CAST(tweaks));
+        for (unsigned int i=1; i<count; ++i)
+        {
+            const __m128i c = _mm_shuffle_epi32(_mm_srai_epi32(x, 31), _MM_SHUFFLE(0,1,0,3));
+            x = _mm_xor_si128(_mm_add_epi64(x, x), _mm_and_si128(c, poly));
+            _mm_storeu_si128(M128_CAST(tweaks+i*16), x);
+        }
+        return;
+    }
+
+    for (unsigned int i=1; i<count; ++i)
+        GF_Double(tweaks+i*len, tweaks+(i-1)*len, len);
+
+#elif defined(__aarch32__) || defined(__aarch64__) || defined(_M_ARM64)
+    if (len == 16)
+    {
+        // Carry bit 63 into bit 64, and bit 127 into the polynomial
+        const uint32_t p[4] = {0x87, 0, 1, 0};
+        const uint32x4_t poly = vld1q_u32(p);
+        uint64x2_t x = vreinterpretq_u64_u8(vld1q_u8(tweaks));
+        for (unsigned int i=1; i<count; ++i)
+        {
+            const uint32x4_t s = vreinterpretq_u32_s32(
+                vshrq_n_s32(vreinterpretq_s32_u64(x), 31));
+            const uint32x4_t c = vandq_u32(vextq_u32(s, s, 3), poly);
+            x = veorq_u64(vshlq_n_u64(x, 1), vreinterpretq_u64_u32(c));
+            vst1q_u8(tweaks+i*16, vreinterpretq_u8_u64(x));
+        }
+        return;
+    }
+
+    for (unsigned int i=1; i<count; ++i)
+        GF_Double(tweaks+i*len, tweaks+(i-1)*len, len);
+
+#else
+    for (unsigned int i=1; i<count; ++i)
+        GF_Double(tweaks+i*len, tweaks+(i-1)*len, len);
+#endif
+}
+
 ANONYMOUS_NAMESPACE_END
 
 NAMESPACE_BEGIN(CryptoPP)
@@ -233,11 +289,48 @@ void XTS_ModeBase::Resynchronize(word64 sector, ByteOrder order)
     GetTweakCipher().ProcessBlock(m_xregister);
 }
 
+void XTS_ModeBase::ProcessSectors(byte *outString, const byte *inString, word64 sector,
+    size_t sectorSize, size_t count, ByteOrder order)
+{
+    const unsigned int blockSize = GetBlockCipher().BlockSize();
+
+    CRYPTOPP_ASSERT(sectorSize != 0 && sectorSize % blockSize == 0);
+    if (sectorSize == 0 || sectorSize % blockSize != 0)
+        throw InvalidArgument(AlgorithmName() + ": sector size is not a multiple of the block size");
+
+    while (count)
+    {
+        const size_t batch = STDMIN(count, (size_t)ParallelBlocks);
+
+        // format the sector numbers, ParallelBlocks at a time
+        std::memset(m_xsectors, 0x00, batch*blockSize);
+        for (size_t i=0; i<batch; ++i)
+            PutWord<word64>(false, order, m_xsectors+i*blockSize, sector+i);
+
+        // encrypt the tweaks in one call to the multi-block kernel
+        GetTweakCipher().AdvancedProcessBlocks(m_xsectors, NULLPTR, m_xsectors,
+            batch*blockSize, BlockTransformation::BT_AllowParallel);
+
+        for (size_t i=0; i<batch; ++i)
+        {
+            std::memcpy(m_xregister, m_xsectors+i*blockSize, blockSize);
+            ProcessData(outString, inString, sectorSize);
+
+            outString += sectorSize;
+            inString += sectorSize;
+        }
+
+        sector += batch;
+        count -= batch;
+    }
+}
+
 void XTS_ModeBase::ResizeBuffers()
 {
     BlockOrientedCipherModeBase::ResizeBuffers();
     m_xworkspace.New(GetBlockCipher().BlockSize()*ParallelBlocks);
     m_xregister.New(GetBlockCipher().BlockSize()*ParallelBlocks);
+    m_xsectors.New(GetBlockCipher().BlockSize()*ParallelBlocks);
 }
 
 void XTS_ModeBase::ProcessData(byte *outString, const byte *inString, size_t length)
@@ -252,13 +345,8 @@ void XTS_ModeBase::ProcessData(byte *outString, const byte *inString, size_t len
     // encrypt the data unit, optimal size at a time
     for ( ; i+parallelSize<=length; i+=parallelSize)
     {
-        // If this fires the GF_Double'ing below is not in sync
-        CRYPTOPP_ASSERT(ParallelBlocks == 4);
-
         // m_xregister[0] always points to the next tweak.
-        GF_Double(m_xregister+1*blockSize, m_xregister+0*blockSize, blockSize);
-        GF_Double(m_xregister+2*blockSize, m_xregister+1*blockSize, blockSize);
-        GF_Double(m_xregister+3*blockSize, m_xregister+2*blockSize, blockSize);
+        GF_Double_Blocks(m_xregister, blockSize, ParallelBlocks);
 
         // merge the tweak into the input block
         XorBuffer(m_xworkspace, inString+i, m_xregister, parallelSize);
@@ -119,6 +119,30 @@ public:
     ///  compatibility with the IEEE P1619 paper.
     void Resynchronize(word64 sector, ByteOrder order=BIG_ENDIAN_ORDER);
 
+    /// \brief Encrypt or decrypt a run of consecutive sectors
+    /// \param outString the output byte buffer
+    /// \param inString the input byte buffer
+    /// \param sector the 64-bit sector number of the first data unit
+    /// \param sectorSize the size of each data unit, in bytes
+    /// \param count the number of data units to process
+    /// \param order the endian order the sector number should be written
+    /// \throws InvalidArgument if sectorSize is not a multiple of BlockSize()
+    /// \details ProcessSectors() is equivalent to calling
+    ///  <tt>Resynchronize(sector+i, order)</tt> followed by
+    ///  <tt>ProcessData(outString+i*sectorSize, inString+i*sectorSize, sectorSize)</tt>
+    ///  for each <tt>i</tt> in <tt>[0, count)</tt>. The tweaks for up to
+    ///  ParallelBlocks sectors are encrypted with a single call to the
+    ///  tweak cipher, and the per-call overhead of Resynchronize() is
+    ///  avoided.
+    /// \details Each data unit must be a multiple of BlockSize(). Ciphertext
+    ///  stealing is not available through this interface. Use Resynchronize()
+    ///  and ProcessLastBlock() for data units with a partial final block.
+    /// \details inString and outString can be the same buffer. After the call
+    ///  the object is synchronized to the end of the last sector.
+    /// \since Crypto++ 8.4
+    void ProcessSectors(byte *outString, const byte *inString, word64 sector,
+        size_t sectorSize, size_t count, ByteOrder order=BIG_ENDIAN_ORDER);
+
 protected:
     virtual void ResizeBuffers();
 
@@ -136,8 +160,9 @@ protected:
     // Buffers are sized based on ParallelBlocks
     SecByteBlock m_xregister;
     SecByteBlock m_xworkspace;
+    SecByteBlock m_xsectors;
 
-    enum {ParallelBlocks = 4};
+    enum {ParallelBlocks = 8};
 };
 
 /// \brief XTS block cipher mode of operation implementation